@@ -54,6 +54,7 @@ using namespace nlohmann;
 #include "libslic3r/Platform.hpp"
 #include "libslic3r/Print.hpp"
 #include "libslic3r/SLAPrint.hpp"
+#include "libslic3r/SlicingService.hpp"
 #include "libslic3r/TriangleMesh.hpp"
 #include "libslic3r/Format/AMF.hpp"
 #include "libslic3r/Format/3mf.hpp"
@@ -63,6 +64,7 @@ using namespace nlohmann;
 #include "libslic3r/Utils.hpp"
 #include "libslic3r/Time.hpp"
 #include "libslic3r/Thread.hpp"
+#include "libslic3r/Trace.hpp"
 #include "libslic3r/BlacklistedLibraryCheck.hpp"
 #include "libslic3r/FlushVolCalc.hpp"
 
@@ -1081,6 +1083,9 @@ int CLI::run(int argc, char **argv)
     m_extra_config.apply(m_config, true);
     m_extra_config.normalize_fdm();
 
+    // Record the slicing pipeline zones when requested, both the GUI and the CLI flow export them on exit.
+    Trace::ScopedChromeTrace chrome_trace(m_config.opt_string("trace", true));
+
     PrinterTechnology printer_technology = get_printer_technology(m_config);
 
     //BBS: remove GCodeViewer as seperate APP logic
@@ -1183,6 +1188,20 @@ int CLI::run(int argc, char **argv)
         }
     }
 
+    if (const std::string &service_socket = m_config.opt_string("service", true); ! service_socket.empty()) {
+        // The models and the settings are received over the socket, the settings loaded from the command line are the defaults of the sessions.
+        DynamicPrintConfig base_config = DynamicPrintConfig::full_print_config();
+        for (const std::string &file : load_configs) {
+            DynamicPrintConfig config;
+            config.load(file, config_substitution_rule);
+            config.normalize_fdm();
+            base_config.apply(config, true);
+        }
+        base_config.apply(m_extra_config, true);
+        // The clients may only read and write the files inside the output directory, by default the working directory.
+        return SlicingService(service_socket, outfile_dir.empty() ? boost::filesystem::current_path().string() : outfile_dir, base_config).run();
+    }
+
     global_begin_time = (long long)Slic3r::Utils::get_current_time_utc();
     BOOST_LOG_TRIVIAL(warning) << boost::format("cli mode, Current OrcaSlicer Version %1%")%SoftFever_VERSION;
 
@@ -4616,6 +4635,11 @@ int CLI::run(int argc, char **argv)
     // loop through action options
     bool export_to_3mf = false, load_slicedata = false, export_slicedata = false, export_slicedata_error = false;
     bool no_check = false;
+    bool memory_report = false, release_intermediate_data = false;
+    if (ConfigOptionBool *memory_report_option = m_config.option<ConfigOptionBool>("memory_report"))
+        memory_report = memory_report_option->value;
+    if (ConfigOptionBool *release_intermediate_data_option = m_config.option<ConfigOptionBool>("release_intermediate_data"))
+        release_intermediate_data = release_intermediate_data_option->value;
     std::string export_3mf_file, load_slice_data_dir, export_slice_data_dir, export_stls_dir;
     std::vector<ThumbnailData*> calibration_thumbnails;
     std::vector<int> plate_object_count(partplate_list.get_plate_count(), 0);
@@ -4991,6 +5015,8 @@ int CLI::run(int argc, char **argv)
                                 const PrintConfig& print_config = print_fff->config();
                                 Model::setExtruderParams(m_print_config, filament_count);
                                 Model::setPrintSpeedTable(m_print_config, print_config);
+                                // The cached slicing data is exported from the objects after the G-code, keep it complete then.
+                                print_fff->set_low_memory_mode(release_intermediate_data && ! load_slicedata && ! export_slicedata);
                                 if (load_slicedata) {
                                     std::string plate_dir = load_slice_data_dir+"/"+std::to_string(index+1);
                                     int ret = print->load_cached_data(plate_dir);
@@ -5065,8 +5091,17 @@ int CLI::run(int argc, char **argv)
                                         part_plate->set_tmp_gcode_path(outfile);
                                     }
                                     BOOST_LOG_TRIVIAL(info) << "process finished, will export gcode temporily to " << outfile << std::endl;
+                                    if (memory_report) {
+                                        for (const PrintObject *object : print_fff->objects())
+                                            if (! object->get_shared_object())
+                                                boost::nowide::cout << "plate " << index + 1 << ", object " << object->model_object()->name << ": " << object->memory_usage().to_string() << std::endl;
+                                    }
                                     temp_time = (long long)Slic3r::Utils::get_current_time_utc();
                                     outfile = print_fff->export_gcode(outfile, gcode_result, nullptr);
+                                    if (print_fff->low_memory_mode())
+                                        BOOST_LOG_TRIVIAL(info) << "plate " << index + 1 << ": exported G-code in low memory mode, " << log_memory_info();
+                                    if (memory_report)
+                                        boost::nowide::cout << "plate " << index + 1 << ", G-code preview data: " << format_memsize_MB(gcode_result->memsize()) << std::endl;
                                     time_using_cache = time_using_cache + ((long long)Slic3r::Utils::get_current_time_utc() - temp_time);
                                     BOOST_LOG_TRIVIAL(info) << "export_gcode finished: time_using_cache update to " << time_using_cache << " secs.";
 
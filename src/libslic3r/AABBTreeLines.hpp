@@ -7,10 +7,16 @@
 #include "libslic3r/AABBTreeIndirect.hpp"
 #include "libslic3r/Line.hpp"
 #include <algorithm>
+#include <array>
 #include <cmath>
+#include <cstdint>
+#include <limits>
+#include <numeric>
 #include <type_traits>
 #include <vector>
 
+#include <boost/config.hpp>
+
 namespace Slic3r {
 namespace AABBTreeLines {
 
@@ -37,6 +43,46 @@ namespace AABBTreeLines {
             }
         };
 
+        // Ray hit count of a single line, see coordinate_aligned_ray_hit_count().
+        template <typename LineType, typename VectorType, int coordinate>
+        inline std::tuple<int, int> coordinate_aligned_ray_hit_count_line(const LineType& line, const VectorType& ray_origin)
+        {
+            static constexpr int other_coordinate = (coordinate + 1) % 2;
+            using Scalar = typename LineType::Scalar;
+            using Floating = typename std::conditional<std::is_floating_point<Scalar>::value, Scalar, double>::type;
+            if (ray_origin[other_coordinate] < std::min(line.a[other_coordinate], line.b[other_coordinate]) || ray_origin[other_coordinate] >= std::max(line.a[other_coordinate], line.b[other_coordinate])) {
+                // the second inequality is nonsharp for a reason
+                //  without it, we may count contour border twice when the lines meet exactly at the spot of intersection. this prevents is
+                return { 0, 0 };
+            }
+
+            Scalar line_max = std::max(line.a[coordinate], line.b[coordinate]);
+            Scalar line_min = std::min(line.a[coordinate], line.b[coordinate]);
+            if (ray_origin[coordinate] > line_max) {
+                return { 1, 0 };
+            } else if (ray_origin[coordinate] < line_min) {
+                return { 0, 1 };
+            } else {
+                // find intersection of ray with line
+                //  that is when ( line.a + t * (line.b - line.a) )[other_coordinate] == ray_origin[other_coordinate]
+                //  t = ray_origin[oc] - line.a[oc] / (line.b[oc] - line.a[oc]);
+                //  then we want to get value of intersection[ coordinate]
+                //  val_c = line.a[c] + t * (line.b[c] - line.a[c]);
+                //  Note that ray and line may overlap, when  (line.b[oc] - line.a[oc]) is zero
+                //  In that case, we return negative number
+                Floating distance_oc = line.b[other_coordinate] - line.a[other_coordinate];
+                Floating t = (ray_origin[other_coordinate] - line.a[other_coordinate]) / distance_oc;
+                Floating val_c = line.a[coordinate] + t * (line.b[coordinate] - line.a[coordinate]);
+                if (ray_origin[coordinate] > val_c) {
+                    return { 1, 0 };
+                } else if (ray_origin[coordinate] < val_c) {
+                    return { 0, 1 };
+                } else { // ray origin is on boundary
+                    return { -1, -1 };
+                }
+            }
+        }
+
         // returns number of intersections of ray starting in ray_origin and following the specified coordinate line with lines in tree
         // first number is hits in positive direction of ray, second number hits in negative direction. returns neagtive numbers when ray_origin is
         // on some line exactly.
@@ -47,43 +93,10 @@ namespace AABBTreeLines {
             const VectorType& ray_origin)
         {
             static constexpr int other_coordinate = (coordinate + 1) % 2;
-            using Scalar = typename LineType::Scalar;
-            using Floating = typename std::conditional<std::is_floating_point<Scalar>::value, Scalar, double>::type;
             const auto& node = tree.node(node_idx);
             assert(node.is_valid());
             if (node.is_leaf()) {
-                const LineType& line = lines[node.idx];
-                if (ray_origin[other_coordinate] < std::min(line.a[other_coordinate], line.b[other_coordinate]) || ray_origin[other_coordinate] >= std::max(line.a[other_coordinate], line.b[other_coordinate])) {
-                    // the second inequality is nonsharp for a reason
-                    //  without it, we may count contour border twice when the lines meet exactly at the spot of intersection. this prevents is
-                    return { 0, 0 };
-                }
-
-                Scalar line_max = std::max(line.a[coordinate], line.b[coordinate]);
-                Scalar line_min = std::min(line.a[coordinate], line.b[coordinate]);
-                if (ray_origin[coordinate] > line_max) {
-                    return { 1, 0 };
-                } else if (ray_origin[coordinate] < line_min) {
-                    return { 0, 1 };
-                } else {
-                    // find intersection of ray with line
-                    //  that is when ( line.a + t * (line.b - line.a) )[other_coordinate] == ray_origin[other_coordinate]
-                    //  t = ray_origin[oc] - line.a[oc] / (line.b[oc] - line.a[oc]);
-                    //  then we want to get value of intersection[ coordinate]
-                    //  val_c = line.a[c] + t * (line.b[c] - line.a[c]);
-                    //  Note that ray and line may overlap, when  (line.b[oc] - line.a[oc]) is zero
-                    //  In that case, we return negative number
-                    Floating distance_oc = line.b[other_coordinate] - line.a[other_coordinate];
-                    Floating t = (ray_origin[other_coordinate] - line.a[other_coordinate]) / distance_oc;
-                    Floating val_c = line.a[coordinate] + t * (line.b[coordinate] - line.a[coordinate]);
-                    if (ray_origin[coordinate] > val_c) {
-                        return { 1, 0 };
-                    } else if (ray_origin[coordinate] < val_c) {
-                        return { 0, 1 };
-                    } else { // ray origin is on boundary
-                        return { -1, -1 };
-                    }
-                }
+                return coordinate_aligned_ray_hit_count_line<LineType, VectorType, coordinate>(lines[node.idx], ray_origin);
             } else {
                 int intersections_above = 0;
                 int intersections_below = 0;
@@ -155,6 +168,25 @@ namespace AABBTreeLines {
             }
         }
 
+        // Sort the intersections by their distance from the start of the line.
+        template <typename LineType, typename VectorType>
+        inline void sort_intersections_along_line(const LineType& line, std::vector<std::pair<VectorType, size_t>>& intersections)
+        {
+            using Floating =
+                typename std::conditional<std::is_floating_point<typename LineType::Scalar>::value, typename LineType::Scalar, double>::type;
+
+            std::vector<std::pair<Floating, std::pair<VectorType, size_t>>> points_with_sq_distance {};
+            for (const auto& p : intersections) {
+                points_with_sq_distance.emplace_back((p.first - line.a).template cast<Floating>().squaredNorm(), p);
+            }
+            std::sort(points_with_sq_distance.begin(), points_with_sq_distance.end(),
+                [](const std::pair<Floating, std::pair<VectorType, size_t>>& left,
+                    std::pair<Floating, std::pair<VectorType, size_t>>& right) { return left.first < right.first; });
+            for (size_t i = 0; i < points_with_sq_distance.size(); i++) {
+                intersections[i] = points_with_sq_distance[i].second;
+            }
+        }
+
     } // namespace detail
 
     // Build a balanced AABB Tree over a vector of lines, balancing the tree
@@ -277,24 +309,383 @@ namespace AABBTreeLines {
 
         auto intersections = detail::get_intersections_with_line<LineType, TreeType, VectorType>(0, tree, lines, line, line_bb);
         if (sorted) {
-            using Floating =
-                typename std::conditional<std::is_floating_point<typename LineType::Scalar>::value, typename LineType::Scalar, double>::type;
-
-            std::vector<std::pair<Floating, std::pair<VectorType, size_t>>> points_with_sq_distance {};
-            for (const auto& p : intersections) {
-                points_with_sq_distance.emplace_back((p.first - line.a).template cast<Floating>().squaredNorm(), p);
-            }
-            std::sort(points_with_sq_distance.begin(), points_with_sq_distance.end(),
-                [](const std::pair<Floating, std::pair<VectorType, size_t>>& left,
-                    std::pair<Floating, std::pair<VectorType, size_t>>& right) { return left.first < right.first; });
-            for (size_t i = 0; i < points_with_sq_distance.size(); i++) {
-                intersections[i] = points_with_sq_distance[i].second;
-            }
+            detail::sort_intersections_along_line(line, intersections);
         }
 
         return intersections;
     }
 
+    namespace detail {
+
+        // Tree over lines, which are packed by their proximity into leaves of up to LEAF_SIZE lines. Each inner node has up to
+        // BRANCHING children, the bounding boxes of the children are stored in the node. Both the leaves and the nodes are stored
+        // as structures of arrays, so that the distances of a point to all lines of a leaf or to all children of a node are
+        // evaluated by a single loop, which the compiler vectorizes. Compared to AABBTreeIndirect::Tree with a single line per leaf
+        // and two children per node, there are much less nodes to traverse and less branches to mispredict.
+        // The distances to lines are evaluated with the same arithmetic as line_alg::distance_to_squared(). Of several lines
+        // at the same distance, the one with the lowest index is reported, thus the results do not depend on the layout of the tree.
+        template <typename LineType>
+        class PackedLinesTree {
+        public:
+            static constexpr size_t LEAF_SIZE = 8;
+            static constexpr size_t BRANCHING = 4;
+            using Scalar = typename LineType::Scalar;
+            // Integer coordinates are stored as doubles, which represent them and their differences exactly.
+            using Floating = typename std::conditional<std::is_floating_point<Scalar>::value, Scalar, double>::type;
+            using BoundingBox = Eigen::AlignedBox<Floating, 2>;
+
+            PackedLinesTree() = default;
+
+            explicit PackedLinesTree(const std::vector<LineType>& lines)
+            {
+                if (lines.empty())
+                    return;
+                assert(lines.size() < size_t(std::numeric_limits<uint32_t>::max()));
+                std::vector<uint32_t> order(lines.size());
+                std::iota(order.begin(), order.end(), 0);
+                std::vector<Vec<2, Floating>> centroids;
+                centroids.reserve(lines.size());
+                for (const LineType& line : lines)
+                    centroids.emplace_back((line.a.template cast<Floating>() + line.b.template cast<Floating>()) * Floating(0.5));
+                m_leaves.reserve((lines.size() + LEAF_SIZE - 1) / LEAF_SIZE);
+                m_nodes.reserve(m_leaves.capacity() / (BRANCHING - 1) + 1);
+                m_nodes.emplace_back();
+                this->build_node(0, lines, centroids, order.begin(), order.end());
+            }
+
+            bool empty() const { return m_nodes.empty(); }
+
+            // Returns squared distance to the closest line, or -1 if the tree is empty.
+            // If hint_idx is a valid line index, its distance bounds the search from the start, which prunes most of the tree
+            // when the hinted line is close to the point, for example the closest line of the previous point of a polyline.
+            Floating squared_distance(const std::vector<LineType>& lines, const Vec<2, Scalar>& point, size_t& hit_idx_out,
+                Vec<2, Floating>& hit_point_out, size_t hint_idx = size_t(-1)) const
+            {
+                if (this->empty())
+                    return Floating(-1);
+
+                const Vec<2, Floating> p = point.template cast<Floating>();
+                Floating best_sqr_d = std::numeric_limits<Floating>::infinity();
+                size_t best_idx = size_t(-1);
+                if (hint_idx < lines.size()) {
+                    best_sqr_d = Floating(line_alg::distance_to_squared(lines[hint_idx], point));
+                    best_idx = hint_idx;
+                }
+
+                // Depth first traversal, visiting the closer children first.
+                std::array<Entry, STACK_SIZE> stack;
+                size_t stack_size = 0;
+                stack[stack_size++] = { 0, false, 0 };
+                while (stack_size > 0) {
+                    const Entry entry = stack[--stack_size];
+                    // Lines at the same distance as the best line are considered to resolve ties by the line index.
+                    if (entry.sqr_d > best_sqr_d)
+                        continue;
+                    if (entry.leaf) {
+                        const Leaf& leaf = m_leaves[entry.idx];
+                        Floating sqr_d[LEAF_SIZE];
+                        leaf_squared_distances(leaf, p, sqr_d);
+                        for (size_t i = 0; i < leaf.count; ++i)
+                            if (sqr_d[i] < best_sqr_d || (sqr_d[i] == best_sqr_d && leaf.line_idx[i] < best_idx)) {
+                                best_sqr_d = sqr_d[i];
+                                best_idx = leaf.line_idx[i];
+                            }
+                    } else {
+                        const Node& node = m_nodes[entry.idx];
+                        Floating sqr_d[BRANCHING];
+                        node_squared_distances(node, p, sqr_d);
+                        // Push the children, which may contain the closest line, sorted by decreasing distance.
+                        const size_t stack_begin = stack_size;
+                        for (size_t i = 0; i < node.num_children; ++i)
+                            if (sqr_d[i] <= best_sqr_d) {
+                                const Entry child { node.child[i], bool(node.leaf_mask & (1 << i)), sqr_d[i] };
+                                size_t j = stack_size++;
+                                for (; j > stack_begin && stack[j - 1].sqr_d < child.sqr_d; --j)
+                                    stack[j] = stack[j - 1];
+                                stack[j] = child;
+                            }
+                        assert(stack_size <= stack.size());
+                    }
+                }
+
+                Vec<2, Scalar> nearest_point;
+                line_alg::distance_to_squared(lines[best_idx], point, &nearest_point);
+                hit_idx_out = best_idx;
+                hit_point_out = nearest_point.template cast<Floating>();
+                return best_sqr_d;
+            }
+
+            // Returns indices of all lines closer than sqrt(max_distance_squared), sorted.
+            std::vector<size_t> all_lines_in_radius(const Vec<2, Scalar>& point, Floating max_distance_squared) const
+            {
+                std::vector<size_t> found_lines;
+                if (this->empty())
+                    return found_lines;
+
+                const Vec<2, Floating> p = point.template cast<Floating>();
+                this->visit([&p, max_distance_squared](const BoundingBox& bbox) { return bbox.squaredExteriorDistance(p) < max_distance_squared; },
+                    [&p, max_distance_squared, &found_lines](const Leaf& leaf) {
+                        Floating sqr_d[LEAF_SIZE];
+                        leaf_squared_distances(leaf, p, sqr_d);
+                        for (size_t i = 0; i < leaf.count; ++i)
+                            if (sqr_d[i] < max_distance_squared)
+                                found_lines.push_back(leaf.line_idx[i]);
+                    });
+                std::sort(found_lines.begin(), found_lines.end());
+                return found_lines;
+            }
+
+            // See detail::coordinate_aligned_ray_hit_count().
+            template <int coordinate>
+            std::tuple<int, int> coordinate_aligned_ray_hit_count(const std::vector<LineType>& lines, const Vec<2, Scalar>& ray_origin) const
+            {
+                static constexpr int other_coordinate = (coordinate + 1) % 2;
+                int intersections_above = 0;
+                int intersections_below = 0;
+                bool on_boundary = false;
+                const Floating ray_oc = Floating(ray_origin[other_coordinate]);
+                this->visit([ray_oc, &on_boundary](const BoundingBox& bbox) {
+                        return !on_boundary && bbox.min()[other_coordinate] <= ray_oc && bbox.max()[other_coordinate] >= ray_oc;
+                    },
+                    [&](const Leaf& leaf) {
+                        for (size_t i = 0; i < leaf.count && !on_boundary; ++i) {
+                            auto [above, below] = detail::coordinate_aligned_ray_hit_count_line<LineType, Vec<2, Scalar>, coordinate>(
+                                lines[leaf.line_idx[i]], ray_origin);
+                            if (above < 0 || below < 0)
+                                on_boundary = true;
+                            intersections_above += above;
+                            intersections_below += below;
+                        }
+                    });
+                if (on_boundary)
+                    return { -1, -1 };
+                return { intersections_above, intersections_below };
+            }
+
+            template <typename VectorType>
+            std::vector<std::pair<VectorType, size_t>> intersections_with_line(const std::vector<LineType>& lines, const LineType& line) const
+            {
+                std::vector<std::pair<VectorType, size_t>> result;
+                if (this->empty())
+                    return result;
+
+                BoundingBox line_bb(line.a.template cast<Floating>(), line.a.template cast<Floating>());
+                line_bb.extend(line.b.template cast<Floating>());
+                this->visit([&line_bb](const BoundingBox& bbox) { return bbox.intersects(line_bb); },
+                    [&lines, &line, &result](const Leaf& leaf) {
+                        for (size_t i = 0; i < leaf.count; ++i) {
+                            VectorType intersection_pt;
+                            if (line_alg::intersection(line, lines[leaf.line_idx[i]], &intersection_pt))
+                                result.emplace_back(intersection_pt, leaf.line_idx[i]);
+                        }
+                    });
+                return result;
+            }
+
+        private:
+            struct alignas(64) Node {
+                // Bounding boxes of the children.
+                Floating min_x[BRANCHING];
+                Floating min_y[BRANCHING];
+                Floating max_x[BRANCHING];
+                Floating max_y[BRANCHING];
+                // Index of a leaf or of a node, see leaf_mask.
+                uint32_t child[BRANCHING];
+                // Bit i is set if the i-th child is a leaf.
+                uint8_t leaf_mask { 0 };
+                uint8_t num_children { 0 };
+            };
+
+            // Lines of a leaf, the unused slots are filled with copies of the last line.
+            struct alignas(64) Leaf {
+                Floating ax[LEAF_SIZE];
+                Floating ay[LEAF_SIZE];
+                Floating bx[LEAF_SIZE];
+                Floating by[LEAF_SIZE];
+                // b - a and its squared length (one for degenerate lines), evaluated in double precision as in line_alg::distance_to_squared().
+                double vx[LEAF_SIZE];
+                double vy[LEAF_SIZE];
+                double l2[LEAF_SIZE];
+                uint32_t line_idx[LEAF_SIZE];
+                uint32_t count;
+            };
+
+            // Node or leaf to visit, with the squared distance of its bounding box.
+            struct Entry {
+                uint32_t idx;
+                bool leaf;
+                Floating sqr_d;
+            };
+            // Each level of the tree adds at most BRANCHING - 1 entries to the stack.
+            static constexpr size_t STACK_SIZE = 32 * (BRANCHING - 1) + 1;
+
+            // Both loops are free of branches, so that they are vectorized. The first one evaluates the distance
+            // to both end points and to the inner point of each line, the second one selects the right distance.
+            // Not inlined, otherwise the compiler unrolls the loops into the traversal instead of vectorizing them.
+            BOOST_NOINLINE static void leaf_squared_distances(const Leaf& leaf, const Vec<2, Floating>& p, Floating (&sqr_d)[LEAF_SIZE])
+            {
+                const Floating px = p.x();
+                const Floating py = p.y();
+                double t[LEAF_SIZE];
+                double sqr_d_a[LEAF_SIZE];
+                double sqr_d_b[LEAF_SIZE];
+                double sqr_d_t[LEAF_SIZE];
+                for (size_t i = 0; i < LEAF_SIZE; ++i) {
+                    const double vax = double(px - leaf.ax[i]);
+                    const double vay = double(py - leaf.ay[i]);
+                    const double vbx = double(px - leaf.bx[i]);
+                    const double vby = double(py - leaf.by[i]);
+                    t[i] = (vax * leaf.vx[i] + vay * leaf.vy[i]) / leaf.l2[i];
+                    const double ex = t[i] * leaf.vx[i] - vax;
+                    const double ey = t[i] * leaf.vy[i] - vay;
+                    sqr_d_a[i] = vax * vax + vay * vay;
+                    sqr_d_b[i] = vbx * vbx + vby * vby;
+                    sqr_d_t[i] = ex * ex + ey * ey;
+                }
+                for (size_t i = 0; i < LEAF_SIZE; ++i) {
+                    double d = t[i] >= 1. ? sqr_d_b[i] : sqr_d_t[i];
+                    d = t[i] <= 0. ? sqr_d_a[i] : d;
+                    sqr_d[i] = Floating(d);
+                }
+            }
+
+            // Same as BoundingBox::squaredExteriorDistance() for all children, infinite for the unused slots.
+            static void node_squared_distances(const Node& node, const Vec<2, Floating>& p, Floating (&sqr_d)[BRANCHING])
+            {
+                const Floating px = p.x();
+                const Floating py = p.y();
+                for (size_t i = 0; i < BRANCHING; ++i) {
+                    const Floating dx = std::max(std::max(node.min_x[i] - px, px - node.max_x[i]), Floating(0));
+                    const Floating dy = std::max(std::max(node.min_y[i] - py, py - node.max_y[i]), Floating(0));
+                    sqr_d[i] = dx * dx + dy * dy;
+                }
+            }
+
+            using LineIndexIt = std::vector<uint32_t>::iterator;
+
+            static BoundingBox lines_bbox(const std::vector<LineType>& lines, LineIndexIt begin, LineIndexIt end)
+            {
+                BoundingBox bbox;
+                for (auto it = begin; it != end; ++it) {
+                    bbox.extend(lines[*it].a.template cast<Floating>());
+                    bbox.extend(lines[*it].b.template cast<Floating>());
+                }
+                return bbox;
+            }
+
+            // Split along the longer side of the centroids' bounding box, so that all leaves of the first half are full.
+            static LineIndexIt split(const std::vector<Vec<2, Floating>>& centroids, LineIndexIt begin, LineIndexIt end)
+            {
+                BoundingBox centroids_bbox;
+                for (auto it = begin; it != end; ++it)
+                    centroids_bbox.extend(centroids[*it]);
+                const int axis = centroids_bbox.sizes().x() >= centroids_bbox.sizes().y() ? 0 : 1;
+                const size_t num_leaves = (size_t(end - begin) + LEAF_SIZE - 1) / LEAF_SIZE;
+                const auto mid = begin + (num_leaves + 1) / 2 * LEAF_SIZE;
+                std::nth_element(begin, mid, end, [&centroids, axis](uint32_t l, uint32_t r) { return centroids[l][axis] < centroids[r][axis]; });
+                return mid;
+            }
+
+            void build_node(size_t node_idx, const std::vector<LineType>& lines, const std::vector<Vec<2, Floating>>& centroids,
+                LineIndexIt begin, LineIndexIt end)
+            {
+                // Split the lines into up to BRANCHING groups by halving the largest group, until all groups fit into a leaf.
+                std::array<std::pair<LineIndexIt, LineIndexIt>, BRANCHING> groups;
+                size_t num_groups = 0;
+                groups[num_groups++] = { begin, end };
+                while (num_groups < BRANCHING) {
+                    auto largest = std::max_element(groups.begin(), groups.begin() + num_groups,
+                        [](const auto& l, const auto& r) { return l.second - l.first < r.second - r.first; });
+                    if (size_t(largest->second - largest->first) <= LEAF_SIZE)
+                        break;
+                    const auto mid = split(centroids, largest->first, largest->second);
+                    std::move_backward(largest + 1, groups.begin() + num_groups, groups.begin() + num_groups + 1);
+                    *(largest + 1) = { mid, largest->second };
+                    largest->second = mid;
+                    ++num_groups;
+                }
+
+                for (size_t i = 0; i < BRANCHING; ++i) {
+                    BoundingBox bbox;
+                    if (i < num_groups)
+                        bbox = lines_bbox(lines, groups[i].first, groups[i].second);
+                    else
+                        // Unused slot, infinitely far from any point.
+                        bbox = BoundingBox(Vec<2, Floating>::Constant(std::numeric_limits<Floating>::infinity()),
+                            Vec<2, Floating>::Constant(-std::numeric_limits<Floating>::infinity()));
+                    m_nodes[node_idx].min_x[i] = bbox.min().x();
+                    m_nodes[node_idx].min_y[i] = bbox.min().y();
+                    m_nodes[node_idx].max_x[i] = bbox.max().x();
+                    m_nodes[node_idx].max_y[i] = bbox.max().y();
+                    m_nodes[node_idx].child[i] = 0;
+                }
+                m_nodes[node_idx].num_children = uint8_t(num_groups);
+
+                for (size_t i = 0; i < num_groups; ++i) {
+                    const size_t count = groups[i].second - groups[i].first;
+                    if (count <= LEAF_SIZE) {
+                        m_nodes[node_idx].leaf_mask |= uint8_t(1 << i);
+                        m_nodes[node_idx].child[i] = uint32_t(m_leaves.size());
+                        m_leaves.emplace_back(make_leaf(lines, groups[i].first, count));
+                    } else {
+                        const size_t child_idx = m_nodes.size();
+                        m_nodes[node_idx].child[i] = uint32_t(child_idx);
+                        m_nodes.emplace_back();
+                        this->build_node(child_idx, lines, centroids, groups[i].first, groups[i].second);
+                    }
+                }
+            }
+
+            static Leaf make_leaf(const std::vector<LineType>& lines, LineIndexIt begin, size_t count)
+            {
+                Leaf leaf;
+                leaf.count = uint32_t(count);
+                for (size_t i = 0; i < LEAF_SIZE; ++i) {
+                    const uint32_t line_idx = *(begin + std::min(i, count - 1));
+                    const LineType& line = lines[line_idx];
+                    leaf.ax[i] = Floating(line.a.x());
+                    leaf.ay[i] = Floating(line.a.y());
+                    leaf.bx[i] = Floating(line.b.x());
+                    leaf.by[i] = Floating(line.b.y());
+                    const Vec<2, double> v = (line.b - line.a).template cast<double>();
+                    const double l2 = v.squaredNorm();
+                    leaf.vx[i] = v.x();
+                    leaf.vy[i] = v.y();
+                    // A degenerate line has zero projection parameter, thus the distance to its first point is reported.
+                    leaf.l2[i] = l2 == 0. ? 1. : l2;
+                    leaf.line_idx[i] = line_idx;
+                }
+                return leaf;
+            }
+
+            // Calls visit_leaf on all leaves, whose bounding box and the bounding boxes of all their parents pass visit_bbox.
+            template <typename VisitBBox, typename VisitLeaf>
+            void visit(const VisitBBox& visit_bbox, const VisitLeaf& visit_leaf) const
+            {
+                std::array<uint32_t, STACK_SIZE> stack;
+                size_t stack_size = 0;
+                stack[stack_size++] = 0;
+                while (stack_size > 0) {
+                    const Node& node = m_nodes[stack[--stack_size]];
+                    for (size_t i = 0; i < node.num_children; ++i) {
+                        if (!visit_bbox(BoundingBox(Vec<2, Floating>(node.min_x[i], node.min_y[i]), Vec<2, Floating>(node.max_x[i], node.max_y[i]))))
+                            continue;
+                        if (node.leaf_mask & (1 << i)) {
+                            visit_leaf(m_leaves[node.child[i]]);
+                        } else {
+                            assert(stack_size < stack.size());
+                            stack[stack_size++] = node.child[i];
+                        }
+                    }
+                }
+            }
+
+            std::vector<Node> m_nodes;
+            std::vector<Leaf> m_leaves;
+        };
+
+    } // namespace detail
+
     template <typename LineType>
     class LinesDistancer {
     public:
@@ -303,25 +694,50 @@ namespace AABBTreeLines {
 
     private:
         std::vector<LineType> lines;
-        AABBTreeIndirect::Tree<2, Scalar> tree;
+        detail::PackedLinesTree<LineType> tree;
 
     public:
         explicit LinesDistancer(const std::vector<LineType>& lines)
             : lines(lines)
+            , tree(this->lines)
         {
-            tree = AABBTreeLines::build_aabb_tree_over_indexed_lines(this->lines);
         }
 
         explicit LinesDistancer(std::vector<LineType>&& lines)
-            : lines(lines)
+            : lines(std::move(lines))
+            , tree(this->lines)
         {
-            tree = AABBTreeLines::build_aabb_tree_over_indexed_lines(this->lines);
         }
 
         LinesDistancer() = default;
 
         // 1 true, -1 false, 0 cannot determine
-        int outside(const Vec<2, Scalar>& point) const { return point_outside_closed_contours(lines, tree, point); }
+        int outside(const Vec<2, Scalar>& point) const
+        {
+            if (tree.empty()) {
+                return 1;
+            }
+
+            auto [hits_above, hits_below] = tree.template coordinate_aligned_ray_hit_count<0>(lines, point);
+            if (hits_above < 0 || hits_below < 0) {
+                return 0;
+            } else if (hits_above % 2 == 1 && hits_below % 2 == 1) {
+                return -1;
+            } else if (hits_above % 2 == 0 && hits_below % 2 == 0) {
+                return 1;
+            } else { // this should not happen with closed contours. lets check it in Y direction
+                auto [hits_above, hits_below] = tree.template coordinate_aligned_ray_hit_count<1>(lines, point);
+                if (hits_above < 0 || hits_below < 0) {
+                    return 0;
+                } else if (hits_above % 2 == 1 && hits_below % 2 == 1) {
+                    return -1;
+                } else if (hits_above % 2 == 0 && hits_below % 2 == 0) {
+                    return 1;
+                } else { // both results were unclear
+                    return 0;
+                }
+            }
+        }
 
         // negative sign means inside
         template <bool SIGNED_DISTANCE>
@@ -329,8 +745,7 @@ namespace AABBTreeLines {
         {
             size_t nearest_line_index_out = size_t(-1);
             Vec<2, Floating> nearest_point_out = Vec<2, Floating>::Zero();
-            Vec<2, Floating> p = point.template cast<Floating>();
-            auto distance = AABBTreeLines::squared_distance_to_indexed_lines(lines, tree, p, nearest_line_index_out, nearest_point_out);
+            auto distance = tree.squared_distance(lines, point, nearest_line_index_out, nearest_point_out);
 
             if (distance < 0) {
                 return { std::numeric_limits<Floating>::infinity(), nearest_line_index_out, nearest_point_out };
@@ -351,15 +766,46 @@ namespace AABBTreeLines {
             return dist;
         }
 
-    	std::vector<size_t> all_lines_in_radius(const Vec<2, Scalar> &point, Floating radius)
-    	{
-        	return AABBTreeLines::all_lines_in_radius(this->lines, this->tree, point.template cast<Floating>(), radius * radius);
-    	}
+        // Distances of a batch of points, for example of the points of an extrusion. The closest line of a point seeds the search
+        // of the next point, thus the batch is much faster than separate queries if the consecutive points are close to each other.
+        template <bool SIGNED_DISTANCE, typename PointsType>
+        std::vector<Floating> distances_from_lines(const PointsType& points) const
+        {
+            std::vector<Floating> distances;
+            distances.reserve(points.size());
+            size_t hint_idx = size_t(-1);
+            for (const auto& point : points) {
+                size_t nearest_line_index = size_t(-1);
+                Vec<2, Floating> nearest_point = Vec<2, Floating>::Zero();
+                Floating distance = tree.squared_distance(lines, point, nearest_line_index, nearest_point, hint_idx);
+                hint_idx = nearest_line_index;
+                if (distance < 0) {
+                    distances.emplace_back(std::numeric_limits<Floating>::infinity());
+                    continue;
+                }
+                distance = sqrt(distance);
+                if (SIGNED_DISTANCE) {
+                    distance *= outside(point);
+                }
+                distances.emplace_back(distance);
+            }
+            return distances;
+        }
+
+        // Indices of the lines closer than radius, sorted.
+        std::vector<size_t> all_lines_in_radius(const Vec<2, Scalar>& point, Floating radius) const
+        {
+            return tree.all_lines_in_radius(point, radius * radius);
+        }
 
         template <bool sorted>
         std::vector<std::pair<Vec<2, Scalar>, size_t>> intersections_with_line(const LineType& line) const
         {
-            return get_intersections_with_line<sorted, Vec<2, Scalar>>(lines, tree, line);
+            auto intersections = tree.template intersections_with_line<Vec<2, Scalar>>(lines, line);
+            if (sorted) {
+                detail::sort_intersections_along_line(line, intersections);
+            }
+            return intersections;
         }
 
         const LineType& get_line(size_t line_idx) const { return lines[line_idx]; }
@@ -28,7 +28,8 @@ BeadingStrategyPtr BeadingStrategyFactory::makeStrategy(const coord_t preferred_
                                                         const coord_t max_bead_count,
                                                         const coord_t outer_wall_offset,
                                                         const int     inward_distributed_center_wall_count,
-                                                        const double  minimum_variable_line_ratio)
+                                                        const double  minimum_variable_line_ratio,
+                                                        BeadingCache *cache)
 {
     // Handle a special case when there is just one external perimeter.
     // Because big differences in bead width for inner and other perimeters cause issues with current beading strategies.
@@ -53,6 +54,14 @@ BeadingStrategyPtr BeadingStrategyFactory::makeStrategy(const coord_t preferred_
     // Apply the LimitedBeadingStrategy last, since that adds a 0-width marker wall which other beading strategies shouldn't touch.
     BOOST_LOG_TRIVIAL(trace) << "Applying the Limited Beading meta-strategy with maximum bead count = " << max_bead_count << ".";
     ret = std::make_unique<LimitedBeadingStrategy>(max_bead_count, std::move(ret));
+
+    if (cache != nullptr) {
+        // The beadings of the whole chain are determined by the parameters of the chain.
+        const BeadingCache::StrategyParams params { preferred_bead_width_outer, preferred_bead_width_inner, preferred_transition_length, transitioning_angle,
+                                                    print_thin_walls, min_bead_width, min_feature_size, wall_split_middle_threshold, wall_add_middle_threshold,
+                                                    max_bead_count, outer_wall_offset, inward_distributed_center_wall_count, minimum_variable_line_ratio };
+        ret = std::make_unique<CachedBeadingStrategy>(params, *cache, std::move(ret));
+    }
     return ret;
 }
 } // namespace Slic3r::Arachne
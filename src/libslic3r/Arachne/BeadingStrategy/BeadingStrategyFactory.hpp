@@ -8,6 +8,7 @@
 #include <cmath>
 
 #include "BeadingStrategy.hpp"
+#include "CachedBeadingStrategy.hpp"
 #include "../../Point.hpp"
 #include "libslic3r/libslic3r.h"
 
@@ -31,7 +32,8 @@ public:
         coord_t max_bead_count = 0,
         coord_t outer_wall_offset = 0,
         int inward_distributed_center_wall_count = 2,
-        double minimum_variable_line_width = 0.5
+        double minimum_variable_line_width = 0.5,
+        BeadingCache *cache = nullptr
     );
 };
 
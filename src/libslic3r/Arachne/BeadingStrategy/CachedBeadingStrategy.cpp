@@ -0,0 +1,102 @@
+#include "CachedBeadingStrategy.hpp"
+
+#include <utility>
+
+#include <boost/functional/hash.hpp>
+
+namespace Slic3r::Arachne
+{
+
+bool BeadingCache::StrategyParams::operator==(const StrategyParams &rhs) const
+{
+    return preferred_bead_width_outer == rhs.preferred_bead_width_outer && preferred_bead_width_inner == rhs.preferred_bead_width_inner &&
+           preferred_transition_length == rhs.preferred_transition_length && transitioning_angle == rhs.transitioning_angle &&
+           print_thin_walls == rhs.print_thin_walls && min_bead_width == rhs.min_bead_width && min_feature_size == rhs.min_feature_size &&
+           wall_split_middle_threshold == rhs.wall_split_middle_threshold && wall_add_middle_threshold == rhs.wall_add_middle_threshold &&
+           max_bead_count == rhs.max_bead_count && outer_wall_offset == rhs.outer_wall_offset &&
+           inward_distributed_center_wall_count == rhs.inward_distributed_center_wall_count &&
+           minimum_variable_line_ratio == rhs.minimum_variable_line_ratio;
+}
+
+size_t BeadingCache::StrategyParams::hash() const
+{
+    size_t seed = 0;
+    boost::hash_combine(seed, preferred_bead_width_outer);
+    boost::hash_combine(seed, preferred_bead_width_inner);
+    boost::hash_combine(seed, preferred_transition_length);
+    boost::hash_combine(seed, transitioning_angle);
+    boost::hash_combine(seed, print_thin_walls);
+    boost::hash_combine(seed, min_bead_width);
+    boost::hash_combine(seed, min_feature_size);
+    boost::hash_combine(seed, wall_split_middle_threshold);
+    boost::hash_combine(seed, wall_add_middle_threshold);
+    boost::hash_combine(seed, max_bead_count);
+    boost::hash_combine(seed, outer_wall_offset);
+    boost::hash_combine(seed, inward_distributed_center_wall_count);
+    boost::hash_combine(seed, minimum_variable_line_ratio);
+    return seed;
+}
+
+size_t BeadingCache::KeyHash::operator()(const Key &key) const noexcept
+{
+    size_t seed = key.params.hash();
+    boost::hash_combine(seed, key.thickness);
+    boost::hash_combine(seed, key.bead_count);
+    return seed;
+}
+
+BeadingStrategy::Beading BeadingCache::compute(const StrategyParams &params, coord_t thickness, coord_t bead_count, const BeadingStrategy &parent)
+{
+    return m_beadings.get(Key{ params, thickness, bead_count }, [&parent, thickness, bead_count]() { return parent.compute(thickness, bead_count); });
+}
+
+CachedBeadingStrategy::CachedBeadingStrategy(const BeadingCache::StrategyParams &params, BeadingCache &cache, BeadingStrategyPtr parent)
+    : BeadingStrategy(*parent)
+    , params(params)
+    , cache(cache)
+    , parent(std::move(parent))
+{
+    name = "CachedBeadingStrategy";
+}
+
+BeadingStrategy::Beading CachedBeadingStrategy::compute(coord_t thickness, coord_t bead_count) const
+{
+    return cache.compute(params, thickness, bead_count, *parent);
+}
+
+coord_t CachedBeadingStrategy::getOptimalThickness(coord_t bead_count) const
+{
+    return parent->getOptimalThickness(bead_count);
+}
+
+coord_t CachedBeadingStrategy::getTransitionThickness(coord_t lower_bead_count) const
+{
+    return parent->getTransitionThickness(lower_bead_count);
+}
+
+coord_t CachedBeadingStrategy::getOptimalBeadCount(coord_t thickness) const
+{
+    return parent->getOptimalBeadCount(thickness);
+}
+
+coord_t CachedBeadingStrategy::getTransitioningLength(coord_t lower_bead_count) const
+{
+    return parent->getTransitioningLength(lower_bead_count);
+}
+
+float CachedBeadingStrategy::getTransitionAnchorPos(coord_t lower_bead_count) const
+{
+    return parent->getTransitionAnchorPos(lower_bead_count);
+}
+
+std::vector<coord_t> CachedBeadingStrategy::getNonlinearThicknesses(coord_t lower_bead_count) const
+{
+    return parent->getNonlinearThicknesses(lower_bead_count);
+}
+
+std::string CachedBeadingStrategy::toString() const
+{
+    return std::string("CachedBeadingStrategy+") + parent->toString();
+}
+
+} // namespace Slic3r::Arachne
@@ -0,0 +1,104 @@
+#ifndef CACHED_BEADING_STRATEGY_H
+#define CACHED_BEADING_STRATEGY_H
+
+#include <string>
+
+#include "BeadingStrategy.hpp"
+#include "libslic3r/ConcurrentCache.hpp"
+#include "libslic3r/libslic3r.h"
+
+namespace Slic3r::Arachne
+{
+
+/*!
+ * Thread-safe table of beadings computed by beading strategies, shared by all the layers of a print region.
+ *
+ * The beadings are keyed by the configuration of the strategy chain, the thickness and the bead count.
+ * The thickness is taken as is: it is already an integer in scaled coordinates, and rounding it further would change
+ * the generated toolpaths.
+ */
+class BeadingCache
+{
+public:
+    // Parameters of BeadingStrategyFactory::makeStrategy(), which determine the beadings of the strategy chain.
+    struct StrategyParams
+    {
+        coord_t preferred_bead_width_outer;
+        coord_t preferred_bead_width_inner;
+        coord_t preferred_transition_length;
+        float   transitioning_angle;
+        bool    print_thin_walls;
+        coord_t min_bead_width;
+        coord_t min_feature_size;
+        double  wall_split_middle_threshold;
+        double  wall_add_middle_threshold;
+        coord_t max_bead_count;
+        coord_t outer_wall_offset;
+        int     inward_distributed_center_wall_count;
+        double  minimum_variable_line_ratio;
+
+        bool operator==(const StrategyParams &rhs) const;
+        size_t hash() const;
+    };
+
+    using Stats = CacheStats;
+
+    /*!
+     * Return the beading for the given key if stored, otherwise compute it with \p parent and store it.
+     */
+    BeadingStrategy::Beading compute(const StrategyParams &params, coord_t thickness, coord_t bead_count, const BeadingStrategy &parent);
+
+    Stats stats() const { return m_beadings.stats(); }
+
+    void clear() { m_beadings.clear(); }
+
+private:
+    struct Key
+    {
+        StrategyParams params;
+        coord_t        thickness;
+        coord_t        bead_count;
+
+        bool operator==(const Key &rhs) const { return thickness == rhs.thickness && bead_count == rhs.bead_count && params == rhs.params; }
+    };
+
+    struct KeyHash
+    {
+        size_t operator()(const Key &key) const noexcept;
+    };
+
+    // Upper bound of the number of beadings per shard.
+    static constexpr size_t MAX_SHARD_SIZE = 8192;
+
+    ShardedCache<Key, BeadingStrategy::Beading, KeyHash, 32> m_beadings { MAX_SHARD_SIZE };
+};
+
+/*!
+ * This is a meta-strategy that can be applied on top of any other beading
+ * strategy, which looks up the beadings of its parent in a BeadingCache
+ * before computing them.
+ */
+class CachedBeadingStrategy : public BeadingStrategy
+{
+public:
+    CachedBeadingStrategy(const BeadingCache::StrategyParams &params, BeadingCache &cache, BeadingStrategyPtr parent);
+
+    ~CachedBeadingStrategy() override = default;
+
+    Beading compute(coord_t thickness, coord_t bead_count) const override;
+    coord_t getOptimalThickness(coord_t bead_count) const override;
+    coord_t getTransitionThickness(coord_t lower_bead_count) const override;
+    coord_t getOptimalBeadCount(coord_t thickness) const override;
+    coord_t getTransitioningLength(coord_t lower_bead_count) const override;
+    float getTransitionAnchorPos(coord_t lower_bead_count) const override;
+    std::vector<coord_t> getNonlinearThicknesses(coord_t lower_bead_count) const override;
+    std::string toString() const override;
+
+private:
+    const BeadingCache::StrategyParams params;
+    BeadingCache                      &cache;
+    const BeadingStrategyPtr           parent;
+};
+
+} // namespace Slic3r::Arachne
+#endif // CACHED_BEADING_STRATEGY_H
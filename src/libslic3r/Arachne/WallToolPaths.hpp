@@ -31,6 +31,8 @@ public:
     float   wall_transition_filter_deviation;
     int     wall_distribution_count;
     bool    is_top_or_bottom_layer;
+    // Beadings shared by the layers of a print region, may be null.
+    BeadingCache *beading_cache { nullptr };
 };
 
 WallToolPathsParams make_paths_params(const int layer_id, const PrintObjectConfig &print_object_config, const PrintConfig &print_config);
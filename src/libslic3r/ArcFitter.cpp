@@ -1,11 +1,18 @@
 #include "ArcFitter.hpp"
 #include "Polyline.hpp"
 
+#include <algorithm>
 #include <cmath>
 #include <cassert>
 
 namespace Slic3r {
 
+//BBS: every attempt to extend an arc by a point verifies all the points of the arc against the new circle,
+//or against a circle through each of its points if the circle through its middle fails. Thus the number of points
+//of a single arc is bounded to keep the fitting of long paths linear in the number of points.
+//Longer arcs are split into consecutive arcs, each of them within the fitting tolerance.
+static constexpr size_t MAX_ARC_FITTING_POINTS = 256;
+
 void ArcFitter::do_arc_fitting(const Points& points, std::vector<PathFittingData>& result, double tolerance)
 {
 #ifdef DEBUG_ARC_FITTING
@@ -40,28 +47,36 @@ void ArcFitter::do_arc_fitting(const Points& points, std::vector<PathFittingData
     ArcSegment last_arc;
     bool can_fit = false;
     Points current_segment;
-    current_segment.reserve(points.size());
+    current_segment.reserve(std::min(points.size(), MAX_ARC_FITTING_POINTS));
+    //BBS: length of current_segment, updated with every point pushed into current_segment
+    double current_segment_length = 0.;
     ArcSegment target_arc;
     for (size_t i = 0; i < points.size(); i++) {
         //BBS: point in stack is not enough, build stack first
         back_index = i;
+        if (! current_segment.empty())
+            current_segment_length += (points[i] - current_segment.back()).cast<double>().norm();
         current_segment.push_back(points[i]);
         if (back_index - front_index < 2)
             continue;
 
-        can_fit = ArcSegment::try_create_arc(current_segment, target_arc, Polyline(current_segment).length(),
+        can_fit = ArcSegment::try_create_arc(current_segment, target_arc, current_segment_length,
                                              DEFAULT_SCALED_MAX_RADIUS,
                                              tolerance,
                                              DEFAULT_ARC_LENGTH_PERCENT_TOLERANCE);
         if (can_fit) {
             //BBS: can be fit as arc, then save arc data temperarily
             last_arc = target_arc;
-            if (back_index == points.size() - 1) {
+            if (back_index == points.size() - 1 || current_segment.size() >= MAX_ARC_FITTING_POINTS) {
                 result.emplace_back(std::move(PathFittingData{ front_index,
                                    back_index,
                                    last_arc.direction == ArcDirection::Arc_Dir_CCW ? EMovePathType::Arc_move_ccw : EMovePathType::Arc_move_cw,
                                    last_arc }));
+                //BBS: the next arc starts at the end of this one
                 front_index = back_index;
+                current_segment.clear();
+                current_segment.push_back(points[front_index]);
+                current_segment_length = 0.;
             }
         } else {
             if (back_index - front_index > 2) {
@@ -82,6 +97,7 @@ void ArcFitter::do_arc_fitting(const Points& points, std::vector<PathFittingData
             current_segment.clear();
             current_segment.push_back(points[front_index]);
             current_segment.push_back(points[front_index + 1]);
+            current_segment_length = (points[front_index + 1] - points[front_index]).cast<double>().norm();
         }
     }
 	//BBS: handle the remain data
@@ -106,14 +122,14 @@ void ArcFitter::do_arc_fitting_and_simplify(Points& points, std::vector<PathFitt
     //for arc part, only need to keep start and end point
     if (result.size() == 1 && result[0].path_type == EMovePathType::Linear_move) {
         //BBS: all are straight segment, directly use DP simplify
-        points = MultiPoint::_douglas_peucker(points, tolerance);
+        points.erase(MultiPoint::_douglas_peucker_inplace(points.begin(), points.end(), tolerance), points.end());
         result[0].end_point_index = points.size() - 1;
         return;
     } else {
         //BBS: has both arc part and straight part, we should spilit the straight part out and do DP simplify
-        Points simplified_points;
-        simplified_points.reserve(points.size());
-        simplified_points.push_back(points[0]);
+        //The simplified parts are compacted in place. The end of the simplified points never passes the start of the
+        //part being simplified, which is shared with the end of the previous part.
+        auto simplified_end = points.begin() + 1;
         std::vector<size_t> reduce_count(result.size(), 0);
         for (size_t i = 0; i < result.size(); i++)
         {
@@ -124,20 +140,15 @@ void ArcFitter::do_arc_fitting_and_simplify(Points& points, std::vector<PathFitt
             //For arc part, theoretically, we only need to keep the start and end point, and
             //delete all other point. But when considering wipe operation, we must keep the original
             //point data and shouldn't reduce too much by only saving start and end point.
-            Points straight_or_arc_part;
-            straight_or_arc_part.reserve(end_index - start_index + 1);
-            for (size_t j = start_index; j <= end_index; j++)
-                straight_or_arc_part.push_back(points[j]);
-            straight_or_arc_part = MultiPoint::_douglas_peucker(straight_or_arc_part, tolerance);
+            auto part_begin = points.begin() + start_index;
+            auto part_end   = MultiPoint::_douglas_peucker_inplace(part_begin, points.begin() + end_index + 1, tolerance);
             //BBS: how many point has been reduced
-            reduce_count[i] = end_index - start_index + 1 - straight_or_arc_part.size();
+            reduce_count[i] = end_index + 1 - size_t(part_end - points.begin());
             //BBS: save the simplified result
-            for (size_t j = 1; j < straight_or_arc_part.size(); j++) {
-                simplified_points.push_back(straight_or_arc_part[j]);
-            }
+            simplified_end = simplified_end == part_begin + 1 ? part_end : std::copy(part_begin + 1, part_end, simplified_end);
         }
         //BBS: save and will return the simplified_points
-        points = simplified_points;
+        points.erase(simplified_end, points.end());
         //BBS: modify the index in result because the point index must be changed to match the simplified points
         for (size_t j = 1; j < reduce_count.size(); j++)
             reduce_count[j] += reduce_count[j - 1];
@@ -31,6 +31,8 @@ public:
     coord_t                      spacing;
     // Angle resolution for the brute force search of the best bridging angle.
     double                       resolution;
+    // Skip the full scoring of the candidate angles, which the analytic pre-score proves to cover less than the best one.
+    bool                         prune_candidates;
     // The final optimal angle.
     double                       angle;
     
@@ -0,0 +1,171 @@
+#ifndef slic3r_ConcurrentCache_hpp_
+#define slic3r_ConcurrentCache_hpp_
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+#include <ankerl/unordered_dense.h>
+
+namespace Slic3r {
+
+// Hits and misses of a cache of computed values.
+struct CacheStats
+{
+    size_t hits;
+    size_t misses;
+    // Total time spent computing the values, which were not found in the table.
+    double compute_seconds;
+
+    double hit_rate() const { return hits + misses == 0 ? 0. : double(hits) / double(hits + misses); }
+    // Time not spent by computing the values found in the table, assuming they would take the average time of a miss.
+    double saved_seconds() const { return misses == 0 ? 0. : compute_seconds * double(hits) / double(misses); }
+};
+
+// Thread-safe table of values computed from a key, shared by the threads processing the layers of a print in parallel.
+// The table is split into shards with separate locks, so that the threads rarely wait for each other.
+// A value is computed outside of the lock. If two threads compute the same value at the same time, the first one stored wins.
+// The number of values per shard is bounded: when a shard is full, new values are computed without being stored.
+template<typename Key, typename Value, typename KeyHash = ankerl::unordered_dense::hash<Key>, size_t NumShards = 16>
+class ShardedCache
+{
+public:
+    explicit ShardedCache(size_t max_shard_size) : m_max_shard_size(max_shard_size) {}
+
+    // Return the value stored for the key, otherwise compute it with \p compute and store it.
+    template<typename ComputeFn>
+    Value get(const Key &key, ComputeFn &&compute)
+    {
+        Shard &shard = m_shards[KeyHash()(key) % NumShards];
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            if (auto it = shard.values.find(key); it != shard.values.end()) {
+                ++ m_hits;
+                return it->second;
+            }
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        Value      value = compute();
+        m_compute_nanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        ++ m_misses;
+
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (shard.values.size() < m_max_shard_size)
+            return shard.values.try_emplace(key, std::move(value)).first->second;
+        return value;
+    }
+
+    CacheStats stats() const { return { m_hits.load(), m_misses.load(), double(m_compute_nanoseconds.load()) * 1e-9 }; }
+
+    size_t size() const
+    {
+        size_t n = 0;
+        for (const Shard &shard : m_shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            n += shard.values.size();
+        }
+        return n;
+    }
+
+    void clear()
+    {
+        for (Shard &shard : m_shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            shard.values.clear();
+        }
+        m_hits                = 0;
+        m_misses              = 0;
+        m_compute_nanoseconds = 0;
+    }
+
+private:
+    struct Shard
+    {
+        mutable std::mutex                                  mutex;
+        ankerl::unordered_dense::map<Key, Value, KeyHash>   values;
+    };
+
+    const size_t                 m_max_shard_size;
+    std::array<Shard, NumShards> m_shards;
+    std::atomic<size_t>          m_hits { 0 };
+    std::atomic<size_t>          m_misses { 0 };
+    std::atomic<int64_t>         m_compute_nanoseconds { 0 };
+};
+
+// Thread-safe table of values derived from a shared object, for example the convex hull or the raycaster of a mesh,
+// so that the owners of the same object compute the value once.
+// Keyed by the address of the object. An entry is valid only while its object is alive, as the address may be reused.
+// The table does not keep the objects nor the values alive, the expired entries are purged as the table grows.
+template<typename Object, typename Value>
+class WeakCache
+{
+public:
+    // Return the value stored for the object if it is still alive.
+    std::shared_ptr<const Value> find(const std::shared_ptr<const Object> &object) const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (auto it = m_entries.find(object.get()); it != m_entries.end() && it->second.object.lock() == object)
+            return it->second.value.lock();
+        return {};
+    }
+
+    // Store the value of the object. Unless \p replace is set, return the value stored by another thread in the meantime.
+    std::shared_ptr<const Value> insert(const std::shared_ptr<const Object> &object, std::shared_ptr<const Value> value, bool replace = false)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Entry &entry = m_entries[object.get()];
+        if (! replace && entry.object.lock() == object)
+            if (std::shared_ptr<const Value> other = entry.value.lock())
+                return other;
+        entry = { object, value };
+        if (m_entries.size() >= m_purge_threshold) {
+            for (auto it = m_entries.begin(); it != m_entries.end();)
+                if (it->second.object.expired() || it->second.value.expired())
+                    it = m_entries.erase(it);
+                else
+                    ++ it;
+            m_purge_threshold = std::max(MIN_PURGE_THRESHOLD, 2 * m_entries.size());
+        }
+        return value;
+    }
+
+    // Return the value stored for the object, otherwise compute it with \p compute and store it.
+    template<typename ComputeFn>
+    std::shared_ptr<const Value> get(const std::shared_ptr<const Object> &object, ComputeFn &&compute)
+    {
+        if (std::shared_ptr<const Value> value = this->find(object))
+            return value;
+        return this->insert(object, compute());
+    }
+
+    void clear()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_entries.clear();
+        m_purge_threshold = MIN_PURGE_THRESHOLD;
+    }
+
+private:
+    static constexpr size_t MIN_PURGE_THRESHOLD = 64;
+
+    struct Entry
+    {
+        std::weak_ptr<const Object> object;
+        std::weak_ptr<const Value>  value;
+    };
+
+    mutable std::mutex                                      m_mutex;
+    ankerl::unordered_dense::map<const Object*, Entry>      m_entries;
+    // Number of entries, at which the expired entries are removed.
+    size_t                                                  m_purge_threshold { MIN_PURGE_THRESHOLD };
+};
+
+} // namespace Slic3r
+
+#endif // slic3r_ConcurrentCache_hpp_
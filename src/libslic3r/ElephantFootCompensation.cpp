@@ -13,6 +13,9 @@
 #include <cmath>
 #include <cassert>
 
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
 // #define CONTOUR_DISTANCE_DEBUG_SVG
 
 namespace Slic3r {
@@ -627,19 +630,19 @@ ExPolygon  elephant_foot_compensation(const ExPolygon  &input, const Flow &exter
 
 ExPolygons elephant_foot_compensation(const ExPolygons &input, const Flow &external_perimeter_flow, const double compensation)
 {
-	ExPolygons out;
-	out.reserve(input.size());
-	for (const ExPolygon &expoly : input)
-		out.emplace_back(elephant_foot_compensation(expoly, external_perimeter_flow, compensation));
-	return out;
+    double min_contour_width = double(external_perimeter_flow.width() + external_perimeter_flow.spacing());
+    return elephant_foot_compensation(input, min_contour_width, compensation);
 }
 
 ExPolygons elephant_foot_compensation(const ExPolygons &input, double min_contour_width, const double compensation)
 {
-	ExPolygons out;
-	out.reserve(input.size());
-	for (const ExPolygon &expoly : input)
-		out.emplace_back(elephant_foot_compensation(expoly, min_contour_width, compensation));
+	// The islands are compensated independently. Compensate them in parallel, as only the first few layers are compensated,
+	// thus parallelization over the layers does not help with a first layer of many islands.
+	ExPolygons out(input.size());
+	tbb::parallel_for(tbb::blocked_range<size_t>(0, input.size(), 1), [&input, &out, min_contour_width, compensation](const tbb::blocked_range<size_t> &range) {
+		for (size_t i = range.begin(); i < range.end(); ++ i)
+			out[i] = elephant_foot_compensation(input[i], min_contour_width, compensation);
+	});
 	return out;
 }
 
@@ -3,21 +3,9 @@
 
 #include "InterlockingGenerator.hpp"
 
-namespace std {
-template<> struct hash<Slic3r::GridPoint3>
-{
-    size_t operator()(const Slic3r::GridPoint3& pp) const noexcept
-    {
-        static int prime  = 31;
-        int        result = 89;
-        result            = static_cast<int>(result * prime + pp.x());
-        result            = static_cast<int>(result * prime + pp.y());
-        result            = static_cast<int>(result * prime + pp.z());
-        return static_cast<size_t>(result);
-    }
-};
-} // namespace std
 
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
 
 namespace Slic3r {
 
@@ -82,7 +70,7 @@ std::pair<ExPolygons, ExPolygons> InterlockingGenerator::growBorderAreasPerpendi
     return {from_border_a, from_border_b};
 }
 
-void InterlockingGenerator::handleThinAreas(const std::unordered_set<GridPoint3>& has_all_meshes) const
+void InterlockingGenerator::handleThinAreas(const VoxelGrid& has_all_meshes) const
 {
     const coord_t     number_of_beams_detect = boundary_avoidance;
     const coord_t     number_of_beams_expand = boundary_avoidance - 1;
@@ -98,13 +86,13 @@ void InterlockingGenerator::handleThinAreas(const std::unordered_set<GridPoint3>
     // Make an inclusionary polygon, to only actually handle thin areas near actual microstructures (so not in skin for example).
     std::vector<Polygons> near_interlock_per_layer;
     near_interlock_per_layer.assign(print_object.layer_count(), Polygons());
-    for (const auto& cell : has_all_meshes) {
+    has_all_meshes.forEach([this, &near_interlock_per_layer](const GridPoint3& cell) {
         const auto bottom_corner = vu.toLowerCorner(cell);
         for (coord_t layer_nr = bottom_corner.z();
              layer_nr < bottom_corner.z() + cell_size.z() && layer_nr < static_cast<coord_t>(near_interlock_per_layer.size()); ++layer_nr) {
             near_interlock_per_layer[static_cast<size_t>(layer_nr)].push_back(vu.toPolygon(cell));
         }
-    }
+    });
     for (auto& near_interlock : near_interlock_per_layer) {
         near_interlock = offset(union_(closing(near_interlock, rounding_errors)), detect);
         polygons_rotate(near_interlock, rotation);
@@ -143,11 +131,10 @@ void InterlockingGenerator::handleThinAreas(const std::unordered_set<GridPoint3>
 
 void InterlockingGenerator::generateInterlockingStructure() const
 {
-    std::vector<std::unordered_set<GridPoint3>> voxels_per_mesh = getShellVoxels(interface_dilation);
+    std::vector<VoxelGrid> voxels_per_mesh = getShellVoxels(interface_dilation);
 
-    std::unordered_set<GridPoint3>& has_any_mesh   = voxels_per_mesh[0];
-    std::unordered_set<GridPoint3>& has_all_meshes = voxels_per_mesh[1];
-    has_any_mesh.merge(has_all_meshes); // perform union and intersection simultaneously. Cannibalizes voxels_per_mesh
+    VoxelGrid& has_all_meshes = voxels_per_mesh[0];
+    has_all_meshes.intersect(voxels_per_mesh[1]); // Only the cells of both meshes are used, the union of the shells is not needed.
 
     if (has_all_meshes.empty()) {
         return;
@@ -156,12 +143,9 @@ void InterlockingGenerator::generateInterlockingStructure() const
     const std::vector<ExPolygons> layer_regions = computeUnionedVolumeRegions();
 
     if (air_filtering) {
-        std::unordered_set<GridPoint3> air_cells;
+        VoxelGrid air_cells;
         addBoundaryCells(layer_regions, air_dilation, air_cells);
-
-        for (const GridPoint3& p : air_cells) {
-            has_all_meshes.erase(p);
-        }
+        has_all_meshes.subtract(air_cells);
 
         handleThinAreas(has_all_meshes);
     }
@@ -169,23 +153,25 @@ void InterlockingGenerator::generateInterlockingStructure() const
     applyMicrostructureToOutlines(has_all_meshes, layer_regions);
 }
 
-std::vector<std::unordered_set<GridPoint3>> InterlockingGenerator::getShellVoxels(const DilationKernel& kernel) const
+std::vector<VoxelGrid> InterlockingGenerator::getShellVoxels(const DilationKernel& kernel) const
 {
-    std::vector<std::unordered_set<GridPoint3>> voxels_per_mesh(2);
+    std::vector<VoxelGrid> voxels_per_mesh(2);
 
     // mark all cells which contain some boundary
     for (size_t region_idx = 0; region_idx < 2; region_idx++)
     {
         const size_t region = (region_idx == 0) ? region_a_index : region_b_index;
-        std::unordered_set<GridPoint3>& mesh_voxels = voxels_per_mesh[region_idx];
+        VoxelGrid& mesh_voxels = voxels_per_mesh[region_idx];
 
         std::vector<ExPolygons> rotated_polygons_per_layer(print_object.layer_count());
-        for (size_t layer_nr = 0; layer_nr < print_object.layer_count(); layer_nr++)
-        {
-            auto layer = print_object.get_layer(layer_nr);
-            rotated_polygons_per_layer[layer_nr] = to_expolygons(layer->get_region(region)->slices.surfaces);
-            expolygons_rotate(rotated_polygons_per_layer[layer_nr], rotation);
-        }
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, print_object.layer_count()), [this, region, &rotated_polygons_per_layer](const tbb::blocked_range<size_t>& range) {
+            for (size_t layer_nr = range.begin(); layer_nr < range.end(); layer_nr++)
+            {
+                auto layer = print_object.get_layer(layer_nr);
+                rotated_polygons_per_layer[layer_nr] = to_expolygons(layer->get_region(region)->slices.surfaces);
+                expolygons_rotate(rotated_polygons_per_layer[layer_nr], rotation);
+            }
+        });
 
         addBoundaryCells(rotated_polygons_per_layer, kernel, mesh_voxels);
     }
@@ -193,28 +179,61 @@ std::vector<std::unordered_set<GridPoint3>> InterlockingGenerator::getShellVoxel
     return voxels_per_mesh;
 }
 
-void InterlockingGenerator::addBoundaryCells(const std::vector<ExPolygons>&  layers,
-                                             const DilationKernel&           kernel,
-                                             std::unordered_set<GridPoint3>& cells) const
+void InterlockingGenerator::addBoundaryCells(const std::vector<ExPolygons>& layers,
+                                             const DilationKernel&          kernel,
+                                             VoxelGrid&                     cells) const
 {
-    auto voxel_emplacer = [&cells](GridPoint3 p) {
-        if (p.z() < 0) {
-            return true;
+    // Cells crossed by the outlines and by the skins of each layer, which are then dilated all at once.
+    std::vector<std::vector<GridPoint3>> seeds_per_layer(layers.size());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, layers.size()), [this, &layers, &kernel, &seeds_per_layer](const tbb::blocked_range<size_t>& range) {
+        for (size_t layer_nr = range.begin(); layer_nr < range.end(); layer_nr++) {
+            std::vector<GridPoint3>& seeds        = seeds_per_layer[layer_nr];
+            auto                     seed_emplacer = [&seeds](GridPoint3 p) {
+                seeds.emplace_back(p);
+                return true;
+            };
+            const coord_t z = static_cast<coord_t>(layer_nr);
+            vu.walkPolygonsToDilate(layers[layer_nr], z, kernel, seed_emplacer);
+            ExPolygons skin = layers[layer_nr];
+            if (layer_nr > 0) {
+                skin = xor_ex(skin, layers[layer_nr - 1]);
+            }
+            skin = opening_ex(skin, cell_size.x() / 2.f); // remove superfluous small areas, which would anyway be included because of walkPolygons
+            vu.walkAreasToDilate(skin, z, kernel, seed_emplacer);
         }
-        cells.emplace(p);
-        return true;
-    };
-
-    for (size_t layer_nr = 0; layer_nr < layers.size(); layer_nr++) {
-        const coord_t z = static_cast<coord_t>(layer_nr);
-        vu.walkDilatedPolygons(layers[layer_nr], z, kernel, voxel_emplacer);
-        ExPolygons skin = layers[layer_nr];
-        if (layer_nr > 0) {
-            skin = xor_ex(skin, layers[layer_nr - 1]);
+    });
+
+    GridPoint3 seeds_min = GridPoint3::Constant(std::numeric_limits<coord_t>::max());
+    GridPoint3 seeds_max = GridPoint3::Constant(std::numeric_limits<coord_t>::lowest());
+    for (const std::vector<GridPoint3>& seeds : seeds_per_layer) {
+        for (const GridPoint3& p : seeds) {
+            seeds_min = seeds_min.cwiseMin(p);
+            seeds_max = seeds_max.cwiseMax(p);
         }
-        skin = opening_ex(skin, cell_size.x() / 2.f); // remove superfluous small areas, which would anyway be included because of walkPolygons
-        vu.walkDilatedAreas(skin, z, kernel, voxel_emplacer);
     }
+    if ((seeds_min.array() > seeds_max.array()).any()) {
+        cells = VoxelGrid();
+        return;
+    }
+
+    VoxelGrid seeds_grid(seeds_min, seeds_max);
+    for (std::vector<GridPoint3>& seeds : seeds_per_layer) {
+        for (const GridPoint3& p : seeds) {
+            seeds_grid.insert(p);
+        }
+        seeds = std::vector<GridPoint3>();
+    }
+
+    GridPoint3 kernel_min = GridPoint3::Zero();
+    GridPoint3 kernel_max = GridPoint3::Zero();
+    for (const GridPoint3& rel : kernel.relative_cells_) {
+        kernel_min = kernel_min.cwiseMin(rel);
+        kernel_max = kernel_max.cwiseMax(rel);
+    }
+    GridPoint3 cells_min = seeds_min + kernel_min;
+    cells_min.z()        = std::max<coord_t>(cells_min.z(), 0); // cells below the first layer are not needed
+    cells                = VoxelGrid(cells_min, seeds_max + kernel_max);
+    seeds_grid.dilateInto(kernel, cells);
 }
 
 std::vector<ExPolygons> InterlockingGenerator::computeUnionedVolumeRegions() const
@@ -265,8 +284,8 @@ std::vector<std::vector<ExPolygons>> InterlockingGenerator::generateMicrostructu
     return cell_area_per_mesh_per_layer;
 }
 
-void InterlockingGenerator::applyMicrostructureToOutlines(const std::unordered_set<GridPoint3>& cells,
-                                                          const std::vector<ExPolygons>&        layer_regions) const
+void InterlockingGenerator::applyMicrostructureToOutlines(const VoxelGrid&               cells,
+                                                          const std::vector<ExPolygons>& layer_regions) const
 {
     std::vector<std::vector<ExPolygons>> cell_area_per_mesh_per_layer = generateMicrostructure();
 
@@ -285,7 +304,7 @@ void InterlockingGenerator::applyMicrostructureToOutlines(const std::unordered_s
 
     // Only compute cell structure for half the layers, because since our beams are two layers high, every odd layer of the structure will
     // be the same as the layer below.
-    for (const GridPoint3& grid_loc : cells) {
+    cells.forEach([&](const GridPoint3& grid_loc) {
         Vec3crd bottom_corner = vu.toLowerCorner(grid_loc);
         for (size_t mesh_idx = 0; mesh_idx < 2; mesh_idx++) {
             for (size_t layer_nr = bottom_corner.z(); layer_nr < bottom_corner.z() + cell_size.z() && layer_nr < max_layer_count;
@@ -298,7 +317,7 @@ void InterlockingGenerator::applyMicrostructureToOutlines(const std::unordered_s
                 expolygons_append(structure_per_layer[mesh_idx][static_cast<size_t>(layer_nr / beam_layer_count)], areas_here);
             }
         }
-    }
+    });
 
     for (size_t mesh_idx = 0; mesh_idx < 2; mesh_idx++) {
         for (size_t layer_nr = 0; layer_nr < structure_per_layer[mesh_idx].size(); layer_nr++) {
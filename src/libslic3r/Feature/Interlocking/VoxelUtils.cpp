@@ -6,6 +6,11 @@
 #include "libslic3r/Fill/FillRectilinear.hpp"
 #include "libslic3r/Surface.hpp"
 
+#include <algorithm>
+
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+
 namespace Slic3r
 {
 
@@ -47,6 +52,120 @@ DilationKernel::DilationKernel(GridPoint3 kernel_size, DilationKernel::Type type
     }
 }
 
+VoxelGrid::VoxelGrid(const GridPoint3& min, const GridPoint3& max)
+    : min_(min)
+    , size_((max - min + GridPoint3(1, 1, 1)).cwiseMax(GridPoint3(0, 0, 0)))
+    , words_per_row_((size_t(size_.x()) + 63) / 64)
+    , words_(words_per_row_ * size_t(size_.y()) * size_t(size_.z()), 0)
+{
+}
+
+bool VoxelGrid::empty() const
+{
+    return std::all_of(words_.begin(), words_.end(), [](uint64_t word) { return word == 0; });
+}
+
+// 64 bits of a row of a grid starting at bit index first. Bits outside of the row are zero.
+static uint64_t rowBits(const uint64_t* row, size_t words_per_row, int64_t first)
+{
+    const int64_t word_idx = (first >= 0 ? first : first - 63) / 64;
+    const int     shift    = int(first - word_idx * 64);
+    auto          word     = [row, words_per_row](int64_t idx) { return idx >= 0 && idx < int64_t(words_per_row) ? row[idx] : uint64_t(0); };
+    return shift == 0 ? word(word_idx) : (word(word_idx) >> shift) | (word(word_idx + 1) << (64 - shift));
+}
+
+void VoxelGrid::intersect(const VoxelGrid& other)
+{
+    const int64_t x_offset = int64_t(min_.x()) - int64_t(other.min_.x());
+    tbb::parallel_for(tbb::blocked_range<coord_t>(0, size_.z()), [this, &other, x_offset](const tbb::blocked_range<coord_t>& range)
+    {
+        for (coord_t z = min_.z() + range.begin(); z < min_.z() + range.end(); ++z)
+        {
+            for (coord_t y = min_.y(); y < min_.y() + size_.y(); ++y)
+            {
+                uint64_t* row = &words_[rowIndex(y, z)];
+                if (z < other.min_.z() || z >= other.min_.z() + other.size_.z() || y < other.min_.y() || y >= other.min_.y() + other.size_.y())
+                {
+                    std::fill(row, row + words_per_row_, 0);
+                    continue;
+                }
+                const uint64_t* other_row = &other.words_[other.rowIndex(y, z)];
+                for (size_t word_idx = 0; word_idx < words_per_row_; ++word_idx)
+                {
+                    row[word_idx] &= rowBits(other_row, other.words_per_row_, int64_t(word_idx) * 64 + x_offset);
+                }
+            }
+        }
+    });
+}
+
+void VoxelGrid::subtract(const VoxelGrid& other)
+{
+    const int64_t x_offset = int64_t(min_.x()) - int64_t(other.min_.x());
+    tbb::parallel_for(tbb::blocked_range<coord_t>(0, size_.z()), [this, &other, x_offset](const tbb::blocked_range<coord_t>& range)
+    {
+        for (coord_t z = min_.z() + range.begin(); z < min_.z() + range.end(); ++z)
+        {
+            if (z < other.min_.z() || z >= other.min_.z() + other.size_.z())
+            {
+                continue;
+            }
+            for (coord_t y = std::max(min_.y(), other.min_.y()); y < std::min(min_.y() + size_.y(), other.min_.y() + other.size_.y()); ++y)
+            {
+                uint64_t*       row       = &words_[rowIndex(y, z)];
+                const uint64_t* other_row = &other.words_[other.rowIndex(y, z)];
+                for (size_t word_idx = 0; word_idx < words_per_row_; ++word_idx)
+                {
+                    row[word_idx] &= ~rowBits(other_row, other.words_per_row_, int64_t(word_idx) * 64 + x_offset);
+                }
+            }
+        }
+    });
+}
+
+void VoxelGrid::dilateInto(const DilationKernel& kernel, VoxelGrid& out) const
+{
+    // Mask of the bits of the last word of a row, which are inside the grid.
+    const uint64_t last_word_mask = (out.size_.x() % 64) == 0 ? ~uint64_t(0) : (uint64_t(1) << (out.size_.x() % 64)) - 1;
+    // Each Z slab of the output is only written by a single thread.
+    tbb::parallel_for(tbb::blocked_range<coord_t>(0, out.size_.z()), [this, &kernel, &out, last_word_mask](const tbb::blocked_range<coord_t>& range)
+    {
+        for (coord_t z = out.min_.z() + range.begin(); z < out.min_.z() + range.end(); ++z)
+        {
+            for (const GridPoint3& rel : kernel.relative_cells_)
+            {
+                const coord_t src_z = z - rel.z();
+                if (src_z < min_.z() || src_z >= min_.z() + size_.z())
+                {
+                    continue;
+                }
+                const int64_t x_offset = int64_t(out.min_.x()) - rel.x() - int64_t(min_.x());
+                for (coord_t y = out.min_.y(); y < out.min_.y() + out.size_.y(); ++y)
+                {
+                    const coord_t src_y = y - rel.y();
+                    if (src_y < min_.y() || src_y >= min_.y() + size_.y())
+                    {
+                        continue;
+                    }
+                    uint64_t*       row     = &out.words_[out.rowIndex(y, z)];
+                    const uint64_t* src_row = &words_[rowIndex(src_y, src_z)];
+                    for (size_t word_idx = 0; word_idx < out.words_per_row_; ++word_idx)
+                    {
+                        row[word_idx] |= rowBits(src_row, words_per_row_, int64_t(word_idx) * 64 + x_offset);
+                    }
+                }
+            }
+            if (out.words_per_row_ > 0)
+            {
+                for (coord_t y = out.min_.y(); y < out.min_.y() + out.size_.y(); ++y)
+                {
+                    out.words_[out.rowIndex(y, z) + out.words_per_row_ - 1] &= last_word_mask;
+                }
+            }
+        }
+    });
+}
+
 bool VoxelUtils::walkLine(Vec3crd start, Vec3crd end, const std::function<bool(GridPoint3)>& process_cell_func) const
 {
     Vec3crd diff = end - start;
@@ -115,6 +234,11 @@ bool VoxelUtils::walkPolygons(const ExPolygon& polys, coord_t z, const std::func
 }
 
 bool VoxelUtils::walkDilatedPolygons(const ExPolygon& polys, coord_t z, const DilationKernel& kernel, const std::function<bool(GridPoint3)>& process_cell_func) const
+{
+    return walkPolygonsToDilate(polys, z, kernel, dilate(kernel, process_cell_func));
+}
+
+bool VoxelUtils::walkPolygonsToDilate(const ExPolygon& polys, coord_t z, const DilationKernel& kernel, const std::function<bool(GridPoint3)>& process_cell_func) const
 {
     ExPolygon translated = polys;
     GridPoint3 k = kernel.kernel_size_;
@@ -126,7 +250,7 @@ bool VoxelUtils::walkDilatedPolygons(const ExPolygon& polys, coord_t z, const Di
     {
         translated.translate(Point(translation.x(), translation.y()));
     }
-    return walkPolygons(translated, z + translation.z(), dilate(kernel, process_cell_func));
+    return walkPolygons(translated, z + translation.z(), process_cell_func);
 }
 
 bool VoxelUtils::walkAreas(const ExPolygon& polys, coord_t z, const std::function<bool(GridPoint3)>& process_cell_func) const
@@ -188,6 +312,11 @@ bool VoxelUtils::_walkAreas(const ExPolygon& polys, coord_t z, const std::functi
 }
 
 bool VoxelUtils::walkDilatedAreas(const ExPolygon& polys, coord_t z, const DilationKernel& kernel, const std::function<bool(GridPoint3)>& process_cell_func) const
+{
+    return walkAreasToDilate(polys, z, kernel, dilate(kernel, process_cell_func));
+}
+
+bool VoxelUtils::walkAreasToDilate(const ExPolygon& polys, coord_t z, const DilationKernel& kernel, const std::function<bool(GridPoint3)>& process_cell_func) const
 {
     ExPolygon translated = polys;
     GridPoint3 k = kernel.kernel_size_;
@@ -200,7 +329,7 @@ bool VoxelUtils::walkDilatedAreas(const ExPolygon& polys, coord_t z, const Dilat
     {
         translated.translate(Point(translation.x(), translation.y()));
     }
-    return _walkAreas(translated, z + translation.z(), dilate(kernel, process_cell_func));
+    return _walkAreas(translated, z + translation.z(), process_cell_func);
 }
 
 std::function<bool(GridPoint3)> VoxelUtils::dilate(const DilationKernel& kernel, const std::function<bool(GridPoint3)>& process_cell_func) const
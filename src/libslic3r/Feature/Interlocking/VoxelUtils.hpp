@@ -4,7 +4,9 @@
 #ifndef UTILS_VOXEL_UTILS_H
 #define UTILS_VOXEL_UTILS_H
 
+#include <cstdint>
 #include <functional>
+#include <vector>
 
 #include "libslic3r/Polygon.hpp"
 #include "libslic3r/ExPolygon.hpp"
@@ -54,6 +56,102 @@ struct DilationKernel
     DilationKernel(GridPoint3 kernel_size, Type type);
 };
 
+/*!
+ * Dense set of voxel cells within a box of grid coordinates.
+ *
+ * Each cell is stored as a single bit, the cells along X are packed into rows of 64 bit words, and the rows of a Z slab are stored contiguously.
+ * The set operations and the dilation process 64 cells at once and the Z slabs are processed in parallel.
+ */
+class VoxelGrid
+{
+public:
+    VoxelGrid() = default;
+
+    /*!
+     * Create an empty grid able to hold the cells from \p min to \p max, both inclusive.
+     */
+    VoxelGrid(const GridPoint3& min, const GridPoint3& max);
+
+    const GridPoint3& min() const { return min_; }
+    GridPoint3 max() const { return min_ + size_ - GridPoint3(1, 1, 1); }
+
+    bool empty() const;
+
+    /*!
+     * Whether the cell is in the set. Cells outside of the bounds of the grid are not.
+     */
+    bool contains(const GridPoint3& p) const
+    {
+        if ((p.array() < min_.array()).any() || (p.array() >= (min_ + size_).array()).any())
+            return false;
+        const coord_t x = p.x() - min_.x();
+        return (words_[rowIndex(p.y(), p.z()) + x / 64] >> (x % 64)) & 1;
+    }
+
+    /*!
+     * Add a cell to the set. The cell has to be inside the bounds of the grid.
+     */
+    void insert(const GridPoint3& p)
+    {
+        assert((p.array() >= min_.array()).all() && (p.array() < (min_ + size_).array()).all());
+        const coord_t x = p.x() - min_.x();
+        words_[rowIndex(p.y(), p.z()) + x / 64] |= uint64_t(1) << (x % 64);
+    }
+
+    /*!
+     * Keep only the cells which are also in \p other. The bounds of the two grids may differ.
+     */
+    void intersect(const VoxelGrid& other);
+
+    /*!
+     * Remove the cells which are in \p other. The bounds of the two grids may differ.
+     */
+    void subtract(const VoxelGrid& other);
+
+    /*!
+     * Add the cells of this grid dilated by the \p kernel to \p out.
+     *
+     * Dilated cells outside of the bounds of \p out are dropped.
+     */
+    void dilateInto(const DilationKernel& kernel, VoxelGrid& out) const;
+
+    /*!
+     * Call \p process_cell_func for each cell in the set, ordered by Z, Y and X.
+     */
+    template<typename ProcessCellFunc>
+    void forEach(ProcessCellFunc&& process_cell_func) const
+    {
+        for (coord_t z = 0; z < size_.z(); ++z)
+        {
+            for (coord_t y = 0; y < size_.y(); ++y)
+            {
+                const uint64_t* row = &words_[rowIndex(min_.y() + y, min_.z() + z)];
+                for (size_t word_idx = 0; word_idx < words_per_row_; ++word_idx)
+                {
+                    for (uint64_t word = row[word_idx]; word != 0; word &= word - 1)
+                    {
+                        int bit = 0;
+                        while (((word >> bit) & 1) == 0)
+                            ++bit;
+                        process_cell_func(GridPoint3(min_.x() + coord_t(word_idx * 64) + bit, min_.y() + y, min_.z() + z));
+                    }
+                }
+            }
+        }
+    }
+
+private:
+    size_t rowIndex(coord_t y, coord_t z) const
+    {
+        return (size_t(z - min_.z()) * size_t(size_.y()) + size_t(y - min_.y())) * words_per_row_;
+    }
+
+    GridPoint3 min_ { 0, 0, 0 };
+    GridPoint3 size_ { 0, 0, 0 };
+    size_t words_per_row_ { 0 };
+    std::vector<uint64_t> words_;
+};
+
 /*!
  * Utility class for walking over a 3D voxel grid.
  *
@@ -116,6 +214,23 @@ public:
         return true;
     }
 
+    /*!
+     * Process the voxels which walkDilatedPolygons would dilate with the \p kernel, without applying the dilation.
+     *
+     * Used to dilate a whole VoxelGrid at once with VoxelGrid::dilateInto.
+     */
+    bool walkPolygonsToDilate(const ExPolygon& polys, coord_t z, const DilationKernel& kernel, const std::function<bool(GridPoint3)>& process_cell_func) const;
+    bool walkPolygonsToDilate(const ExPolygons& polys, coord_t z, const DilationKernel& kernel, const std::function<bool(GridPoint3)>& process_cell_func) const
+    {
+        for (const auto & poly : polys) {
+            if (!walkPolygonsToDilate(poly, z, kernel, process_cell_func)) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
 private:
     /*!
      * \warning the \p polys is assumed to be translated by half the cell_size in xy already
@@ -158,6 +273,23 @@ public:
         return true;
     }
 
+    /*!
+     * Process the voxels which walkDilatedAreas would dilate with the \p kernel, without applying the dilation.
+     *
+     * Used to dilate a whole VoxelGrid at once with VoxelGrid::dilateInto.
+     */
+    bool walkAreasToDilate(const ExPolygon& polys, coord_t z, const DilationKernel& kernel, const std::function<bool(GridPoint3)>& process_cell_func) const;
+    bool walkAreasToDilate(const ExPolygons& polys, coord_t z, const DilationKernel& kernel, const std::function<bool(GridPoint3)>& process_cell_func) const
+    {
+        for (const auto & poly : polys) {
+            if (!walkAreasToDilate(poly, z, kernel, process_cell_func)) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
     /*!
      * Dilate with a kernel.
      *
@@ -7,8 +7,24 @@
 #include "FillBase.hpp"
 #include "FillGyroid.hpp"
 
+#include <boost/functional/hash.hpp>
+
 namespace Slic3r {
 
+size_t GyroidWaveCache::KeyHash::operator()(const Key &key) const noexcept
+{
+    size_t seed = std::hash<int64_t>()(key.phase);
+    boost::hash_combine(seed, key.phase_steps);
+    boost::hash_combine(seed, key.scale_factor);
+    boost::hash_combine(seed, key.tolerance);
+    return seed;
+}
+
+std::shared_ptr<const GyroidWaveCache::Waves> GyroidWaveCache::waves(const Key &key, const std::function<Waves()> &compute)
+{
+    return m_waves.get(key, [&compute]() { return std::make_shared<const Waves>(compute()); });
+}
+
 static inline double f(double x, double z_sin, double z_cos, bool vertical, bool flip)
 {
     if (vertical) {
@@ -35,7 +51,12 @@ static inline Polyline make_wave(
 {
     std::vector<Vec2d> points = one_period;
     double period = points.back()(0);
-    if (width != period) // do not extend if already truncated
+    if (width < period - EPSILON) {
+        // cut the period of a surface narrower than a period
+        points.erase(std::lower_bound(points.begin(), points.end(), width, [](const Vec2d &p, double x) { return p.x() < x; }), points.end());
+        points.emplace_back(Vec2d(width, f(width, z_sin, z_cos, vertical, flip)));
+    }
+    else if (width > period + EPSILON)
     {
         points.reserve(one_period.size() * size_t(floor(width / period)));
         points.pop_back();
@@ -62,11 +83,11 @@ static inline Polyline make_wave(
     return polyline;
 }
 
-static std::vector<Vec2d> make_one_period(double width, double scaleFactor, double z_cos, double z_sin, bool vertical, bool flip, double tolerance)
+static std::vector<Vec2d> make_one_period(double scaleFactor, double z_cos, double z_sin, bool vertical, bool flip, double tolerance)
 {
     std::vector<Vec2d> points;
     double dx = M_PI_2; // exact coordinates on main inflexion lobes
-    double limit = std::min(2*M_PI, width);
+    double limit = 2*M_PI;
     points.reserve(coord_t(ceil(limit / tolerance / 3)));
 
     for (double x = 0.; x < limit - EPSILON; x += dx) {
@@ -102,7 +123,7 @@ static std::vector<Vec2d> make_one_period(double width, double scaleFactor, doub
     return points;
 }
 
-static Polylines make_gyroid_waves(double gridZ, double density_adjusted, double line_spacing, double width, double height)
+static Polylines make_gyroid_waves(double gridZ, double density_adjusted, double line_spacing, double resolution, double width, double height, GyroidWaveCache *wave_cache)
 {
     const double scaleFactor = scale_(line_spacing) / density_adjusted;
 
@@ -112,7 +133,18 @@ static Polylines make_gyroid_waves(double gridZ, double density_adjusted, double
 
     //scale factor for 5% : 8 712 388
     // 1z = 10^-6 mm ?
-    const double z     = gridZ / scaleFactor;
+    // The pattern is periodic in Z, only the phase of the layer in the period matters. The phase is snapped to a step, which moves
+    // the waves by at most the fill resolution, so that the layers at about the same phase share their waves and the result
+    // does not depend on whether the waves were cached.
+    // The waves move by less than 10x the change of the phase, except within 0.01 of the phases where they switch between
+    // the vertical and the horizontal orientation and jump anyway.
+    const double  max_wave_slope = 10.;
+    const int64_t phase_steps    = std::max<int64_t>(64, int64_t(std::ceil(max_wave_slope * M_PI * unscale<double>(scaleFactor) / std::max(resolution, EPSILON))));
+    double        phase          = std::fmod(gridZ / scaleFactor, 2. * M_PI);
+    if (phase < 0.)
+        phase += 2. * M_PI;
+    const int64_t phase_idx = std::llround(phase * double(phase_steps) / (2. * M_PI)) % phase_steps;
+    const double z     = double(phase_idx) * 2. * M_PI / double(phase_steps);
     const double z_sin = sin(z);
     const double z_cos = cos(z);
 
@@ -127,9 +159,20 @@ static Polylines make_gyroid_waves(double gridZ, double density_adjusted, double
         std::swap(width,height);
     }
 
-    std::vector<Vec2d> one_period_odd = make_one_period(width, scaleFactor, z_cos, z_sin, vertical, flip, tolerance); // creates one period of the waves, so it doesn't have to be recalculated all the time
-    flip = !flip;                                                                   // even polylines are a bit shifted
-    std::vector<Vec2d> one_period_even = make_one_period(width, scaleFactor, z_cos, z_sin, vertical, flip, tolerance);
+    // creates one period of the waves, so it doesn't have to be recalculated all the time
+    auto make_periods = [scaleFactor, z_cos, z_sin, vertical, flip, tolerance]() {
+        GyroidWaveCache::Waves waves;
+        waves.odd  = make_one_period(scaleFactor, z_cos, z_sin, vertical, flip, tolerance);
+        // even polylines are a bit shifted
+        waves.even = make_one_period(scaleFactor, z_cos, z_sin, vertical, ! flip, tolerance);
+        return waves;
+    };
+    std::shared_ptr<const GyroidWaveCache::Waves> waves = wave_cache ?
+        wave_cache->waves({ phase_idx, phase_steps, scaleFactor, tolerance }, make_periods) :
+        std::make_shared<const GyroidWaveCache::Waves>(make_periods());
+    const std::vector<Vec2d> &one_period_odd  = waves->odd;
+    const std::vector<Vec2d> &one_period_even = waves->even;
+    flip = !flip;
     Polylines result;
 
     for (double y0 = lower_bound; y0 < upper_bound + EPSILON; y0 += M_PI) {
@@ -177,8 +220,10 @@ void FillGyroid::_fill_surface_single(
         scale_(this->z),
         density_adjusted,
         this->spacing,
+        params.resolution,
         ceil(bb.size()(0) / distance) + 1.,
-        ceil(bb.size()(1) / distance) + 1.);
+        ceil(bb.size()(1) / distance) + 1.,
+        this->wave_cache);
 
 	// shift the polyline to the grid origin
 	for (Polyline &pl : polylines)
@@ -3,10 +3,59 @@
 
 #include "../libslic3r.h"
 
+#include "../ConcurrentCache.hpp"
+
 #include "FillBase.hpp"
 
+#include <functional>
+#include <memory>
+
 namespace Slic3r {
 
+// Thread-safe table of the gyroid waves of one period, shared by all the layers and surfaces of a PrintObject.
+// The waves only depend on the phase of the layer in the Z period of the pattern, on the pattern scale and on the tolerance.
+// The phase is snapped to a step bounded by the fill resolution, so that the layers at about the same phase share the waves,
+// as do the surfaces of a layer and the repeated filling of a layer by the bridge over infill detection and by the infill step.
+class GyroidWaveCache
+{
+public:
+    struct Key
+    {
+        // Phase of the layer in the Z period of the pattern, in multiples of 2 * PI / phase_steps.
+        int64_t phase;
+        int64_t phase_steps;
+        double  scale_factor;
+        double  tolerance;
+
+        bool operator==(const Key &rhs) const
+        {
+            return phase == rhs.phase && phase_steps == rhs.phase_steps && scale_factor == rhs.scale_factor && tolerance == rhs.tolerance;
+        }
+    };
+
+    struct Waves
+    {
+        std::vector<Vec2d> odd;
+        std::vector<Vec2d> even;
+    };
+
+    // Return the waves stored for the key, otherwise compute them with \p compute and store them.
+    std::shared_ptr<const Waves> waves(const Key &key, const std::function<Waves()> &compute);
+
+    CacheStats stats() const { return m_waves.stats(); }
+
+private:
+    struct KeyHash
+    {
+        size_t operator()(const Key &key) const noexcept;
+    };
+
+    // Upper bound of the number of waves per shard.
+    static constexpr size_t MAX_SHARD_SIZE = 256;
+
+    ShardedCache<Key, std::shared_ptr<const Waves>, KeyHash> m_waves { MAX_SHARD_SIZE };
+};
+
 class FillGyroid : public Fill
 {
 public:
@@ -27,6 +76,9 @@ public:
     // Gyroid upper resolution tolerance (mm^-2)
     static constexpr double PatternTolerance = 0.2;
 
+    // Waves shared with the other layers of the object, may be null.
+    GyroidWaveCache *wave_cache = nullptr;
+
 
 protected:
     void _fill_surface_single(
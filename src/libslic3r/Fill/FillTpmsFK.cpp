@@ -375,18 +375,6 @@ void FillTpmsFK::_fill_surface_single(const FillParams&              params,
     float myperiod = 2 * PI / vari_T;
     float c_z      = myperiod * this->z; // z height
 
-    // scalar field Fischer-Koch
-    auto scalar_field = [&](float x, float y) -> float {
-        const float a_x       = myperiod * x;
-        const float b_y       = myperiod * y;
-
-        // Fischer - Koch S equation:
-        // cos(2x)sin(y)cos(z) + cos(2y)sin(z)cos(x) + cos(2z)sin(x)cos(y) = 0
-        return cosf(2 * a_x) * sinf(b_y) * cosf(c_z)
-             + cosf(2 * b_y) * sinf(c_z) * cosf(a_x) 
-             + cosf(2 * c_z) * sinf(a_x) * cosf(b_y);
-    };
-
     // Mesh generation
     std::vector<std::vector<MarchingSquares::Point>> posxy;
     int                                              i = 0, j = 0;
@@ -406,13 +394,38 @@ void FillTpmsFK::_fill_surface_single(const FillParams&              params,
 
     int width      = posxy[0].size();
     int height     = posxy.size();
-    int total_size = (height) * (width);
-    tbb::parallel_for(tbb::blocked_range<size_t>(0, total_size),
-                      [&width, &scalar_field, &data, &posxy](const tbb::blocked_range<size_t>& range) {
-                          for (size_t k = range.begin(); k < range.end(); ++k) {
-                              int i      = k / (width);
-                              int j      = k % (width);
-                              data[i][j] = scalar_field(posxy[i][j].x, posxy[i][j].y);
+
+    // Scalar field Fischer-Koch S:
+    // cos(2x)sin(y)cos(z) + cos(2y)sin(z)cos(x) + cos(2z)sin(x)cos(y) = 0
+    // The grid is regular, thus every term is a product of a factor of the column, a factor of the row and a constant of the layer.
+    // The trigonometric functions are evaluated once per column and once per row instead of once per grid point.
+    struct ColumnTerms { float cos_2ax, cos_ax, sin_ax; };
+    struct RowTerms    { float sin_by, cos_2by, cos_by; };
+    std::vector<ColumnTerms> columns(width);
+    std::vector<RowTerms>    rows(height);
+    for (int j = 0; j < width; ++ j) {
+        const float a_x = myperiod * float(posxy[0][j].x);
+        columns[j] = { cosf(2 * a_x), cosf(a_x), sinf(a_x) };
+    }
+    for (int i = 0; i < height; ++ i) {
+        const float b_y = myperiod * float(posxy[i][0].y);
+        rows[i] = { sinf(b_y), cosf(2 * b_y), cosf(b_y) };
+    }
+    const float cos_cz  = cosf(c_z);
+    const float sin_cz  = sinf(c_z);
+    const float cos_2cz = cosf(2 * c_z);
+
+    tbb::parallel_for(tbb::blocked_range<int>(0, height),
+                      [width, &columns, &rows, cos_cz, sin_cz, cos_2cz, &data](const tbb::blocked_range<int>& range) {
+                          for (int i = range.begin(); i < range.end(); ++ i) {
+                              const RowTerms &row  = rows[i];
+                              std::vector<double> &line = data[i];
+                              for (int j = 0; j < width; ++ j) {
+                                  const ColumnTerms &col = columns[j];
+                                  line[j] = col.cos_2ax * row.sin_by * cos_cz
+                                          + row.cos_2by * sin_cz * col.cos_ax
+                                          + cos_2cz * col.sin_ax * row.cos_by;
+                              }
                           }
                       });
 
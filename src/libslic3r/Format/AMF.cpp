@@ -666,7 +666,7 @@ void AMFParserContext::endElement(const char * /* name */)
             // pass false if the mesh offset has been already taken from the data 
             m_volume->center_geometry_after_creation(m_volume->source.input_file.empty());
 
-        m_volume->calculate_convex_hull();
+        m_volume->invalidate_convex_hull();
         m_volume_facets.clear();
         m_volume = nullptr;
         break;
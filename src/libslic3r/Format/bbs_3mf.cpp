@@ -4751,7 +4751,7 @@ void PlateData::parse_filament_info(GCodeProcessorResult *result)
             if (has_transform)
                 volume->source.transform = Slic3r::Geometry::Transformation(volume_matrix_to_object);
 
-            volume->calculate_convex_hull();
+            volume->invalidate_convex_hull();
 
             //set transform from 3mf
             Slic3r::Geometry::Transformation comp_transformatino(sub_comp.transform);
@@ -4924,7 +4924,7 @@ void PlateData::parse_filament_info(GCodeProcessorResult *result)
             // stores the volume matrix taken from the metadata, if present
             if (has_transform)
                 volume->source.transform = Slic3r::Geometry::Transformation(volume_matrix_to_object);
-            volume->calculate_convex_hull();
+            volume->invalidate_convex_hull();
 
             // recreate custom supports, seam and mmu segmentation from previously loaded attribute
             volume->supported_facets.reserve(triangles_count);
@@ -20,6 +20,7 @@
 #include "LocalesUtils.hpp"
 #include "libslic3r/format.hpp"
 #include "Time.hpp"
+#include "Trace.hpp"
 #include "GCode/ExtrusionProcessor.hpp"
 #include <algorithm>
 #include <cmath>
@@ -1312,6 +1313,29 @@ std::vector<std::pair<coordf_t, std::vector<GCode::LayerToPrint>>> GCode::collec
     return layers_to_print;
 }
 
+// G-code of the layers of a non-sequential print as generated by GCode::process_layer(), before the post-processing filters
+// (cooling buffer, fan mover, pressure equalizer, adaptive pressure advance) were applied. The cache is kept by the Print
+// between the exports, so that if only the options of the post-processing filters changed, the next export just runs
+// the cached layers through the filters again.
+struct GCodeLayerCache
+{
+    // Full print configuration the layers were generated with.
+    DynamicPrintConfig          config;
+    // Timestamps of the Print and PrintObject steps the layers were generated from.
+    std::vector<size_t>         timestamps;
+    std::vector<LayerResult>    layers;
+    // Length of the G-code of the layers, limited by Print::gcode_layer_cache_limit().
+    size_t                      layers_size { 0 };
+    // G-code exported after the layers. The config block in between is not cached, it is generated by every export.
+    std::string                 footer;
+    bool                        has_config_block { false };
+    std::string                 footer_after_config_block;
+    // State of the GCode generator and of the Print collected while exporting the layers.
+    std::set<unsigned int>      initial_layer_extruders;
+    bool                        support_traditional_timelapse { true };
+    PrintStatistics             print_statistics;
+};
+
 // free functions called by GCode::do_export()
 namespace DoExport {
 //    static void update_print_estimated_times_stats(const GCodeProcessor& processor, PrintStatistics& print_statistics)
@@ -1423,6 +1447,42 @@ namespace DoExport {
 
         return ret;
     }
+
+    // Timestamps of the Print and PrintObject steps the G-code of the layers is generated from.
+    static std::vector<size_t> layer_cache_timestamps(const Print &print)
+    {
+        std::vector<size_t> timestamps;
+        for (int step = 0; step < int(psGCodeExport); ++ step)
+            timestamps.emplace_back(print.step_state_with_timestamp(PrintStep(step)).timestamp);
+        for (const PrintObject *object : print.objects())
+            for (int step = 0; step < int(posCount); ++ step)
+                timestamps.emplace_back(object->step_state_with_timestamp(PrintObjectStep(step)).timestamp);
+        return timestamps;
+    }
+
+    // The layers cached by the previous export may be replayed if none of the steps they were generated from was recalculated since
+    // and if only the options of the G-code post-processing filters changed.
+    static bool layer_cache_valid(const Print &print, const GCodeLayerCache &cache)
+    {
+        if (cache.timestamps != layer_cache_timestamps(print))
+            return false;
+        const DynamicPrintConfig  &config = print.full_print_config();
+        const t_config_option_keys diff   = cache.config.diff(config);
+        if (! std::all_of(diff.begin(), diff.end(), Print::is_gcode_postprocess_option))
+            return false;
+        // The pressure equalizer makes the G-code generator emit the extrusion role markers.
+        if ((cache.config.opt_float("max_volumetric_extrusion_rate_slope") > 0) != (config.opt_float("max_volumetric_extrusion_rate_slope") > 0))
+            return false;
+        // The custom G-code expanded into the layers may reference the changed options.
+        for (const t_config_option_key &opt_key : config.keys())
+            if (const ConfigOptionDef *def = config.def()->get(opt_key); def != nullptr && def->is_code) {
+                const std::string code = config.opt_serialize(opt_key);
+                for (const t_config_option_key &changed_key : diff)
+                    if (code.find(changed_key) != std::string::npos)
+                        return false;
+            }
+        return true;
+    }
 } // namespace DoExport
 
 bool GCode::is_BBL_Printer()
@@ -1435,6 +1495,7 @@ bool GCode::is_BBL_Printer()
 void GCode::do_export(Print* print, const char* path, GCodeProcessorResult* result, ThumbnailsGeneratorCallback thumbnail_cb)
 {
     PROFILE_CLEAR();
+    SLIC3R_TRACE_ZONE("GCode::do_export");
 
     // BBS
     m_curr_print = print;
@@ -1493,6 +1554,25 @@ void GCode::do_export(Print* print, const char* path, GCodeProcessorResult* resu
         throw Slic3r::RuntimeError(std::string("G-code export to ") + path + " failed.\nCannot open the file for writing.\n");
     }
 
+    // Replay the layers cached by the previous export if only the options of the post-processing filters changed,
+    // otherwise cache the layers generated now if enabled. The low memory mode releases the extrusions instead.
+    m_layer_cache_replay = false;
+    m_layer_cache.reset();
+    if (print->gcode_layer_cache_limit() == 0 || print->low_memory_mode())
+        print->m_gcode_layer_cache.reset();
+    if (print->m_gcode_layer_cache && DoExport::layer_cache_valid(*print, *print->m_gcode_layer_cache)) {
+        m_layer_cache        = print->m_gcode_layer_cache;
+        m_layer_cache_replay = true;
+        BOOST_LOG_TRIVIAL(info) << "Replaying " << m_layer_cache->layers.size() << " G-code layers cached by the previous export";
+    } else {
+        print->m_gcode_layer_cache.reset();
+        if (print->gcode_layer_cache_limit() > 0 && ! print->low_memory_mode()) {
+            m_layer_cache             = std::make_shared<GCodeLayerCache>();
+            m_layer_cache->config     = print->full_print_config();
+            m_layer_cache->timestamps = DoExport::layer_cache_timestamps(*print);
+        }
+    }
+
     try {
         this->_do_export(*print, file, thumbnail_cb);
         file.flush();
@@ -1591,6 +1671,9 @@ void GCode::do_export(Print* print, const char* path, GCodeProcessorResult* resu
         BOOST_LOG_TRIVIAL(info) << boost::format("rename_file from %1% to %2% successfully")% path_tmp % path;
     }
 
+    if (m_layer_cache && ! m_layer_cache_replay)
+        print->m_gcode_layer_cache = std::move(m_layer_cache);
+
     BOOST_LOG_TRIVIAL(info) << "Exporting G-code finished" << log_memory_info();
     print->set_done(psGCodeExport);
     
@@ -2542,6 +2625,9 @@ void GCode::_do_export(Print& print, GCodeOutputStream &file, ThumbnailsGenerato
 
         // Do all objects for each layer.
         if (print.config().print_sequence == PrintSequence::ByObject && !has_wipe_tower) {
+            // The layers of the sequential print are not cached, see GCodeLayerCache.
+            m_layer_cache.reset();
+            m_layer_cache_replay = false;
             size_t finished_objects = 0;
             const PrintObject *prev_object = (*print_object_instance_sequential_active)->print_object;
             for (; print_object_instance_sequential_active != print_object_instances_ordering.end(); ++ print_object_instance_sequential_active) {
@@ -2662,6 +2748,12 @@ void GCode::_do_export(Print& print, GCodeOutputStream &file, ThumbnailsGenerato
             // Generate G-code, run the filters (vase mode, cooling buffer), run the G-code analyser
             // and export G-code into file.
             this->process_layers(print, tool_ordering, print_object_instances_ordering, layers_to_print, file);
+            if (m_layer_cache_replay) {
+                this->replay_layer_cache_footer(print, file);
+                return;
+            }
+            if (m_layer_cache)
+                file.record(&m_layer_cache->footer);
             //BBS: close powerlost recovery
             {
                 if (is_bbl_printers && m_second_layer_things_done) {
@@ -2762,27 +2854,59 @@ void GCode::_do_export(Print& print, GCodeOutputStream &file, ThumbnailsGenerato
                 GCodeProcessor::ETags::Estimated_Printing_Time_Placeholder)
             .c_str());
       file.write("\n");
-      file.write("; CONFIG_BLOCK_START\n");
-      std::string full_config;
-      append_full_config(print, full_config);
-      if (!full_config.empty())
-        file.write(full_config);
+      // The config block is generated by every export, thus it is not recorded into the layer cache.
+      std::string *recording = file.recording();
+      file.record(nullptr);
+      this->write_config_block(print, file);
+      if (recording != nullptr) {
+          m_layer_cache->has_config_block = true;
+          file.record(&m_layer_cache->footer_after_config_block);
+      }
+    }
+    file.write("\n");
 
-      // SoftFever: write compatiple info
-      int first_layer_bed_temperature = get_bed_temperature(0, true, print.config().curr_bed_type);
-      file.write_format("; first_layer_bed_temperature = %d\n", first_layer_bed_temperature);
-      file.write_format("; bed_shape = %s\n", print.full_print_config().opt_serialize("printable_area").c_str());
-      file.write_format("; first_layer_temperature = %d\n", print.config().nozzle_temperature_initial_layer.get_at(0));
-      file.write_format("; first_layer_height = %.3f\n", print.config().initial_layer_print_height.value);
-        
-        //SF TODO
-//      file.write_format("; variable_layer_height = %d\n", print.ad.adaptive_layer_height ? 1 : 0);
-   
-      file.write("; CONFIG_BLOCK_END\n\n");
+    print.throw_if_canceled();
 
+    if (m_layer_cache) {
+        file.record(nullptr);
+        m_layer_cache->initial_layer_extruders       = m_initial_layer_extruders;
+        m_layer_cache->support_traditional_timelapse = m_support_traditional_timelapse;
+        m_layer_cache->print_statistics              = print.m_print_statistics;
     }
-    file.write("\n");
+}
+
+void GCode::write_config_block(const Print &print, GCodeOutputStream &file)
+{
+    file.write("; CONFIG_BLOCK_START\n");
+    std::string full_config;
+    append_full_config(print, full_config);
+    if (!full_config.empty())
+        file.write(full_config);
+
+    // SoftFever: write compatiple info
+    int first_layer_bed_temperature = get_bed_temperature(0, true, print.config().curr_bed_type);
+    file.write_format("; first_layer_bed_temperature = %d\n", first_layer_bed_temperature);
+    file.write_format("; bed_shape = %s\n", print.full_print_config().opt_serialize("printable_area").c_str());
+    file.write_format("; first_layer_temperature = %d\n", print.config().nozzle_temperature_initial_layer.get_at(0));
+    file.write_format("; first_layer_height = %.3f\n", print.config().initial_layer_print_height.value);
+
+    //SF TODO
+//  file.write_format("; variable_layer_height = %d\n", print.ad.adaptive_layer_height ? 1 : 0);
+
+    file.write("; CONFIG_BLOCK_END\n\n");
+}
 
+void GCode::replay_layer_cache_footer(Print &print, GCodeOutputStream &file)
+{
+    const GCodeLayerCache &cache = *m_layer_cache;
+    file.write(cache.footer);
+    if (cache.has_config_block) {
+        this->write_config_block(print, file);
+        file.write(cache.footer_after_config_block);
+    }
+    m_initial_layer_extruders       = cache.initial_layer_extruders;
+    m_support_traditional_timelapse = cache.support_traditional_timelapse;
+    print.m_print_statistics        = cache.print_statistics;
     print.throw_if_canceled();
 }
 
@@ -2799,11 +2923,25 @@ void GCode::check_placeholder_parser_failed()
     }
 }
 
+// Low memory mode of the command line slicer: release the extrusions of the layers, whose G-code was generated.
+// The layers are released by the objects owning them.
+static void release_printed_layer_extrusions(Print &print, const std::vector<GCode::LayerToPrint> &layers)
+{
+    for (const GCode::LayerToPrint &layer_to_print : layers)
+        if (const PrintObject *object = layer_to_print.object()) {
+            auto it = std::find(print.objects_mutable().begin(), print.objects_mutable().end(), object);
+            assert(it != print.objects_mutable().end());
+            (*it)->release_layer_extrusions(layer_to_print.object_layer, layer_to_print.support_layer);
+        }
+}
+
 // Process all layers of all objects (non-sequential mode) with a parallel pipeline:
 // Generate G-code, run the filters (vase mode, cooling buffer), run the G-code analyser
 // and export G-code into file.
+// In the low memory mode the extrusions of each layer are released once its G-code is generated.
+// Otherwise the generated layers are recorded into m_layer_cache, or replayed from m_layer_cache if m_layer_cache_replay is set.
 void GCode::process_layers(
-    const Print                                                         &print,
+    Print                                                               &print,
     const ToolOrdering                                                  &tool_ordering,
     const std::vector<const PrintInstance*>                             &print_object_instances_ordering,
     const std::vector<std::pair<coordf_t, std::vector<LayerToPrint>>>   &layers_to_print,
@@ -2823,6 +2961,11 @@ void GCode::process_layers(
                     ++layer_to_print_idx;
                     return LayerResult::make_nop_layer_result();
                 }
+            } else if (m_layer_cache_replay) {
+                // Only the post-processing filters below are to be run again, replay the layers generated by the previous export.
+                print.set_status(80, Slic3r::format(_(L("Generating G-code: layer %1%")), std::to_string(layer_to_print_idx + 1)));
+                print.throw_if_canceled();
+                return m_layer_cache->layers[layer_to_print_idx++];
             } else {
                 const std::pair<coordf_t, std::vector<LayerToPrint>>& layer = layers_to_print[layer_to_print_idx++];
                 const LayerTools& layer_tools = tool_ordering.tools_for_layer(layer.first);
@@ -2832,7 +2975,19 @@ void GCode::process_layers(
                 //BBS
                 check_placeholder_parser_failed();
                 print.throw_if_canceled();
-                return this->process_layer(print, layer.second, layer_tools, &layer == &layers_to_print.back(), &print_object_instances_ordering, size_t(-1));
+                SLIC3R_TRACE_ZONE_LAYER("GCode::process_layer", Trace::NO_OBJECT, layer_to_print_idx - 1);
+                LayerResult result = this->process_layer(print, layer.second, layer_tools, &layer == &layers_to_print.back(), &print_object_instances_ordering, size_t(-1));
+                if (print.low_memory_mode())
+                    release_printed_layer_extrusions(print, layer.second);
+                if (m_layer_cache) {
+                    m_layer_cache->layers_size += result.gcode.size();
+                    if (m_layer_cache->layers_size > print.gcode_layer_cache_limit())
+                        // Too large to be kept by the Print, export without caching.
+                        m_layer_cache.reset();
+                    else
+                        m_layer_cache->layers.emplace_back(result);
+                }
+                return result;
             }
         });
     if (m_spiral_vase) {
@@ -2844,6 +2999,7 @@ void GCode::process_layers(
         [&spiral_mode = *this->m_spiral_vase.get(), &layers_to_print](LayerResult in) -> LayerResult {
         	if (in.nop_layer_result)
                 return in;
+            SLIC3R_TRACE_ZONE_LAYER("SpiralVase::process_layer", Trace::NO_OBJECT, in.layer_id);
                 
             spiral_mode.enable(in.spiral_vase_enable);
             bool last_layer = in.layer_id == layers_to_print.size() - 1;
@@ -2851,27 +3007,34 @@ void GCode::process_layers(
         });
     const auto pressure_equalizer = tbb::make_filter<LayerResult, LayerResult>(slic3r_tbb_filtermode::serial_in_order,
         [pressure_equalizer = this->m_pressure_equalizer.get()](LayerResult in) -> LayerResult {
+            SLIC3R_TRACE_ZONE_LAYER("PressureEqualizer::process_layer", Trace::NO_OBJECT, in.layer_id);
             return pressure_equalizer->process_layer(std::move(in));
         });
     const auto cooling = tbb::make_filter<LayerResult, std::string>(slic3r_tbb_filtermode::serial_in_order,
         [&cooling_buffer = *this->m_cooling_buffer.get()](LayerResult in) -> std::string {
         	if (in.nop_layer_result)
                 return in.gcode;
+            SLIC3R_TRACE_ZONE_LAYER("CoolingBuffer::process_layer", Trace::NO_OBJECT, in.layer_id);
             return cooling_buffer.process_layer(std::move(in.gcode), in.layer_id, in.cooling_buffer_flush);
         });
     const auto pa_processor_filter = tbb::make_filter<std::string, std::string>(slic3r_tbb_filtermode::serial_in_order,
             [&pa_processor = *this->m_pa_processor](std::string in) -> std::string {
+                SLIC3R_TRACE_ZONE("AdaptivePAProcessor::process_layer");
                 return pa_processor.process_layer(std::move(in));
             }
         );
     
     const auto output = tbb::make_filter<std::string, void>(slic3r_tbb_filtermode::serial_in_order,
-        [&output_stream](std::string s) { output_stream.write(s); }
+        [&output_stream](std::string s) {
+            SLIC3R_TRACE_ZONE("GCode::output");
+            output_stream.write(s);
+        }
     );
 
     const auto fan_mover = tbb::make_filter<std::string, std::string>(slic3r_tbb_filtermode::serial_in_order,
             [&fan_mover = this->m_fan_mover, &config = this->config(), &writer = this->m_writer](std::string in)->std::string {
 
+        SLIC3R_TRACE_ZONE("FanMover::process_gcode");
         CNumericLocalesSetter locales_setter;
 
         if (config.fan_speedup_time.value != 0 || config.fan_kickstart.value > 0) {
@@ -2932,6 +3095,7 @@ void GCode::process_layers(
                 //BBS
                 check_placeholder_parser_failed();
                 print.throw_if_canceled();
+                SLIC3R_TRACE_ZONE_LAYER("GCode::process_layer", Trace::NO_OBJECT, layer_to_print_idx - 1);
                 return this->process_layer(print, { std::move(layer) }, tool_ordering.tools_for_layer(layer.print_z()), &layer == &layers_to_print.back(), nullptr, single_object_idx, prime_extruder);
             }
         });
@@ -2944,33 +3108,41 @@ void GCode::process_layers(
         [&spiral_mode = *this->m_spiral_vase.get(), &layers_to_print](LayerResult in)->LayerResult {
             if (in.nop_layer_result)
                 return in;
+            SLIC3R_TRACE_ZONE_LAYER("SpiralVase::process_layer", Trace::NO_OBJECT, in.layer_id);
             spiral_mode.enable(in.spiral_vase_enable);
             bool last_layer = in.layer_id == layers_to_print.size() - 1;
             return { spiral_mode.process_layer(std::move(in.gcode), last_layer), in.layer_id, in.spiral_vase_enable, in.cooling_buffer_flush };
         });
     const auto pressure_equalizer = tbb::make_filter<LayerResult, LayerResult>(slic3r_tbb_filtermode::serial_in_order,
         [pressure_equalizer = this->m_pressure_equalizer.get()](LayerResult in) -> LayerResult {
+             SLIC3R_TRACE_ZONE_LAYER("PressureEqualizer::process_layer", Trace::NO_OBJECT, in.layer_id);
              return pressure_equalizer->process_layer(std::move(in));
         });
     const auto cooling = tbb::make_filter<LayerResult, std::string>(slic3r_tbb_filtermode::serial_in_order,
         [&cooling_buffer = *this->m_cooling_buffer.get()](LayerResult in)->std::string {
             if (in.nop_layer_result)
                 return in.gcode;
+            SLIC3R_TRACE_ZONE_LAYER("CoolingBuffer::process_layer", Trace::NO_OBJECT, in.layer_id);
             return cooling_buffer.process_layer(std::move(in.gcode), in.layer_id, in.cooling_buffer_flush);
         });
     const auto pa_processor_filter = tbb::make_filter<std::string, std::string>(slic3r_tbb_filtermode::serial_in_order,
         [&pa_processor = *this->m_pa_processor](std::string in) -> std::string {
+            SLIC3R_TRACE_ZONE("AdaptivePAProcessor::process_layer");
             return pa_processor.process_layer(std::move(in));
         }
     );
     
     const auto output = tbb::make_filter<std::string, void>(slic3r_tbb_filtermode::serial_in_order,
-        [&output_stream](std::string s) { output_stream.write(s); }
+        [&output_stream](std::string s) {
+            SLIC3R_TRACE_ZONE("GCode::output");
+            output_stream.write(s);
+        }
     );
 
     const auto fan_mover = tbb::make_filter<std::string, std::string>(slic3r_tbb_filtermode::serial_in_order,
         [&fan_mover = this->m_fan_mover, &config = this->config(), &writer = this->m_writer](std::string in)->std::string {
 
+        SLIC3R_TRACE_ZONE("FanMover::process_gcode");
         if (config.fan_speedup_time.value != 0 || config.fan_kickstart.value > 0) {
             if (fan_mover.get() == nullptr)
                 fan_mover.reset(new Slic3r::FanMover(
@@ -5182,6 +5354,8 @@ void GCode::GCodeOutputStream::write(const char *what)
         fwrite(gcode, 1, ::strlen(gcode), this->f);
         //FIXME don't allocate a string, maybe process a batch of lines?
         m_processor.process_buffer(std::string(gcode));
+        if (m_recording != nullptr)
+            *m_recording += gcode;
     }
 }
 
@@ -37,6 +37,7 @@ namespace Slic3r {
 
 // Forward declarations.
 class GCode;
+struct GCodeLayerCache;
 
 namespace { struct Item; }
 struct PrintInstance;
@@ -300,11 +301,20 @@ private:
         // Formats and write into a file the given data.
         void write_format(const char* format, ...);
 
+        // Append everything written into the file to the string as well, until the recording is stopped by passing nullptr.
+        void record(std::string *recording) { m_recording = recording; }
+        std::string* recording() const { return m_recording; }
+
     private:
         FILE *f = nullptr;
         GCodeProcessor &m_processor;
+        std::string *m_recording = nullptr;
     };
     void            _do_export(Print &print, GCodeOutputStream &file, ThumbnailsGeneratorCallback thumbnail_cb);
+    // Write the "; CONFIG_BLOCK_START" ... "; CONFIG_BLOCK_END" section with the full print configuration.
+    void            write_config_block(const Print &print, GCodeOutputStream &file);
+    // Write the G-code following the layers as cached by the previous export and restore the state collected while exporting the layers.
+    void            replay_layer_cache_footer(Print &print, GCodeOutputStream &file);
 
     static std::vector<LayerToPrint>        		                   collect_layers_to_print(const PrintObject &object);
     static std::vector<std::pair<coordf_t, std::vector<LayerToPrint>>> collect_layers_to_print(const Print &print);
@@ -333,8 +343,9 @@ private:
     // Process all layers of all objects (non-sequential mode) with a parallel pipeline:
     // Generate G-code, run the filters (vase mode, cooling buffer), run the G-code analyser
     // and export G-code into file.
+    // The print is mutable for its objects to release the extrusions of the printed layers in the low memory mode.
     void process_layers(
-        const Print                                                         &print,
+        Print                                                               &print,
         const ToolOrdering                                                  &tool_ordering,
         const std::vector<const PrintInstance*>                             &print_object_instances_ordering,
         const std::vector<std::pair<coordf_t, std::vector<LayerToPrint>>>   &layers_to_print,
@@ -599,6 +610,9 @@ private:
     int m_start_gcode_filament = -1;
 
     std::set<unsigned int>                  m_initial_layer_extruders;
+    // Layers generated by this export to be cached by the Print, or the layers cached by the previous export to be replayed.
+    std::shared_ptr<GCodeLayerCache>        m_layer_cache;
+    bool                                    m_layer_cache_replay { false };
     // BBS
     int get_bed_temperature(const int extruder_id, const bool is_first_layer, const BedType bed_type) const;
 
@@ -8,6 +8,7 @@
 #include <cmath>
 #include <algorithm>
 #include <sstream>
+#include <map>
 
 /**
  * @brief Parses the input data and sets up the interpolators.
@@ -17,6 +18,8 @@
 int AdaptivePAInterpolator::parseAndSetData(const std::string& data) {
     flow_interpolators_.clear();
     accelerations_.clear();
+    acceleration_steps_.clear();
+    m_hasInvalidPA = false;
 
     try {
         std::istringstream ss(data);
@@ -63,9 +66,13 @@ int AdaptivePAInterpolator::parseAndSetData(const std::string& data) {
 
             // Only set up the interpolator if there are enough data points
             if (flowRates.size() > 1) {
-                PchipInterpolatorHelper interpolator(flowRates, paValues);
-                flow_interpolators_[acceleration] = interpolator;
+                flow_interpolators_.emplace_back(flowRates, paValues);
+                if (! accelerations_.empty())
+                    acceleration_steps_.push_back(acceleration - accelerations_.back());
                 accelerations_.push_back(acceleration);
+                // A PCHIP model does not overshoot its data, thus it only returns -1 if some of its PA values are -1 or lower.
+                if (*std::min_element(paValues.begin(), paValues.end()) <= -1)
+                    m_hasInvalidPA = true;
             }
         }
     } catch (const std::exception&) {
@@ -82,18 +89,66 @@ int AdaptivePAInterpolator::parseAndSetData(const std::string& data) {
  * @param acceleration The acceleration at which to interpolate.
  * @return The interpolated PA value, or -1 if interpolation fails.
  */
-double AdaptivePAInterpolator::operator()(double flow_rate, double acceleration) {
+double AdaptivePAInterpolator::operator()(double flow_rate, double acceleration) const {
+    if (m_hasInvalidPA)
+        return interpolateAllModels(flow_rate, acceleration);
+
+    const size_t n = accelerations_.size();
+    if (n < 2) {
+        // Special case: Only one acceleration value
+        if (n == 1) {
+            return std::round(flow_interpolators_.front().interpolate(flow_rate) * 1000.0) / 1000.0; // Rounded to 3 decimal places
+        }
+        return -1; // Error: Not enough data points for interpolation
+    }
+
+    // Evaluate the PA-acceleration PCHIP model of the PA values estimated by the flow-rate-to-PA models at the given flow rate.
+    // The model is only evaluated on the segment containing the acceleration, whose derivatives depend on the PA values of
+    // the neighboring segments, so only these up to four flow-rate-to-PA models are evaluated.
+    double pa_value;
+    if (acceleration <= accelerations_.front()) {
+        pa_value = flow_interpolators_.front().interpolate(flow_rate);
+    } else if (acceleration >= accelerations_.back()) {
+        pa_value = flow_interpolators_.back().interpolate(flow_rate);
+    } else {
+        const size_t i  = std::distance(accelerations_.begin(), std::lower_bound(accelerations_.begin(), accelerations_.end(), acceleration)) - 1;
+        const double y0 = flow_interpolators_[i].interpolate(flow_rate);
+        const double y1 = flow_interpolators_[i + 1].interpolate(flow_rate);
+        const double delta = (y1 - y0) / acceleration_steps_[i];
+        // Derivatives at the ends of the segment, as in PchipInterpolatorHelper::computePCHIP().
+        double d0 = delta;
+        if (i > 0) {
+            const double y_prev = flow_interpolators_[i - 1].interpolate(flow_rate);
+            d0 = PchipInterpolatorHelper::interiorDerivative(acceleration_steps_[i - 1], acceleration_steps_[i], (y0 - y_prev) / acceleration_steps_[i - 1], delta);
+        }
+        double d1 = delta;
+        if (i + 2 < n) {
+            const double y_next = flow_interpolators_[i + 2].interpolate(flow_rate);
+            d1 = PchipInterpolatorHelper::interiorDerivative(acceleration_steps_[i], acceleration_steps_[i + 1], delta, (y_next - y1) / acceleration_steps_[i + 1]);
+        }
+        pa_value = PchipInterpolatorHelper::hermite(acceleration, accelerations_[i], acceleration_steps_[i], y0, y1, d0, d1);
+    }
+    return std::round(pa_value * 1000.0) / 1000.0; // Rounded to 3 decimal places
+}
+
+/**
+ * @brief Interpolates the PA value by building the PA-acceleration PCHIP model of all the flow-rate-to-PA models.
+ * @param flow_rate The flow rate at which to interpolate.
+ * @param acceleration The acceleration at which to interpolate.
+ * @return The interpolated PA value, or -1 if interpolation fails.
+ */
+double AdaptivePAInterpolator::interpolateAllModels(double flow_rate, double acceleration) const {
     std::vector<double> pa_values;
     std::vector<double> acc_values;
 
     // Estimate PA value for every flow to PA model for the given flow rate
-    for (const auto& kv : flow_interpolators_) {
-        double pa_value = kv.second.interpolate(flow_rate);
+    for (size_t i = 0; i < flow_interpolators_.size(); ++i) {
+        double pa_value = flow_interpolators_[i].interpolate(flow_rate);
         
         // Check if the interpolated PA value is valid
         if (pa_value != -1) {
             pa_values.push_back(pa_value);
-            acc_values.push_back(kv.first);
+            acc_values.push_back(accelerations_[i]);
         }
     }
 
@@ -8,7 +8,6 @@
 
 #include <vector>
 #include <string>
-#include <map>
 #include "PchipInterpolatorHelper.hpp"
 
 /**
@@ -35,7 +34,7 @@ public:
      * @param acceleration The acceleration at which to interpolate.
      * @return The interpolated PA value, or -1 if interpolation fails.
      */
-    double operator()(double flow_rate, double acceleration);
+    double operator()(double flow_rate, double acceleration) const;
     
     /**
      * @brief Returns the initialization status.
@@ -46,8 +45,21 @@ public:
     }
 
 private:
-    std::map<double, PchipInterpolatorHelper> flow_interpolators_; ///< Map each acceleration to a flow-rate-to-PA interpolator.
-    std::vector<double> accelerations_; ///< Store unique accelerations.
+    /**
+     * @brief Interpolates the PA value by building the PA-acceleration PCHIP model of all the flow-rate-to-PA models.
+     * Used if a flow-rate-to-PA model may return the invalid PA value -1, which drops the model from the PA-acceleration model.
+     * @param flow_rate The flow rate at which to interpolate.
+     * @param acceleration The acceleration at which to interpolate.
+     * @return The interpolated PA value, or -1 if interpolation fails.
+     */
+    double interpolateAllModels(double flow_rate, double acceleration) const;
+
+    // The flow rate x acceleration surface: the flow-rate-to-PA models are sorted by acceleration and stored with the differences
+    // of the successive accelerations, so that a query only evaluates the (up to four) models around the acceleration.
+    std::vector<PchipInterpolatorHelper> flow_interpolators_; ///< Flow-rate-to-PA interpolator of each acceleration.
+    std::vector<double> accelerations_; ///< Store unique accelerations, sorted.
+    std::vector<double> acceleration_steps_; ///< Differences between successive accelerations.
+    bool m_hasInvalidPA = false; ///< Some PA value is -1 or lower, thus a flow-rate-to-PA model may return -1.
     bool m_isInitialised;
 };
 
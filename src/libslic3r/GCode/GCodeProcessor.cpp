@@ -6,6 +6,7 @@
 #include "libslic3r/Print.hpp"
 #include "libslic3r/LocalesUtils.hpp"
 #include "libslic3r/format.hpp"
+#include "libslic3r/Trace.hpp"
 #include "GCodeProcessor.hpp"
 
 #include <boost/log/trivial.hpp>
@@ -715,6 +716,14 @@ void GCodeProcessorResult::reset() {
 }
 #endif // ENABLE_GCODE_VIEWER_STATISTICS
 
+size_t GCodeProcessorResult::memsize() const
+{
+    size_t out = moves.capacity() * sizeof(MoveVertex) + lines_ends.capacity() * sizeof(size_t);
+    for (const MoveVertex &move : moves)
+        out += move.interpolation_points.capacity() * sizeof(Vec3f);
+    return out;
+}
+
 const std::vector<std::pair<GCodeProcessor::EProducer, std::string>> GCodeProcessor::Producers = {
     //BBS: OrcaSlicer is also "bambu". Otherwise the time estimation didn't work.
     //FIXME: Workaround and should be handled when do removing-bambu
@@ -1332,6 +1341,7 @@ static inline const char* remove_eols(const char *begin, const char *end) {
 // throws CanceledException through print->throw_if_canceled() (sent by the caller as callback).
 void GCodeProcessor::process_file(const std::string& filename, std::function<void()> cancel_callback)
 {
+    SLIC3R_TRACE_ZONE("GCodeProcessor::process_file");
     CNumericLocalesSetter locales_setter;
 
 #if ENABLE_GCODE_VIEWER_STATISTICS
@@ -1461,6 +1471,7 @@ void GCodeProcessor::initialize(const std::string& filename)
 
 void GCodeProcessor::process_buffer(const std::string &buffer)
 {
+    SLIC3R_TRACE_ZONE("GCodeProcessor::process_buffer");
     //FIXME maybe cache GCodeLine gline to be over multiple parse_buffer() invocations.
     m_parser.parse_buffer(buffer, [this](GCodeReader&, const GCodeReader::GCodeLine& line) { 
         this->process_gcode_line(line, false);
@@ -1513,6 +1524,7 @@ void GCodeProcessor::apply_time_overrides()
 
 void GCodeProcessor::finalize(bool post_process)
 {
+    SLIC3R_TRACE_ZONE("GCodeProcessor::finalize");
     // update width/height of wipe moves
     for (GCodeProcessorResult::MoveVertex& move : m_result.moves) {
         if (move.type == EMoveType::Wipe) {
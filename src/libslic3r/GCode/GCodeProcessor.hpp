@@ -306,6 +306,8 @@ class Print;
         int64_t time{ 0 };
 #endif // ENABLE_GCODE_VIEWER_STATISTICS
         void reset();
+        // Estimate of the memory held by the moves and the line ends, which make up most of the result.
+        size_t memsize() const;
 
         //BBS: add mutex for protection of gcode result
         mutable std::mutex result_mutex;
@@ -66,28 +66,27 @@ void PchipInterpolatorHelper::computePCHIP() {
     d_[0] = delta_[0];
     d_[n] = delta_[n-1];
     for (size_t i = 1; i < n; ++i) {
-        if (delta_[i-1] * delta_[i] > 0) {
-            double w1 = 2 * h_[i] + h_[i-1];
-            double w2 = h_[i] + 2 * h_[i-1];
-            d_[i] = (w1 + w2) / (w1 / delta_[i-1] + w2 / delta_[i]);
-        } else {
-            d_[i] = 0;
-        }
+        d_[i] = interiorDerivative(h_[i-1], h_[i], delta_[i-1], delta_[i]);
     }
 }
 
 /**
- * @brief Interpolates the value at a given point.
+ * @brief Computes the PCHIP derivative at an interior data point from its two adjacent segments.
  */
-double PchipInterpolatorHelper::interpolate(double xi) const {
-    if (xi <= x_.front()) return y_.front();
-    if (xi >= x_.back()) return y_.back();
-
-    auto it = std::lower_bound(x_.begin(), x_.end(), xi);
-    size_t i = std::distance(x_.begin(), it) - 1;
+double PchipInterpolatorHelper::interiorDerivative(double h_prev, double h_next, double delta_prev, double delta_next) {
+    if (delta_prev * delta_next > 0) {
+        double w1 = 2 * h_next + h_prev;
+        double w2 = h_next + 2 * h_prev;
+        return (w1 + w2) / (w1 / delta_prev + w2 / delta_next);
+    }
+    return 0;
+}
 
-    double h_i = h_[i];
-    double t = (xi - x_[i]) / h_i;
+/**
+ * @brief Evaluates the cubic Hermite polynomial of a segment.
+ */
+double PchipInterpolatorHelper::hermite(double xi, double x0, double h, double y0, double y1, double d0, double d1) {
+    double t = (xi - x0) / h;
     double t2 = t * t;
     double t3 = t2 * t;
 
@@ -96,5 +95,18 @@ double PchipInterpolatorHelper::interpolate(double xi) const {
     double h01 = -2 * t3 + 3 * t2;
     double h11 = t3 - t2;
 
-    return h00 * y_[i] + h10 * h_i * d_[i] + h01 * y_[i+1] + h11 * h_i * d_[i+1];
+    return h00 * y0 + h10 * h * d0 + h01 * y1 + h11 * h * d1;
+}
+
+/**
+ * @brief Interpolates the value at a given point.
+ */
+double PchipInterpolatorHelper::interpolate(double xi) const {
+    if (xi <= x_.front()) return y_.front();
+    if (xi >= x_.back()) return y_.back();
+
+    auto it = std::lower_bound(x_.begin(), x_.end(), xi);
+    size_t i = std::distance(x_.begin(), it) - 1;
+
+    return hermite(xi, x_[i], h_[i], y_[i], y_[i+1], d_[i], d_[i+1]);
 }
@@ -41,6 +41,29 @@ public:
      */
     double interpolate(double xi) const;
 
+    /**
+     * @brief Computes the PCHIP derivative at an interior data point from its two adjacent segments.
+     * @param h_prev The length of the segment before the data point.
+     * @param h_next The length of the segment after the data point.
+     * @param delta_prev The slope of the segment before the data point.
+     * @param delta_next The slope of the segment after the data point.
+     * @return The derivative at the data point, zero at a local extreme.
+     */
+    static double interiorDerivative(double h_prev, double h_next, double delta_prev, double delta_next);
+
+    /**
+     * @brief Evaluates the cubic Hermite polynomial of a segment.
+     * @param xi The x-coordinate at which to interpolate, inside the segment.
+     * @param x0 The x-coordinate of the start of the segment.
+     * @param h The length of the segment.
+     * @param y0 The y-coordinate at the start of the segment.
+     * @param y1 The y-coordinate at the end of the segment.
+     * @param d0 The derivative at the start of the segment.
+     * @param d1 The derivative at the end of the segment.
+     * @return The interpolated y-coordinate.
+     */
+    static double hermite(double xi, double x0, double h, double y0, double y1, double d0, double d1);
+
 private:
     std::vector<double> x_; ///< The x-coordinates of the data points.
     std::vector<double> y_; ///< The y-coordinates of the data points.
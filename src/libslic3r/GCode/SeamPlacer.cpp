@@ -1209,10 +1209,22 @@ void SeamPlacer::calculate_overhangs_and_layer_embedding(const PrintObject *po)
                             to_unscaled_linesf(po->layers()[layer_idx]->lslices));
 
                         auto& layer_seams = layers[layer_idx];
-                        for (SeamCandidate &perimeter_point : layer_seams.points) {
-                          Vec2f point = Vec2f { perimeter_point.position.head<2>() };
+                        // The candidates follow the perimeters, thus they are queried in a batch, each one starting at the line closest to the previous one.
+                        std::vector<Vec2d> points;
+                        points.reserve(layer_seams.points.size());
+                        for (const SeamCandidate &perimeter_point : layer_seams.points)
+                          points.emplace_back(perimeter_point.position.head<2>().cast<double>());
+                        std::vector<double> prev_layer_distances;
+                        if (prev_layer_distancer.get() != nullptr)
+                          prev_layer_distances = prev_layer_distancer->distances_from_lines<true>(points);
+                        std::vector<double> current_layer_distances;
+                        if (should_compute_layer_embedding)
+                          current_layer_distances = current_layer_distancer->distances_from_lines<true>(points);
+
+                        for (size_t point_idx = 0; point_idx < layer_seams.points.size(); ++point_idx) {
+                          SeamCandidate &perimeter_point = layer_seams.points[point_idx];
                           if (prev_layer_distancer.get() != nullptr) {
-                            const auto _dist = prev_layer_distancer->distance_from_lines<true>(point.cast<double>());
+                            const auto _dist = prev_layer_distances[point_idx];
                             perimeter_point.overhang = _dist
                                                        + 0.65f * perimeter_point.perimeter.flow_width
                                                        - tan(SeamPlacer::overhang_angle_threshold)
@@ -1223,7 +1235,7 @@ void SeamPlacer::calculate_overhangs_and_layer_embedding(const PrintObject *po)
                           }
 
                           if (should_compute_layer_embedding) { // search for embedded perimeter points (points hidden inside the print ,e.g. multimaterial join, best position for seam)
-                            perimeter_point.embedded_distance = current_layer_distancer->distance_from_lines<true>(point.cast<double>())
+                            perimeter_point.embedded_distance = current_layer_distances[point_idx]
                                                                 + 0.65f * perimeter_point.perimeter.flow_width;
                           }
                         }
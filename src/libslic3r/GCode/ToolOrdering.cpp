@@ -17,6 +17,13 @@
 #include <cassert>
 #include <limits>
 #include <algorithm>
+#include <optional>
+#include <unordered_map>
+
+#include <boost/functional/hash.hpp>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
 
 #include <libslic3r.h>
 
@@ -25,38 +32,79 @@ namespace Slic3r {
 const static bool g_wipe_into_objects = false;
 
 
-// Shortest hamilton path problem
-static std::vector<unsigned int> solve_extruder_order(const std::vector<std::vector<float>>& wipe_volumes, std::vector<unsigned int> all_extruders, std::optional<unsigned int> start_extruder_id) 
+// Up to this number of extruders (including a start extruder not printing the layer), the order is found by an exact
+// dynamic programming over the subsets of the extruders, taking O(n^2 * 2^n) time and O(n * 2^n) memory.
+static constexpr size_t MAX_EXACT_ORDER_EXTRUDERS = 16;
+
+// Short Hamiltonian paths through the extruders of a layer from the start extruder, one for each possible last extruder.
+struct ExtruderPaths
 {
-    bool add_start_extruder_flag = false;
+    struct Path
+    {
+        // Sum of the flush volumes, including the flush from a start extruder not printing the layer.
+        float                     cost;
+        std::vector<unsigned int> order;
+    };
+    std::vector<Path> paths;
 
-    if (start_extruder_id) {
-        auto start_iter = std::find(all_extruders.begin(), all_extruders.end(), start_extruder_id);
-        if (start_iter == all_extruders.end())
-            all_extruders.insert(all_extruders.begin(), *start_extruder_id), add_start_extruder_flag = true;
-        else
-            std::swap(*all_extruders.begin(), *start_iter);
+    // The first one of the paths of the minimum cost.
+    const Path& best() const
+    {
+        assert(! paths.empty());
+        const Path *out = &paths.front();
+        for (const Path &path : paths)
+            if (out->cost > path.cost)
+                out = &path;
+        return *out;
     }
-    else {
-        start_extruder_id = all_extruders.front();
+};
+
+// Extruders printing a layer as a bit mask and the extruder active before the layer (-1 if none).
+// 64 bits hold all the MAXIMUM_EXTRUDER_NUMBER extruders.
+struct ExtruderOrderKey
+{
+    uint64_t extruders;
+    int      start;
+
+    bool operator==(const ExtruderOrderKey &rhs) const { return extruders == rhs.extruders && start == rhs.start; }
+};
+
+struct ExtruderOrderKeyHash
+{
+    size_t operator()(const ExtruderOrderKey &key) const noexcept
+    {
+        size_t seed = std::hash<uint64_t>()(key.extruders);
+        boost::hash_combine(seed, key.start);
+        return seed;
     }
+};
+
+// The layers of a print mostly share a few sets of extruders, thus the paths are solved once per set and start extruder.
+using ExtruderOrderCache = std::unordered_map<ExtruderOrderKey, ExtruderPaths, ExtruderOrderKeyHash>;
 
-    unsigned int iterations = (1 << all_extruders.size());
-    unsigned int final_state = iterations - 1;
-    std::vector<std::vector<float>>cache(iterations, std::vector<float>(all_extruders.size(),0x7fffffff));
-    std::vector<std::vector<int>>prev(iterations, std::vector<int>(all_extruders.size(), -1));
-    cache[1][0] = 0.;
-    for (unsigned int state = 0; state < iterations; ++state) {
-        if (state & 1) {
-            for (unsigned int target = 0; target < all_extruders.size(); ++target) {
-                if (state >> target & 1) {
-                    for (unsigned int mid_point = 0; mid_point < all_extruders.size(); ++mid_point) {
-                        if(state>>mid_point&1){
-                            auto tmp = cache[state - (1 << target)][mid_point] + wipe_volumes[all_extruders[mid_point]][all_extruders[target]];
-                            if (cache[state][target] >tmp) {
-                                cache[state][target] = tmp;
-                                prev[state][target] = mid_point;
-                            }
+// Shortest Hamiltonian paths through all_extruders[1..] starting with all_extruders[0] by dynamic programming over the subsets.
+static void solve_extruder_paths_exact(const std::vector<std::vector<float>> &wipe_volumes, const std::vector<unsigned int> &all_extruders, bool add_start_extruder_flag, ExtruderPaths &out)
+{
+    const size_t       n           = all_extruders.size();
+    const unsigned int iterations  = (1 << n);
+    const unsigned int final_state = iterations - 1;
+    // cache[state * n + target]: minimum flush volume of printing the extruders of state, starting with extruder 0 and ending with target.
+    // Only the states containing extruder 0 are reachable and only a target from the state is updated.
+    std::vector<float>  cache(size_t(iterations) * n, float(0x7fffffff));
+    std::vector<int8_t> prev(size_t(iterations) * n, -1);
+    cache[1 * n + 0] = 0.;
+    for (unsigned int state = 1; state < iterations; state += 2) {
+        for (unsigned int target = 1; target < n; ++ target) {
+            if (state >> target & 1) {
+                const unsigned int prev_state = state - (1 << target);
+                const float       *prev_cost  = cache.data() + size_t(prev_state) * n;
+                float             &cost       = cache[size_t(state) * n + target];
+                for (unsigned int mid_point = 0; mid_point < n; ++ mid_point) {
+                    if (prev_state >> mid_point & 1) {
+                        auto tmp = prev_cost[mid_point] + wipe_volumes[all_extruders[mid_point]][all_extruders[target]];
+                        if (cost > tmp) {
+                            cost = tmp;
+                            prev[size_t(state) * n + target] = int8_t(mid_point);
                         }
                     }
                 }
@@ -64,70 +112,278 @@ static std::vector<unsigned int> solve_extruder_order(const std::vector<std::vec
         }
     }
 
-    //get res
-    float cost = std::numeric_limits<float>::max();
-    int final_dst =0;
-    for (unsigned int dst = 0; dst < all_extruders.size(); ++dst) {
-        if (all_extruders[dst] != start_extruder_id && cost > cache[final_state][dst]) {
-            cost = cache[final_state][dst];
-            final_dst = dst;
+    auto path_to = [&](int final_dst) {
+        std::vector<unsigned int> path;
+        path.reserve(n);
+        unsigned int curr_state = final_state;
+        int          curr_point = final_dst;
+        while (curr_point != -1) {
+            path.emplace_back(all_extruders[curr_point]);
+            auto mid_point = prev[size_t(curr_state) * n + curr_point];
+            curr_state -= (1 << curr_point);
+            curr_point = mid_point;
         }
+        if (add_start_extruder_flag)
+            path.pop_back();
+        std::reverse(path.begin(), path.end());
+        return path;
+    };
+
+    out.paths.reserve(n);
+    for (unsigned int dst = 1; dst < n; ++ dst)
+        out.paths.push_back({ cache[size_t(final_state) * n + dst], path_to(dst) });
+}
+
+// Short Hamiltonian paths through all_extruders[1..] starting with all_extruders[0], for too many extruders to be solved exactly.
+// For each last extruder, a nearest neighbor path is shortened by moving segments of up to three extruders (Or-opt) until no move helps.
+// A segment keeps its direction when moved, as the flush volumes are not symmetric.
+static void solve_extruder_paths_heuristic(const std::vector<std::vector<float>> &wipe_volumes, const std::vector<unsigned int> &all_extruders, bool add_start_extruder_flag, ExtruderPaths &out)
+{
+    const size_t n      = all_extruders.size();
+    auto         volume = [&wipe_volumes, &all_extruders](size_t from, size_t to) { return wipe_volumes[all_extruders[from]][all_extruders[to]]; };
+
+    std::vector<size_t> path;
+    std::vector<bool>   visited;
+    path.reserve(n);
+    out.paths.reserve(n);
+    for (size_t dst = 1; dst < n; ++ dst) {
+        path.assign(1, 0);
+        visited.assign(n, false);
+        visited[0] = visited[dst] = true;
+        for (size_t i = 2; i < n; ++ i) {
+            size_t next = size_t(-1);
+            for (size_t j = 1; j < n; ++ j)
+                if (! visited[j] && (next == size_t(-1) || volume(path.back(), j) < volume(path.back(), next)))
+                    next = j;
+            visited[next] = true;
+            path.emplace_back(next);
+        }
+        path.emplace_back(dst);
+
+        // Move the segment path[i, i + len) between path[j] and path[j + 1]. The first and the last extruder stay in place.
+        for (bool improved = true; improved;) {
+            improved = false;
+            for (size_t len = 1; len <= 3; ++ len)
+                for (size_t i = 1; i + len < path.size(); ++ i) {
+                    const size_t first  = path[i];
+                    const size_t last   = path[i + len - 1];
+                    const float  remove = volume(path[i - 1], path[i + len]) - volume(path[i - 1], first) - volume(last, path[i + len]);
+                    for (size_t j = 0; j + 1 < path.size(); ++ j) {
+                        if (j + 1 >= i && j < i + len)
+                            // Edges touching the segment.
+                            continue;
+                        if (remove + volume(path[j], first) + volume(last, path[j + 1]) - volume(path[j], path[j + 1]) < - float(EPSILON)) {
+                            if (j < i)
+                                std::rotate(path.begin() + j + 1, path.begin() + i, path.begin() + i + len);
+                            else
+                                std::rotate(path.begin() + i, path.begin() + i + len, path.begin() + j + 1);
+                            improved = true;
+                            break;
+                        }
+                    }
+                }
+        }
+
+        ExtruderPaths::Path out_path { 0.f, {} };
+        out_path.order.reserve(n);
+        for (size_t i = 0; i < path.size(); ++ i) {
+            if (i > 0)
+                out_path.cost += volume(path[i - 1], path[i]);
+            if (i > 0 || ! add_start_extruder_flag)
+                out_path.order.emplace_back(all_extruders[path[i]]);
+        }
+        out.paths.emplace_back(std::move(out_path));
     }
+}
 
-    std::vector<unsigned int>path;
-    unsigned int curr_state = final_state;
-    int curr_point = final_dst;
-    while (curr_point != -1) {
-        path.emplace_back(all_extruders[curr_point]);
-        auto mid_point = prev[curr_state][curr_point];
-        curr_state -= (1 << curr_point);
-        curr_point = mid_point;
-    };
+// Short Hamiltonian paths through all_extruders starting with start_extruder_id, or with the first extruder if there is no start extruder.
+// A start extruder not printing the layer is not part of the paths.
+static ExtruderPaths solve_extruder_paths(const std::vector<std::vector<float>> &wipe_volumes, std::vector<unsigned int> all_extruders, std::optional<unsigned int> start_extruder_id)
+{
+    bool add_start_extruder_flag = false;
+
+    if (start_extruder_id) {
+        auto start_iter = std::find(all_extruders.begin(), all_extruders.end(), start_extruder_id);
+        if (start_iter == all_extruders.end())
+            all_extruders.insert(all_extruders.begin(), *start_extruder_id), add_start_extruder_flag = true;
+        else
+            std::swap(*all_extruders.begin(), *start_iter);
+    }
 
-    if (add_start_extruder_flag)
-        path.pop_back();
+    ExtruderPaths out;
+    if (all_extruders.size() == 1)
+        out.paths.push_back({ 0.f, all_extruders });
+    else if (all_extruders.size() <= MAX_EXACT_ORDER_EXTRUDERS)
+        solve_extruder_paths_exact(wipe_volumes, all_extruders, add_start_extruder_flag, out);
+    else
+        solve_extruder_paths_heuristic(wipe_volumes, all_extruders, add_start_extruder_flag, out);
+    return out;
+}
+
+static ExtruderOrderKey extruder_order_key(const std::vector<unsigned int> &extruders, std::optional<unsigned int> start_extruder_id)
+{
+    ExtruderOrderKey key { 0, start_extruder_id ? int(*start_extruder_id) : -1 };
+    for (unsigned int extruder : extruders) {
+        assert(extruder < MAXIMUM_EXTRUDER_NUMBER);
+        key.extruders |= uint64_t(1) << extruder;
+    }
+    return key;
+}
 
-    std::reverse(path.begin(), path.end());
-    return path;
+static const ExtruderPaths& solve_extruder_paths(ExtruderOrderCache &cache, const std::vector<std::vector<float>> &wipe_volumes, const std::vector<unsigned int> &extruders, std::optional<unsigned int> start_extruder_id)
+{
+    const ExtruderOrderKey key = extruder_order_key(extruders, start_extruder_id);
+    auto                   it  = cache.find(key);
+    if (it == cache.end())
+        it = cache.emplace(key, solve_extruder_paths(wipe_volumes, extruders, start_extruder_id)).first;
+    return it->second;
 }
 
-std::vector<unsigned int> get_extruders_order(const std::vector<std::vector<float>> &wipe_volumes, std::vector<unsigned int> all_extruders, std::optional<unsigned int>start_extruder_id)
+// Paths of a layer for each of the start extruders. The paths missing in the cache are solved in parallel.
+static std::vector<const ExtruderPaths*> solve_extruder_paths(ExtruderOrderCache &cache, const std::vector<std::vector<float>> &wipe_volumes, const std::vector<unsigned int> &extruders, const std::vector<unsigned int> &start_extruder_ids)
 {
-#define USE_DP_OPTIMIZE
-#ifdef USE_DP_OPTIMIZE
-    return solve_extruder_order(wipe_volumes, all_extruders, start_extruder_id);
-#else
-if (all_extruders.size() > 1) {
-        int begin_index = 0;
-        auto iter = std::find(all_extruders.begin(), all_extruders.end(), start_extruder_id);
-        if (iter != all_extruders.end()) {
-            for (int i = 0; i < all_extruders.size(); ++i) {
-                if (all_extruders[i] == start_extruder_id) {
-                    std::swap(all_extruders[i], all_extruders[0]);
-                }
-            }
-            begin_index = 1;
+    std::vector<unsigned int> missing;
+    for (unsigned int start_extruder_id : start_extruder_ids)
+        if (cache.find(extruder_order_key(extruders, start_extruder_id)) == cache.end() && std::find(missing.begin(), missing.end(), start_extruder_id) == missing.end())
+            missing.emplace_back(start_extruder_id);
+    std::vector<ExtruderPaths> solved(missing.size());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, missing.size(), 1), [&](const tbb::blocked_range<size_t> &range) {
+        for (size_t i = range.begin(); i < range.end(); ++ i)
+            solved[i] = solve_extruder_paths(wipe_volumes, extruders, missing[i]);
+    });
+    for (size_t i = 0; i < missing.size(); ++ i)
+        cache.emplace(extruder_order_key(extruders, missing[i]), std::move(solved[i]));
+
+    std::vector<const ExtruderPaths*> out;
+    out.reserve(start_extruder_ids.size());
+    for (unsigned int start_extruder_id : start_extruder_ids)
+        out.emplace_back(&cache.at(extruder_order_key(extruders, start_extruder_id)));
+    return out;
+}
+
+std::vector<unsigned int> get_extruders_order(const std::vector<std::vector<float>> &wipe_volumes, std::vector<unsigned int> all_extruders, std::optional<unsigned int> start_extruder_id)
+{
+    return solve_extruder_paths(wipe_volumes, std::move(all_extruders), start_extruder_id).best().order;
+}
+
+float get_flush_volume(const std::vector<std::vector<float>> &wipe_volumes, const std::vector<std::vector<unsigned int>> &layers_extruders, std::optional<unsigned int> start_extruder_id)
+{
+    float                       volume  = 0.f;
+    std::optional<unsigned int> current = start_extruder_id;
+    for (const std::vector<unsigned int> &extruders : layers_extruders)
+        for (unsigned int extruder : extruders) {
+            if (current && *current != extruder)
+                volume += wipe_volumes[*current][extruder];
+            current = extruder;
         }
+    return volume;
+}
 
-        std::pair<float, std::vector<unsigned int>> volumes_to_extruder_order;
-        volumes_to_extruder_order.first = 10000 * all_extruders.size();
-        std::sort(all_extruders.begin() + begin_index, all_extruders.end());
-        do {
-            float flush_volume = 0;
-            for (int i = 0; i < all_extruders.size() - 1; ++i) {
-                flush_volume += wipe_volumes[all_extruders[i]][all_extruders[i + 1]];
-            }
-            if (flush_volume < volumes_to_extruder_order.first) {
-                volumes_to_extruder_order = std::pair(flush_volume, all_extruders);
-            }
-        } while (std::next_permutation(all_extruders.begin() + begin_index, all_extruders.end()));
+// Each layer ordered for the minimum flush volume after the last extruder of the layer below.
+static std::vector<std::vector<unsigned int>> order_layers_one_by_one(ExtruderOrderCache &cache, const std::vector<std::vector<float>> &wipe_volumes,
+    const std::vector<std::vector<unsigned int>> &layers_extruders, const std::vector<bool> &fixed_layers)
+{
+    std::vector<std::vector<unsigned int>> out = layers_extruders;
+    std::optional<unsigned int>            current_extruder_id;
+    for (size_t i = 0; i < out.size(); ++ i) {
+        if (out[i].empty())
+            continue;
+        if (! fixed_layers[i])
+            out[i] = solve_extruder_paths(cache, wipe_volumes, out[i], current_extruder_id).best().order;
+        current_extruder_id = out[i].back();
+    }
+    return out;
+}
+
+// All layers ordered for the minimum total flush volume. The flush volume of the layers above only depends on the last extruder
+// of a layer, thus the shortest sequence of the layer orders is found by dynamic programming over the last extruders (Viterbi).
+static std::vector<std::vector<unsigned int>> order_layers_across(ExtruderOrderCache &cache, const std::vector<std::vector<float>> &wipe_volumes,
+    const std::vector<std::vector<unsigned int>> &layers_extruders, const std::vector<bool> &fixed_layers)
+{
+    struct State
+    {
+        // Last extruder of the layer.
+        unsigned int                     extruder;
+        // Flush volume of the layers up to this one.
+        float                            cost;
+        // Index of the state of the layer below, -1 for the first layer printed.
+        int                              prev;
+        const std::vector<unsigned int> *order;
+    };
+    // States of the non-empty layers.
+    std::vector<std::vector<State>> layers_states;
+    std::vector<size_t>             layer_ids;
+    // Index of the state ending with an extruder in the layer being processed.
+    std::vector<int>                extruder_state(wipe_volumes.size(), -1);
+    for (size_t i = 0; i < layers_extruders.size(); ++ i) {
+        const std::vector<unsigned int> &extruders = layers_extruders[i];
+        if (extruders.empty())
+            continue;
+        const std::vector<State> *below = layers_states.empty() ? nullptr : &layers_states.back();
+        std::vector<State>        states;
+        auto add_state = [&states, &extruder_state](unsigned int extruder, float cost, int prev, const std::vector<unsigned int> *order) {
+            int &idx = extruder_state[extruder];
+            if (idx == -1) {
+                idx = int(states.size());
+                states.push_back({ extruder, cost, prev, order });
+            } else if (states[idx].cost > cost)
+                states[idx] = { extruder, cost, prev, order };
+        };
+        if (fixed_layers[i]) {
+            const float cost = get_flush_volume(wipe_volumes, { extruders });
+            if (below == nullptr)
+                add_state(extruders.back(), cost, -1, &extruders);
+            else
+                for (int k = 0; k < int(below->size()); ++ k) {
+                    const State &from = (*below)[k];
+                    add_state(extruders.back(), from.cost + cost + (from.extruder == extruders.front() ? 0.f : wipe_volumes[from.extruder][extruders.front()]), k, &extruders);
+                }
+        } else if (below == nullptr) {
+            for (const ExtruderPaths::Path &path : solve_extruder_paths(cache, wipe_volumes, extruders, std::nullopt).paths)
+                add_state(path.order.back(), path.cost, -1, &path.order);
+        } else {
+            std::vector<unsigned int> start_extruder_ids;
+            start_extruder_ids.reserve(below->size());
+            for (const State &from : *below)
+                start_extruder_ids.emplace_back(from.extruder);
+            std::vector<const ExtruderPaths*> paths = solve_extruder_paths(cache, wipe_volumes, extruders, start_extruder_ids);
+            for (int k = 0; k < int(below->size()); ++ k)
+                for (const ExtruderPaths::Path &path : paths[k]->paths)
+                    add_state(path.order.back(), (*below)[k].cost + path.cost, k, &path.order);
+        }
+        for (const State &state : states)
+            extruder_state[state.extruder] = -1;
+        layers_states.emplace_back(std::move(states));
+        layer_ids.emplace_back(i);
+    }
 
-        if (volumes_to_extruder_order.second.size() > 0)
-            return volumes_to_extruder_order.second;
+    std::vector<std::vector<unsigned int>> out = layers_extruders;
+    if (layers_states.empty())
+        return out;
+    int idx = 0;
+    for (int k = 1; k < int(layers_states.back().size()); ++ k)
+        if (layers_states.back()[idx].cost > layers_states.back()[k].cost)
+            idx = k;
+    for (size_t l = layers_states.size(); l > 0 && idx != -1; -- l) {
+        const State &state = layers_states[l - 1][idx];
+        out[layer_ids[l - 1]] = *state.order;
+        idx = state.prev;
     }
-    return all_extruders;
+    return out;
+}
 
-#endif // OPTIMIZE
+std::vector<std::vector<unsigned int>> get_layers_extruders_order(const std::vector<std::vector<float>> &wipe_volumes,
+    const std::vector<std::vector<unsigned int>> &layers_extruders, const std::vector<bool> &fixed_layers, bool across_layers)
+{
+    assert(fixed_layers.size() == layers_extruders.size());
+    ExtruderOrderCache                     cache;
+    std::vector<std::vector<unsigned int>> one_by_one = order_layers_one_by_one(cache, wipe_volumes, layers_extruders, fixed_layers);
+    if (! across_layers)
+        return one_by_one;
+    // The layers ordered one by one are a valid solution of the ordering across layers, thus the ordering across layers is never worse
+    // if the paths of the layers are exact. Above MAX_EXACT_ORDER_EXTRUDERS they are not, thus keep the better one.
+    std::vector<std::vector<unsigned int>> across = order_layers_across(cache, wipe_volumes, layers_extruders, fixed_layers);
+    return get_flush_volume(wipe_volumes, across) < get_flush_volume(wipe_volumes, one_by_one) - float(EPSILON) ? across : one_by_one;
 }
 
 // Returns true in case that extruder a comes before b (b does not have to be present). False otherwise.
@@ -852,17 +1108,6 @@ void ToolOrdering::reorder_extruders_for_minimum_flush_volume()
             wipe_volumes.push_back(std::vector<float>(number_of_extruders, print_config->prime_volume));
     }
 
-    auto extruders_to_hash_key = [](const std::vector<unsigned int>& extruders,
-                                    std::optional<unsigned int>      initial_extruder_id) -> uint32_t {
-        uint32_t hash_key = 0;
-        // high 16 bit define initial extruder ,low 16 bit define extruder set
-        if (initial_extruder_id)
-            hash_key |= (1 << (16 + *initial_extruder_id));
-        for (auto item : extruders)
-            hash_key |= (1 << item);
-        return hash_key;
-    };
-
     std::vector<LayerPrintSequence> other_layers_seqs;
     const ConfigOptionInts *other_layers_print_sequence_op = print_config->option<ConfigOptionInts>("other_layers_print_sequence");
     const ConfigOptionInt *other_layers_print_sequence_nums_op = print_config->option<ConfigOptionInt>("other_layers_print_sequence_nums");
@@ -884,9 +1129,12 @@ void ToolOrdering::reorder_extruders_for_minimum_flush_volume()
         return false;
     };
 
-    std::optional<unsigned int>current_extruder_id;
+    // The first layer and the layers with a custom sequence keep their order.
+    std::vector<std::vector<unsigned int>> layers_extruders(m_layer_tools.size());
+    std::vector<bool>                      fixed_layers(m_layer_tools.size(), false);
     for (int i = 0; i < m_layer_tools.size(); ++i) {
         LayerTools& lt = m_layer_tools[i];
+        fixed_layers[i] = i == 0;
         if (lt.extruders.empty())
             continue;
 
@@ -902,32 +1150,15 @@ void ToolOrdering::reorder_extruders_for_minimum_flush_volume()
             }
             assert(lt.extruders.size() == unsign_custom_extruder_seq.size());
             lt.extruders = unsign_custom_extruder_seq;
-            current_extruder_id = lt.extruders.back();
-            continue;
+            fixed_layers[i] = true;
         }
-
-        // The algorithm complexity is O(n2*2^n)
-        if (i != 0) {
-            auto hash_key = extruders_to_hash_key(lt.extruders, current_extruder_id);
-            auto iter = m_tool_order_cache.find(hash_key);
-            if (iter == m_tool_order_cache.end()) {
-                lt.extruders = get_extruders_order(wipe_volumes, lt.extruders, current_extruder_id);
-                std::vector<uint8_t> hash_val;
-                hash_val.reserve(lt.extruders.size());
-                for (auto item : lt.extruders)
-                    hash_val.emplace_back(static_cast<uint8_t>(item));
-                m_tool_order_cache[hash_key] = hash_val;
-            }
-            else {
-                std::vector<unsigned int>extruder_order;
-                extruder_order.reserve(iter->second.size());
-                for (auto item : iter->second)
-                    extruder_order.emplace_back(static_cast<unsigned int>(item));
-                lt.extruders = std::move(extruder_order);
-            }
-        }
-        current_extruder_id = lt.extruders.back();
+        layers_extruders[i] = lt.extruders;
     }
+
+    // Minimize the flush volume of the whole print, not worse than ordering the layers one by one.
+    layers_extruders = get_layers_extruders_order(wipe_volumes, layers_extruders, fixed_layers);
+    for (size_t i = 0; i < m_layer_tools.size(); ++i)
+        m_layer_tools[i].extruders = std::move(layers_extruders[i]);
 }
 
 // Layers are marked for infinite skirt aka draft shield. Not all the layers have to be printed.
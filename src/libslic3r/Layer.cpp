@@ -302,25 +302,9 @@ void Layer::export_region_fill_surfaces_to_svg(const char *path) const
 }
 
 //BBS: method to simplify support path
-void Layer::simplify_support_entity_collection(ExtrusionEntityCollection* entity_collection)
+void Layer::simplify_support_path(ExtrusionPath * path) const
 {
-    for (size_t i = 0; i < entity_collection->entities.size(); i++) {
-        if (ExtrusionEntityCollection* collection = dynamic_cast<ExtrusionEntityCollection*>(entity_collection->entities[i]))
-            this->simplify_support_entity_collection(collection);
-        else if (ExtrusionPath* path = dynamic_cast<ExtrusionPath*>(entity_collection->entities[i]))
-            this->simplify_support_path(path);
-        else if (ExtrusionMultiPath* multipath = dynamic_cast<ExtrusionMultiPath*>(entity_collection->entities[i]))
-            this->simplify_support_multi_path(multipath);
-        else if (ExtrusionLoop* loop = dynamic_cast<ExtrusionLoop*>(entity_collection->entities[i]))
-            this->simplify_support_loop(loop);
-        else
-            throw Slic3r::InvalidArgument("Invalid extrusion entity supplied to simplify_support_entity_collection()");
-    }
-}
-//BBS: method to simplify support path
-void Layer::simplify_support_path(ExtrusionPath * path)
-{
-    const auto print_config = this->object()->print()->config();
+    const auto &print_config = this->object()->print()->config();
     const bool spiral_mode = print_config.spiral_mode;
     const bool enable_arc_fitting = print_config.enable_arc_fitting;
     const auto scaled_resolution = scaled<double>(print_config.resolution.value);
@@ -332,40 +316,6 @@ void Layer::simplify_support_path(ExtrusionPath * path)
         path->simplify(scaled_resolution);
     }
 }
-//BBS: method to simplify support path
-void Layer::simplify_support_multi_path(ExtrusionMultiPath* multipath)
-{
-    const auto print_config = this->object()->print()->config();
-    const bool spiral_mode = print_config.spiral_mode;
-    const bool enable_arc_fitting = print_config.enable_arc_fitting;
-    const auto scaled_resolution = scaled<double>(print_config.resolution.value);
-
-    for (size_t i = 0; i < multipath->paths.size(); ++i) {
-        if (enable_arc_fitting &&
-            !spiral_mode) {
-            multipath->paths[i].simplify_by_fitting_arc(SCALED_SUPPORT_RESOLUTION);
-        } else {
-            multipath->paths[i].simplify(scaled_resolution);
-        }
-    }
-}
-//BBS: method to simplify support path
-void Layer::simplify_support_loop(ExtrusionLoop* loop)
-{
-    const auto print_config = this->object()->print()->config();
-    const bool spiral_mode = print_config.spiral_mode;
-    const bool enable_arc_fitting = print_config.enable_arc_fitting;
-    const auto scaled_resolution = scaled<double>(print_config.resolution.value);
-
-    for (size_t i = 0; i < loop->paths.size(); ++i) {
-        if (enable_arc_fitting &&
-            !spiral_mode) {
-            loop->paths[i].simplify_by_fitting_arc(SCALED_SUPPORT_RESOLUTION);
-        } else {
-            loop->paths[i].simplify(scaled_resolution);
-        }
-    }
-}
 
 // Export to "out/LayerRegion-name-%d.svg" with an increasing index with every export.
 void Layer::export_region_fill_surfaces_to_svg_debug(const char *name) const
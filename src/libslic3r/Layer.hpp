@@ -26,6 +26,8 @@ namespace FillLightning {
     class Generator;
 };
 
+class GyroidWaveCache;
+
 class LayerRegion
 {
 public:
@@ -95,14 +97,9 @@ public:
 
     // Is there any valid extrusion assigned to this LayerRegion?
     bool    has_extrusions() const { return ! this->perimeters.entities.empty() || ! this->fills.entities.empty(); }
-    //BBS
-    void    simplify_infill_extrusion_entity() { simplify_entity_collection(&fills); }
-    void    simplify_wall_extrusion_entity() { simplify_entity_collection(&perimeters); }
 private:
-    void    simplify_entity_collection(ExtrusionEntityCollection* entity_collection);
-    void    simplify_path(ExtrusionPath* path);
-    void    simplify_multi_path(ExtrusionMultiPath* multipath);
-    void    simplify_loop(ExtrusionLoop* loop);
+    //BBS: simplify a single path of the perimeters or fills of this region
+    void    simplify_path(ExtrusionPath* path) const;
 
 protected:
     friend class Layer;
@@ -186,10 +183,12 @@ public:
     void                    make_perimeters();
     // Phony version of make_fills() without parameters for Perl integration only.
     void                    make_fills() { this->make_fills(nullptr, nullptr); }
-    void                    make_fills(FillAdaptive::Octree* adaptive_fill_octree, FillAdaptive::Octree* support_fill_octree, FillLightning::Generator* lightning_generator = nullptr);
+    void                    make_fills(FillAdaptive::Octree* adaptive_fill_octree, FillAdaptive::Octree* support_fill_octree, FillLightning::Generator* lightning_generator = nullptr,
+                                       GyroidWaveCache* gyroid_wave_cache = nullptr);
     Polylines               generate_sparse_infill_polylines_for_anchoring(FillAdaptive::Octree *adaptive_fill_octree,
                                                                            FillAdaptive::Octree *support_fill_octree,
-                                                                           FillLightning::Generator* lightning_generator) const;
+                                                                           FillLightning::Generator* lightning_generator,
+                                                                           GyroidWaveCache* gyroid_wave_cache = nullptr) const;
     void 					make_ironing();
 
     void                    export_region_slices_to_svg(const char *path) const;
@@ -201,9 +200,6 @@ public:
     // Is there any valid extrusion assigned to this LayerRegion?
     virtual bool            has_extrusions() const { for (auto layerm : m_regions) if (layerm->has_extrusions()) return true; return false; }
 
-    //BBS
-    void simplify_wall_extrusion_path() { for (auto layerm : m_regions) layerm->simplify_wall_extrusion_entity();}
-    void simplify_infill_extrusion_path() { for (auto layerm : m_regions) layerm->simplify_infill_extrusion_entity(); }
     //BBS: this function calculate the maximum void grid area of sparse infill of this layer. Just estimated value
     coordf_t get_sparse_infill_max_void_area();
 
@@ -253,10 +249,7 @@ protected:
     virtual ~Layer();
 
 //BBS: method to simplify support path
-    void    simplify_support_entity_collection(ExtrusionEntityCollection* entity_collection);
-    void    simplify_support_path(ExtrusionPath* path);
-    void    simplify_support_multi_path(ExtrusionMultiPath* multipath);
-    void    simplify_support_loop(ExtrusionLoop* loop);
+    void    simplify_support_path(ExtrusionPath* path) const;
 
 private:
     // Sequential index of layer, 0-based, offsetted by number of raft layers.
@@ -290,8 +283,6 @@ public:
     // Zero based index of an interface layer, used for alternating direction of interface / contact layers.
     size_t                      interface_id() const { return m_interface_id; }
 
-    void simplify_support_extrusion_path() { this->simplify_support_entity_collection(&support_fills); }
-
 protected:
     friend class PrintObject;
     friend class TreeSupport;
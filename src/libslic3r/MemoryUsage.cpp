@@ -0,0 +1,103 @@
+#include "MemoryUsage.hpp"
+#include "ExPolygon.hpp"
+#include "ExtrusionEntity.hpp"
+#include "ExtrusionEntityCollection.hpp"
+#include "Polygon.hpp"
+#include "Polyline.hpp"
+#include "SurfaceCollection.hpp"
+#include "Utils.hpp"
+
+#include <boost/format.hpp>
+
+namespace Slic3r {
+
+size_t memsize(const Points &points)
+{
+    return points.capacity() * sizeof(Point);
+}
+
+size_t memsize(const Polygon &polygon)
+{
+    return memsize(polygon.points);
+}
+
+size_t memsize(const Polygons &polygons)
+{
+    size_t out = polygons.capacity() * sizeof(Polygon);
+    for (const Polygon &polygon : polygons)
+        out += memsize(polygon);
+    return out;
+}
+
+size_t memsize(const Polyline &polyline)
+{
+    return memsize(polyline.points) + polyline.fitting_result.capacity() * sizeof(PathFittingData);
+}
+
+size_t memsize(const Polylines &polylines)
+{
+    size_t out = polylines.capacity() * sizeof(Polyline);
+    for (const Polyline &polyline : polylines)
+        out += memsize(polyline);
+    return out;
+}
+
+size_t memsize(const ExPolygon &expolygon)
+{
+    return memsize(expolygon.contour) + memsize(expolygon.holes);
+}
+
+size_t memsize(const ExPolygons &expolygons)
+{
+    size_t out = expolygons.capacity() * sizeof(ExPolygon);
+    for (const ExPolygon &expolygon : expolygons)
+        out += memsize(expolygon);
+    return out;
+}
+
+size_t memsize(const SurfaceCollection &surfaces)
+{
+    size_t out = surfaces.surfaces.capacity() * sizeof(Surface);
+    for (const Surface &surface : surfaces.surfaces)
+        out += memsize(surface.expolygon);
+    return out;
+}
+
+static size_t memsize(const ExtrusionPaths &paths)
+{
+    size_t out = paths.capacity() * sizeof(ExtrusionPath);
+    for (const ExtrusionPath &path : paths)
+        out += memsize(path.polyline);
+    return out;
+}
+
+size_t memsize(const ExtrusionEntity &entity)
+{
+    if (entity.is_collection())
+        return sizeof(ExtrusionEntityCollection) + memsize(static_cast<const ExtrusionEntityCollection&>(entity));
+    if (auto *loop = dynamic_cast<const ExtrusionLoop*>(&entity))
+        return (dynamic_cast<const ExtrusionLoopSloped*>(loop) ? sizeof(ExtrusionLoopSloped) : sizeof(ExtrusionLoop)) + memsize(loop->paths);
+    if (auto *multipath = dynamic_cast<const ExtrusionMultiPath*>(&entity))
+        return sizeof(ExtrusionMultiPath) + memsize(multipath->paths);
+    if (auto *path = dynamic_cast<const ExtrusionPath*>(&entity))
+        return (dynamic_cast<const ExtrusionPathSloped*>(path) ? sizeof(ExtrusionPathSloped) : sizeof(ExtrusionPath)) + memsize(path->polyline);
+    assert(false);
+    return 0;
+}
+
+size_t memsize(const ExtrusionEntityCollection &collection)
+{
+    size_t out = collection.entities.capacity() * sizeof(ExtrusionEntity*);
+    for (const ExtrusionEntity *entity : collection.entities)
+        out += memsize(*entity);
+    return out;
+}
+
+std::string PrintObjectMemoryUsage::to_string() const
+{
+    return (boost::format("slices %1%, perimeters %2%, fill surfaces %3%, fills %4%, support layers %5%, support caches peak %6%, total %7%")
+        % format_memsize_MB(slices) % format_memsize_MB(perimeters) % format_memsize_MB(fill_surfaces) % format_memsize_MB(fills)
+        % format_memsize_MB(support_layers) % format_memsize_MB(support_caches) % format_memsize_MB(this->total())).str();
+}
+
+} // namespace Slic3r
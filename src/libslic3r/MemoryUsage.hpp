@@ -0,0 +1,57 @@
+#ifndef slic3r_MemoryUsage_hpp_
+#define slic3r_MemoryUsage_hpp_
+
+#include "libslic3r.h"
+#include "ExPolygon.hpp"
+#include "Point.hpp"
+#include "Polygon.hpp"
+#include "Polyline.hpp"
+
+#include <string>
+#include <vector>
+
+namespace Slic3r {
+
+class SurfaceCollection;
+class ExtrusionEntity;
+class ExtrusionEntityCollection;
+
+// Estimates of the heap memory held by the geometric containers, counting the reserved capacity of the vectors.
+// sizeof() of the container passed as a parameter is not included, as it is accounted for by its owner.
+size_t memsize(const Points &points);
+size_t memsize(const Polygon &polygon);
+size_t memsize(const Polygons &polygons);
+size_t memsize(const Polyline &polyline);
+size_t memsize(const Polylines &polylines);
+size_t memsize(const ExPolygon &expolygon);
+size_t memsize(const ExPolygons &expolygons);
+size_t memsize(const SurfaceCollection &surfaces);
+// Including sizeof() of the polymorphic entity, which is allocated on the heap.
+size_t memsize(const ExtrusionEntity &entity);
+size_t memsize(const ExtrusionEntityCollection &collection);
+
+// Bytes held by the layers of a PrintObject, grouped by the PrintObjectStep producing the data.
+struct PrintObjectMemoryUsage
+{
+    // posSlice: Layer::lslices and the LayerRegion slices including their untyped backup.
+    size_t slices           { 0 };
+    // posPerimeters: LayerRegion perimeters, gap fills and the regions left for infill.
+    size_t perimeters       { 0 };
+    // posPrepareInfill: LayerRegion::fill_surfaces.
+    size_t fill_surfaces    { 0 };
+    // posInfill: LayerRegion::fills.
+    size_t fills            { 0 };
+    // posSupportMaterial: support layers with their islands and extrusions.
+    size_t support_layers   { 0 };
+    // Peak size of the TreeModelVolumes caches while generating the organic tree supports.
+    // The caches are released once the supports are generated, therefore this value is not included in total().
+    size_t support_caches   { 0 };
+
+    size_t      total() const { return slices + perimeters + fill_surfaces + fills + support_layers; }
+    // Single line summary in MB, for logging.
+    std::string to_string() const;
+};
+
+} // namespace Slic3r
+
+#endif // slic3r_MemoryUsage_hpp_
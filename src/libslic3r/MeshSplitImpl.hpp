@@ -11,6 +11,10 @@
 #include "libnest2d/tools/benchmark.h"
 #include "Execution/ExecutionTBB.hpp"
 
+#include <atomic>
+
+#include <ankerl/unordered_dense.h>
+
 namespace Slic3r {
 
 template<class ExPolicy>
@@ -129,53 +133,135 @@ struct SplitOutputFn {
     SplitOutputFn& operator++() { return *this; };
 };
 
+// Label the connected patches of facets of a mesh in parallel by a concurrent union-find. Each facet is linked towards a lower
+// facet of its patch, thus the label of a facet is the lowest facet of its patch, which is where the serial NeighborVisitor
+// starts the patch. Returns the labels and the number of patches.
+template<class NeighborIndex>
+std::pair<std::vector<int>, size_t> label_patches(size_t num_faces, const NeighborIndex &neighbor_index)
+{
+    std::vector<std::atomic<int>> parent(num_faces);
+    execution::for_each(ex_tbb, size_t(0), num_faces, [&parent](size_t face_idx) {
+        parent[face_idx].store(int(face_idx), std::memory_order_relaxed);
+    }, 4096);
+
+    // Path halving: each visited facet is linked to its grandparent. Only the links of facets, which are not roots, are shortened,
+    // while the union below only links roots, thus a failed exchange just means another thread shortened the link already.
+    auto find = [&parent](int face_idx) {
+        for (int up = parent[face_idx].load(std::memory_order_relaxed); up != face_idx; up = parent[face_idx].load(std::memory_order_relaxed)) {
+            const int grandparent = parent[up].load(std::memory_order_relaxed);
+            if (grandparent != up)
+                parent[face_idx].compare_exchange_weak(up, grandparent, std::memory_order_relaxed);
+            face_idx = grandparent;
+        }
+        return face_idx;
+    };
+    execution::for_each(ex_tbb, size_t(0), num_faces, [&parent, &neighbor_index, &find](size_t face_idx) {
+        // Both directions of a link are followed, thus the patches are connected even by a neighbor index, which is not symmetric.
+        for (auto neighbor_idx : neighbor_index[face_idx]) {
+            if (neighbor_idx < 0)
+                continue;
+            for (int a = find(int(face_idx)), b = find(int(neighbor_idx)); a != b; a = find(a), b = find(b)) {
+                if (a < b)
+                    std::swap(a, b);
+                // Link the higher root below the lower one. Retry if another thread linked it in the meantime.
+                if (int expected = a; parent[a].compare_exchange_strong(expected, b))
+                    break;
+            }
+        }
+    }, 4096);
+
+    std::vector<int> labels(num_faces);
+    execution::for_each(ex_tbb, size_t(0), num_faces, [&labels, &find](size_t face_idx) {
+        labels[face_idx] = find(int(face_idx));
+    }, 4096);
+    size_t num_patches = 0;
+    for (size_t face_idx = 0; face_idx < num_faces; ++ face_idx)
+        if (labels[face_idx] == int(face_idx))
+            ++ num_patches;
+    return { std::move(labels), num_patches };
+}
+
 // Splits a mesh into multiple meshes when possible.
+// The patches are labeled and their meshes are built in parallel. The parts are ordered by their lowest facet and their facets
+// are ordered by the same depth first traversal as with the NeighborVisitor, thus the output does not depend on the scheduling.
+// The labels decide which facets form a part. If the neighbor index is not symmetric, the facets of the patch not reached
+// by the traversal follow in the order of their indices.
 template<class Its, class OutputIt>
 void its_split(const Its &m, OutputIt out_it)
 {
     using namespace meshsplit_detail;
 
-    const indexed_triangle_set &its = ItsWithNeighborsIndex_<Its>::get_its(m);
-
-    struct VertexConv {
-        size_t part_id      = std::numeric_limits<size_t>::max();
-        size_t vertex_image;
-    };
-    std::vector<VertexConv> vidx_conv(its.vertices.size());
-
-    meshsplit_detail::NeighborVisitor visitor(its, meshsplit_detail::ItsWithNeighborsIndex_<Its>::get_index(m));
-
-    std::vector<size_t> facets;
-    for (size_t part_id = 0;; ++part_id) {
-        // Collect all faces of the next patch.
-        facets.clear();
-        visitor.visit([&facets](size_t idx) { facets.emplace_back(idx); return true; });
-        if (facets.empty())
-            break;
+    const indexed_triangle_set &its            = ItsWithNeighborsIndex_<Its>::get_its(m);
+    const auto                 &neighbor_index = ItsWithNeighborsIndex_<Its>::get_index(m);
+
+    auto [labels, num_patches] = label_patches(its.indices.size(), neighbor_index);
+    std::vector<int> seeds;
+    seeds.reserve(num_patches);
+    // Number of facets of each patch, indexed by its label.
+    std::vector<int> patch_sizes(labels.size(), 0);
+    for (size_t face_idx = 0; face_idx < labels.size(); ++ face_idx) {
+        if (labels[face_idx] == int(face_idx))
+            seeds.emplace_back(int(face_idx));
+        ++ patch_sizes[labels[face_idx]];
+    }
 
-        // Create a new mesh for the part that was just split off.
-        indexed_triangle_set mesh;
-        mesh.indices.reserve(facets.size());
-        mesh.vertices.reserve(std::min(facets.size() * 3, its.vertices.size()));
-
-        // Assign the facets to the new mesh.
-        for (size_t face_id : facets) {
-            const auto &face = its.indices[face_id];
-            Vec3i32       new_face;
-            for (size_t v = 0; v < 3; ++v) {
-                auto vi = face(v);
-
-                if (vidx_conv[vi].part_id != part_id) {
-                    vidx_conv[vi] = {part_id, mesh.vertices.size()};
-                    mesh.vertices.emplace_back(its.vertices[size_t(vi)]);
+    std::vector<indexed_triangle_set> parts(seeds.size());
+    // Patches are disjoint, thus the traversals of the patches mark distinct facets as visited.
+    std::vector<char> visited(its.indices.size(), false);
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, seeds.size()), [&its, &neighbor_index, &labels = labels, &seeds, &patch_sizes, &parts, &visited](const tbb::blocked_range<size_t> &range) {
+        // Buffers reused by the parts of the range.
+        std::vector<size_t>                    facets;
+        std::vector<size_t>                    facestack;
+        ankerl::unordered_dense::map<int, int> vidx_conv;
+        for (size_t part_id = range.begin(); part_id < range.end(); ++ part_id) {
+            // Collect all faces of the patch.
+            facets.assign(1, size_t(seeds[part_id]));
+            facestack.assign(1, size_t(seeds[part_id]));
+            visited[seeds[part_id]] = true;
+            while (! facestack.empty()) {
+                size_t facet_idx = facestack.back();
+                facestack.pop_back();
+                for (auto neighbor_idx : neighbor_index[facet_idx]) {
+                    if (neighbor_idx >= 0 && ! visited[neighbor_idx]) {
+                        visited[neighbor_idx] = true;
+                        facets.emplace_back(neighbor_idx);
+                        facestack.emplace_back(neighbor_idx);
+                    }
                 }
-
-                new_face(v) = vidx_conv[vi].vertex_image;
             }
+            if (facets.size() < size_t(patch_sizes[seeds[part_id]]))
+                for (size_t face_idx = size_t(seeds[part_id]) + 1; face_idx < labels.size(); ++ face_idx)
+                    if (labels[face_idx] == seeds[part_id] && ! visited[face_idx]) {
+                        visited[face_idx] = true;
+                        facets.emplace_back(face_idx);
+                    }
 
-            mesh.indices.emplace_back(new_face);
+            // Create a new mesh for the part.
+            indexed_triangle_set &mesh = parts[part_id];
+            mesh.indices.reserve(facets.size());
+            mesh.vertices.reserve(std::min(facets.size() * 3, its.vertices.size()));
+            // Clearing the map costs its capacity, don't let a large part slow down the small parts following it.
+            if (vidx_conv.bucket_count() > 8 * facets.size() + 64)
+                vidx_conv = {};
+            else
+                vidx_conv.clear();
+
+            // Assign the facets to the new mesh.
+            for (size_t face_id : facets) {
+                const auto &face = its.indices[face_id];
+                Vec3i32     new_face;
+                for (size_t v = 0; v < 3; ++v) {
+                    auto [it, inserted] = vidx_conv.try_emplace(face(v), int(mesh.vertices.size()));
+                    if (inserted)
+                        mesh.vertices.emplace_back(its.vertices[size_t(face(v))]);
+                    new_face(v) = it->second;
+                }
+                mesh.indices.emplace_back(new_face);
+            }
         }
+    });
 
+    for (indexed_triangle_set &mesh : parts) {
         *out_it = std::move(mesh);
         ++out_it;
     }
@@ -15,6 +15,7 @@
 // BBS
 #include "FaceDetector.hpp"
 
+#include "libslic3r/ConcurrentCache.hpp"
 #include "libslic3r/Geometry/ConvexHull.hpp"
 
 #include <float.h>
@@ -25,6 +26,8 @@
 #include <boost/log/trivial.hpp>
 #include <boost/nowide/iostream.hpp>
 
+#include <tbb/parallel_for.h>
+
 #include "SVG.hpp"
 #include <Eigen/Dense>
 #include <functional>
@@ -217,6 +220,9 @@ Model Model::read_from_step(const std::string&
     for (ModelObject *o : model.objects)
         o->input_file = input_file;
 
+    // The loaders leave the convex hulls to be calculated on demand, calculate them in parallel now.
+    model.calculate_convex_hulls();
+
     if (options & LoadStrategy::AddDefaultInstances)
         model.add_default_instances();
 
@@ -342,6 +348,9 @@ Model Model::read_from_file(const std::string&
     for (ModelObject *o : model.objects)
         o->input_file = input_file;
 
+    // The loaders leave the convex hulls to be calculated on demand, calculate them in parallel now.
+    model.calculate_convex_hulls();
+
     if (options & LoadStrategy::AddDefaultInstances)
         model.add_default_instances();
 
@@ -402,6 +411,9 @@ Model Model::read_from_archive(const std::string& input_file, DynamicPrintConfig
             o->input_file = input_file;
     }
 
+    // The loaders leave the convex hulls to be calculated on demand, calculate them in parallel now.
+    model.calculate_convex_hulls();
+
     bool cb_cancel;
     if (options & LoadStrategy::AddDefaultInstances) {
         model.add_default_instances();
@@ -646,6 +658,27 @@ bool Model::add_default_instances()
     return true;
 }
 
+// Calculate the missing convex hulls of the volumes in parallel.
+// The volumes sharing a mesh share the hull, the first of them to get there calculates it.
+static void calculate_convex_hulls(const std::vector<const ModelVolume*> &volumes)
+{
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, volumes.size(), 1), [&volumes](const tbb::blocked_range<size_t> &range) {
+        for (size_t i = range.begin(); i < range.end(); ++ i)
+            if (! volumes[i]->has_convex_hull())
+                volumes[i]->get_convex_hull();
+    });
+}
+
+void Model::calculate_convex_hulls()
+{
+    std::vector<const ModelVolume*> volumes;
+    for (const ModelObject *o : this->objects)
+        for (const ModelVolume *v : o->volumes)
+            if (! v->has_convex_hull())
+                volumes.emplace_back(v);
+    Slic3r::calculate_convex_hulls(volumes);
+}
+
 // this returns the bounding box of the *transformed* instances
 BoundingBoxf3 Model::bounding_box_approx() const
 {
@@ -1973,6 +2006,7 @@ static void invalidate_translations(ModelObject* object, const ModelInstance* sr
 
 void ModelObject::split(ModelObjectPtrs* new_objects)
 {
+    const size_t num_old_objects = new_objects->size();
     std::vector<TriangleMesh> all_meshes;
     std::vector<Transform3d> all_transfos;
     std::vector<std::pair<int, int>> volume_mesh_counts;
@@ -2087,6 +2121,13 @@ void ModelObject::split(ModelObjectPtrs* new_objects)
             new_objects->emplace_back(new_object);
         }
     }
+
+    // The hulls of the parts are calculated in parallel instead of on their first use one after the other.
+    std::vector<const ModelVolume*> new_volumes;
+    for (auto it = new_objects->begin() + num_old_objects; it != new_objects->end(); ++ it)
+        for (const ModelVolume *new_volume : (*it)->volumes)
+            new_volumes.emplace_back(new_volume);
+    calculate_convex_hulls(new_volumes);
 }
 
 
@@ -2505,6 +2546,7 @@ void ModelVolume::center_geometry_after_creation(bool update_source_offset)
             const_cast<TriangleMesh*>(m_mesh.get())->translate(-(float)shift(0), -(float)shift(1), -(float)shift(2));
             const_cast<TriangleMesh*>(m_mesh.get())->set_init_shift(shift);
         }
+        // If the hull was not calculated yet, it will be calculated from the translated mesh.
         if (m_convex_hull)
 			const_cast<TriangleMesh*>(m_convex_hull.get())->translate(-(float)shift(0), -(float)shift(1), -(float)shift(2));
         translate(shift);
@@ -2514,16 +2556,26 @@ void ModelVolume::center_geometry_after_creation(bool update_source_offset)
         source.mesh_offset = shift;
 }
 
+// Convex hulls of the meshes shared by several ModelVolumes, for example by the clones of a volume or by the volumes
+// of a 3MF referencing the same mesh, so that the hull of a mesh is calculated just once.
+static WeakCache<TriangleMesh, TriangleMesh>& mesh_convex_hull_cache()
+{
+    static WeakCache<TriangleMesh, TriangleMesh> cache;
+    return cache;
+}
+
 void ModelVolume::calculate_convex_hull()
 {
-    m_convex_hull = std::make_shared<TriangleMesh>(this->mesh().convex_hull_3d());
+    auto convex_hull = std::make_shared<const TriangleMesh>(this->mesh().convex_hull_3d());
+    // The mesh may have been modified in place, replace the hull stored for it.
+    std::atomic_store(&m_convex_hull, mesh_convex_hull_cache().insert(m_mesh, std::move(convex_hull), true));
     assert(m_convex_hull.get());
 }
 
 //BBS: convex_hull_2d using convex_hull_3d
 void  ModelVolume::calculate_convex_hull_2d(const Geometry::Transformation &transformation) const
 {
-    const indexed_triangle_set &its = m_convex_hull->its;
+    const indexed_triangle_set &its = this->get_convex_hull().its;
 	if (its.vertices.empty())
         return;
 
@@ -2609,7 +2661,20 @@ int ModelVolume::get_repaired_errors_count() const
 
 const TriangleMesh& ModelVolume::get_convex_hull() const
 {
-    return *m_convex_hull.get();
+    return *this->get_convex_hull_shared_ptr();
+}
+
+const std::shared_ptr<const TriangleMesh>& ModelVolume::get_convex_hull_shared_ptr() const
+{
+    if (! std::atomic_load(&m_convex_hull)) {
+        std::shared_ptr<const TriangleMesh> convex_hull = mesh_convex_hull_cache().get(m_mesh,
+            [this]() { return std::make_shared<const TriangleMesh>(this->mesh().convex_hull_3d()); });
+        // Another thread may have assigned the same hull in the meantime.
+        std::shared_ptr<const TriangleMesh> expected;
+        std::atomic_compare_exchange_strong(&m_convex_hull, &expected, convex_hull);
+    }
+    // Once assigned, the hull is only replaced by the non-const methods.
+    return m_convex_hull;
 }
 
 //BBS: refine the model part names
@@ -2673,7 +2738,7 @@ size_t ModelVolume::split(unsigned int max_extruders)
 
         if (idx == 0) {
             this->set_mesh(std::move(mesh));
-            this->calculate_convex_hull();
+            this->invalidate_convex_hull();
             this->invalidate_convex_hull_2d();
             // Assign a new unique ID, so that a new GLVolume will be generated.
             this->set_new_unique_id();
@@ -2701,6 +2766,9 @@ size_t ModelVolume::split(unsigned int max_extruders)
         ++ idx;
     }
 
+    // The hulls of the parts are calculated in parallel before the degenerate parts are discarded.
+    calculate_convex_hulls(std::vector<const ModelVolume*>(this->object->volumes.begin(), this->object->volumes.end()));
+
     // discard volumes for which the convex hull was not generated or is degenerate
     size_t i = 0;
     while (i < this->object->volumes.size()) {
@@ -2782,7 +2850,10 @@ void ModelVolume::mirror(Axis axis)
 void ModelVolume::scale_geometry_after_creation(const Vec3f& versor)
 {
 	const_cast<TriangleMesh*>(m_mesh.get())->scale(versor);
-    if (m_convex_hull->empty())
+    if (! m_convex_hull)
+        // Not calculated yet, it will be calculated from the scaled mesh.
+        ;
+    else if (m_convex_hull->empty())
         //BBS: recompute the convex hull if it is null for previous too small
         this->calculate_convex_hull();
     else
@@ -2794,9 +2865,12 @@ void ModelVolume::transform_this_mesh(const Transform3d &mesh_trafo, bool fix_le
 	TriangleMesh mesh = this->mesh();
 	mesh.transform(mesh_trafo, fix_left_handed);
 	this->set_mesh(std::move(mesh));
-    TriangleMesh convex_hull = this->get_convex_hull();
-    convex_hull.transform(mesh_trafo, fix_left_handed);
-    m_convex_hull = std::make_shared<TriangleMesh>(std::move(convex_hull));
+    // Transform the hull if it was calculated already, otherwise it will be calculated from the transformed mesh.
+    if (m_convex_hull) {
+        TriangleMesh convex_hull = *m_convex_hull;
+        convex_hull.transform(mesh_trafo, fix_left_handed);
+        m_convex_hull = std::make_shared<TriangleMesh>(std::move(convex_hull));
+    }
     // Let the rest of the application know that the geometry changed, so the meshes have to be reloaded.
     this->set_new_unique_id();
 }
@@ -2806,9 +2880,12 @@ void ModelVolume::transform_this_mesh(const Matrix3d &matrix, bool fix_left_hand
 	TriangleMesh mesh = this->mesh();
 	mesh.transform(matrix, fix_left_handed);
 	this->set_mesh(std::move(mesh));
-    TriangleMesh convex_hull = this->get_convex_hull();
-    convex_hull.transform(matrix, fix_left_handed);
-    m_convex_hull = std::make_shared<TriangleMesh>(std::move(convex_hull));
+    // Transform the hull if it was calculated already, otherwise it will be calculated from the transformed mesh.
+    if (m_convex_hull) {
+        TriangleMesh convex_hull = *m_convex_hull;
+        convex_hull.transform(matrix, fix_left_handed);
+        m_convex_hull = std::make_shared<TriangleMesh>(std::move(convex_hull));
+    }
     // Let the rest of the application know that the geometry changed, so the meshes have to be reloaded.
     this->set_new_unique_id();
 }
@@ -3405,6 +3482,13 @@ indexed_triangle_set FacetsAnnotation::get_facets_strict(const ModelVolume& mv,
     return selector.get_facets_strict(type);
 }
 
+void FacetsAnnotation::get_facets_strict(const ModelVolume& mv, std::vector<Vec3f>& vertices, std::vector<std::vector<stl_triangle_vertex_indices>>& indices_per_type) const
+{
+    TriangleSelector selector(mv.mesh());
+    selector.deserialize(m_data, false);
+    selector.get_facets_strict(vertices, indices_per_type);
+}
+
 bool FacetsAnnotation::has_facets(const ModelVolume& mv, EnforcerBlockerType type) const
 {
     return TriangleSelector::has_facets(m_data, type);
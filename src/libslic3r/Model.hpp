@@ -748,6 +748,8 @@ public:
     void get_facets(const ModelVolume& mv, std::vector<indexed_triangle_set>& facets_per_type) const;
     void set_enforcer_block_type_limit(const ModelVolume& mv, EnforcerBlockerType max_type);
     indexed_triangle_set get_facets_strict(const ModelVolume& mv, EnforcerBlockerType type) const;
+    // Facets of all the states at once, decoding the painting only once. All the states share the vertices.
+    void get_facets_strict(const ModelVolume& mv, std::vector<Vec3f>& vertices, std::vector<std::vector<stl_triangle_vertex_indices>>& indices_per_type) const;
     bool has_facets(const ModelVolume& mv, EnforcerBlockerType type) const;
     bool empty() const { return m_data.triangles_to_split.empty(); }
 
@@ -949,9 +951,15 @@ public:
     // Attention! This method may only be called just after ModelVolume creation! It must not be called once the TriangleMesh of this ModelVolume is shared!
     void                center_geometry_after_creation(bool update_source_offset = true);
 
+    // Calculate the convex hull of the current mesh now.
     void                calculate_convex_hull();
+    // Drop the convex hull, it will be calculated on demand. Call after the mesh was replaced.
+    void                invalidate_convex_hull() { std::atomic_store(&m_convex_hull, std::shared_ptr<const TriangleMesh>()); }
+    bool                has_convex_hull() const { return std::atomic_load(&m_convex_hull) != nullptr; }
+    // The convex hull is calculated on the first request, or shared with the other volumes of the same mesh.
+    // Thread safe against other const methods.
     const TriangleMesh& get_convex_hull() const;
-    const std::shared_ptr<const TriangleMesh>& get_convex_hull_shared_ptr() const { return m_convex_hull; }
+    const std::shared_ptr<const TriangleMesh>& get_convex_hull_shared_ptr() const;
     //BBS: add convex_hell_2d related logic
     const Polygon& get_convex_hull_2d(const Transform3d &trafo_instance) const;
     void invalidate_convex_hull_2d()
@@ -1041,8 +1049,9 @@ private:
     // Is it an object to be printed, or a modifier volume?
     ModelVolumeType                 	m_type;
     t_model_material_id             	m_material_id;
-    // The convex hull of this model's mesh.
-    std::shared_ptr<const TriangleMesh> m_convex_hull;
+    // The convex hull of this model's mesh, null until requested. Accessed with std::atomic_load() / std::atomic_store(),
+    // as it is calculated lazily by const methods.
+    mutable std::shared_ptr<const TriangleMesh> m_convex_hull;
     //BBS: add convex hull 2d related logic
     mutable Polygon                     m_convex_hull_2d; //BBS, used for convex_hell_2d acceleration
     mutable Transform3d                 m_cached_trans_matrix; //BBS, used for convex_hell_2d acceleration
@@ -1071,8 +1080,6 @@ private:
         assert(this->id() != this->seam_facets.id());
         assert(this->id() != this->mmu_segmentation_facets.id());
         assert(this->id() != this->fuzzy_skin_facets.id());
-        if (mesh.facets_count() > 1)
-            calculate_convex_hull();
     }
     ModelVolume(ModelObject *object, const std::shared_ptr<const TriangleMesh> &mesh, ModelVolumeType type = ModelVolumeType::MODEL_PART) : m_mesh(mesh), m_type(type), object(object)
     {
@@ -1106,7 +1113,7 @@ private:
     // Copying an existing volume, therefore this volume will get a copy of the ID assigned.
     ModelVolume(ModelObject *object, const ModelVolume &other) :
         ObjectBase(other),
-        name(other.name), source(other.source), m_mesh(other.m_mesh), m_convex_hull(other.m_convex_hull),
+        name(other.name), source(other.source), m_mesh(other.m_mesh), m_convex_hull(std::atomic_load(&other.m_convex_hull)),
         config(other.config), m_type(other.m_type), object(object), m_transformation(other.m_transformation),
         supported_facets(other.supported_facets), seam_facets(other.seam_facets), mmu_segmentation_facets(other.mmu_segmentation_facets),
         fuzzy_skin_facets(other.fuzzy_skin_facets), cut_info(other.cut_info), text_configuration(other.text_configuration), emboss_shape(other.emboss_shape)
@@ -1149,8 +1156,6 @@ private:
         assert(this->config.id() == other.config.id());
         this->set_material_id(other.material_id());
         this->config.set_new_unique_id();
-        if (m_mesh->facets_count() > 1)
-            calculate_convex_hull();
 		assert(this->config.id().valid()); 
         assert(this->config.id() != other.config.id()); 
         assert(this->supported_facets.id() != other.supported_facets.id());
@@ -1199,18 +1204,17 @@ private:
         cereal::load(ar, text_configuration);
         cereal::load(ar, emboss_shape);
 		assert(m_mesh);
-		if (has_convex_hull) {
+		if (has_convex_hull)
+			// If the convex hull was released from the Undo / Redo stack to conserve memory, it will be recalculated on demand.
 			cereal::load_optional(ar, m_convex_hull);
-			if (! m_convex_hull && ! m_mesh->empty())
-				// The convex hull was released from the Undo / Redo stack to conserve memory. Recalculate it.
-				this->calculate_convex_hull();
-		} else
+		else
 			m_convex_hull.reset();
         if (mesh_changed && object)
             Slic3r::save_object_mesh(*object);
 	}
 	template<class Archive> void save(Archive &ar) const {
-		bool has_convex_hull = m_convex_hull.get() != nullptr;
+		std::shared_ptr<const TriangleMesh> convex_hull = std::atomic_load(&m_convex_hull);
+		bool has_convex_hull = convex_hull != nullptr;
         ar(name, source, m_mesh, m_type, m_material_id, m_transformation, m_is_splittable, has_convex_hull, cut_info);
         cereal::save_by_value(ar, supported_facets);
         cereal::save_by_value(ar, seam_facets);
@@ -1220,7 +1224,7 @@ private:
         cereal::save(ar, text_configuration);
         cereal::save(ar, emboss_shape);
 		if (has_convex_hull)
-			cereal::save_optional(ar, m_convex_hull);
+			cereal::save_optional(ar, convex_hull);
 	}
 };
 
@@ -1650,6 +1654,8 @@ public:
     void          delete_material(t_model_material_id material_id);
     void          clear_materials();
     bool          add_default_instances();
+    // Calculate in parallel the convex hulls of all volumes, which do not have one yet.
+    void          calculate_convex_hulls();
     // Returns approximate axis aligned bounding box of this model.
     BoundingBoxf3 bounding_box_approx() const;
     // Returns exact axis aligned bounding box of this model.
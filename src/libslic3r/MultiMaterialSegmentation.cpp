@@ -1213,8 +1213,14 @@ static inline std::vector<std::vector<ExPolygons>> segmentation_top_and_bottom_l
         for (const ModelVolume *mv : print_object.model_object()->volumes)
             if (mv->is_model_part()) {
                 const Transform3d volume_trafo = object_trafo * mv->get_matrix();
+                // Decode the painting once for all the states. The states share the vertices,
+                // the triangles of each state are swapped into the same mesh in turn.
+                indexed_triangle_set                                  painted;
+                std::vector<std::vector<stl_triangle_vertex_indices>> painted_indices_per_type;
+                extract_facets_info(*mv).facets_annotation.get_facets_strict(*mv, painted.vertices, painted_indices_per_type);
+                painted_indices_per_type.resize(num_facets_states);
                 for (size_t extruder_idx = 0; extruder_idx < num_facets_states; ++extruder_idx) {
-                    const indexed_triangle_set painted = extract_facets_info(*mv).facets_annotation.get_facets_strict(*mv, EnforcerBlockerType(extruder_idx));
+                    painted.indices = std::move(painted_indices_per_type[extruder_idx]);
 #ifdef MM_SEGMENTATION_DEBUG_TOP_BOTTOM
                     {
                         static int iRun = 0;
@@ -2029,12 +2035,17 @@ std::vector<std::vector<ExPolygons>> segmentation_by_painting(const PrintObject
 
     BOOST_LOG_TRIVIAL(debug) << "Print object segmentation - Projection of painted triangles - Begin";
     for (const ModelVolume *mv : print_object.model_object()->volumes) {
-        const ModelVolumeFacetsInfo facets_info = extract_facets_info(*mv);
-        tbb::parallel_for(tbb::blocked_range<size_t>(1, num_facets_states), [&mv, &print_object, &facets_info, &layers, &edge_grids, &painted_lines, &painted_lines_mutex, &input_expolygons, &throw_on_cancel_callback](const tbb::blocked_range<size_t> &range) {
+        if (!mv->is_model_part())
+            continue;
+        // Decode the painting once for all the states, then project the states in parallel.
+        std::vector<indexed_triangle_set> custom_facets_per_type;
+        extract_facets_info(*mv).facets_annotation.get_facets(*mv, custom_facets_per_type);
+        custom_facets_per_type.resize(num_facets_states);
+        tbb::parallel_for(tbb::blocked_range<size_t>(1, num_facets_states), [&mv, &print_object, &custom_facets_per_type, &layers, &edge_grids, &painted_lines, &painted_lines_mutex, &input_expolygons, &throw_on_cancel_callback](const tbb::blocked_range<size_t> &range) {
             for (size_t extruder_idx = range.begin(); extruder_idx < range.end(); ++extruder_idx) {
                 throw_on_cancel_callback();
-                const indexed_triangle_set custom_facets = facets_info.facets_annotation.get_facets(*mv, EnforcerBlockerType(extruder_idx));
-                if (!mv->is_model_part() || custom_facets.indices.empty())
+                const indexed_triangle_set &custom_facets = custom_facets_per_type[extruder_idx];
+                if (custom_facets.indices.empty())
                     continue;
 
                 const Transform3f tr = print_object.trafo().cast<float>() * mv->get_matrix().cast<float>();
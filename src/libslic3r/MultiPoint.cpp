@@ -161,54 +161,59 @@ bool MultiPoint::intersections(const Line &line, Points *intersections) const
     return intersections->size() > intersections_size;
 }
 
-Points MultiPoint::_douglas_peucker(const Points &pts, const double tolerance)
+// The kept points are written in increasing order to positions not above the position of the anchor point,
+// and only the points from the anchor point on are read, thus the points may be compacted in place.
+Points::iterator MultiPoint::_douglas_peucker_inplace(Points::iterator begin, Points::iterator end, const double tolerance)
 {
-    Points result_pts;
-	double tolerance_sq = tolerance * tolerance;
-    if (! pts.empty()) {
-        const Point  *anchor      = &pts.front();
-        size_t        anchor_idx  = 0;
-        const Point  *floater     = &pts.back();
-        size_t        floater_idx = pts.size() - 1;
-        result_pts.reserve(pts.size());
-        result_pts.emplace_back(*anchor);
-        if (anchor_idx != floater_idx) {
-            assert(pts.size() > 1);
-            std::vector<size_t> dpStack;
-            dpStack.reserve(pts.size());
-            dpStack.emplace_back(floater_idx);
-            for (;;) {
-                double max_dist_sq  = 0.0;
-                size_t furthest_idx = anchor_idx;
-                // find point furthest from line seg created by (anchor, floater) and note it
-                for (size_t i = anchor_idx + 1; i < floater_idx; ++ i) {
-                    double dist_sq = Line::distance_to_squared(pts[i], *anchor, *floater);
-                    if (dist_sq > max_dist_sq) {
-                        max_dist_sq  = dist_sq;
-                        furthest_idx = i;
-                    }
-                }
-                // remove point if less than tolerance
-                if (max_dist_sq <= tolerance_sq) {
-                    result_pts.emplace_back(*floater);
-                    anchor_idx = floater_idx;
-                    anchor     = floater;
-                    assert(dpStack.back() == floater_idx);
-                    dpStack.pop_back();
-                    if (dpStack.empty())
-                        break;
-                    floater_idx = dpStack.back();
-                } else {
-                    floater_idx = furthest_idx;
-                    dpStack.emplace_back(floater_idx);
+    if (begin == end)
+        return end;
+    double           tolerance_sq = tolerance * tolerance;
+    Points::iterator out          = begin + 1;
+    size_t           anchor_idx   = 0;
+    size_t           floater_idx  = size_t(end - begin) - 1;
+    if (anchor_idx != floater_idx) {
+        Point               anchor  = begin[anchor_idx];
+        Point               floater = begin[floater_idx];
+        std::vector<size_t> dpStack;
+        dpStack.reserve(floater_idx + 1);
+        dpStack.emplace_back(floater_idx);
+        for (;;) {
+            double max_dist_sq  = 0.0;
+            size_t furthest_idx = anchor_idx;
+            // find point furthest from line seg created by (anchor, floater) and note it
+            for (size_t i = anchor_idx + 1; i < floater_idx; ++ i) {
+                double dist_sq = Line::distance_to_squared(begin[i], anchor, floater);
+                if (dist_sq > max_dist_sq) {
+                    max_dist_sq  = dist_sq;
+                    furthest_idx = i;
                 }
-                floater = &pts[floater_idx];
             }
+            // remove point if less than tolerance
+            if (max_dist_sq <= tolerance_sq) {
+                *out ++    = floater;
+                anchor_idx = floater_idx;
+                anchor     = floater;
+                assert(dpStack.back() == floater_idx);
+                dpStack.pop_back();
+                if (dpStack.empty())
+                    break;
+                floater_idx = dpStack.back();
+            } else {
+                floater_idx = furthest_idx;
+                dpStack.emplace_back(floater_idx);
+            }
+            floater = begin[floater_idx];
         }
-        assert(result_pts.front() == pts.front());
-        assert(result_pts.back()  == pts.back());
+    }
+    return out;
+}
 
+Points MultiPoint::_douglas_peucker(const Points &pts, const double tolerance)
+{
+    Points result_pts(pts);
+    result_pts.erase(MultiPoint::_douglas_peucker_inplace(result_pts.begin(), result_pts.end(), tolerance), result_pts.end());
 #if 0
+    if (! pts.empty()) {
         {
             static int iRun = 0;
 			BoundingBox bbox(pts);
@@ -224,8 +229,8 @@ Points MultiPoint::_douglas_peucker(const Points &pts, const double tolerance)
             else
                 svg.draw(Polyline(result_pts), "green", scale_(0.1));
         }
-#endif
     }
+#endif
     return result_pts;
 }
 
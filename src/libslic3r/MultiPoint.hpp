@@ -96,6 +96,9 @@ public:
     bool intersections(const Line &line, Points *intersections) const;
     void symmetric_y(const coord_t &y_axis);
     static Points _douglas_peucker(const Points &points, const double tolerance);
+    // Douglas-Peucker simplification of the points in [begin, end), moving the kept points to the front of the range.
+    // Returns the end of the kept points.
+    static Points::iterator _douglas_peucker_inplace(Points::iterator begin, Points::iterator end, const double tolerance);
     static Points visivalingam(const Points& pts, const double tolerance);
     static Points concave_hull_2d(const Points& pts, const double tolerence);
     
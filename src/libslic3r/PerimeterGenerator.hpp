@@ -10,6 +10,10 @@
 #include "SurfaceCollection.hpp"
 
 namespace Slic3r {
+namespace Arachne {
+    class BeadingCache;
+}
+
 struct FuzzySkinConfig
 {
     FuzzySkinType type;
@@ -77,6 +81,8 @@ public:
     const PrintRegionConfig     *config;
     const PrintObjectConfig     *object_config;
     const PrintConfig           *print_config;
+    // Beadings of Arachne shared by the layers of the region, may be null.
+    Arachne::BeadingCache       *beading_cache;
     // Outputs:
     ExtrusionEntityCollection   *loops;
     ExtrusionEntityCollection   *gap_fill;
@@ -117,7 +123,7 @@ public:
         : slices(slices), compatible_regions(compatible_regions), upper_slices(nullptr), lower_slices(nullptr), layer_height(layer_height),
             slice_z(slice_z), layer_id(-1), perimeter_flow(flow), ext_perimeter_flow(flow),
             overhang_flow(flow), solid_infill_flow(flow),
-            config(config), object_config(object_config), print_config(print_config),
+            config(config), object_config(object_config), print_config(print_config), beading_cache(nullptr),
             m_spiral_vase(spiral_mode),
             m_scaled_resolution(scaled<double>(print_config->resolution.value > EPSILON ? print_config->resolution.value : EPSILON)),
             loops(loops), gap_fill(gap_fill), fill_surfaces(fill_surfaces), fill_no_overlap(fill_no_overlap),
@@ -145,7 +145,7 @@ Points Polyline::equally_spaced_points(double distance) const
 
 void Polyline::simplify(double tolerance)
 {
-    this->points = MultiPoint::_douglas_peucker(this->points, tolerance);
+    this->points.erase(MultiPoint::_douglas_peucker_inplace(this->points.begin(), this->points.end(), tolerance), this->points.end());
     this->fitting_result.clear();
 }
 
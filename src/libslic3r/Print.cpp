@@ -11,6 +11,7 @@
 #include "ShortestPath.hpp"
 #include "Thread.hpp"
 #include "Time.hpp"
+#include "Trace.hpp"
 #include "GCode.hpp"
 #include "GCode/WipeTower.hpp"
 #include "GCode/WipeTower2.hpp"
@@ -84,7 +85,6 @@ bool Print::invalidate_state_by_config_options(const ConfigOptionResolver & /* n
     // or they are only notes not influencing the generated G-code.
     static std::unordered_set<std::string> steps_gcode = {
         //BBS
-        "additional_cooling_fan_speed",
         "reduce_crossing_wall",
         "max_travel_detour_distance",
         "printable_area",
@@ -95,9 +95,7 @@ bool Print::invalidate_state_by_config_options(const ConfigOptionResolver & /* n
         "enable_pressure_advance",
         "pressure_advance",
         "enable_overhang_bridge_fan",
-        "overhang_fan_speed",
         "overhang_fan_threshold",
-        "slow_down_for_layer_cooling",
         "default_acceleration",
         "deretraction_speed",
         "close_fan_the_first_x_layers",
@@ -113,13 +111,6 @@ bool Print::invalidate_state_by_config_options(const ConfigOptionResolver & /* n
         "extruder_colour",
         "extruder_offset",
         "filament_flow_ratio",
-        "reduce_fan_stop_start_freq",
-        "dont_slow_down_outer_wall",
-        "fan_cooling_layer_time",
-        "full_fan_speed_layer",
-        "fan_kickstart",
-        "fan_speedup_overhangs",
-        "fan_speedup_time",
         "filament_colour",
         "default_filament_colour",
         "filament_diameter",
@@ -145,13 +136,7 @@ bool Print::invalidate_state_by_config_options(const ConfigOptionResolver & /* n
         "gcode_add_line_number",
         "layer_change_gcode",
         "time_lapse_gcode",
-        "fan_min_speed",
-        "fan_max_speed",
         "printable_height",
-        "slow_down_min_speed",
-        "max_volumetric_extrusion_rate_slope",
-        "max_volumetric_extrusion_rate_slope_segment_length",
-        "extrusion_rate_smoothing_external_perimeter_only",
         "reduce_infill_retraction",
         "filename_format",
         "retraction_minimum_travel",
@@ -168,7 +153,6 @@ bool Print::invalidate_state_by_config_options(const ConfigOptionResolver & /* n
         "retract_restart_extra_toolchange",
         "retraction_speed",
         "use_firmware_retraction",
-        "slow_down_layer_time",
         "standby_temperature_delta",
         "preheat_time",
         "preheat_steps",
@@ -199,7 +183,6 @@ bool Print::invalidate_state_by_config_options(const ConfigOptionResolver & /* n
         "gcode_label_objects", 
         "exclude_object",
         "support_material_interface_fan_speed",
-        "internal_bridge_fan_speed", // ORCA: Add support for separate internal bridge fan speed control
         "ironing_fan_speed",
         "single_extruder_multi_material_priming",
         "activate_air_filtration",
@@ -222,8 +205,12 @@ bool Print::invalidate_state_by_config_options(const ConfigOptionResolver & /* n
     std::vector<PrintObjectStep> osteps;
     bool invalidated = false;
 
+    bool postprocess_only = false;
     for (const t_config_option_key &opt_key : opt_keys) {
-        if (steps_gcode.find(opt_key) != steps_gcode.end()) {
+        if (is_gcode_postprocess_option(opt_key)) {
+            // These options only affect the post-processing of the G-code, the G-code layers cached by the last export stay valid.
+            postprocess_only = true;
+        } else if (steps_gcode.find(opt_key) != steps_gcode.end()) {
             // These options only affect G-code export or they are just notes without influence on the generated G-code,
             // so there is nothing to invalidate.
             steps.emplace_back(psGCodeExport);
@@ -361,6 +348,8 @@ bool Print::invalidate_state_by_config_options(const ConfigOptionResolver & /* n
         }
     }
 
+    if (postprocess_only)
+        invalidated |= Inherited::invalidate_step(psGCodeExport);
     sort_remove_duplicates(steps);
     for (PrintStep step : steps)
         invalidated |= this->invalidate_step(step);
@@ -377,9 +366,42 @@ void Print::set_calib_params(const Calib_Params& params) {
     m_calib_params.mode = params.mode;
 }
 
+bool Print::is_gcode_postprocess_option(const t_config_option_key &opt_key)
+{
+    static std::unordered_set<std::string> postprocess_options = {
+        // CoolingBuffer
+        "slow_down_for_layer_cooling",
+        "slow_down_layer_time",
+        "slow_down_min_speed",
+        "dont_slow_down_outer_wall",
+        "fan_min_speed",
+        "fan_max_speed",
+        "fan_cooling_layer_time",
+        "full_fan_speed_layer",
+        "reduce_fan_stop_start_freq",
+        "additional_cooling_fan_speed",
+        "overhang_fan_speed",
+        "internal_bridge_fan_speed",
+        // FanMover
+        "fan_speedup_time",
+        "fan_speedup_overhangs",
+        "fan_kickstart",
+        // PressureEqualizer, switching it on or off changes the layers though.
+        "max_volumetric_extrusion_rate_slope",
+        "max_volumetric_extrusion_rate_slope_segment_length",
+        "extrusion_rate_smoothing_external_perimeter_only",
+        // AdaptivePAProcessor
+        "adaptive_pressure_advance_model",
+        "adaptive_pressure_advance_bridges"
+    };
+    return postprocess_options.find(opt_key) != postprocess_options.end();
+}
+
 bool Print::invalidate_step(PrintStep step)
 {
 	bool invalidated = Inherited::invalidate_step(step);
+    // Anything but the options of the G-code post-processing invalidates the cached G-code layers, see is_gcode_postprocess_option().
+    m_gcode_layer_cache.reset();
     // Propagate to dependent steps.
     if (step != psGCodeExport)
         invalidated |= Inherited::invalidate_step(psGCodeExport);
@@ -1862,6 +1884,7 @@ void Print::process(long long *time_cost_with_cache, bool use_cache)
         *time_cost_with_cache = 0;
 
     name_tbb_thread_pool_threads_set_locale();
+    SLIC3R_TRACE_ZONE("Print::process");
 
     //compute the PrintObject with the same geometries
     BOOST_LOG_TRIVIAL(info) << __FUNCTION__ << boost::format(": this=%1%, enter, use_cache=%2%, object size=%3%")%this%use_cache%m_objects.size();
@@ -1999,6 +2022,13 @@ void Print::process(long long *time_cost_with_cache, bool use_cache)
                     obj->set_done(posInfill);
             }
         }
+        if (m_low_memory_mode) {
+            // Release the infill inputs before the support generator allocates its caches to lower the peak memory usage.
+            for (PrintObject *obj : m_objects)
+                if (need_slicing_objects.count(obj) != 0)
+                    obj->release_intermediate_data(posInfill);
+            BOOST_LOG_TRIVIAL(info) << "Released the intermediate infill data." << log_memory_info();
+        }
         for (PrintObject *obj : m_objects) {
             if (need_slicing_objects.count(obj) != 0) {
                 obj->ironing();
@@ -2033,6 +2063,12 @@ void Print::process(long long *time_cost_with_cache, bool use_cache)
                     obj->set_done(posDetectOverhangsForLift);
             }
         }
+        if (m_low_memory_mode) {
+            for (PrintObject *obj : m_objects)
+                if (need_slicing_objects.count(obj) != 0)
+                    obj->release_intermediate_data(posSupportMaterial);
+            BOOST_LOG_TRIVIAL(info) << "Released the intermediate support data." << log_memory_info();
+        }
     }
     else {
         for (PrintObject *obj : m_objects) {
@@ -2072,6 +2108,7 @@ void Print::process(long long *time_cost_with_cache, bool use_cache)
     }
 
     if (this->set_started(psWipeTower)) {
+        SLIC3R_TRACE_ZONE("Print::make_wipe_tower");
         m_wipe_tower_data.clear();
         m_tool_ordering.clear();
         if (this->has_wipe_tower()) {
@@ -2085,6 +2122,7 @@ void Print::process(long long *time_cost_with_cache, bool use_cache)
         this->set_done(psWipeTower);
     }
     if (this->set_started(psSkirtBrim)) {
+        SLIC3R_TRACE_ZONE("Print::make_skirt_brim");
         this->set_status(70, L("Generating skirt & brim"));
 
         if (time_cost_with_cache)
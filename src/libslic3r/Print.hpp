@@ -8,6 +8,7 @@
 #include "BoundingBox.hpp"
 #include "ExtrusionEntityCollection.hpp"
 #include "Flow.hpp"
+#include "MemoryUsage.hpp"
 #include "Point.hpp"
 #include "Slicing.hpp"
 #include "TriangleMeshSlicer.hpp"
@@ -17,6 +18,7 @@
 #include "GCode/ThumbnailData.hpp"
 #include "GCode/GCodeProcessor.hpp"
 #include "MultiMaterialSegmentation.hpp"
+#include "Arachne/BeadingStrategy/CachedBeadingStrategy.hpp"
 #include "libslic3r.h"
 
 #include <Eigen/Geometry>
@@ -29,6 +31,7 @@
 namespace Slic3r {
 
 class GCode;
+struct GCodeLayerCache;
 class Layer;
 class ModelObject;
 class Print;
@@ -37,6 +40,8 @@ class SupportLayer;
 // BBS
 class TreeSupportData;
 class TreeSupport;
+struct TreeSupportOverhangs;
+class GyroidWaveCache;
 
 #define MAX_OUTER_NOZZLE_DIAMETER   4
 // BBS: move from PrintObjectSlice.cpp
@@ -124,6 +129,8 @@ public:
     coordf_t                    nozzle_dmr_avg(const PrintConfig &print_config) const;
     // Average diameter of nozzles participating on extruding this region.
     coordf_t                    bridging_height_avg(const PrintConfig &print_config) const;
+    // Beadings of Arachne computed for this region, shared by its layers until the perimeters are invalidated or released.
+    Arachne::BeadingCache*      beading_cache() const { return m_beading_cache.get(); }
 
     // Collect 0-based extruder indices used to print this region's object.
 	void                        collect_object_printing_extruders(const Print &print, std::vector<unsigned int> &object_extruders) const;
@@ -131,10 +138,10 @@ public:
 
 // Methods modifying the PrintRegion's state:
 public:
-    void                        set_config(const PrintRegionConfig &config) { m_config = config; m_config_hash = m_config.hash(); }
-    void                        set_config(PrintRegionConfig &&config) { m_config = std::move(config); m_config_hash = m_config.hash(); }
+    void                        set_config(const PrintRegionConfig &config) { m_config = config; m_config_hash = m_config.hash(); m_beading_cache->clear(); }
+    void                        set_config(PrintRegionConfig &&config) { m_config = std::move(config); m_config_hash = m_config.hash(); m_beading_cache->clear(); }
     void                        config_apply_only(const ConfigBase &other, const t_config_option_keys &keys, bool ignore_nonexistent = false)
-                                        { m_config.apply_only(other, keys, ignore_nonexistent); m_config_hash = m_config.hash(); }
+                                        { m_config.apply_only(other, keys, ignore_nonexistent); m_config_hash = m_config.hash(); m_beading_cache->clear(); }
 private:
     friend Print;
     friend void print_region_ref_inc(PrintRegion&);
@@ -146,6 +153,7 @@ private:
     int                m_print_region_id { -1 };
     int                m_print_object_region_id { -1 };
     int                m_ref_cnt { 0 };
+    std::shared_ptr<Arachne::BeadingCache> m_beading_cache { std::make_shared<Arachne::BeadingCache>() };
 };
 
 inline bool operator==(const PrintRegion &lhs, const PrintRegion &rhs) { return lhs.config_hash() == rhs.config_hash() && lhs.config() == rhs.config(); }
@@ -398,6 +406,9 @@ public:
     SupportLayer* add_tree_support_layer(int id, coordf_t height, coordf_t print_z, coordf_t slice_z);
     std::shared_ptr<TreeSupportData> alloc_tree_support_preview_cache();
     void clear_tree_support_preview_cache() { m_tree_support_preview_cache.reset(); }
+    // Overhangs detected by the tree support generator during the last posSupportMaterial step, see TreeSupportOverhangs.
+    const std::shared_ptr<TreeSupportOverhangs>& tree_support_overhangs() const { return m_tree_support_overhangs; }
+    void set_tree_support_overhangs(std::shared_ptr<TreeSupportOverhangs> overhangs) { m_tree_support_overhangs = std::move(overhangs); }
 
     size_t          support_layer_count() const { return m_support_layers.size(); }
     void            clear_support_layers();
@@ -467,9 +478,26 @@ public:
     size_t get_id() const { return m_id; }
     void set_id(size_t id) { m_id = id; }
 
+    // Estimate of the memory held by the layers of this object. Objects sharing the layers of another object report nothing.
+    PrintObjectMemoryUsage  memory_usage() const;
+    // Called by the tree support generator with the size of its TreeModelVolumes caches, the peak is reported by memory_usage().
+    void                    update_support_caches_memsize(size_t memsize) { m_support_caches_memsize = std::max(m_support_caches_memsize, memsize); }
+    // Release the data, which is only needed to calculate the PrintObject steps, but not to export the G-code.
+    // posInfill releases the data consumed by the infill generator, posSupportMaterial the data consumed by the support generators.
+    // The released data is not restored, thus the object must not be processed again once released.
+    // Used in the low memory mode of the command line slicer, which never invalidates the steps of an already processed object.
+    void                    release_intermediate_data(PrintObjectStep step);
+    // Release the extrusions of an object layer and of a support layer of this object, once their G-code was generated.
+    // Used in the low memory mode of the command line slicer, the G-code of the object can not be exported again.
+    void                    release_layer_extrusions(const Layer *object_layer, const SupportLayer *support_layer);
+    // Release the Arachne beadings of the regions of this object.
+    void                    clear_beading_caches();
+
   private:
     // to be called from Print only.
     friend class Print;
+    // Unit tests compare the steps of prepare_infill() against their reference implementations.
+    friend struct PrintObjectTestAccess;
 
 	PrintObject(Print* print, ModelObject* model_object, const Transform3d& trafo, PrintInstances&& instances);
 	~PrintObject();
@@ -545,6 +573,8 @@ private:
     SupportLayerPtrs                        m_support_layers;
     // BBS
     std::shared_ptr<TreeSupportData>        m_tree_support_preview_cache;
+    // Kept across the invalidation of posSupportMaterial, released when the slices or the perimeters are invalidated.
+    std::shared_ptr<TreeSupportOverhangs>   m_tree_support_overhangs;
 
     // this is set to true when LayerRegion->slices is split in top/internal/bottom
     // so that next call to make_perimeters() performs a union() before computing loops
@@ -552,6 +582,7 @@ private:
 
     std::pair<FillAdaptive::OctreePtr, FillAdaptive::OctreePtr> m_adaptive_fill_octrees;
     FillLightning::GeneratorPtr m_lightning_generator;
+    std::shared_ptr<GyroidWaveCache> m_gyroid_wave_cache;
 
     std::vector < VolumeSlices >            firstLayerObjSliceByVolume;
     std::vector<groupedVolumeSlices>        firstLayerObjSliceByGroups;
@@ -561,6 +592,9 @@ private:
 
     PrintObject*                            m_shared_object{ nullptr };
 
+    // Peak size of the TreeModelVolumes caches during the last posSupportMaterial step.
+    size_t                                  m_support_caches_memsize{ 0 };
+
     
     // SoftFever
     // 
@@ -1011,9 +1045,35 @@ public:
 
     std::tuple<float, float> object_skirt_offset(double margin_height = 0) const;
 
+    // Low memory mode of the command line slicer: the data consumed by the object steps is released as soon as the steps finish
+    // and the extrusions of the layers are released while the G-code is being exported.
+    // Such a Print can neither be processed again nor exported for the second time.
+    void                set_low_memory_mode(bool enable) { m_low_memory_mode = enable; }
+    bool                low_memory_mode() const { return m_low_memory_mode; }
+
+    // Options consumed by the G-code post-processing filters only (cooling buffer, fan mover, pressure equalizer,
+    // adaptive pressure advance). Changing them keeps the G-code layers cached by the last export, see GCodeLayerCache.
+    static bool         is_gcode_postprocess_option(const t_config_option_key &opt_key);
+    // Keep up to max_bytes of the G-code layers generated by the last export, so that changing only the options
+    // of the post-processing filters does not generate the layers again. Zero (the default) disables the cache,
+    // a print exceeding the limit is not cached. The low memory mode never caches the layers.
+    void                set_gcode_layer_cache_limit(size_t max_bytes) { m_gcode_layer_cache_limit = max_bytes; if (max_bytes == 0) m_gcode_layer_cache.reset(); }
+    size_t              gcode_layer_cache_limit() const { return m_gcode_layer_cache_limit; }
+    bool                has_gcode_layer_cache() const { return m_gcode_layer_cache != nullptr; }
+    // Limit of the G-code layer cache of the prints edited interactively, by the GUI and by the slicing service.
+    static constexpr const size_t DefaultGCodeLayerCacheLimit = size_t(256) << 20;
+
 protected:
     // Invalidates the step, and its depending steps in Print.
     bool                invalidate_step(PrintStep step);
+    // Invalidate the steps and drop the G-code layers cached by the last export.
+    template<typename StepTypeIterator>
+    bool                invalidate_steps(StepTypeIterator step_begin, StepTypeIterator step_end)
+        { m_gcode_layer_cache.reset(); return Inherited::invalidate_steps(step_begin, step_end); }
+    bool                invalidate_steps(std::initializer_list<PrintStep> il)
+        { m_gcode_layer_cache.reset(); return Inherited::invalidate_steps(il); }
+    bool                invalidate_all_steps()
+        { m_gcode_layer_cache.reset(); return Inherited::invalidate_all_steps(); }
 
 private:
     //BBS
@@ -1069,6 +1129,12 @@ private:
     //SoftFever: calibration
     Calib_Params m_calib_params;
 
+    bool              m_low_memory_mode { false };
+    // G-code of the layers generated by the last export, dropped whenever the G-code export is invalidated by anything
+    // else than the options of the post-processing filters.
+    std::shared_ptr<GCodeLayerCache> m_gcode_layer_cache;
+    size_t                           m_gcode_layer_cache_limit { 0 };
+
     // To allow GCode to set the Print's GCodeExport step status.
     friend class GCode;
     // Allow PrintObject to access m_mutex and m_cancel_callback.
@@ -1156,7 +1156,9 @@ Print::ApplyStatus Print::apply(const Model &model, DynamicPrintConfig new_full_
     if (! full_config_diff.empty()) {
         //BBS: add more logs
         BOOST_LOG_TRIVIAL(info) << __FUNCTION__ << boost::format(" %1%: found full_config_diff changed.")%__LINE__;
-        update_apply_status(this->invalidate_step(psGCodeExport));
+        // Changing just the options of the G-code post-processing keeps the G-code layers cached by the last export.
+        update_apply_status(std::all_of(full_config_diff.begin(), full_config_diff.end(), Print::is_gcode_postprocess_option) ?
+            Inherited::invalidate_step(psGCodeExport) : this->invalidate_step(psGCodeExport));
         m_placeholder_parser.clear_config();
         // Set the profile aliases for the PrintBase::output_filename()
 		m_placeholder_parser.set("print_preset",              new_full_config.option("print_settings_id")->clone());
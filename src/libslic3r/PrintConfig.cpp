@@ -7855,6 +7855,14 @@ CLIActionsConfigDef::CLIActionsConfigDef()
     def->tooltip = L("Send progress to pipe.");
     def->cli_params = "pipename";
     def->set_default_value(new ConfigOptionString());
+
+    def = this->add("service", coString);
+    def->label = L("Slicing service");
+    def->tooltip = L("Run as a slicing service listening on the given UNIX domain socket. The clients load models and settings "
+                     "into sessions and slice them repeatedly, only the steps affected by the changed settings are recalculated. "
+                     "The clients may only access the files inside the output directory, by default the working directory.");
+    def->cli_params = "socket";
+    def->set_default_value(new ConfigOptionString());
 }
 
 //BBS: remove unused command currently
@@ -8093,6 +8101,24 @@ CLIMiscConfigDef::CLIMiscConfigDef()
     def->cli_params = "level";
     def->set_default_value(new ConfigOptionInt(1));
 
+    def = this->add("trace", coString);
+    def->label = L("Trace file");
+    def->tooltip = L("Record the duration of the slicing steps on each thread and export them to the given file in the Chrome trace format.");
+    def->cli_params = "trace.json";
+    def->set_default_value(new ConfigOptionString());
+
+    def = this->add("memory_report", coBool);
+    def->label = L("Memory report");
+    def->tooltip = L("Print the memory held by the slices, extrusions and support layers of each object and by the G-code preview data once a plate is sliced.");
+    def->cli_params = "option";
+    def->set_default_value(new ConfigOptionBool(false));
+
+    def = this->add("release_intermediate_data", coBool);
+    def->label = L("Release intermediate data");
+    def->tooltip = L("Release the slicing data as soon as it is consumed: the intermediate data of the slicing steps once the steps finish and the extrusions of each layer once its G-code is generated. Lowers the peak memory usage of large jobs.");
+    def->cli_params = "option";
+    def->set_default_value(new ConfigOptionBool(false));
+
     def = this->add("enable_timelapse", coBool);
     def->label = L("Enable timelapse for print");
     def->tooltip = L("If enabled, this slicing will be considered using timelapse.");
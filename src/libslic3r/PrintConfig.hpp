@@ -664,8 +664,13 @@ protected:
                 m_keys.emplace_back(kvp.first);
                 const ConfigOptionDef *def = defs->get(kvp.first);
                 assert(def != nullptr);
-                if (def->default_value)
+                if (def->default_value) {
                     opt->set(def->default_value.get());
+                    // Same as ConfigOptionDef::create_default_option(): the generic enum vectors need the keys to serialize their values.
+                    if (def->type == coEnums)
+                        if (auto *opt_enums = dynamic_cast<ConfigOptionEnumsGeneric*>(opt); opt_enums != nullptr)
+                            opt_enums->keys_map = def->enum_keys_map;
+                }
             }
         }
 
@@ -14,10 +14,12 @@
 #include "Surface.hpp"
 #include "Slicing.hpp"
 #include "Tesselate.hpp"
+#include "Trace.hpp"
 #include "TriangleMeshSlicer.hpp"
 #include "Utils.hpp"
 #include "Fill/FillAdaptive.hpp"
 #include "Fill/FillLightning.hpp"
+#include "Fill/FillGyroid.hpp"
 #include "Format/STL.hpp"
 #include "format.hpp"
 
@@ -297,6 +299,7 @@ void PrintObject::make_perimeters()
 
     if (! this->set_started(posPerimeters))
         return;
+    SLIC3R_TRACE_ZONE_OBJECT("PrintObject::make_perimeters", this->id().id);
 
     m_print->set_status(15, L("Generating walls"));
     BOOST_LOG_TRIVIAL(info) << "Generating walls..." << log_memory_info();
@@ -386,6 +389,7 @@ void PrintObject::make_perimeters()
         tbb::blocked_range<size_t>(0, m_layers.size()),
         [this](const tbb::blocked_range<size_t>& range) {
             for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx) {
+                SLIC3R_TRACE_ZONE_LAYER("Layer::make_perimeters", this->id().id, layer_idx);
                 m_print->throw_if_canceled();
                 m_layers[layer_idx]->make_perimeters();
             }
@@ -394,6 +398,13 @@ void PrintObject::make_perimeters()
     m_print->throw_if_canceled();
     BOOST_LOG_TRIVIAL(debug) << "Generating perimeters in parallel - end";
 
+    if (m_config.wall_generator.value == PerimeterGeneratorType::Arachne)
+        for (size_t region_id = 0; region_id < this->num_printing_regions(); ++ region_id) {
+            const Arachne::BeadingCache::Stats stats = this->printing_region(region_id).beading_cache()->stats();
+            BOOST_LOG_TRIVIAL(debug) << "Arachne beading cache of region " << region_id << ": " << stats.hits << " hits, " << stats.misses << " misses, hit rate "
+                                     << 100. * stats.hit_rate() << "%, " << stats.compute_seconds << " s computing, " << stats.saved_seconds() << " s saved";
+        }
+
     this->set_done(posPerimeters);
 }
 
@@ -401,6 +412,7 @@ void PrintObject::prepare_infill()
 {
     if (! this->set_started(posPrepareInfill))
         return;
+    SLIC3R_TRACE_ZONE_OBJECT("PrintObject::prepare_infill", this->id().id);
     m_print->set_status(25, L("Generating infill regions"));
     if (m_typed_slices) {
         // To improve robustness of detect_surfaces_type() when reslicing (working with typed slices), see GH issue #7442.
@@ -542,17 +554,22 @@ void PrintObject::infill()
     this->prepare_infill();
 
     if (this->set_started(posInfill)) {
+        SLIC3R_TRACE_ZONE_OBJECT("PrintObject::infill", this->id().id);
         m_print->set_status(35, L("Generating infill toolpath"));
         const auto& adaptive_fill_octree = this->m_adaptive_fill_octrees.first;
         const auto& support_fill_octree = this->m_adaptive_fill_octrees.second;
+        // The waves may have been generated already by bridge_over_infill().
+        if (! m_gyroid_wave_cache)
+            m_gyroid_wave_cache = std::make_shared<GyroidWaveCache>();
 
         BOOST_LOG_TRIVIAL(debug) << "Filling layers in parallel - start";
         tbb::parallel_for(
             tbb::blocked_range<size_t>(0, m_layers.size()),
             [this, &adaptive_fill_octree = adaptive_fill_octree, &support_fill_octree = support_fill_octree](const tbb::blocked_range<size_t>& range) {
                 for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx) {
+                    SLIC3R_TRACE_ZONE_LAYER("Layer::make_fills", this->id().id, layer_idx);
                     m_print->throw_if_canceled();
-                    m_layers[layer_idx]->make_fills(adaptive_fill_octree.get(), support_fill_octree.get(), this->m_lightning_generator.get());
+                    m_layers[layer_idx]->make_fills(adaptive_fill_octree.get(), support_fill_octree.get(), this->m_lightning_generator.get(), m_gyroid_wave_cache.get());
                 }
             }
         );
@@ -568,6 +585,7 @@ void PrintObject::infill()
 void PrintObject::ironing()
 {
     if (this->set_started(posIroning)) {
+        SLIC3R_TRACE_ZONE_OBJECT("PrintObject::ironing", this->id().id);
         BOOST_LOG_TRIVIAL(debug) << "Ironing in parallel - start";
         tbb::parallel_for(
             // Ironing starting with layer 0 to support ironing all surfaces.
@@ -599,6 +617,7 @@ static const float g_min_overhang_percent_for_lift = 0.3f;
 void PrintObject::detect_overhangs_for_lift()
 {
     if (this->set_started(posDetectOverhangsForLift)) {
+        SLIC3R_TRACE_ZONE_OBJECT("PrintObject::detect_overhangs_for_lift", this->id().id);
         const double nozzle_diameter = m_print->config().nozzle_diameter.get_at(0);
         const coordf_t line_width = this->config().get_abs_value("line_width", nozzle_diameter);
 
@@ -631,7 +650,9 @@ void PrintObject::detect_overhangs_for_lift()
 void PrintObject::generate_support_material()
 {
     if (this->set_started(posSupportMaterial)) {
+        SLIC3R_TRACE_ZONE_OBJECT("PrintObject::generate_support_material", this->id().id);
         this->clear_support_layers();
+        m_support_caches_memsize = 0;
 
         if(!has_support() && !m_print->get_no_check_flag()) {
             // BBS: pop a warning if objects have significant amount of overhangs but support material is not enabled
@@ -678,6 +699,7 @@ void PrintObject::generate_support_material()
 void PrintObject::estimate_curled_extrusions()
 {
     if (this->set_started(posEstimateCurledExtrusions)) {
+        SLIC3R_TRACE_ZONE_OBJECT("PrintObject::estimate_curled_extrusions", this->id().id);
         if ( std::any_of(this->print()->m_print_regions.begin(), this->print()->m_print_regions.end(),
                         [](const PrintRegion *region) { return region->config().enable_overhang_speed.getBool(); })) {
 
@@ -694,56 +716,79 @@ void PrintObject::estimate_curled_extrusions()
     }
 }
 
+//BBS: collect the paths of an extrusion tree, so that the paths of all layers are simplified by a single parallel loop
+template<typename Owner>
+static void collect_paths_to_simplify(Owner *owner, const ExtrusionEntityCollection &collection, std::vector<std::pair<Owner*, ExtrusionPath*>> &out)
+{
+    for (ExtrusionEntity *entity : collection.entities) {
+        if (ExtrusionEntityCollection *sub_collection = dynamic_cast<ExtrusionEntityCollection*>(entity))
+            collect_paths_to_simplify(owner, *sub_collection, out);
+        else if (ExtrusionPath *path = dynamic_cast<ExtrusionPath*>(entity))
+            out.emplace_back(owner, path);
+        else if (ExtrusionMultiPath *multipath = dynamic_cast<ExtrusionMultiPath*>(entity))
+            for (ExtrusionPath &path : multipath->paths)
+                out.emplace_back(owner, &path);
+        else if (ExtrusionLoop *loop = dynamic_cast<ExtrusionLoop*>(entity))
+            for (ExtrusionPath &path : loop->paths)
+                out.emplace_back(owner, &path);
+        else
+            throw Slic3r::InvalidArgument("Invalid extrusion entity supplied to collect_paths_to_simplify()");
+    }
+}
+
 void PrintObject::simplify_extrusion_path()
 {
+    // The paths are distributed over the worker threads one by one rather than layer by layer,
+    // because a few layers may hold most of the paths and the cost of a path grows with its length.
+    auto simplify_paths = [this](const auto &paths, auto simplify_path) {
+        tbb::parallel_for(
+            tbb::blocked_range<size_t>(0, paths.size()),
+            [this, &paths, &simplify_path](const tbb::blocked_range<size_t>& range) {
+                m_print->throw_if_canceled();
+                for (size_t path_idx = range.begin(); path_idx < range.end(); ++ path_idx)
+                    simplify_path(paths[path_idx]);
+            }
+        );
+    };
+
     if (this->set_started(posSimplifyPath)) {
+        SLIC3R_TRACE_ZONE_OBJECT("PrintObject::simplify_wall_extrusion_path", this->id().id);
         m_print->set_status(75, L("Optimizing toolpath"));
         BOOST_LOG_TRIVIAL(debug) << "Simplify extrusion path of object in parallel - start";
         //BBS: infill and walls
-        tbb::parallel_for(
-            tbb::blocked_range<size_t>(0, m_layers.size()),
-            [this](const tbb::blocked_range<size_t>& range) {
-                for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx) {
-                    m_print->throw_if_canceled();
-                    m_layers[layer_idx]->simplify_wall_extrusion_path();
-                }
-            }
-        );
+        std::vector<std::pair<LayerRegion*, ExtrusionPath*>> paths;
+        for (Layer *layer : m_layers)
+            for (LayerRegion *layerm : layer->regions())
+                collect_paths_to_simplify(layerm, layerm->perimeters, paths);
+        simplify_paths(paths, [](const std::pair<LayerRegion*, ExtrusionPath*> &path) { path.first->simplify_path(path.second); });
         m_print->throw_if_canceled();
         BOOST_LOG_TRIVIAL(debug) << "Simplify wall extrusion path of object in parallel - end";
         this->set_done(posSimplifyPath);
     }
 
     if (this->set_started(posSimplifyInfill)) {
+        SLIC3R_TRACE_ZONE_OBJECT("PrintObject::simplify_infill_extrusion_path", this->id().id);
         m_print->set_status(75, L("Optimizing toolpath"));
         BOOST_LOG_TRIVIAL(debug) << "Simplify infill extrusion path of object in parallel - start";
         //BBS: infills
-        tbb::parallel_for(
-            tbb::blocked_range<size_t>(0, m_layers.size()),
-            [this](const tbb::blocked_range<size_t>& range) {
-                for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++layer_idx) {
-                    m_print->throw_if_canceled();
-                    m_layers[layer_idx]->simplify_infill_extrusion_path();
-                }
-            }
-        );
+        std::vector<std::pair<LayerRegion*, ExtrusionPath*>> paths;
+        for (Layer *layer : m_layers)
+            for (LayerRegion *layerm : layer->regions())
+                collect_paths_to_simplify(layerm, layerm->fills, paths);
+        simplify_paths(paths, [](const std::pair<LayerRegion*, ExtrusionPath*> &path) { path.first->simplify_path(path.second); });
         m_print->throw_if_canceled();
         BOOST_LOG_TRIVIAL(debug) << "Simplify infill extrusion path of object in parallel - end";
         this->set_done(posSimplifyInfill);
     }
 
     if (this->set_started(posSimplifySupportPath)) {
+        SLIC3R_TRACE_ZONE_OBJECT("PrintObject::simplify_support_extrusion_path", this->id().id);
         m_print->set_status(75, L("Optimizing toolpath"));
         BOOST_LOG_TRIVIAL(debug) << "Simplify extrusion path of support in parallel - start";
-        tbb::parallel_for(
-            tbb::blocked_range<size_t>(0, m_support_layers.size()),
-            [this](const tbb::blocked_range<size_t>& range) {
-                for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx) {
-                    m_print->throw_if_canceled();
-                    m_support_layers[layer_idx]->simplify_support_extrusion_path();
-                }
-            }
-        );
+        std::vector<std::pair<SupportLayer*, ExtrusionPath*>> paths;
+        for (SupportLayer *support_layer : m_support_layers)
+            collect_paths_to_simplify(support_layer, support_layer->support_fills, paths);
+        simplify_paths(paths, [](const std::pair<SupportLayer*, ExtrusionPath*> &path) { path.first->simplify_support_path(path.second); });
         m_print->throw_if_canceled();
         BOOST_LOG_TRIVIAL(debug) << "Simplify extrusion path of support in parallel - end";
         this->set_done(posSimplifySupportPath);
@@ -809,6 +854,100 @@ void PrintObject::clear_layers()
     }
 }
 
+void PrintObject::clear_beading_caches()
+{
+    if (m_shared_regions)
+        for (size_t region_id = 0; region_id < this->num_printing_regions(); ++ region_id)
+            this->printing_region(region_id).beading_cache()->clear();
+}
+
+PrintObjectMemoryUsage PrintObject::memory_usage() const
+{
+    PrintObjectMemoryUsage out;
+    if (m_shared_object)
+        return out;
+    for (const Layer *layer : m_layers) {
+        out.slices += sizeof(Layer) + memsize(layer->lslices) + memsize(layer->lslices_extrudable) + layer->lslices_bboxes.capacity() * sizeof(BoundingBox);
+        for (const LayerRegion *layerm : layer->regions()) {
+            out.slices        += sizeof(LayerRegion) + memsize(layerm->slices) + memsize(layerm->raw_slices);
+            out.perimeters    += memsize(layerm->perimeters) + memsize(layerm->thin_fills) + memsize(layerm->fill_expolygons) + memsize(layerm->fill_no_overlap_expolygons);
+            out.fill_surfaces += memsize(layerm->fill_surfaces) + memsize(layerm->unsupported_bridge_edges);
+            out.fills         += memsize(layerm->fills);
+        }
+    }
+    for (const SupportLayer *layer : m_support_layers)
+        out.support_layers += sizeof(SupportLayer) + memsize(layer->support_islands) + memsize(layer->support_fills) + memsize(layer->base_areas) +
+            memsize(layer->roof_areas) + memsize(layer->roof_1st_layer) + memsize(layer->floor_areas) + memsize(layer->roof_gap_areas) +
+            layer->area_groups.capacity() * sizeof(SupportLayer::AreaGroup);
+    out.support_caches = m_support_caches_memsize + (m_tree_support_overhangs ? m_tree_support_overhangs->memsize() : 0);
+    return out;
+}
+
+void PrintObject::release_intermediate_data(PrintObjectStep step)
+{
+    if (m_shared_object)
+        // The layers are owned and released by the shared object.
+        return;
+    // The G-code generator works with the lslices, the typed slices, the fill surfaces (avoid crossing perimeters),
+    // the raw slices (tool ordering) and the extrusions. All the other per layer data is only consumed by the object steps.
+    if (step == posInfill) {
+        assert(this->is_step_done(posInfill));
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, m_layers.size()), [this](const tbb::blocked_range<size_t> &range) {
+            for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx)
+                for (LayerRegion *layerm : m_layers[layer_idx]->regions()) {
+                    // Already copied to LayerRegion::fills by Layer::make_fills().
+                    layerm->thin_fills.clear();
+                    layerm->thin_fills.entities.shrink_to_fit();
+                    ExPolygons().swap(layerm->fill_expolygons);
+                    ExPolygons().swap(layerm->fill_no_overlap_expolygons);
+                }
+        });
+        m_adaptive_fill_octrees.first.reset();
+        m_adaptive_fill_octrees.second.reset();
+        m_lightning_generator.reset();
+        m_gyroid_wave_cache.reset();
+        this->clear_beading_caches();
+    } else if (step == posSupportMaterial) {
+        assert(this->is_step_done(posSupportMaterial));
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, m_layers.size()), [this](const tbb::blocked_range<size_t> &range) {
+            for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx) {
+                Layer *layer = m_layers[layer_idx];
+                ExPolygons().swap(layer->lslices_extrudable);
+                ExPolygons().swap(layer->sharp_tails);
+                ExPolygons().swap(layer->cantilevers);
+                std::vector<float>().swap(layer->sharp_tails_height);
+                for (LayerRegion *layerm : layer->regions())
+                    Polylines().swap(layerm->unsupported_bridge_edges);
+            }
+        });
+        m_tree_support_preview_cache.reset();
+        m_tree_support_overhangs.reset();
+    } else
+        assert(false);
+}
+
+void PrintObject::release_layer_extrusions(const Layer *object_layer, const SupportLayer *support_layer)
+{
+    // The layer outlines, the typed slices and the fill surfaces are kept, as they are referenced by the travel planning
+    // and the extrusion quality estimation of the layers above.
+    if (object_layer != nullptr) {
+        Layer *layer = this->get_layer_at_printz(object_layer->print_z);
+        assert(layer == object_layer);
+        for (LayerRegion *layerm : layer->regions()) {
+            layerm->perimeters.clear();
+            layerm->perimeters.entities.shrink_to_fit();
+            layerm->fills.clear();
+            layerm->fills.entities.shrink_to_fit();
+        }
+    }
+    if (support_layer != nullptr) {
+        SupportLayer *layer = this->get_support_layer_at_printz(support_layer->print_z, EPSILON);
+        assert(layer == support_layer);
+        layer->support_fills.clear();
+        layer->support_fills.entities.shrink_to_fit();
+    }
+}
+
 Layer* PrintObject::add_layer(int id, coordf_t height, coordf_t print_z, coordf_t slice_z)
 {
     m_layers.emplace_back(new Layer(id, this, height, print_z, slice_z));
@@ -1228,6 +1367,9 @@ bool PrintObject::invalidate_step(PrintObjectStep step)
     if (step == posPerimeters) {
 		invalidated |= this->invalidate_steps({ posPrepareInfill, posInfill, posIroning, posSimplifyPath, posSimplifyInfill });
         invalidated |= m_print->invalidate_steps({ psSkirtBrim });
+        // Tree support does not add bridging perimeters to the overhangs.
+        m_tree_support_overhangs.reset();
+        this->clear_beading_caches();
     } else if (step == posPrepareInfill) {
         invalidated |= this->invalidate_steps({ posInfill, posIroning, posSimplifyPath, posSimplifyInfill });
     } else if (step == posInfill) {
@@ -1237,11 +1379,16 @@ bool PrintObject::invalidate_step(PrintObjectStep step)
 		invalidated |= this->invalidate_steps({ posPerimeters, posPrepareInfill, posInfill, posIroning, posSupportMaterial, posSimplifyPath, posSimplifyInfill });
         invalidated |= m_print->invalidate_steps({ psSkirtBrim });
         m_slicing_params.valid = false;
+        m_tree_support_overhangs.reset();
+        this->clear_beading_caches();
     } else if (step == posSupportMaterial) {
         invalidated |= this->invalidate_steps({ posSimplifySupportPath });
         invalidated |= m_print->invalidate_steps({ psSkirtBrim });
         m_slicing_params.valid = false;
     }
+    if (step == posSlice || step == posPerimeters || step == posPrepareInfill || step == posInfill)
+        // The infill is invalidated, the gyroid waves will be computed for the new infill parameters.
+        m_gyroid_wave_cache.reset();
 
     // Wipe tower depends on the ordering of extruders, which in turn depends on everything.
     // It also decides about what the flush_into_infill / wipe_into_object / flush_into_support features will do,
@@ -1258,6 +1405,7 @@ bool PrintObject::invalidate_all_steps()
     bool result = Inherited::invalidate_all_steps() | m_print->invalidate_all_steps();
 	// Then reset some of the depending values.
 	m_slicing_params.valid = false;
+    m_tree_support_overhangs.reset();
 	return result;
 }
 
@@ -1272,6 +1420,7 @@ bool PrintObject::invalidate_all_steps()
 // If a part of a region is of stBottom and stTop, the stBottom wins.
 void PrintObject::detect_surfaces_type()
 {
+    SLIC3R_TRACE_ZONE_OBJECT("PrintObject::detect_surfaces_type", this->id().id);
     BOOST_LOG_TRIVIAL(info) << "Detecting solid surfaces..." << log_memory_info();
 
     // Interface shells: the intersecting parts are treated as self standing objects supporting each other.
@@ -1613,6 +1762,7 @@ void PrintObject::detect_surfaces_type()
 
 void PrintObject::process_external_surfaces()
 {
+    SLIC3R_TRACE_ZONE_OBJECT("PrintObject::process_external_surfaces", this->id().id);
     BOOST_LOG_TRIVIAL(info) << "Processing external surfaces..." << log_memory_info();
 
     // Cached surfaces covered by some extrusion, defining regions, over which the from the surfaces one layer higher are allowed to expand.
@@ -1695,6 +1845,7 @@ void PrintObject::process_external_surfaces()
 
 void PrintObject::discover_vertical_shells()
 {
+    SLIC3R_TRACE_ZONE_OBJECT("PrintObject::discover_vertical_shells", this->id().id);
     PROFILE_FUNC();
 
     BOOST_LOG_TRIVIAL(info) << "Discovering vertical shells..." << log_memory_info();
@@ -2155,6 +2306,7 @@ template<typename T> void debug_draw(std::string name, const T& a, const T& b, c
 // This method applies bridge flow to the first internal solid layer above sparse infill.
 void PrintObject::bridge_over_infill()
 {
+    SLIC3R_TRACE_ZONE_OBJECT("PrintObject::bridge_over_infill", this->id().id);
     BOOST_LOG_TRIVIAL(info) << "Bridge over infill - Start" << log_memory_info();
     struct CandidateSurface
     {
@@ -2374,6 +2526,8 @@ void PrintObject::bridge_over_infill()
         }
 
         this->m_adaptive_fill_octrees = this->prepare_adaptive_infill_data(surfaces_w_bottom_z);
+        if (! this->m_gyroid_wave_cache)
+            this->m_gyroid_wave_cache = std::make_shared<GyroidWaveCache>();
 
         std::vector<size_t> layers_to_generate_infill;
         for (const auto &pair : surfaces_by_layer) {
@@ -2391,7 +2545,8 @@ void PrintObject::bridge_over_infill()
                 infill_lines.at(
                     lidx) = po->get_layer(lidx)->generate_sparse_infill_polylines_for_anchoring(po->m_adaptive_fill_octrees.first.get(),
                                                                                                 po->m_adaptive_fill_octrees.second.get(),
-                                                                                                po->m_lightning_generator.get());
+                                                                                                po->m_lightning_generator.get(),
+                                                                                                po->m_gyroid_wave_cache.get());
             }
         });
 #ifdef DEBUG_BRIDGE_OVER_INFILL
@@ -3395,6 +3550,7 @@ Points PrintObject::get_instances_shift_without_plate_offset()
 // fill_surfaces but we only turn them into VOID surfaces, thus preserving the boundaries.
 void PrintObject::clip_fill_surfaces()
 {
+    SLIC3R_TRACE_ZONE_OBJECT("PrintObject::clip_fill_surfaces", this->id().id);
     if (! PrintObject::infill_only_where_needed)
         return;
     bool has_infill = false;
@@ -3406,34 +3562,71 @@ void PrintObject::clip_fill_surfaces()
     if (! has_infill)
         return;
 
+    // Surfaces of a layer, which are not modified by the sweep below, collected in parallel for a batch of layers
+    // ahead of the sweep. The sweep only modifies the internal and void surfaces of a layer after the layer above it was processed.
+    struct LayerSurfaces {
+        // Solid surfaces to be supported.
+        Polygons overhangs;
+        // Cummulative fill surfaces before the sweep.
+        Polygons fill_surfaces;
+        // Internal and void surfaces before the sweep.
+        Polygons internal_surfaces;
+        // Minimum perimeter width of the regions.
+        float    perimeter_width { FLT_MAX };
+    };
+    // Only the surfaces of a batch of layers are held, not copies of the surfaces of all the layers.
+    static constexpr const size_t batch_size = 64;
+    std::vector<LayerSurfaces> layer_surfaces(m_layers.size());
+    size_t                     collected_begin = m_layers.size();
+    auto collect_layer_surfaces = [this, &layer_surfaces](size_t begin, size_t end) {
+        tbb::parallel_for(
+            tbb::blocked_range<size_t>(begin, end),
+            [this, &layer_surfaces](const tbb::blocked_range<size_t>& range) {
+                for (size_t layer_id = range.begin(); layer_id < range.end(); ++ layer_id) {
+                    m_print->throw_if_canceled();
+                    LayerSurfaces &out = layer_surfaces[layer_id];
+                    for (const LayerRegion *layerm : m_layers[layer_id]->m_regions) {
+                        for (const Surface &surface : layerm->fill_surfaces.surfaces) {
+                            Polygons polygons = to_polygons(surface.expolygon);
+                            if (surface.is_solid())
+                                polygons_append(out.overhangs, polygons);
+                            if (surface.surface_type == stInternal || surface.surface_type == stInternalVoid)
+                                polygons_append(out.internal_surfaces, polygons);
+                            polygons_append(out.fill_surfaces, std::move(polygons));
+                        }
+                        out.perimeter_width = std::min(out.perimeter_width, (float)layerm->flow(frPerimeter).scaled_width());
+                    }
+                }
+            });
+    };
+
     // We only want infill under ceilings; this is almost like an
     // internal support material.
     // Proceed top-down, skipping the bottom layer.
+    // The overhangs accumulate from the top down, thus the sweep itself is serial.
     Polygons upper_internal;
     for (int layer_id = int(m_layers.size()) - 1; layer_id > 0; -- layer_id) {
+        if (size_t(layer_id - 1) < collected_begin) {
+            // None of the layers of the next batch was modified by the sweep yet.
+            const size_t begin = size_t(layer_id) > batch_size ? size_t(layer_id) - batch_size : 0;
+            collect_layer_surfaces(begin, collected_begin);
+            collected_begin = begin;
+        }
         Layer *layer       = m_layers[layer_id];
         Layer *lower_layer = m_layers[layer_id - 1];
         // Detect things that we need to support.
-        // Cummulative fill surfaces.
+        // Cummulative fill surfaces, the internal surfaces were modified when processing the layer above.
         Polygons fill_surfaces;
-        // Solid surfaces to be supported.
-        Polygons overhangs;
-        for (const LayerRegion *layerm : layer->m_regions)
-            for (const Surface &surface : layerm->fill_surfaces.surfaces) {
-                Polygons polygons = to_polygons(surface.expolygon);
-                if (surface.is_solid())
-                    polygons_append(overhangs, polygons);
-                polygons_append(fill_surfaces, std::move(polygons));
-            }
-        Polygons lower_layer_fill_surfaces;
-        Polygons lower_layer_internal_surfaces;
-        for (const LayerRegion *layerm : lower_layer->m_regions)
-            for (const Surface &surface : layerm->fill_surfaces.surfaces) {
-                Polygons polygons = to_polygons(surface.expolygon);
-                if (surface.surface_type == stInternal || surface.surface_type == stInternalVoid)
-                    polygons_append(lower_layer_internal_surfaces, polygons);
-                polygons_append(lower_layer_fill_surfaces, std::move(polygons));
-            }
+        if (layer_id + 1 == int(m_layers.size()))
+            fill_surfaces = std::move(layer_surfaces[layer_id].fill_surfaces);
+        else
+            for (const LayerRegion *layerm : layer->m_regions)
+                for (const Surface &surface : layerm->fill_surfaces.surfaces)
+                    polygons_append(fill_surfaces, to_polygons(surface.expolygon));
+        // Solid surfaces to be supported, they were not modified by the sweep.
+        Polygons overhangs = std::move(layer_surfaces[layer_id].overhangs);
+        const Polygons &lower_layer_fill_surfaces     = layer_surfaces[layer_id - 1].fill_surfaces;
+        const Polygons &lower_layer_internal_surfaces = layer_surfaces[layer_id - 1].internal_surfaces;
         // We also need to support perimeters when there's at least one full unsupported loop
         {
             // Get perimeters area as the difference between slices and fill_surfaces
@@ -3442,9 +3635,7 @@ void PrintObject::clip_fill_surfaces()
             // Only consider perimeter areas that are at least one extrusion width thick.
             //FIXME Offset2 eats out from both sides, while the perimeters are create outside in.
             //Should the pw not be half of the current value?
-            float pw = FLT_MAX;
-            for (const LayerRegion *layerm : layer->m_regions)
-                pw = std::min(pw, (float)layerm->flow(frPerimeter).scaled_width());
+            float pw = layer_surfaces[layer_id].perimeter_width;
             // Append such thick perimeters to the areas that need support
             polygons_append(overhangs, opening(perimeters, pw));
         }
@@ -3458,223 +3649,326 @@ void PrintObject::clip_fill_surfaces()
                 scaled<coord_t>(0.1)),
             lower_layer_internal_surfaces);
         // Apply new internal infill to regions.
-        for (LayerRegion *layerm : lower_layer->m_regions) {
-            if (layerm->region().config().sparse_infill_density.value == 0)
-                continue;
-            Polygons internal;
-            for (Surface &surface : layerm->fill_surfaces.surfaces)
-                if (surface.surface_type == stInternal || surface.surface_type == stInternalVoid)
-                    polygons_append(internal, std::move(surface.expolygon));
-            layerm->fill_surfaces.remove_types({ stInternal, stInternalVoid });
-            layerm->fill_surfaces.append(intersection_ex(internal, upper_internal, ApplySafetyOffset::Yes), stInternal);
-            layerm->fill_surfaces.append(diff_ex        (internal, upper_internal, ApplySafetyOffset::Yes), stInternalVoid);
-            // If there are voids it means that our internal infill is not adjacent to
-            // perimeters. In this case it would be nice to add a loop around infill to
-            // make it more robust and nicer. TODO.
+        tbb::parallel_for(
+            tbb::blocked_range<size_t>(0, lower_layer->m_regions.size()),
+            [lower_layer, &upper_internal](const tbb::blocked_range<size_t>& range) {
+                for (size_t region_id = range.begin(); region_id < range.end(); ++ region_id) {
+                    LayerRegion *layerm = lower_layer->m_regions[region_id];
+                    if (layerm->region().config().sparse_infill_density.value == 0)
+                        continue;
+                    Polygons internal;
+                    for (Surface &surface : layerm->fill_surfaces.surfaces)
+                        if (surface.surface_type == stInternal || surface.surface_type == stInternalVoid)
+                            polygons_append(internal, std::move(surface.expolygon));
+                    layerm->fill_surfaces.remove_types({ stInternal, stInternalVoid });
+                    layerm->fill_surfaces.append(intersection_ex(internal, upper_internal, ApplySafetyOffset::Yes), stInternal);
+                    layerm->fill_surfaces.append(diff_ex        (internal, upper_internal, ApplySafetyOffset::Yes), stInternalVoid);
+                    // If there are voids it means that our internal infill is not adjacent to
+                    // perimeters. In this case it would be nice to add a loop around infill to
+                    // make it more robust and nicer. TODO.
 #ifdef SLIC3R_DEBUG_SLICE_PROCESSING
-            layerm->export_region_fill_surfaces_to_svg_debug("6_clip_fill_surfaces");
+                    layerm->export_region_fill_surfaces_to_svg_debug("6_clip_fill_surfaces");
 #endif
-        }
+                }
+            });
+        // Release the surfaces of the upper layer, which are not needed anymore.
+        layer_surfaces[layer_id] = LayerSurfaces();
         m_print->throw_if_canceled();
     }
 }
 
 void PrintObject::discover_horizontal_shells()
 {
+    SLIC3R_TRACE_ZONE_OBJECT("PrintObject::discover_horizontal_shells", this->id().id);
     BOOST_LOG_TRIVIAL(trace) << "discover_horizontal_shells()";
 
-    for (size_t region_id = 0; region_id < this->num_printing_regions(); ++ region_id) {
-        for (size_t i = 0; i < m_layers.size(); ++ i) {
-            m_print->throw_if_canceled();
-            Layer 					*layer  = m_layers[i];
-            LayerRegion             *layerm = layer->regions()[region_id];
-            const PrintRegionConfig &region_config = layerm->region().config();
-
-            if (!region_config.extra_solid_infills.value.empty() &&
-                check_layer_id_pattern(region_config.extra_solid_infills.value, i)) {
-                // Insert a solid internal layer. Mark stInternal surfaces as stInternalSolid.
-                for (Surface& surface : layerm->fill_surfaces.surfaces)
-                    if (surface.surface_type == stInternal)
-                        surface.surface_type = stInternalSolid;
+    // The top / bottom surfaces of a layer are scattered to the neighbor layers as internal solid surfaces. The neighbor layers
+    // are modified one after the other, thus a shell propagates over the surfaces already modified by the shells of the other layers.
+    // To get the very same surfaces as by scattering the layers one after the other, the scatter is split into steps modifying
+    // a single layer region each. The steps modifying the same layer region are executed in the order of the serial scatter,
+    // the steps modifying different layer regions do not depend on each other and they are executed in parallel.
+
+    // Shell scattered from the top / bottom surfaces of a layer region to the neighbor layers.
+    struct Shell {
+        size_t      layer_id;
+        SurfaceType type;
+        // Last neighbor layer reached by the shell.
+        size_t      last_layer_id;
+        // Top / bottom area of the layer region, limiting the shell on the following neighbor layers.
+        Polygons    solid;
+        // The shell does not propagate to the following neighbor layers.
+        bool        finished { false };
+    };
+    // Step of the scatter modifying a single layer region: Either the turn of the layer region itself, which inserts the extra solid
+    // infill and collects the top / bottom areas of its shells, or the propagation of a shell to a neighbor layer region.
+    struct Step {
+        size_t region_id;
+        size_t layer_id;
+        // Index of the propagated shell, NO_SHELL for the turn of the layer region.
+        size_t shell_id;
+    };
+    static constexpr const size_t NO_SHELL = std::numeric_limits<size_t>::max();
+
+    const size_t num_layers  = m_layers.size();
+    const size_t num_regions = this->num_printing_regions();
+    std::vector<Shell>                     shells;
+    // Range of the shells of a layer region, indexed by region_id * num_layers + layer_id.
+    std::vector<std::pair<size_t, size_t>> layer_shells(num_regions * num_layers, { 0, 0 });
+    // Steps executed in parallel, round by round.
+    std::vector<std::vector<Step>>         rounds;
+    {
+        // First round, in which the next step modifying a layer region of the current region may be executed.
+        std::vector<size_t> next_round;
+        // Returns the first round, in which the next step of the same shell may be executed.
+        auto add_step = [&rounds, &next_round](const Step &step, size_t min_round) {
+            size_t round = std::max(min_round, next_round[step.layer_id]);
+            next_round[step.layer_id] = round + 1;
+            if (rounds.size() <= round)
+                rounds.resize(round + 1);
+            rounds[round].push_back(step);
+            return round + 1;
+        };
+        for (size_t region_id = 0; region_id < num_regions; ++ region_id) {
+            const PrintRegionConfig &region_config = this->printing_region(region_id).config();
+            next_round.assign(num_layers, 0);
+            for (size_t i = 0; i < num_layers; ++ i) {
+                // The shells of the layer region may only propagate after its turn.
+                const size_t after_turn = add_step({ region_id, i, NO_SHELL }, 0);
+                // If ensure_vertical_shell_thickness, then the rest has already been performed by discover_vertical_shells().
+                if (region_config.ensure_vertical_shell_thickness.value == evstAll)
+                    continue;
+                const LayerRegion *layerm   = m_layers[i]->regions()[region_id];
+                coordf_t           print_z  = m_layers[i]->print_z;
+                coordf_t           bottom_z = m_layers[i]->bottom_z();
+                layer_shells[region_id * num_layers + i].first = shells.size();
+                for (size_t idx_surface_type = 0; idx_surface_type < 3; ++ idx_surface_type) {
+                    SurfaceType type = (idx_surface_type == 0) ? stTop : (idx_surface_type == 1) ? stBottom : stBottomBridge;
+                    int num_solid_layers = (type == stTop) ? region_config.top_shell_layers.value : region_config.bottom_shell_layers.value;
+                    if (num_solid_layers == 0)
+                        continue;
+                    // The scatter never adds surfaces of a new type to a layer region, thus a layer region without surfaces of this type
+                    // will not have any top / bottom area to scatter at its turn.
+                    auto has_type = [type](const Surface &surface) { return surface.surface_type == type; };
+                    if (std::none_of(layerm->slices.surfaces.begin(), layerm->slices.surfaces.end(), has_type) &&
+                        std::none_of(layerm->fill_surfaces.surfaces.begin(), layerm->fill_surfaces.surfaces.end(), has_type))
+                        continue;
+                    size_t shell_id = shells.size();
+                    shells.push_back({ i, type, i });
+                    size_t min_round = after_turn;
+                    for (int n = (type == stTop) ? int(i) - 1 : int(i) + 1;
+                        (type == stTop) ?
+                            (n >= 0                   && (int(i) - n < num_solid_layers ||
+                                                          print_z - m_layers[n]->print_z < region_config.top_shell_thickness.value - EPSILON)) :
+                            (n < int(num_layers)      && (n - int(i) < num_solid_layers ||
+                                                          m_layers[n]->bottom_z() - bottom_z < region_config.bottom_shell_thickness.value - EPSILON));
+                        (type == stTop) ? -- n : ++ n) {
+                        min_round = add_step({ region_id, size_t(n), shell_id }, min_round);
+                        shells[shell_id].last_layer_id = size_t(n);
+                    }
+                    if (shells[shell_id].last_layer_id == i)
+                        // There is no neighbor layer to propagate the shell to.
+                        shells.pop_back();
+                }
+                layer_shells[region_id * num_layers + i].second = shells.size();
             }
+        }
+    }
 
-            // If ensure_vertical_shell_thickness, then the rest has already been performed by discover_vertical_shells().
-            if (region_config.ensure_vertical_shell_thickness.value == evstAll)
-                continue;
+    // Turn of a layer region: Insert the extra solid infill and collect the top / bottom areas of its shells.
+    auto turn = [this, &shells, &layer_shells, num_layers](const Step &step) {
+        LayerRegion             *layerm        = m_layers[step.layer_id]->regions()[step.region_id];
+        const PrintRegionConfig &region_config = layerm->region().config();
+
+        if (!region_config.extra_solid_infills.value.empty() &&
+            check_layer_id_pattern(region_config.extra_solid_infills.value, step.layer_id)) {
+            // Insert a solid internal layer. Mark stInternal surfaces as stInternalSolid.
+            for (Surface& surface : layerm->fill_surfaces.surfaces)
+                if (surface.surface_type == stInternal)
+                    surface.surface_type = stInternalSolid;
+        }
 
-            coordf_t print_z  = layer->print_z;
-            coordf_t bottom_z = layer->bottom_z();
-            for (size_t idx_surface_type = 0; idx_surface_type < 3; ++ idx_surface_type) {
-                m_print->throw_if_canceled();
-                SurfaceType type = (idx_surface_type == 0) ? stTop : (idx_surface_type == 1) ? stBottom : stBottomBridge;
-                int num_solid_layers = (type == stTop) ? region_config.top_shell_layers.value : region_config.bottom_shell_layers.value;
-                if (num_solid_layers == 0)
-                	continue;
-                // Find slices of current type for current layer.
-                // Use slices instead of fill_surfaces, because they also include the perimeter area,
-                // which needs to be propagated in shells; we need to grow slices like we did for
-                // fill_surfaces though. Using both ungrown slices and grown fill_surfaces will
-                // not work in some situations, as there won't be any grown region in the perimeter
-                // area (this was seen in a model where the top layer had one extra perimeter, thus
-                // its fill_surfaces were thinner than the lower layer's infill), however it's the best
-                // solution so far. Growing the external slices by EXTERNAL_INFILL_MARGIN will put
-                // too much solid infill inside nearly-vertical slopes.
-
-                // Surfaces including the area of perimeters. Everything, that is visible from the top / bottom
-                // (not covered by a layer above / below).
-                // This does not contain the areas covered by perimeters!
-                Polygons solid;
-                for (const Surface &surface : layerm->slices.surfaces)
-                    if (surface.surface_type == type)
-                        polygons_append(solid, to_polygons(surface.expolygon));
-                // Infill areas (slices without the perimeters).
-                for (const Surface &surface : layerm->fill_surfaces.surfaces)
-                    if (surface.surface_type == type)
-                        polygons_append(solid, to_polygons(surface.expolygon));
-                if (solid.empty())
-                    continue;
-//                Slic3r::debugf "Layer %d has %s surfaces\n", $i, ($type == stTop) ? 'top' : 'bottom';
-
-                // Scatter top / bottom regions to other layers. Scattering process is inherently serial, it is difficult to parallelize without locking.
-                for (int n = (type == stTop) ? int(i) - 1 : int(i) + 1;
-                	(type == stTop) ?
-                		(n >= 0                   && (int(i) - n < num_solid_layers ||
-                								 	  print_z - m_layers[n]->print_z < region_config.top_shell_thickness.value - EPSILON)) :
-                		(n < int(m_layers.size()) && (n - int(i) < num_solid_layers ||
-                									  m_layers[n]->bottom_z() - bottom_z < region_config.bottom_shell_thickness.value - EPSILON));
-                	(type == stTop) ? -- n : ++ n)
-                {
-//                    Slic3r::debugf "  looking for neighbors on layer %d...\n", $n;
-                    // Reference to the lower layer of a TOP surface, or an upper layer of a BOTTOM surface.
-                    LayerRegion *neighbor_layerm = m_layers[n]->regions()[region_id];
-
-                    // find intersection between neighbor and current layer's surfaces
-                    // intersections have contours and holes
-                    // we update $solid so that we limit the next neighbor layer to the areas that were
-                    // found on this one - in other words, solid shells on one layer (for a given external surface)
-                    // are always a subset of the shells found on the previous shell layer
-                    // this approach allows for DWIM in hollow sloping vases, where we want bottom
-                    // shells to be generated in the base but not in the walls (where there are many
-                    // narrow bottom surfaces): reassigning $solid will consider the 'shadow' of the
-                    // upper perimeter as an obstacle and shell will not be propagated to more upper layers
-                    //FIXME How does it work for stInternalBRIDGE? This is set for sparse infill. Likely this does not work.
-                    Polygons new_internal_solid;
-                    {
-                        Polygons internal;
-                        for (const Surface &surface : neighbor_layerm->fill_surfaces.surfaces)
-                            if (surface.surface_type == stInternal || surface.surface_type == stInternalSolid)
-                                polygons_append(internal, to_polygons(surface.expolygon));
-                        new_internal_solid = intersection(solid, internal, ApplySafetyOffset::Yes);
-                    }
-                    if (new_internal_solid.empty()) {
-                        // No internal solid needed on this layer. In order to decide whether to continue
-                        // searching on the next neighbor (thus enforcing the configured number of solid
-                        // layers, use different strategies according to configured infill density:
-                        
-                        // Orca: Also use the same strategy if the user has selected to further reduce
-                        // the amount of solid infill on walls.
-                        if (region_config.sparse_infill_density.value == 0 || region_config.ensure_vertical_shell_thickness.value == evstCriticalOnly || region_config.ensure_vertical_shell_thickness.value == evstNone) {
-                            // If user expects the object to be void (for example a hollow sloping vase),
-                            // don't continue the search. In this case, we only generate the external solid
-                            // shell if the object would otherwise show a hole (gap between perimeters of
-                            // the two layers), and internal solid shells are a subset of the shells found
-                            // on each previous layer.
-                            goto EXTERNAL;
-                        } else {
-                            // If we have internal infill, we can generate internal solid shells freely.
-                            continue;
-                        }
-                    }
+        auto [shells_begin, shells_end] = layer_shells[step.region_id * num_layers + step.layer_id];
+        for (size_t shell_id = shells_begin; shell_id < shells_end; ++ shell_id) {
+            Shell &shell = shells[shell_id];
+            // Find slices of current type for current layer.
+            // Use slices instead of fill_surfaces, because they also include the perimeter area,
+            // which needs to be propagated in shells; we need to grow slices like we did for
+            // fill_surfaces though. Using both ungrown slices and grown fill_surfaces will
+            // not work in some situations, as there won't be any grown region in the perimeter
+            // area (this was seen in a model where the top layer had one extra perimeter, thus
+            // its fill_surfaces were thinner than the lower layer's infill), however it's the best
+            // solution so far. Growing the external slices by EXTERNAL_INFILL_MARGIN will put
+            // too much solid infill inside nearly-vertical slopes.
+
+            // Surfaces including the area of perimeters. Everything, that is visible from the top / bottom
+            // (not covered by a layer above / below).
+            // This does not contain the areas covered by perimeters!
+            for (const Surface &surface : layerm->slices.surfaces)
+                if (surface.surface_type == shell.type)
+                    polygons_append(shell.solid, to_polygons(surface.expolygon));
+            // Infill areas (slices without the perimeters).
+            for (const Surface &surface : layerm->fill_surfaces.surfaces)
+                if (surface.surface_type == shell.type)
+                    polygons_append(shell.solid, to_polygons(surface.expolygon));
+            shell.finished = shell.solid.empty();
+        }
+    };
 
-                    float factor = 0.0f;
-                    if (region_config.sparse_infill_density.value == 0)
-                        factor = 1.0f;
-                    else if (region_config.ensure_vertical_shell_thickness.value == evstNone)
-                        factor = 0.5f;
-                    else if (region_config.ensure_vertical_shell_thickness.value == evstCriticalOnly)
-                        factor = 0.2f;
-                    if (factor > 0.0f) {
-                        // if we're printing a hollow object we discard any solid shell thinner
-                        // than a perimeter width, since it's probably just crossing a sloping wall
-                        // and it's not wanted in a hollow print even if it would make sense when
-                        // obeying the solid shell count option strictly (DWIM!)
-
-                        // Orca: Also use the same strategy if the user has selected to reduce
-                        // the amount of solid infill on walls. However reduce the margin to 20% overhang
-                        // as we want to generate infill on sloped vertical surfaces but still keep a small amount of
-                        // filtering. This is an arbitrary value to make this option safe
-                        // by ensuring that top surfaces, especially slanted ones dont go **completely** unsupported
-                        // especially when using single perimeter top layers.
-                        float    margin     = float(neighbor_layerm->flow(frExternalPerimeter).scaled_width()) * factor;
-                        Polygons too_narrow = diff(new_internal_solid,
-                                                   opening(new_internal_solid, margin, margin + ClipperSafetyOffset, jtMiter, 5));
-                        // Trim the regularized region by the original region.
-                        if (!too_narrow.empty())
-                            new_internal_solid = solid = diff(new_internal_solid, too_narrow);
-                    }
+    // Propagate a shell to a neighbor layer region.
+    auto propagate = [this, &shells](const Step &step) {
+        Shell &shell = shells[step.shell_id];
+        if (shell.finished)
+            return;
+        // Layer region of the top / bottom surface scattered.
+        const LayerRegion       *layerm        = m_layers[shell.layer_id]->regions()[step.region_id];
+        const PrintRegionConfig &region_config = layerm->region().config();
+        // Reference to the lower layer of a TOP surface, or an upper layer of a BOTTOM surface.
+        LayerRegion             *neighbor_layerm = m_layers[step.layer_id]->regions()[step.region_id];
+        Polygons                &solid           = shell.solid;
+
+        // find intersection between neighbor and current layer's surfaces
+        // intersections have contours and holes
+        // we update $solid so that we limit the next neighbor layer to the areas that were
+        // found on this one - in other words, solid shells on one layer (for a given external surface)
+        // are always a subset of the shells found on the previous shell layer
+        // this approach allows for DWIM in hollow sloping vases, where we want bottom
+        // shells to be generated in the base but not in the walls (where there are many
+        // narrow bottom surfaces): reassigning $solid will consider the 'shadow' of the
+        // upper perimeter as an obstacle and shell will not be propagated to more upper layers
+        //FIXME How does it work for stInternalBRIDGE? This is set for sparse infill. Likely this does not work.
+        Polygons new_internal_solid;
+        {
+            Polygons internal;
+            for (const Surface &surface : neighbor_layerm->fill_surfaces.surfaces)
+                if (surface.surface_type == stInternal || surface.surface_type == stInternalSolid)
+                    polygons_append(internal, to_polygons(surface.expolygon));
+            new_internal_solid = intersection(solid, internal, ApplySafetyOffset::Yes);
+        }
+        if (new_internal_solid.empty()) {
+            // No internal solid needed on this layer. In order to decide whether to continue
+            // searching on the next neighbor (thus enforcing the configured number of solid
+            // layers, use different strategies according to configured infill density:
+
+            // Orca: Also use the same strategy if the user has selected to further reduce
+            // the amount of solid infill on walls.
+            if (region_config.sparse_infill_density.value == 0 || region_config.ensure_vertical_shell_thickness.value == evstCriticalOnly || region_config.ensure_vertical_shell_thickness.value == evstNone) {
+                // If user expects the object to be void (for example a hollow sloping vase),
+                // don't continue the search. In this case, we only generate the external solid
+                // shell if the object would otherwise show a hole (gap between perimeters of
+                // the two layers), and internal solid shells are a subset of the shells found
+                // on each previous layer.
+                shell.finished = true;
+                solid.clear();
+            }
+            // If we have internal infill, we can generate internal solid shells freely.
+            return;
+        }
 
-                    // make sure the new internal solid is wide enough, as it might get collapsed
-                    // when spacing is added in Fill.pm
-                    {
-                        //FIXME Vojtech: Disable this and you will be sorry.
-                        float margin = (region_config.ensure_vertical_shell_thickness.value != evstNone ? 3.f : 1.0f) * layerm->flow(frSolidInfill).scaled_width(); // require at least this size
-                        // we use a higher miterLimit here to handle areas with acute angles
-                        // in those cases, the default miterLimit would cut the corner and we'd
-                        // get a triangle in $too_narrow; if we grow it below then the shell
-                        // would have a different shape from the external surface and we'd still
-                        // have the same angle, so the next shell would be grown even more and so on.
-                        Polygons too_narrow = diff(
-                            new_internal_solid,
-                            opening(new_internal_solid, margin, margin + ClipperSafetyOffset, ClipperLib::jtMiter, 5));
-                        if (! too_narrow.empty()) {
-                            // grow the collapsing parts and add the extra area to  the neighbor layer
-                            // as well as to our original surfaces so that we support this
-                            // additional area in the next shell too
-                            // make sure our grown surfaces don't exceed the fill area
-                            Polygons internal;
-                            for (const Surface &surface : neighbor_layerm->fill_surfaces.surfaces)
-                                if (surface.is_internal() && !surface.is_bridge())
-                                    polygons_append(internal, to_polygons(surface.expolygon));
-                            polygons_append(new_internal_solid,
-                                intersection(
-                                    expand(too_narrow, +margin),
-                                    // Discard bridges as they are grown for anchoring and we can't
-                                    // remove such anchors. (This may happen when a bridge is being
-                                    // anchored onto a wall where little space remains after the bridge
-                                    // is grown, and that little space is an internal solid shell so
-                                    // it triggers this too_narrow logic.)
-                                    internal));
-                            // solid = new_internal_solid;
-                        }
-                    }
+        float factor = 0.0f;
+        if (region_config.sparse_infill_density.value == 0)
+            factor = 1.0f;
+        else if (region_config.ensure_vertical_shell_thickness.value == evstNone)
+            factor = 0.5f;
+        else if (region_config.ensure_vertical_shell_thickness.value == evstCriticalOnly)
+            factor = 0.2f;
+        if (factor > 0.0f) {
+            // if we're printing a hollow object we discard any solid shell thinner
+            // than a perimeter width, since it's probably just crossing a sloping wall
+            // and it's not wanted in a hollow print even if it would make sense when
+            // obeying the solid shell count option strictly (DWIM!)
+
+            // Orca: Also use the same strategy if the user has selected to reduce
+            // the amount of solid infill on walls. However reduce the margin to 20% overhang
+            // as we want to generate infill on sloped vertical surfaces but still keep a small amount of
+            // filtering. This is an arbitrary value to make this option safe
+            // by ensuring that top surfaces, especially slanted ones dont go **completely** unsupported
+            // especially when using single perimeter top layers.
+            float    margin     = float(neighbor_layerm->flow(frExternalPerimeter).scaled_width()) * factor;
+            Polygons too_narrow = diff(new_internal_solid,
+                                       opening(new_internal_solid, margin, margin + ClipperSafetyOffset, jtMiter, 5));
+            // Trim the regularized region by the original region.
+            if (!too_narrow.empty())
+                new_internal_solid = solid = diff(new_internal_solid, too_narrow);
+        }
+
+        // make sure the new internal solid is wide enough, as it might get collapsed
+        // when spacing is added in Fill.pm
+        {
+            //FIXME Vojtech: Disable this and you will be sorry.
+            float margin = (region_config.ensure_vertical_shell_thickness.value != evstNone ? 3.f : 1.0f) * layerm->flow(frSolidInfill).scaled_width(); // require at least this size
+            // we use a higher miterLimit here to handle areas with acute angles
+            // in those cases, the default miterLimit would cut the corner and we'd
+            // get a triangle in $too_narrow; if we grow it below then the shell
+            // would have a different shape from the external surface and we'd still
+            // have the same angle, so the next shell would be grown even more and so on.
+            Polygons too_narrow = diff(
+                new_internal_solid,
+                opening(new_internal_solid, margin, margin + ClipperSafetyOffset, ClipperLib::jtMiter, 5));
+            if (! too_narrow.empty()) {
+                // grow the collapsing parts and add the extra area to  the neighbor layer
+                // as well as to our original surfaces so that we support this
+                // additional area in the next shell too
+                // make sure our grown surfaces don't exceed the fill area
+                Polygons internal;
+                for (const Surface &surface : neighbor_layerm->fill_surfaces.surfaces)
+                    if (surface.is_internal() && !surface.is_bridge())
+                        polygons_append(internal, to_polygons(surface.expolygon));
+                polygons_append(new_internal_solid,
+                    intersection(
+                        expand(too_narrow, +margin),
+                        // Discard bridges as they are grown for anchoring and we can't
+                        // remove such anchors. (This may happen when a bridge is being
+                        // anchored onto a wall where little space remains after the bridge
+                        // is grown, and that little space is an internal solid shell so
+                        // it triggers this too_narrow logic.)
+                        internal));
+                // solid = new_internal_solid;
+            }
+        }
+
+        // internal-solid are the union of the existing internal-solid surfaces
+        // and new ones
+        SurfaceCollection backup = std::move(neighbor_layerm->fill_surfaces);
+        polygons_append(new_internal_solid, to_polygons(backup.filter_by_type(stInternalSolid)));
+        ExPolygons internal_solid = union_ex(new_internal_solid);
+        // assign new internal-solid surfaces to layer
+        neighbor_layerm->fill_surfaces.set(internal_solid, stInternalSolid);
+        // subtract intersections from layer surfaces to get resulting internal surfaces
+        Polygons polygons_internal = to_polygons(std::move(internal_solid));
+        ExPolygons internal = diff_ex(backup.filter_by_type(stInternal), polygons_internal, ApplySafetyOffset::Yes);
+        // assign resulting internal surfaces to layer
+        neighbor_layerm->fill_surfaces.append(internal, stInternal);
+        polygons_append(polygons_internal, to_polygons(std::move(internal)));
+        // assign top and bottom surfaces to layer
+        backup.keep_types({ stTop, stBottom, stBottomBridge });
+        std::vector<SurfacesPtr> top_bottom_groups;
+        backup.group(&top_bottom_groups);
+        for (SurfacesPtr &group : top_bottom_groups)
+            neighbor_layerm->fill_surfaces.append(
+                diff_ex(group, polygons_internal),
+                // Use an existing surface as a template, it carries the bridge angle etc.
+                *group.front());
+
+        if (step.layer_id == shell.last_layer_id)
+            // Release the top / bottom area of the shell, which is not needed anymore.
+            solid = Polygons();
+    };
 
-                    // internal-solid are the union of the existing internal-solid surfaces
-                    // and new ones
-                    SurfaceCollection backup = std::move(neighbor_layerm->fill_surfaces);
-                    polygons_append(new_internal_solid, to_polygons(backup.filter_by_type(stInternalSolid)));
-                    ExPolygons internal_solid = union_ex(new_internal_solid);
-                    // assign new internal-solid surfaces to layer
-                    neighbor_layerm->fill_surfaces.set(internal_solid, stInternalSolid);
-                    // subtract intersections from layer surfaces to get resulting internal surfaces
-                    Polygons polygons_internal = to_polygons(std::move(internal_solid));
-                    ExPolygons internal = diff_ex(backup.filter_by_type(stInternal), polygons_internal, ApplySafetyOffset::Yes);
-                    // assign resulting internal surfaces to layer
-                    neighbor_layerm->fill_surfaces.append(internal, stInternal);
-                    polygons_append(polygons_internal, to_polygons(std::move(internal)));
-                    // assign top and bottom surfaces to layer
-                    backup.keep_types({ stTop, stBottom, stBottomBridge });
-                    std::vector<SurfacesPtr> top_bottom_groups;
-                    backup.group(&top_bottom_groups);
-                    for (SurfacesPtr &group : top_bottom_groups)
-                        neighbor_layerm->fill_surfaces.append(
-                            diff_ex(group, polygons_internal),
-                            // Use an existing surface as a template, it carries the bridge angle etc.
-                            *group.front());
+    for (const std::vector<Step> &round : rounds) {
+        m_print->throw_if_canceled();
+        tbb::parallel_for(
+            tbb::blocked_range<size_t>(0, round.size()),
+            [this, &round, &turn, &propagate](const tbb::blocked_range<size_t>& range) {
+                for (size_t step_idx = range.begin(); step_idx < range.end(); ++ step_idx) {
+                    m_print->throw_if_canceled();
+                    const Step &step = round[step_idx];
+                    if (step.shell_id == NO_SHELL)
+                        turn(step);
+                    else
+                        propagate(step);
                 }
-		EXTERNAL:;
-            } // foreach type (stTop, stBottom, stBottomBridge)
-        } // for each layer
-    }     // for each region
+            });
+    }
 
 #ifdef SLIC3R_DEBUG_SLICE_PROCESSING
     for (size_t region_id = 0; region_id < this->num_printing_regions(); ++region_id) {
@@ -3692,6 +3986,23 @@ void PrintObject::discover_horizontal_shells()
 // fill_surfaces but we only turn them into VOID surfaces, thus preserving the boundaries.
 void PrintObject::combine_infill()
 {
+    SLIC3R_TRACE_ZONE_OBJECT("PrintObject::combine_infill", this->id().id);
+
+    // Parameters of the regions combining their infill.
+    struct RegionCombination {
+        SurfaceType   surface_type;
+        InfillPattern infill_pattern;
+    };
+    std::vector<RegionCombination> region_combinations(this->num_printing_regions());
+    // Combination groups of layers, each given by its region and by its uppermost layer. The groups of a region do not overlap,
+    // thus all the groups are processed in parallel.
+    struct CombinationGroup {
+        size_t region_id;
+        size_t layer_idx;
+        size_t num_layers;
+    };
+    std::vector<CombinationGroup> groups;
+
     // Work on each region separately.
     for (size_t region_id = 0; region_id < this->num_printing_regions(); ++ region_id) {
         const PrintRegion &region = this->printing_region(region_id);
@@ -3701,10 +4012,10 @@ void PrintObject::combine_infill()
             continue;
 
         // Support internal solid infill when sparse_infill_density is 100%
-        const bool          use_solid_infill = fabs(region.config().sparse_infill_density.value - 100.) < EPSILON;
-        const SurfaceType   surface_type     = use_solid_infill ? stInternalSolid : stInternal;
-        const InfillPattern infill_pattern   = use_solid_infill ? region.config().internal_solid_infill_pattern :
-                                                                  region.config().sparse_infill_pattern;
+        const bool use_solid_infill = fabs(region.config().sparse_infill_density.value - 100.) < EPSILON;
+        region_combinations[region_id].surface_type   = use_solid_infill ? stInternalSolid : stInternal;
+        region_combinations[region_id].infill_pattern = use_solid_infill ? region.config().internal_solid_infill_pattern :
+                                                                           region.config().sparse_infill_pattern;
 
         // Limit the number of combined layers to the maximum height allowed by this regions' nozzle.
         //FIXME limit the layer height to max_layer_height
@@ -3744,73 +4055,81 @@ void PrintObject::combine_infill()
             combine[m_layers.size() - 1] = num_layers;
         }
 
-        // loop through layers to which we have assigned layers to combine
-        for (size_t layer_idx = 0; layer_idx < m_layers.size(); ++ layer_idx) {
-            m_print->throw_if_canceled();
-            size_t num_layers = combine[layer_idx];
-			if (num_layers <= 1)
-                continue;
-            // Get all the LayerRegion objects to be combined.
-            std::vector<LayerRegion*> layerms;
-            layerms.reserve(num_layers);
-			for (size_t i = layer_idx + 1 - num_layers; i <= layer_idx; ++ i)
-                layerms.emplace_back(m_layers[i]->regions()[region_id]);
-            // We need to perform a multi-layer intersection, so let's split it in pairs.
-            // Initialize the intersection with the candidates of the lowest layer.
-            ExPolygons intersection = to_expolygons(layerms.front()->fill_surfaces.filter_by_type(surface_type));
-            // Start looping from the second layer and intersect the current intersection with it.
-            for (size_t i = 1; i < layerms.size(); ++ i)
-                intersection = intersection_ex(layerms[i]->fill_surfaces.filter_by_type(surface_type), intersection);
-            double area_threshold = layerms.front()->infill_area_threshold();
-            if (! intersection.empty() && area_threshold > 0.)
-                intersection.erase(std::remove_if(intersection.begin(), intersection.end(),
-                    [area_threshold](const ExPolygon &expoly) { return expoly.area() <= area_threshold; }),
-                    intersection.end());
-            if (intersection.empty())
-                continue;
-//            Slic3r::debugf "  combining %d %s regions from layers %d-%d\n",
-//                scalar(@$intersection),
-//                ($type == stInternal ? 'internal' : 'internal-solid'),
-//                $layer_idx-($every-1), $layer_idx;
-            // intersection now contains the regions that can be combined across the full amount of layers,
-            // so let's remove those areas from all layers.
-            Polygons intersection_with_clearance;
-            intersection_with_clearance.reserve(intersection.size());
-            float clearance_offset =
-                0.5f * layerms.back()->flow(frPerimeter).scaled_width() +
-             // Because fill areas for rectilinear and honeycomb are grown
-             // later to overlap perimeters, we need to counteract that too.
-                ((infill_pattern == ipRectilinear   ||
-                  infill_pattern == ipMonotonic     ||
-                  infill_pattern == ipGrid          ||
-                  infill_pattern == ipLateralLattice     ||
-                  infill_pattern == ipLine          ||
-                  infill_pattern == ipHoneycomb     ||
-                  infill_pattern == ipLateralHoneycomb) ? 1.5f : 0.5f) *
-                    layerms.back()->flow(frSolidInfill).scaled_width();
-            for (ExPolygon &expoly : intersection)
-                polygons_append(intersection_with_clearance, offset(expoly, clearance_offset));
-            for (LayerRegion *layerm : layerms) {
-                Polygons internal = to_polygons(std::move(layerm->fill_surfaces.filter_by_type(surface_type)));
-                layerm->fill_surfaces.remove_type(surface_type);
-                layerm->fill_surfaces.append(diff_ex(internal, intersection_with_clearance), surface_type);
-                if (layerm == layerms.back()) {
-                    // Apply surfaces back with adjusted depth to the uppermost layer.
-                    Surface templ(surface_type, ExPolygon());
-                    templ.thickness = 0.;
-                    for (LayerRegion *layerm2 : layerms)
-                        templ.thickness += layerm2->layer()->height;
-                    templ.thickness_layers = (unsigned short)layerms.size();
-                    layerm->fill_surfaces.append(intersection, templ);
-                } else {
-                    // Save void surfaces.
-                    layerm->fill_surfaces.append(
-                        intersection_ex(internal, intersection_with_clearance),
-                        stInternalVoid);
+        // collect the layers to which we have assigned layers to combine
+        for (size_t layer_idx = 0; layer_idx < m_layers.size(); ++ layer_idx)
+            if (combine[layer_idx] > 1)
+                groups.push_back({ region_id, layer_idx, combine[layer_idx] });
+    }
+
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, groups.size()),
+        [this, &groups, &region_combinations](const tbb::blocked_range<size_t>& range) {
+            for (size_t group_idx = range.begin(); group_idx < range.end(); ++ group_idx) {
+                m_print->throw_if_canceled();
+                const auto [region_id, layer_idx, num_layers] = groups[group_idx];
+                const SurfaceType   surface_type   = region_combinations[region_id].surface_type;
+                const InfillPattern infill_pattern = region_combinations[region_id].infill_pattern;
+                // Get all the LayerRegion objects to be combined.
+                std::vector<LayerRegion*> layerms;
+                layerms.reserve(num_layers);
+                for (size_t i = layer_idx + 1 - num_layers; i <= layer_idx; ++ i)
+                    layerms.emplace_back(m_layers[i]->regions()[region_id]);
+                // We need to perform a multi-layer intersection, so let's split it in pairs.
+                // Initialize the intersection with the candidates of the lowest layer.
+                ExPolygons intersection = to_expolygons(layerms.front()->fill_surfaces.filter_by_type(surface_type));
+                // Start looping from the second layer and intersect the current intersection with it.
+                for (size_t i = 1; i < layerms.size(); ++ i)
+                    intersection = intersection_ex(layerms[i]->fill_surfaces.filter_by_type(surface_type), intersection);
+                double area_threshold = layerms.front()->infill_area_threshold();
+                if (! intersection.empty() && area_threshold > 0.)
+                    intersection.erase(std::remove_if(intersection.begin(), intersection.end(),
+                        [area_threshold](const ExPolygon &expoly) { return expoly.area() <= area_threshold; }),
+                        intersection.end());
+                if (intersection.empty())
+                    continue;
+//                Slic3r::debugf "  combining %d %s regions from layers %d-%d\n",
+//                    scalar(@$intersection),
+//                    ($type == stInternal ? 'internal' : 'internal-solid'),
+//                    $layer_idx-($every-1), $layer_idx;
+                // intersection now contains the regions that can be combined across the full amount of layers,
+                // so let's remove those areas from all layers.
+                Polygons intersection_with_clearance;
+                intersection_with_clearance.reserve(intersection.size());
+                float clearance_offset =
+                    0.5f * layerms.back()->flow(frPerimeter).scaled_width() +
+                 // Because fill areas for rectilinear and honeycomb are grown
+                 // later to overlap perimeters, we need to counteract that too.
+                    ((infill_pattern == ipRectilinear   ||
+                      infill_pattern == ipMonotonic     ||
+                      infill_pattern == ipGrid          ||
+                      infill_pattern == ipLateralLattice     ||
+                      infill_pattern == ipLine          ||
+                      infill_pattern == ipHoneycomb     ||
+                      infill_pattern == ipLateralHoneycomb) ? 1.5f : 0.5f) *
+                        layerms.back()->flow(frSolidInfill).scaled_width();
+                for (ExPolygon &expoly : intersection)
+                    polygons_append(intersection_with_clearance, offset(expoly, clearance_offset));
+                for (LayerRegion *layerm : layerms) {
+                    Polygons internal = to_polygons(std::move(layerm->fill_surfaces.filter_by_type(surface_type)));
+                    layerm->fill_surfaces.remove_type(surface_type);
+                    layerm->fill_surfaces.append(diff_ex(internal, intersection_with_clearance), surface_type);
+                    if (layerm == layerms.back()) {
+                        // Apply surfaces back with adjusted depth to the uppermost layer.
+                        Surface templ(surface_type, ExPolygon());
+                        templ.thickness = 0.;
+                        for (LayerRegion *layerm2 : layerms)
+                            templ.thickness += layerm2->layer()->height;
+                        templ.thickness_layers = (unsigned short)layerms.size();
+                        layerm->fill_surfaces.append(intersection, templ);
+                    } else {
+                        // Save void surfaces.
+                        layerm->fill_surfaces.append(
+                            intersection_ex(internal, intersection_with_clearance),
+                            stInternalVoid);
+                    }
                 }
             }
-        }
-    }
+        });
 }
 
 void PrintObject::_generate_support_material()
@@ -3819,6 +4138,7 @@ void PrintObject::_generate_support_material()
         TreeSupport tree_support(*this, m_slicing_params);
         tree_support.throw_on_cancel = [this]() { this->throw_if_canceled(); };
         tree_support.generate();
+        tree_support.store_overhangs();
     }
     else {
         PrintObjectSupportMaterial support_material(this, m_slicing_params);
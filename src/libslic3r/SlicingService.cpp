@@ -0,0 +1,357 @@
+#include "SlicingService.hpp"
+#include "BoundingBox.hpp"
+#include "Exception.hpp"
+#include "GCode/GCodeProcessor.hpp"
+#include "Utils.hpp"
+
+#include <boost/algorithm/string/predicate.hpp>
+#include <boost/asio.hpp>
+#include <boost/beast/core/detail/base64.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/format.hpp>
+#include <boost/log/trivial.hpp>
+#include <boost/nowide/fstream.hpp>
+
+#include <condition_variable>
+#include <set>
+#include <thread>
+
+#ifndef _WIN32
+#include <sys/stat.h>
+#endif
+
+#include "nlohmann/json.hpp"
+
+namespace Slic3r {
+
+SlicingSession::SlicingSession(const DynamicPrintConfig &base_config) : m_config(base_config)
+{
+    // Printing the status into the console is of no use to the clients of the service.
+    m_print.set_status_silent();
+    // Tuning the cooling or the pressure advance between the slices of a session only re-runs the G-code post-processing.
+    m_print.set_gcode_layer_cache_limit(Print::DefaultGCodeLayerCacheLimit);
+}
+
+void SlicingSession::load_model(const std::string &path)
+{
+    DynamicPrintConfig        config;
+    ConfigSubstitutionContext config_substitutions{ ForwardCompatibilitySubstitutionRule::EnableSilent };
+    Model model = Model::read_from_file(path, &config, &config_substitutions, LoadStrategy::LoadModel | LoadStrategy::AddDefaultInstances);
+    if (model.objects.empty())
+        throw Slic3r::RuntimeError((boost::format("No object found in %1%") % path).str());
+    m_model        = std::move(model);
+    m_model_placed = false;
+}
+
+void SlicingSession::load_config(const std::string &path)
+{
+    DynamicPrintConfig config;
+    config.load(path, ForwardCompatibilitySubstitutionRule::Enable);
+    if (config.empty())
+        throw Slic3r::RuntimeError((boost::format("No configuration found in %1%") % path).str());
+    config.normalize_fdm();
+    m_config.apply(config, true);
+}
+
+void SlicingSession::set_config(std::map<std::string, std::string> &key_values)
+{
+    DynamicPrintConfig config;
+    config.load_string_map(key_values, ForwardCompatibilitySubstitutionRule::Disable);
+    m_config.apply(config, true);
+}
+
+float SlicingSession::slice(const std::string &output_path, PrintBase::status_callback_type status_cb)
+{
+    if (m_model.objects.empty())
+        throw Slic3r::SlicingError("No model was loaded into the session");
+    if (! m_model_placed) {
+        // Same placement as the command line slicer without arrangement: center the objects on the print bed.
+        if (const ConfigOptionPoints *printable_area = m_config.option<ConfigOptionPoints>("printable_area"); printable_area && ! printable_area->values.empty())
+            m_model.center_instances_around_point(BoundingBoxf(printable_area->values).center());
+        for (ModelObject *object : m_model.objects)
+            object->ensure_on_bed();
+        m_model_placed = true;
+    }
+
+    const ConfigOptionString *printer_model = m_config.option<ConfigOptionString>("printer_model");
+    m_print.is_BBL_printer() = printer_model != nullptr && boost::starts_with(printer_model->value, "Bambu Lab");
+    // Only the steps invalidated by the changes since the last slicing of this session are recalculated.
+    Print::ApplyStatus apply_status = m_print.apply(m_model, m_config);
+    BOOST_LOG_TRIVIAL(info) << "SlicingSession: apply status " << int(apply_status);
+    Model::setExtruderParams(m_config, int(m_print.config().filament_diameter.size()));
+    Model::setPrintSpeedTable(m_config, m_print.config());
+
+    StringObjectException warning;
+    StringObjectException err = m_print.validate(&warning);
+    if (! err.string.empty())
+        throw Slic3r::SlicingError(err.string);
+
+    m_print.set_status_callback(std::move(status_cb));
+    GCodeProcessorResult result;
+    try {
+        // A cancel request arriving before this point is meant for the previous slicing.
+        m_print.restart();
+        m_print.process();
+        m_print.export_gcode(output_path, &result, nullptr);
+    } catch (...) {
+        m_print.set_status_silent();
+        throw;
+    }
+    m_print.set_status_silent();
+    return result.print_statistics.modes[static_cast<size_t>(PrintEstimatedStatistics::ETimeMode::Normal)].time;
+}
+
+SlicingService::SlicingService(const std::string &socket_path, const std::string &root_dir, const DynamicPrintConfig &base_config) :
+    m_socket_path(socket_path), m_root_dir(boost::filesystem::weakly_canonical(boost::filesystem::absolute(root_dir)).string()), m_base_config(base_config)
+{}
+
+SlicingService::~SlicingService() = default;
+
+std::string SlicingService::resolve_path(const std::string &path) const
+{
+    namespace fs = boost::filesystem;
+    const fs::path root(m_root_dir);
+    fs::path       resolved(path);
+    if (! resolved.is_absolute())
+        resolved = root / resolved;
+    // Resolves both ".." and the symbolic links of the existing part of the path.
+    resolved = fs::weakly_canonical(resolved);
+    auto it_resolved = resolved.begin();
+    for (auto it_root = root.begin(); it_root != root.end(); ++ it_root, ++ it_resolved)
+        if (it_resolved == resolved.end() || *it_root != *it_resolved)
+            throw Slic3r::InvalidArgument((boost::format("Path %1% is outside of the directory %2% of the service") % path % m_root_dir).str());
+    return resolved.string();
+}
+
+std::shared_ptr<SlicingSession> SlicingService::session(size_t id) const
+{
+    std::lock_guard<std::mutex> lock(m_sessions_mutex);
+    auto it = m_sessions.find(id);
+    if (it == m_sessions.end())
+        throw Slic3r::InvalidArgument((boost::format("Unknown session %1%") % id).str());
+    return it->second;
+}
+
+void SlicingService::cancel_all()
+{
+    std::lock_guard<std::mutex> lock(m_sessions_mutex);
+    for (auto &[id, session] : m_sessions)
+        session->cancel();
+}
+
+// Store a model uploaded by the client into a temporary file, so that it could be loaded by Model::read_from_file().
+static std::string store_uploaded_model(const std::string &name, const std::string &data)
+{
+    std::string decoded;
+    decoded.resize(boost::beast::detail::base64::decoded_size(data.size()));
+    decoded.resize(boost::beast::detail::base64::decode(decoded.data(), data.data(), data.size()).first);
+    boost::filesystem::path path = boost::filesystem::temp_directory_path() /
+        boost::filesystem::unique_path("orca_service_%%%%-%%%%-%%%%" + boost::filesystem::path(name).extension().string());
+    boost::nowide::ofstream file(path.string(), std::ios::binary);
+    if (! file.write(decoded.data(), decoded.size()))
+        throw Slic3r::FileIOError((boost::format("Failed to store the uploaded model into %1%") % path.string()).str());
+    return path.string();
+}
+
+std::string SlicingService::process_request(const std::string &request, const std::function<void(const std::string&)> &send_line)
+{
+    nlohmann::json answer;
+    try {
+        nlohmann::json    j       = nlohmann::json::parse(request);
+        const std::string command = j.at("command").get<std::string>();
+        if (command == "open") {
+            std::lock_guard<std::mutex> lock(m_sessions_mutex);
+            size_t id = m_next_session_id ++;
+            m_sessions.emplace(id, std::make_shared<SlicingSession>(m_base_config));
+            answer["session"] = id;
+        } else if (command == "shutdown") {
+            m_shutdown = true;
+        } else {
+            const size_t                    id      = j.at("session").get<size_t>();
+            std::shared_ptr<SlicingSession> session = this->session(id);
+            answer["session"] = id;
+            if (command == "cancel") {
+                // Not waiting for the session, which is busy slicing.
+                session->cancel();
+            } else if (command == "close") {
+                {
+                    std::lock_guard<std::mutex> lock(m_sessions_mutex);
+                    m_sessions.erase(id);
+                }
+                // The session is released once its slicing stops.
+                session->cancel();
+            } else {
+                std::lock_guard<std::mutex> session_lock(session->mutex());
+                if (command == "load_model") {
+                    if (j.contains("data")) {
+                        std::string path = store_uploaded_model(j.at("name").get<std::string>(), j.at("data").get<std::string>());
+                        try {
+                            session->load_model(path);
+                        } catch (...) {
+                            boost::filesystem::remove(path);
+                            throw;
+                        }
+                        boost::filesystem::remove(path);
+                    } else
+                        session->load_model(this->resolve_path(j.at("path").get<std::string>()));
+                } else if (command == "load_config") {
+                    session->load_config(this->resolve_path(j.at("path").get<std::string>()));
+                } else if (command == "set_config") {
+                    std::map<std::string, std::string> key_values;
+                    for (const auto &item : j.at("options").items())
+                        key_values[item.key()] = item.value().is_string() ? item.value().get<std::string>() : item.value().dump();
+                    session->set_config(key_values);
+                } else if (command == "slice") {
+                    const std::string output = this->resolve_path(j.at("output").get<std::string>());
+                    std::mutex        status_mutex;
+                    bool              disconnected = false;
+                    std::lock_guard<std::mutex> slice_lock(m_slice_mutex);
+                    if (m_shutdown)
+                        throw CanceledException();
+                    float print_time = session->slice(output, [id, &send_line, &status_mutex, &disconnected, &session](const PrintBase::SlicingStatus &status) {
+                        nlohmann::json progress;
+                        progress["session"] = id;
+                        progress["percent"] = status.percent;
+                        progress["text"]    = status.text;
+                        std::lock_guard<std::mutex> lock(status_mutex);
+                        if (! disconnected) {
+                            try {
+                                send_line(progress.dump());
+                            } catch (const std::exception &ex) {
+                                // Nobody is waiting for the G-code anymore. Throwing here would unwind the slicing threads.
+                                BOOST_LOG_TRIVIAL(error) << "SlicingService: client of session " << id << " disconnected while slicing: " << ex.what();
+                                disconnected = true;
+                                session->cancel();
+                            }
+                        }
+                    });
+                    answer["output"]     = j.at("output");
+                    answer["print_time"] = print_time;
+                } else
+                    throw Slic3r::InvalidArgument("Unknown command " + command);
+            }
+        }
+        answer["result"] = "ok";
+    } catch (const std::exception &ex) {
+        BOOST_LOG_TRIVIAL(error) << "SlicingService: request failed: " << ex.what();
+        answer["result"] = "error";
+        answer["error"]  = ex.what();
+    }
+    return answer.dump();
+}
+
+#ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
+// Answer the requests of a single client until it disconnects or the service is shut down.
+static void serve_client(SlicingService &service, boost::asio::local::stream_protocol::socket &socket)
+{
+    namespace asio = boost::asio;
+    asio::streambuf buffer;
+    try {
+        auto send_line = [&socket](const std::string &line) { asio::write(socket, asio::buffer(line + "\n")); };
+        while (! service.shutdown_requested()) {
+            asio::read_until(socket, buffer, '\n');
+            std::istream stream(&buffer);
+            std::string  request;
+            std::getline(stream, request);
+            if (! request.empty())
+                send_line(service.process_request(request, send_line));
+        }
+    } catch (const boost::system::system_error &ex) {
+        // The client disconnected, its sessions stay open for the next connection.
+        if (ex.code() != asio::error::eof && ! service.shutdown_requested())
+            BOOST_LOG_TRIVIAL(error) << "SlicingService: connection failed: " << ex.what();
+    }
+}
+#endif // BOOST_ASIO_HAS_LOCAL_SOCKETS
+
+int SlicingService::run()
+{
+#ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
+    namespace asio = boost::asio;
+    namespace fs   = boost::filesystem;
+    using local = asio::local::stream_protocol;
+
+    // A socket file left over by a previous service instance would fail the bind. Anything else is not ours to delete.
+    boost::system::error_code ec;
+    if (fs::file_status status = fs::symlink_status(m_socket_path, ec); status.type() == fs::socket_file)
+        fs::remove(m_socket_path, ec);
+    else if (fs::exists(status)) {
+        BOOST_LOG_TRIVIAL(error) << "SlicingService: " << m_socket_path << " exists and it is not a socket";
+        return 1;
+    }
+
+    asio::io_context io_context;
+    local::acceptor  acceptor(io_context);
+    {
+#ifndef _WIN32
+        // The clients read and write files with the privileges of the service, only its user may connect.
+        // The socket is created with the restricted permissions, so that there is no window for others to connect.
+        const mode_t old_umask = ::umask(S_IRWXG | S_IRWXO);
+#endif
+        const local::endpoint endpoint(m_socket_path);
+        acceptor.open(endpoint.protocol(), ec);
+        if (! ec)
+            acceptor.bind(endpoint, ec);
+#ifndef _WIN32
+        ::umask(old_umask);
+#endif
+        if (! ec)
+            fs::permissions(m_socket_path, fs::owner_read | fs::owner_write, ec);
+        if (! ec)
+            acceptor.listen(asio::socket_base::max_listen_connections, ec);
+        if (ec) {
+            BOOST_LOG_TRIVIAL(error) << "SlicingService: failed to listen on " << m_socket_path << ": " << ec.message();
+            return 1;
+        }
+    }
+    BOOST_LOG_TRIVIAL(info) << "SlicingService: listening on " << m_socket_path << ", root directory " << m_root_dir;
+
+    // Each client is served by its own thread, so that a slice could be canceled from another connection.
+    std::mutex                               clients_mutex;
+    std::condition_variable                  clients_done;
+    std::set<std::shared_ptr<local::socket>> clients;
+    std::function<void()> accept_client = [&]() {
+        auto socket = std::make_shared<local::socket>(io_context);
+        acceptor.async_accept(*socket, [&, socket](const boost::system::error_code &ec) {
+            if (ec)
+                // Acceptor was closed on shutdown.
+                return;
+            BOOST_LOG_TRIVIAL(info) << "SlicingService: client connected";
+            {
+                std::lock_guard<std::mutex> lock(clients_mutex);
+                clients.insert(socket);
+            }
+            std::thread([&, socket]() mutable {
+                serve_client(*this, *socket);
+                if (m_shutdown)
+                    asio::post(io_context, [&acceptor]() { acceptor.close(); });
+                std::lock_guard<std::mutex> lock(clients_mutex);
+                clients.erase(socket);
+                // The socket shall not outlive io_context, which may be destroyed as soon as the lock is released.
+                socket.reset();
+                clients_done.notify_all();
+            }).detach();
+            accept_client();
+        });
+    };
+    accept_client();
+    io_context.run();
+
+    // Wake up the other clients blocked on reading their next request and stop their slicing.
+    this->cancel_all();
+    {
+        std::unique_lock<std::mutex> lock(clients_mutex);
+        for (const std::shared_ptr<local::socket> &socket : clients)
+            socket->shutdown(local::socket::shutdown_both, ec);
+        clients_done.wait(lock, [&clients]() { return clients.empty(); });
+    }
+    fs::remove(m_socket_path, ec);
+    BOOST_LOG_TRIVIAL(info) << "SlicingService: shut down";
+    return 0;
+#else
+    BOOST_LOG_TRIVIAL(error) << "SlicingService: UNIX domain sockets are not supported on this platform";
+    return 1;
+#endif
+}
+
+} // namespace Slic3r
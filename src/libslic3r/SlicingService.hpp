@@ -0,0 +1,110 @@
+#ifndef slic3r_SlicingService_hpp_
+#define slic3r_SlicingService_hpp_
+
+#include "libslic3r.h"
+#include "Model.hpp"
+#include "Print.hpp"
+#include "PrintConfig.hpp"
+
+#include <atomic>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace Slic3r {
+
+// Model and Print kept alive between the requests of a client of the SlicingService.
+// Slicing again after the model or the configuration changed goes through Print::apply(),
+// thus only the steps invalidated by the change are recalculated.
+class SlicingSession
+{
+public:
+    explicit SlicingSession(const DynamicPrintConfig &base_config);
+
+    // Replace the model of the session with the objects loaded from a file (STL, OBJ, 3MF, STEP...).
+    // Throws Slic3r::RuntimeError if the file could not be loaded or if it contains no object.
+    void                load_model(const std::string &path);
+    // Load a configuration file (G-code or a fully resolved JSON preset) on top of the current configuration.
+    void                load_config(const std::string &path);
+    // Override single configuration values, the values are serialized the same way as in the configuration files.
+    void                set_config(std::map<std::string, std::string> &key_values);
+
+    // Slice the model and export G-code into output_path. Calls status_cb from the slicing threads.
+    // Returns the estimated print time in seconds. Throws Slic3r::SlicingError if the configuration is not valid.
+    float               slice(const std::string &output_path, PrintBase::status_callback_type status_cb);
+
+    // Stop the slicing running in another thread. The slice() call throws Slic3r::CanceledException.
+    void                cancel() { m_print.cancel(); }
+
+    const Print&        print() const { return m_print; }
+    // Serializes the requests of the clients sharing this session.
+    std::mutex&         mutex() { return m_mutex; }
+
+private:
+    std::mutex          m_mutex;
+    DynamicPrintConfig  m_config;
+    Model               m_model;
+    // Model was replaced and its instances were not yet placed onto the print bed.
+    bool                m_model_placed { true };
+    Print               m_print;
+};
+
+// Local slicing service: newline delimited JSON requests and responses over a UNIX domain socket.
+// The sessions survive the client connections, the clients are served concurrently.
+// The socket is only accessible to the user running the service and the paths sent by the clients
+// are confined to the root directory of the service.
+//
+// Requests: {"command": "open"}                                                 -> {"session": id}
+//           {"command": "load_model",  "session": id, "path": "..."}
+//           {"command": "load_model",  "session": id, "name": "part.stl", "data": "<base64>"}
+//           {"command": "load_config", "session": id, "path": "..."}
+//           {"command": "set_config",  "session": id, "options": {"key": "value", ...}}
+//           {"command": "slice",       "session": id, "output": "....gcode"} -> {"session": id, "percent": p, "text": "..."} ...
+//                                                                                -> {"output": "....gcode", "print_time": seconds}
+//           {"command": "cancel",      "session": id}
+//           {"command": "close",       "session": id}
+//           {"command": "shutdown"}
+// Every request is answered by a single line containing {"result": "ok", ...} or {"result": "error", "error": "..."},
+// the slice request streams the progress lines before its answer. A slice is canceled by a cancel request
+// sent over another connection, by closing its session or by its client disconnecting.
+class SlicingService
+{
+public:
+    // Relative paths sent by the clients are resolved against root_dir, paths outside of root_dir are rejected.
+    // base_config is the configuration every new session starts with.
+    SlicingService(const std::string &socket_path, const std::string &root_dir, const DynamicPrintConfig &base_config);
+    ~SlicingService();
+
+    // Serve the requests until a shutdown request is received. Returns the process exit code.
+    int                 run();
+
+    // Process a single request, the progress of a slice request is passed to send_line.
+    // Returns the answer of the request. Thread safe, send_line may throw if the client disconnected.
+    std::string         process_request(const std::string &request, const std::function<void(const std::string&)> &send_line);
+    bool                shutdown_requested() const { return m_shutdown; }
+
+    // Absolute path of a file inside the root directory.
+    // Throws Slic3r::InvalidArgument if the path points outside of the root directory, also through a symbolic link.
+    std::string         resolve_path(const std::string &path) const;
+
+private:
+    std::shared_ptr<SlicingSession> session(size_t id) const;
+    // Cancel the slicing of all sessions, called on shutdown.
+    void                cancel_all();
+
+    std::string                                         m_socket_path;
+    std::string                                         m_root_dir;
+    DynamicPrintConfig                                  m_base_config;
+    mutable std::mutex                                  m_sessions_mutex;
+    std::map<size_t, std::shared_ptr<SlicingSession>>   m_sessions;
+    size_t                                              m_next_session_id { 1 };
+    std::atomic<bool>                                   m_shutdown { false };
+    // Model::setExtruderParams() and Model::setPrintSpeedTable() fill process wide tables, thus the sessions are sliced one at a time.
+    std::mutex                                          m_slice_mutex;
+};
+
+} // namespace Slic3r
+
+#endif // slic3r_SlicingService_hpp_
@@ -9,6 +9,7 @@
 #include "../Point.hpp"
 #include "clipper/clipper_z.hpp"
 
+#include <atomic>
 #include <cmath>
 #include <boost/container/static_vector.hpp>
 #include <boost/log/trivial.hpp>
@@ -1479,6 +1480,8 @@ SupportGeneratorLayersPtr generate_support_layers(
     return layers_sorted;
 }
 
+bool support_reuse_base_fills = true;
+
 void generate_support_toolpaths(
     SupportLayerPtrs                    &support_layers,
     const PrintObjectConfig             &config,
@@ -1617,11 +1620,27 @@ void generate_support_toolpaths(
         }
     };
     std::vector<LayerCache>             layer_caches(support_layers.size());
+    // Number of base layers filled by the fill generator and number of base layers, which reused the paths of a layer below.
+    std::atomic<size_t>                 num_base_layers_filled { 0 };
+    std::atomic<size_t>                 num_base_layers_reused { 0 };
 
-    tbb::parallel_for(tbb::blocked_range<size_t>(n_raft_layers, support_layers.size()),
+    // The base fills are only reused along the layers of a single range, thus the ranges shall not be split down to single layers.
+    const size_t grain_size = 16;
+    tbb::parallel_for(tbb::blocked_range<size_t>(n_raft_layers, support_layers.size(), grain_size),
         [&config, &slicing_params, &support_params, &support_layers, &bottom_contacts, &top_contacts, &intermediate_layers, &interface_layers, &base_interface_layers, &layer_caches, &loop_interface_processor,
-            &bbox_object, &angles, n_raft_layers, link_max_length_factor]
+            &bbox_object, &angles, n_raft_layers, link_max_length_factor, &num_base_layers_filled, &num_base_layers_reused]
             (const tbb::blocked_range<size_t>& range) {
+        // Base fill of the last layer of this range filled at each of the base angles.
+        // Columns of support with a constant footprint produce the very same base fill at each such layer, thus its paths are copied
+        // instead of running the fill generator again. The layers with a different angle of the alternating grid pattern are skipped.
+        struct ReusableBaseFill {
+            size_t   support_layer_id { size_t(-1) };
+            Polygons polygons;
+            float    height { 0.f };
+            size_t   extrusions_begin { 0 };
+            size_t   extrusions_end { 0 };
+        };
+        std::vector<ReusableBaseFill> reusable_base_fills(angles.size());
         // Indices of the 1st layer in their respective container at the support layer height.
         size_t idx_layer_bottom_contact   = size_t(-1);
         size_t idx_layer_top_contact      = size_t(-1);
@@ -1810,7 +1829,8 @@ void generate_support_toolpaths(
                 bool  sheath  = support_params.with_sheath;
                 bool  no_sort = false;
                 bool  done    = false;
-                if (base_layer.layer->bottom_z < EPSILON) {
+                const bool first_layer = base_layer.layer->bottom_z < EPSILON;
+                if (first_layer) {
                     // Base flange (the 1st layer).
                     filler = filler_first_layer;
                     filler->angle = Geometry::deg2rad(float(config.support_angle.value + 90.));
@@ -1831,7 +1851,7 @@ void generate_support_toolpaths(
                     tree_supports_generate_paths(base_layer.extrusions, base_layer.polygons_to_extrude(), flow, support_params2);
                     done = true;
                 }
-                if (! done)
+                if (! done && first_layer)
                     fill_expolygons_with_sheath_generate_paths(
                         // Destination
                         base_layer.extrusions,
@@ -1842,6 +1862,36 @@ void generate_support_toolpaths(
                         // Extrusion parameters
                         ExtrusionRole::erSupportMaterial, flow,
                         support_params, sheath, no_sort);
+                else if (! done) {
+                    ReusableBaseFill &reusable         = reusable_base_fills[support_layer_id % angles.size()];
+                    const Polygons   &polygons         = base_layer.polygons_to_extrude();
+                    const size_t      extrusions_begin = base_layer.extrusions.size();
+                    if (support_reuse_base_fills && reusable.support_layer_id + angles.size() == support_layer_id && reusable.height == flow.height() &&
+                        reusable.polygons == polygons) {
+                        // Same footprint and the same angle as the layer below, copy its paths.
+                        const ExtrusionEntitiesPtr &reused = layer_caches[reusable.support_layer_id].base_layer.extrusions;
+                        for (size_t i = reusable.extrusions_begin; i < reusable.extrusions_end; ++ i)
+                            base_layer.extrusions.emplace_back(reused[i]->clone());
+                        ++ num_base_layers_reused;
+                    } else {
+                        fill_expolygons_with_sheath_generate_paths(
+                            // Destination
+                            base_layer.extrusions,
+                            // Regions to fill
+                            polygons,
+                            // Filler and its parameters
+                            filler, density,
+                            // Extrusion parameters
+                            ExtrusionRole::erSupportMaterial, flow,
+                            support_params, sheath, no_sort);
+                        reusable.polygons = polygons;
+                        reusable.height   = flow.height();
+                        ++ num_base_layers_filled;
+                    }
+                    reusable.support_layer_id = support_layer_id;
+                    reusable.extrusions_begin = extrusions_begin;
+                    reusable.extrusions_end   = base_layer.extrusions.size();
+                }
             }
 
             // Merge base_interface_layers to base_layers to avoid unneccessary retractions
@@ -1892,6 +1942,7 @@ void generate_support_toolpaths(
             }
         } // for each support_layer_id
     });
+    BOOST_LOG_TRIVIAL(debug) << "Support base layers: " << num_base_layers_filled << " filled, " << num_base_layers_reused << " reused from a layer below";
 
     // Now modulate the support layer height in parallel.
     tbb::parallel_for(tbb::blocked_range<size_t>(n_raft_layers, support_layers.size()),
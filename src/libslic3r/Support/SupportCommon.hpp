@@ -65,6 +65,10 @@ SupportGeneratorLayersPtr generate_support_layers(
     const SupportGeneratorLayersPtr     &interface_layers,
     const SupportGeneratorLayersPtr     &base_interface_layers);
 
+// Copy the base fill of a support layer from the layer below with the same footprint and angle instead of filling it again.
+// Only switched off by the tests, to compare the copied base fills with the generated ones.
+extern bool support_reuse_base_fills;
+
 // Produce the support G-code.
 // Used by both classic and tree supports.
 void generate_support_toolpaths(
@@ -145,46 +145,116 @@ void estimate_malformations(LayerPtrs &layers, const Params &params)
     FILE *full_file  = boost::nowide::fopen(debug_out_path("object_full.obj").c_str(), "w");
 #endif
 
-    LD prev_layer_lines{};
+    // Only the propagation of the curled up height from the previous layer is sequential. The geometry is processed for all layers
+    // in parallel: first the external perimeters of each layer are collected, then the external perimeters of each layer are annotated
+    // against the external perimeters of the previous layer and the boundary of the layer below, and the closest line of the previous
+    // layer is found for each annotated line.
+    std::vector<LD> external_perimeters(layers.size());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, layers.size()), [&layers, &external_perimeters](const tbb::blocked_range<size_t> &range) {
+        for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx) {
+            std::vector<ExtrusionLine> lines;
+            for (const LayerRegion *layer_region : layers[layer_idx]->regions())
+                for (const ExtrusionEntity *extrusion : layer_region->perimeters.flatten().entities) {
+                    if (extrusion->role() != Slic3r::erExternalPerimeter)
+                        continue;
+                    Points extrusion_pts;
+                    extrusion->collect_points(extrusion_pts);
+                    for (size_t i = 1; i < extrusion_pts.size(); ++ i)
+                        lines.emplace_back(unscaled(extrusion_pts[i - 1]).cast<float>(), unscaled(extrusion_pts[i]).cast<float>());
+                }
+            external_perimeters[layer_idx] = LD{std::move(lines)};
+        }
+    });
 
-    for (Layer *l : layers) {
-        l->curled_lines.clear();
-        std::vector<Linef> boundary_lines = l->lower_layer != nullptr ? to_unscaled_linesf(l->lower_layer->lslices) : std::vector<Linef>();
-        AABBTreeLines::LinesDistancer<Linef> prev_layer_boundary{std::move(boundary_lines)};
-        std::vector<ExtrusionLine>           current_layer_lines;
-        for (const LayerRegion *layer_region : l->regions()) {
-            for (const ExtrusionEntity *extrusion : layer_region->perimeters.flatten().entities) {
-                if (extrusion->role() != Slic3r::erExternalPerimeter)
-                    continue;
-
-                Points extrusion_pts;
-                extrusion->collect_points(extrusion_pts);
-                float flow_width       = get_flow_width(layer_region, extrusion->role());
-                auto  annotated_points = estimate_points_properties<true, true, false, false>(extrusion_pts,
-                                                                                                                 prev_layer_lines,
-                                                                                                                 flow_width,
-                                                                                                                 params.bridge_distance);
-                for (size_t i = 0; i < annotated_points.size(); ++i) {
-                    const ExtendedPoint &a = i > 0 ? annotated_points[i - 1] : annotated_points[i];
-                    const ExtendedPoint &b = annotated_points[i];
-                    ExtrusionLine line_out{a.position.cast<float>(), b.position.cast<float>(), float((a.position - b.position).norm()),
-                                           extrusion};
-
-                    Vec2f middle                               = 0.5 * (line_out.a + line_out.b);
-                    auto [middle_distance, bottom_line_idx, x] = prev_layer_lines.distance_from_lines_extra<false>(middle);
-                    ExtrusionLine bottom_line                  = prev_layer_lines.get_lines().empty() ? ExtrusionLine{} :
-                                                                                                        prev_layer_lines.get_line(bottom_line_idx);
-
-                    // correctify the distance sign using slice polygons
-                    float sign = (prev_layer_boundary.distance_from_lines<true>(middle.cast<double>()) + 0.5f * flow_width) < 0.0f ? -1.0f :
-                                                                                                                                     1.0f;
-
-                    line_out.curled_up_height = estimate_curled_up_height(middle_distance * sign * params.curled_distance_expansion, 0.5 * (a.curvature + b.curvature),
-                                                                          l->height, flow_width, bottom_line.curled_up_height, params);
-
-                    current_layer_lines.push_back(line_out);
+    // Per annotated line of a layer: the closest line of the previous layer and the inputs of estimate_curled_up_height().
+    struct LineCurlingInput
+    {
+        size_t bottom_line_idx;
+        // Is the middle of the line outside of the layer below?
+        float  sign;
+        float  distance;
+        float  curvature;
+        float  flow_width;
+    };
+    std::vector<std::vector<ExtrusionLine>>    layer_lines(layers.size());
+    std::vector<LD>                            layer_lines_distancers(layers.size());
+    std::vector<std::vector<LineCurlingInput>> layer_curling_inputs(layers.size());
+    const LD                                   no_lines;
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, layers.size()), [&](const tbb::blocked_range<size_t> &range) {
+        for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx) {
+            const Layer *l = layers[layer_idx];
+            // The previous layer is annotated in parallel, its external perimeters are used instead. The annotation only inserts points
+            // into the extrusions, thus the distances from the previous layer are the same. Only the intersections with the previous layer
+            // may be split differently where an extrusion crosses a point inserted into the previous layer.
+            const LD                            &prev_layer_lines = layer_idx == 0 ? no_lines : external_perimeters[layer_idx - 1];
+            std::vector<Linef>                   boundary_lines   = l->lower_layer != nullptr ? to_unscaled_linesf(l->lower_layer->lslices) : std::vector<Linef>();
+            AABBTreeLines::LinesDistancer<Linef> prev_layer_boundary{std::move(boundary_lines)};
+            std::vector<ExtrusionLine>          &current_layer_lines = layer_lines[layer_idx];
+            std::vector<LineCurlingInput>       &curling_inputs      = layer_curling_inputs[layer_idx];
+            for (const LayerRegion *layer_region : l->regions()) {
+                for (const ExtrusionEntity *extrusion : layer_region->perimeters.flatten().entities) {
+                    if (extrusion->role() != Slic3r::erExternalPerimeter)
+                        continue;
+
+                    Points extrusion_pts;
+                    extrusion->collect_points(extrusion_pts);
+                    float flow_width       = get_flow_width(layer_region, extrusion->role());
+                    auto  annotated_points = estimate_points_properties<true, true, false, false>(extrusion_pts,
+                                                                                                                     prev_layer_lines,
+                                                                                                                     flow_width,
+                                                                                                                     params.bridge_distance);
+                    for (size_t i = 0; i < annotated_points.size(); ++i) {
+                        const ExtendedPoint &a = i > 0 ? annotated_points[i - 1] : annotated_points[i];
+                        const ExtendedPoint &b = annotated_points[i];
+                        ExtrusionLine line_out{a.position.cast<float>(), b.position.cast<float>(), float((a.position - b.position).norm()),
+                                               extrusion};
+
+                        Vec2f middle = 0.5 * (line_out.a + line_out.b);
+                        // correctify the distance sign using slice polygons
+                        float sign = (prev_layer_boundary.distance_from_lines<true>(middle.cast<double>()) + 0.5f * flow_width) < 0.0f ? -1.0f :
+                                                                                                                                         1.0f;
+
+                        current_layer_lines.push_back(line_out);
+                        curling_inputs.push_back({ size_t(-1), sign, 0.f, 0.5f * float(a.curvature + b.curvature), flow_width });
+                    }
                 }
             }
+            layer_lines_distancers[layer_idx] = LD{current_layer_lines};
+        }
+    });
+    external_perimeters.clear();
+    external_perimeters.shrink_to_fit();
+
+    // Distances from the annotated lines of the previous layer, the same lines the curled up height is propagated along.
+    tbb::parallel_for(tbb::blocked_range<size_t>(1, std::max<size_t>(1, layers.size())), [&](const tbb::blocked_range<size_t> &range) {
+        for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx) {
+            const LD &prev_layer_lines = layer_lines_distancers[layer_idx - 1];
+            if (prev_layer_lines.get_lines().empty())
+                continue;
+            const std::vector<ExtrusionLine> &lines = layer_lines[layer_idx];
+            for (size_t line_idx = 0; line_idx < lines.size(); ++ line_idx) {
+                LineCurlingInput &input                    = layer_curling_inputs[layer_idx][line_idx];
+                Vec2f             middle                   = 0.5 * (lines[line_idx].a + lines[line_idx].b);
+                auto [middle_distance, bottom_line_idx, x] = prev_layer_lines.distance_from_lines_extra<false>(middle);
+                input.bottom_line_idx                      = bottom_line_idx;
+                input.distance                             = middle_distance * input.sign * params.curled_distance_expansion;
+            }
+        }
+    });
+    layer_lines_distancers.clear();
+    layer_lines_distancers.shrink_to_fit();
+
+    for (size_t layer_idx = 0; layer_idx < layers.size(); ++ layer_idx) {
+        Layer                      *l                   = layers[layer_idx];
+        std::vector<ExtrusionLine> &current_layer_lines = layer_lines[layer_idx];
+        l->curled_lines.clear();
+        for (size_t line_idx = 0; line_idx < current_layer_lines.size(); ++ line_idx) {
+            const LineCurlingInput &input = layer_curling_inputs[layer_idx][line_idx];
+            float prev_line_curled_height = input.bottom_line_idx == size_t(-1) ? 0.f : layer_lines[layer_idx - 1][input.bottom_line_idx].curled_up_height;
+            // Without any line below, the distance is infinite.
+            float distance = input.bottom_line_idx == size_t(-1) ? std::numeric_limits<float>::infinity() : input.distance;
+            current_layer_lines[line_idx].curled_up_height = estimate_curled_up_height(distance, input.curvature, l->height, input.flow_width,
+                                                                                       prev_line_curled_height, params);
         }
 
         for (const ExtrusionLine &line : current_layer_lines) {
@@ -206,7 +276,9 @@ void estimate_malformations(LayerPtrs &layers, const Params &params)
         }
 #endif
 
-        prev_layer_lines = LD{current_layer_lines};
+        // The lines of the previous layer are not needed anymore.
+        if (layer_idx > 0)
+            std::vector<ExtrusionLine>().swap(layer_lines[layer_idx - 1]);
     }
 
 #ifdef DEBUG_FILES
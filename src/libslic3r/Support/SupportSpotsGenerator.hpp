@@ -80,6 +80,10 @@ struct Params
     }
 };
 
+// Height, by which an extrusion line curls up, given its signed distance from the layer below and the curled up height of the line below it.
+float estimate_curled_up_height(
+    float distance, float curvature, float layer_height, float flow_width, float prev_line_curled_height, Params params);
+
 void estimate_malformations(std::vector<Layer *> &layers, const Params &params);
 
 
@@ -882,4 +882,26 @@ std::vector<std::pair<TreeModelVolumes::RadiusLayerPair, std::reference_wrapper<
     return out;
 }
 
+size_t TreeModelVolumes::RadiusLayerPolygonCache::memsize() const
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    size_t out = m_data.capacity() * sizeof(LayerData);
+    for (const LayerData &layer : m_data)
+        for (const auto &radius_polygons : layer)
+            // Approximate size of a std::map node.
+            out += 4 * sizeof(void*) + sizeof(radius_polygons) + Slic3r::memsize(radius_polygons.second);
+    return out;
+}
+
+size_t TreeModelVolumes::memsize() const
+{
+    size_t out = 0;
+    for (const RadiusLayerPolygonCache *cache : {
+            &m_collision_cache, &m_collision_cache_holefree, &m_avoidance_cache, &m_avoidance_cache_slow,
+            &m_avoidance_cache_to_model, &m_avoidance_cache_to_model_slow, &m_placeable_areas_cache,
+            &m_avoidance_cache_holefree, &m_avoidance_cache_holefree_to_model, &m_wall_restrictions_cache, &m_wall_restrictions_cache_min })
+        out += cache->memsize();
+    return out;
+}
+
 } // namespace Slic3r::TreeSupport3D
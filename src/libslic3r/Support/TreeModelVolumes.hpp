@@ -70,6 +70,9 @@ public:
         m_wall_restrictions_cache_min.clear();
     }
 
+    // Estimate of the memory held by the collision, avoidance, placeable and wall restriction caches.
+    [[nodiscard]] size_t memsize() const;
+
     enum class AvoidanceType : int8_t
     {
         Slow,
@@ -284,6 +287,8 @@ private:
 
         // For debugging purposes, sorted by layer index, then by radius.
         [[nodiscard]] std::vector<std::pair<RadiusLayerPair, std::reference_wrapper<const Polygons>>> sorted() const;
+        // Estimate of the memory held by the cached polygons.
+        [[nodiscard]] size_t memsize() const;
 
         void clear() { m_data.clear(); }
         void clear_all_but_radius0() { 
@@ -1,3 +1,4 @@
+#include <atomic>
 #include <chrono>
 #include <math.h>
 
@@ -6,6 +7,7 @@
 #include "Fill/FillBase.hpp"
 #include "I18N.hpp"
 #include "Layer.hpp"
+#include "MemoryUsage.hpp"
 #include "MinimumSpanningTree.hpp"
 #include "Print.hpp"
 #include "ShortestPath.hpp"
@@ -24,6 +26,7 @@
 #include <tbb/parallel_for.h>
 #include <tbb/parallel_for_each.h>
 
+#include <boost/functional/hash.hpp>
 #include <boost/log/trivial.hpp>
 
 #ifndef M_PI
@@ -637,6 +640,36 @@ TreeSupport::TreeSupport(PrintObject& object, const SlicingParameters &slicing_p
 }
 
 
+bool TreeSupportOverhangs::Key::operator==(const Key &rhs) const
+{
+    return support_type == rhs.support_type && layer_count == rhs.layer_count && settings.equals(rhs.settings) &&
+        enforcers == rhs.enforcers && blockers == rhs.blockers;
+}
+
+size_t TreeSupportOverhangs::memsize() const
+{
+    size_t out = sizeof(TreeSupportOverhangs) + layers.capacity() * sizeof(LayerOverhangs);
+    for (const std::vector<Polygons> *volumes : { &key.enforcers, &key.blockers })
+        for (const Polygons &polygons : *volumes)
+            out += Slic3r::memsize(polygons);
+    for (const LayerOverhangs &layer : layers)
+        out += Slic3r::memsize(layer.overhangs) + Slic3r::memsize(layer.cantilevers) + Slic3r::memsize(layer.sharp_tails) +
+            layer.sharp_tails_height.capacity() * sizeof(float);
+    return out;
+}
+
+// Inputs of TreeSupport::detect_overhangs() except for the slices and the perimeters,
+// whose invalidation releases the detected overhangs stored at the PrintObject.
+static TreeSupportOverhangs::Key tree_support_overhangs_key(const PrintObject &object, SupportType support_type,
+    const std::vector<Polygons> &enforcers, const std::vector<Polygons> &blockers)
+{
+    TreeSupportOverhangs::Key key { support_type, {}, object.layer_count(), enforcers, blockers };
+    key.settings.apply_only(object.config(), { "enable_support", "line_width", "layer_height", "support_threshold_angle",
+        "support_critical_regions_only", "support_remove_small_overhang", "enforce_support_layers", "max_bridge_length" });
+    key.settings.apply_only(object.print()->config(), { "nozzle_diameter" });
+    return key;
+}
+
 #define SUPPORT_SURFACES_OFFSET_PARAMETERS ClipperLib::jtSquare, 0.
 void TreeSupport::detect_overhangs(bool check_support_necessity/* = false*/)
 {
@@ -778,6 +811,64 @@ void TreeSupport::detect_overhangs(bool check_support_necessity/* = false*/)
             }
         });
 
+    // Classify the overhangs of the layers by their origin, shared by the newly detected and the reused overhangs.
+    auto collect_overhang_types = [this](const TreeSupportOverhangs &overhangs) {
+        int layers_with_overhangs = 0;
+        int layers_with_enforcers = 0;
+        for (size_t layer_nr = 0; layer_nr < m_object->layer_count(); layer_nr++) {
+            Layer                                      *layer        = m_object->get_layer(layer_nr);
+            const TreeSupportOverhangs::LayerOverhangs &layer_counts = overhangs.layers[layer_nr];
+            for (size_t i = 0; i < layer->loverhangs.size(); i++)
+                overhang_types.emplace(&layer->loverhangs[i], i < layer_counts.num_detected ? OverhangType::Detected :
+                    i < layer_counts.num_enforced ? OverhangType::Enforced : OverhangType::SharpTail);
+            if (!layer->loverhangs.empty()) {
+                layers_with_overhangs++;
+                m_highest_overhang_layer = std::max(m_highest_overhang_layer, layer_nr);
+            }
+            if (layer_counts.num_enforced > 0) layers_with_enforcers++;
+            if (!layer->cantilevers.empty()) has_cantilever = true;
+        }
+        BOOST_LOG_TRIVIAL(info) << "Tree support overhang detection done. " << layers_with_overhangs << " layers with overhangs. nEnforced=" << layers_with_enforcers;
+    };
+
+    std::vector<Polygons> enforcers;
+    std::vector<Polygons> blockers;
+    m_overhangs.reset();
+    if (!check_support_necessity) {
+        enforcers = m_object->slice_support_enforcers();
+        blockers  = m_object->slice_support_blockers();
+        m_vertical_enforcer_points.clear();
+        m_object->project_and_append_custom_facets(false, EnforcerBlockerType::ENFORCER, enforcers, &m_vertical_enforcer_points);
+        m_object->project_and_append_custom_facets(false, EnforcerBlockerType::BLOCKER, blockers);
+
+        m_overhangs      = std::make_shared<TreeSupportOverhangs>();
+        m_overhangs->key = tree_support_overhangs_key(*m_object, stype, enforcers, blockers);
+        // Only the tree parameters changed since the last run: reuse the overhangs.
+        if (std::shared_ptr<TreeSupportOverhangs> cached = m_object->tree_support_overhangs();
+            cached && cached->key == m_overhangs->key && cached->layers.size() == m_object->layer_count()) {
+            // The cantilevers and the sharp tails move back to the layers until store_overhangs().
+            m_object->set_tree_support_overhangs(nullptr);
+            m_overhangs = std::move(cached);
+            tbb::parallel_for(tbb::blocked_range<size_t>(0, m_object->layer_count()),
+                [this](const tbb::blocked_range<size_t>& range) {
+                    for (size_t layer_nr = range.begin(); layer_nr < range.end(); layer_nr++) {
+                        Layer                                &layer        = *m_object->get_layer(layer_nr);
+                        TreeSupportOverhangs::LayerOverhangs &cached_layer = m_overhangs->layers[layer_nr];
+                        layer.loverhangs = cached_layer.overhangs;
+                        layer.cantilevers.swap(cached_layer.cantilevers);
+                        layer.sharp_tails.swap(cached_layer.sharp_tails);
+                        layer.sharp_tails_height.swap(cached_layer.sharp_tails_height);
+                    }
+                });
+            has_sharp_tails     = m_overhangs->has_sharp_tails;
+            has_cantilever      = m_overhangs->has_cantilever;
+            max_cantilever_dist = m_overhangs->max_cantilever_dist;
+            BOOST_LOG_TRIVIAL(info) << "Reusing the tree support overhangs detected by the previous run.";
+            collect_overhang_types(*m_overhangs);
+            return;
+        }
+    }
+
     typedef std::chrono::high_resolution_clock clock_;
     typedef std::chrono::duration<double, std::ratio<1> > second_;
     std::chrono::time_point<clock_> t0{ clock_::now() };
@@ -893,89 +984,102 @@ void TreeSupport::detect_overhangs(bool check_support_necessity/* = false*/)
             // BBS detect sharp tail
             const ExPolygons& lower_layer_sharptails = lower_layer->sharp_tails;
             const auto& lower_layer_sharptails_height = lower_layer->sharp_tails_height;
-            for (ExPolygon& expoly : layer->lslices_extrudable) {
-                bool  is_sharp_tail = false;
-                float accum_height = layer->height;
-                do {
-                    // 2. something below
-                    // check whether this is above a sharp tail region.
-
-                    // 2.1 If no sharp tail below, this is considered as common region.
-                    ExPolygons supported_by_lower = intersection_ex({ expoly }, lower_layer_sharptails);
-                    if (supported_by_lower.empty()) {
-                        is_sharp_tail = false;
-                        break;
-                    }
+            // The regions of a layer only depend on the sharp tails of the layer below, thus they are classified in parallel.
+            std::vector<float> sharp_tails_height(layer->lslices_extrudable.size(), 0.f);
+            tbb::parallel_for(tbb::blocked_range<size_t>(0, layer->lslices_extrudable.size()),
+                [&](const tbb::blocked_range<size_t>& range) {
+                for (size_t expoly_idx = range.begin(); expoly_idx < range.end(); expoly_idx++) {
+                    const ExPolygon& expoly = layer->lslices_extrudable[expoly_idx];
+                    bool  is_sharp_tail = false;
+                    float accum_height = layer->height;
+                    do {
+                        // 2. something below
+                        // check whether this is above a sharp tail region.
+
+                        // 2.1 If no sharp tail below, this is considered as common region.
+                        ExPolygons supported_by_lower = intersection_ex({ expoly }, lower_layer_sharptails);
+                        if (supported_by_lower.empty()) {
+                            is_sharp_tail = false;
+                            break;
+                        }
 
-                    // 2.2 If sharp tail below, check whether it support this region enough.
+                        // 2.2 If sharp tail below, check whether it support this region enough.
 #if 0
-                    // judge by area isn't reliable, failure cases include 45 degree rotated cube
-                    float       supported_area = area(supported_by_lower);
-                    if (supported_area > area_thresh_well_supported) {
-                        is_sharp_tail = false;
-                        break;
-                    }
+                        // judge by area isn't reliable, failure cases include 45 degree rotated cube
+                        float       supported_area = area(supported_by_lower);
+                        if (supported_area > area_thresh_well_supported) {
+                            is_sharp_tail = false;
+                            break;
+                        }
 #endif
-                    BoundingBox bbox = get_extents(supported_by_lower);
-                    if (bbox.size().x() > length_thresh_well_supported && bbox.size().y() > length_thresh_well_supported) {
-                        is_sharp_tail = false;
-                        break;
-                    }
+                        BoundingBox bbox = get_extents(supported_by_lower);
+                        if (bbox.size().x() > length_thresh_well_supported && bbox.size().y() > length_thresh_well_supported) {
+                            is_sharp_tail = false;
+                            break;
+                        }
 
-                    // 2.3 check whether sharp tail exceed the max height
-                    for(size_t i=0;i<lower_layer_sharptails.size();i++) {
-                        if (lower_layer_sharptails[i].overlaps(expoly)) {
-                            accum_height += lower_layer_sharptails_height[i];
+                        // 2.3 check whether sharp tail exceed the max height
+                        for(size_t i=0;i<lower_layer_sharptails.size();i++) {
+                            if (lower_layer_sharptails[i].overlaps(expoly)) {
+                                accum_height += lower_layer_sharptails_height[i];
+                                break;
+                            }
+                        }
+                        if (accum_height > sharp_tail_max_support_height) {
+                            is_sharp_tail = false;
                             break;
                         }
-                    }
-                    if (accum_height > sharp_tail_max_support_height) {
-                        is_sharp_tail = false;
-                        break;
-                    }
 
-                    // 2.4 if the area grows fast than threshold, it get connected to other part or
-                    // it has a sharp slop and will be auto supported.
-                    ExPolygons new_overhang_expolys = diff_ex({ expoly }, lower_layer_sharptails);
-                    if ((get_extents(new_overhang_expolys).size() - get_extents(lower_layer_sharptails).size()).both_comp(Point(scale_(5), scale_(5)), ">") || !offset_ex(new_overhang_expolys, -5.0 * extrusion_width_scaled).empty()) {
-                        is_sharp_tail = false;
-                        break;
-                    }
+                        // 2.4 if the area grows fast than threshold, it get connected to other part or
+                        // it has a sharp slop and will be auto supported.
+                        ExPolygons new_overhang_expolys = diff_ex({ expoly }, lower_layer_sharptails);
+                        if ((get_extents(new_overhang_expolys).size() - get_extents(lower_layer_sharptails).size()).both_comp(Point(scale_(5), scale_(5)), ">") || !offset_ex(new_overhang_expolys, -5.0 * extrusion_width_scaled).empty()) {
+                            is_sharp_tail = false;
+                            break;
+                        }
 
-                    // 2.5 mark the expoly as sharptail
-                    is_sharp_tail = true;
-                } while (0);
+                        // 2.5 mark the expoly as sharptail
+                        is_sharp_tail = true;
+                    } while (0);
 
-                if (is_sharp_tail) {
-                    layer->sharp_tails.push_back(expoly);
-                    layer->sharp_tails_height.push_back( accum_height);
+                    if (is_sharp_tail)
+                        sharp_tails_height[expoly_idx] = accum_height;
+                }
+            });
+            // Sharp tails are at least one layer high.
+            for (size_t expoly_idx = 0; expoly_idx < sharp_tails_height.size(); expoly_idx++)
+                if (sharp_tails_height[expoly_idx] > 0.f) {
+                    layer->sharp_tails.push_back(layer->lslices_extrudable[expoly_idx]);
+                    layer->sharp_tails_height.push_back(sharp_tails_height[expoly_idx]);
                 }
-
-            }
         }
     }
 
+    // Overhangs overlapping the cantilevers of their layer, independent of the clustering.
+    std::vector<std::vector<bool>> overhangs_on_cantilevers(m_object->layer_count());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, m_object->layer_count()),
+        [&](const tbb::blocked_range<size_t>& range) {
+            for (size_t layer_nr = range.begin(); layer_nr < range.end(); layer_nr++) {
+                const Layer* layer = m_object->get_layer(layer_nr);
+                for (const ExPolygon& overhang : overhangs_all_layers[layer_nr])
+                    overhangs_on_cantilevers[layer_nr].push_back(overlaps({ overhang }, layer->cantilevers));
+            }
+        });
+
     // group overhang clusters
     for (size_t layer_nr = 0; layer_nr < m_object->layer_count(); layer_nr++) {
         if (m_object->print()->canceled())
             break;
-        Layer* layer = m_object->get_layer(layer_nr);
-        for (auto& overhang : overhangs_all_layers[layer_nr]) {
-            OverhangCluster* cluster = find_and_insert_cluster(overhangClusters, overhang, layer_nr, extrusion_width_scaled);
-            if (overlaps({ overhang }, layer->cantilevers))
+        for (size_t overhang_idx = 0; overhang_idx < overhangs_all_layers[layer_nr].size(); overhang_idx++) {
+            OverhangCluster* cluster = find_and_insert_cluster(overhangClusters, overhangs_all_layers[layer_nr][overhang_idx], layer_nr, extrusion_width_scaled);
+            if (overhangs_on_cantilevers[layer_nr][overhang_idx])
                 cluster->is_cantilever = true;
         }
     }
 
-    auto enforcers = m_object->slice_support_enforcers();
-    auto blockers  = m_object->slice_support_blockers();
-    m_vertical_enforcer_points.clear();
-    m_object->project_and_append_custom_facets(false, EnforcerBlockerType::ENFORCER, enforcers, &m_vertical_enforcer_points);
-    m_object->project_and_append_custom_facets(false, EnforcerBlockerType::BLOCKER, blockers);
-
     if (is_auto(stype) && config_remove_small_overhangs) {
         // remove small overhangs
-        for (auto& cluster : overhangClusters) {
+        tbb::parallel_for_each(overhangClusters.begin(), overhangClusters.end(), [&](OverhangCluster& cluster) {
             // 3. check whether the small overhang is sharp tail
             cluster.is_sharp_tail = false;
             for (size_t layer_id = cluster.min_layer; layer_id <= cluster.max_layer; layer_id++) {
@@ -1006,7 +1110,7 @@ void TreeSupport::detect_overhangs(bool check_support_necessity/* = false*/)
                 { cluster.merged_poly,{"overhang", "blue", 0.5} },
                 { cluster.is_cantilever? layer1->cantilevers: offset_ex(cluster.merged_poly, -1 * extrusion_width_scaled), {cluster.is_cantilever ? "cantilever":"erode1","green",0.5}} });
 #endif
-        }
+        });
     }
 
     for (auto& cluster : overhangClusters) {
@@ -1019,83 +1123,90 @@ void TreeSupport::detect_overhangs(bool check_support_necessity/* = false*/)
         }
     }
 
-    int layers_with_overhangs = 0;
-    int layers_with_enforcers = 0;
-    for (int layer_nr = 0; layer_nr < m_object->layer_count(); layer_nr++) {
-        if (m_object->print()->canceled())
-            break;
+    // The layers are finished independently of each other.
+    // The numbers of the overhangs of each layer by origin are needed even if the overhangs are not kept.
+    TreeSupportOverhangs overhangs;
+    overhangs.layers.assign(m_object->layer_count(), {});
+    std::atomic<bool> has_sharp_tail_overhangs { false };
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, m_object->layer_count()),
+        [&](const tbb::blocked_range<size_t>& range) {
+        for (size_t layer_nr = range.begin(); layer_nr < range.end(); layer_nr++) {
+            if (m_object->print()->canceled())
+                break;
 
-        auto layer = m_object->get_layer(layer_nr);
-        auto lower_layer = layer->lower_layer;
+            auto layer = m_object->get_layer(layer_nr);
+            auto lower_layer = layer->lower_layer;
 
-        // add support for every 1mm height for sharp tails
-        ExPolygons sharp_tail_overhangs;
-        if (lower_layer == nullptr)
-            sharp_tail_overhangs = layer->sharp_tails;
-        else {
-            ExPolygons lower_layer_expanded = offset_ex(lower_layer->lslices_extrudable, SCALED_RESOLUTION);
-            for (size_t i = 0; i < layer->sharp_tails_height.size();i++) {
-                ExPolygons areas = diff_clipped({ layer->sharp_tails[i]}, lower_layer_expanded);
-                float accum_height = layer->sharp_tails_height[i];
-                if (!areas.empty() && int(accum_height * 10) % 5 == 0) {
-                    append(sharp_tail_overhangs, areas);
-                    has_sharp_tails = true;
+            // add support for every 1mm height for sharp tails
+            ExPolygons sharp_tail_overhangs;
+            if (lower_layer == nullptr)
+                sharp_tail_overhangs = layer->sharp_tails;
+            else {
+                ExPolygons lower_layer_expanded = offset_ex(lower_layer->lslices_extrudable, SCALED_RESOLUTION);
+                for (size_t i = 0; i < layer->sharp_tails_height.size();i++) {
+                    ExPolygons areas = diff_clipped({ layer->sharp_tails[i]}, lower_layer_expanded);
+                    float accum_height = layer->sharp_tails_height[i];
+                    if (!areas.empty() && int(accum_height * 10) % 5 == 0) {
+                        append(sharp_tail_overhangs, areas);
+                        has_sharp_tail_overhangs = true;
 #ifdef SUPPORT_TREE_DEBUG_TO_SVG
-                    SVG::export_expolygons(debug_out_path("sharp_tail_%.02f.svg", layer->print_z), areas);
+                        SVG::export_expolygons(debug_out_path("sharp_tail_%.02f.svg", layer->print_z), areas);
 #endif
+                    }
                 }
             }
-        }
-
-        if (layer_nr < blockers.size()) {
-            // Arthur: union_ is a must because after mirroring, the blocker polygons are in left-hand coordinates, ie clockwise,
-            // which are not valid polygons, and will be removed by offset_ex. union_ can make these polygons right.
-            ExPolygons blocker = offset_ex(union_(blockers[layer_nr]), scale_(radius_sample_resolution));
-            layer->loverhangs = diff_ex(layer->loverhangs, blocker);
-            layer->cantilevers = diff_ex(layer->cantilevers, blocker);
-            sharp_tail_overhangs = diff_ex(sharp_tail_overhangs, blocker);
-        }
 
-        if (support_critical_regions_only && is_auto(stype)) {
-            layer->loverhangs.clear();  // remove oridinary overhangs, only keep cantilevers and sharp tails (added later)
-            append(layer->loverhangs, layer->cantilevers);
-        }
+            if (layer_nr < blockers.size()) {
+                // Arthur: union_ is a must because after mirroring, the blocker polygons are in left-hand coordinates, ie clockwise,
+                // which are not valid polygons, and will be removed by offset_ex. union_ can make these polygons right.
+                ExPolygons blocker = offset_ex(union_(blockers[layer_nr]), scale_(radius_sample_resolution));
+                layer->loverhangs = diff_ex(layer->loverhangs, blocker);
+                layer->cantilevers = diff_ex(layer->cantilevers, blocker);
+                sharp_tail_overhangs = diff_ex(sharp_tail_overhangs, blocker);
+            }
 
-        if (max_bridge_length > 0 && layer->loverhangs.size() > 0 && lower_layer) {
-            // do not break bridge as the interface will be poor, see #4318
-            bool break_bridge = false;
-            m_object->remove_bridges_from_contacts(lower_layer, layer, extrusion_width_scaled, &layer->loverhangs, max_bridge_length, break_bridge);
-        }
+            if (support_critical_regions_only && is_auto(stype)) {
+                layer->loverhangs.clear();  // remove oridinary overhangs, only keep cantilevers and sharp tails (added later)
+                append(layer->loverhangs, layer->cantilevers);
+            }
 
-		int nDetected = layer->loverhangs.size();
-        // enforcers now follow same logic as normal support. See STUDIO-3692
-        if (layer_nr < enforcers.size() && lower_layer) {
-            ExPolygons enforced_overhangs   = intersection_ex(diff_ex(layer->lslices_extrudable, lower_layer->lslices_extrudable), enforcers[layer_nr]);
-            if (!enforced_overhangs.empty()) {
-                // FIXME this is a hack to make enforcers work on steep overhangs. See STUDIO-7538.
-                enforced_overhangs = diff_ex(offset_ex(enforced_overhangs, enforcer_overhang_offset), lower_layer->lslices_extrudable);
-                append(layer->loverhangs, enforced_overhangs);
+            if (max_bridge_length > 0 && layer->loverhangs.size() > 0 && lower_layer) {
+                // do not break bridge as the interface will be poor, see #4318
+                bool break_bridge = false;
+                m_object->remove_bridges_from_contacts(lower_layer, layer, extrusion_width_scaled, &layer->loverhangs, max_bridge_length, break_bridge);
             }
-        }
-        int nEnforced = layer->loverhangs.size();
 
-        // add sharp tail overhangs
-        append(layer->loverhangs, sharp_tail_overhangs);
+            TreeSupportOverhangs::LayerOverhangs &layer_overhangs = overhangs.layers[layer_nr];
+            layer_overhangs.num_detected = layer->loverhangs.size();
+            // enforcers now follow same logic as normal support. See STUDIO-3692
+            if (layer_nr < enforcers.size() && lower_layer) {
+                ExPolygons enforced_overhangs   = intersection_ex(diff_ex(layer->lslices_extrudable, lower_layer->lslices_extrudable), enforcers[layer_nr]);
+                if (!enforced_overhangs.empty()) {
+                    // FIXME this is a hack to make enforcers work on steep overhangs. See STUDIO-7538.
+                    enforced_overhangs = diff_ex(offset_ex(enforced_overhangs, enforcer_overhang_offset), lower_layer->lslices_extrudable);
+                    append(layer->loverhangs, enforced_overhangs);
+                }
+            }
+            layer_overhangs.num_enforced = layer->loverhangs.size();
 
-        // fill overhang_types
-        for (size_t i = 0; i < layer->loverhangs.size(); i++)
-            overhang_types.emplace(&layer->loverhangs[i], i < nDetected ? OverhangType::Detected :
-                i < nEnforced ? OverhangType::Enforced : OverhangType::SharpTail);
+            // add sharp tail overhangs
+            append(layer->loverhangs, sharp_tail_overhangs);
 
-        if (!layer->loverhangs.empty()) {
-            layers_with_overhangs++;
-            m_highest_overhang_layer = std::max(m_highest_overhang_layer, size_t(layer_nr));
+            if (m_overhangs)
+                layer_overhangs.overhangs = layer->loverhangs;
         }
-        if (nEnforced > 0) layers_with_enforcers++;
-        if (!layer->cantilevers.empty()) has_cantilever = true;
-    }
+    });
+    if (has_sharp_tail_overhangs)
+        has_sharp_tails = true;
 
-    BOOST_LOG_TRIVIAL(info) << "Tree support overhang detection done. " << layers_with_overhangs << " layers with overhangs. nEnforced=" << layers_with_enforcers;
+    collect_overhang_types(overhangs);
+
+    if (m_overhangs) {
+        m_overhangs->layers              = std::move(overhangs.layers);
+        m_overhangs->has_sharp_tails     = has_sharp_tails;
+        m_overhangs->has_cantilever      = has_cantilever;
+        m_overhangs->max_cantilever_dist = max_cantilever_dist;
+    }
 
 #ifdef SUPPORT_TREE_DEBUG_TO_SVG
     for (const Layer* layer : m_object->layers()) {
@@ -1712,6 +1823,26 @@ void TreeSupport::generate()
     BOOST_LOG_TRIVIAL(info) << "tree support time " << profiler.report();
 }
 
+void TreeSupport::store_overhangs()
+{
+    if (! m_overhangs || m_overhangs->layers.size() != m_object->layer_count() || m_object->print()->canceled())
+        return;
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, m_object->layer_count()),
+        [this](const tbb::blocked_range<size_t>& range) {
+            for (size_t layer_nr = range.begin(); layer_nr < range.end(); layer_nr++) {
+                Layer                                &layer           = *m_object->get_layer(layer_nr);
+                TreeSupportOverhangs::LayerOverhangs &layer_overhangs = m_overhangs->layers[layer_nr];
+                layer_overhangs.cantilevers        = std::move(layer.cantilevers);
+                layer_overhangs.sharp_tails        = std::move(layer.sharp_tails);
+                layer_overhangs.sharp_tails_height = std::move(layer.sharp_tails_height);
+                layer.cantilevers.clear();
+                layer.sharp_tails.clear();
+                layer.sharp_tails_height.clear();
+            }
+        });
+    m_object->set_tree_support_overhangs(std::move(m_overhangs));
+}
+
 coordf_t TreeSupport::calc_branch_radius(coordf_t base_radius, size_t layers_to_top, size_t tip_layers, double diameter_angle_scale_factor)
 {
     double radius;
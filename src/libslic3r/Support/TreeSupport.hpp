@@ -341,6 +341,49 @@ public:
     friend TreeSupport;
 };
 
+/*!
+ * \brief Result of TreeSupport::detect_overhangs(), kept by the PrintObject between the runs of the support generator.
+ *
+ * The overhang detection depends on the slices, the perimeters, the support enforcers / blockers and a handful of settings
+ * (see Key), but not on the shape of the trees. If only the tree parameters change, the detection is skipped.
+ *
+ * The cantilevers and the sharp tails are not needed by the layers once the trees are generated, thus they are moved here.
+ * The overhangs are copied, because Layer::loverhangs is replaced by PrintObject::detect_overhangs_for_lift().
+ */
+struct TreeSupportOverhangs
+{
+    // Inputs of the detection except for the slices and the perimeters, whose invalidation releases the overhangs.
+    struct Key
+    {
+        SupportType           support_type;
+        DynamicPrintConfig    settings;
+        size_t                layer_count;
+        std::vector<Polygons> enforcers;
+        std::vector<Polygons> blockers;
+
+        bool operator==(const Key &rhs) const;
+    };
+
+    struct LayerOverhangs
+    {
+        // Layer::loverhangs: the detected, then the enforced and then the sharp tail overhangs.
+        ExPolygons         overhangs;
+        size_t             num_detected = 0;
+        size_t             num_enforced = 0;
+        ExPolygons         cantilevers;
+        ExPolygons         sharp_tails;
+        std::vector<float> sharp_tails_height;
+    };
+
+    Key                         key;
+    std::vector<LayerOverhangs> layers;
+    bool                        has_sharp_tails     = false;
+    bool                        has_cantilever      = false;
+    double                      max_cantilever_dist = 0;
+
+    size_t memsize() const;
+};
+
 struct LineHash {
     size_t operator()(const Line& line) const {
         return (std::hash<coord_t>()(line.a(0)) ^ std::hash<coord_t>()(line.b(1))) * 102 +
@@ -376,6 +419,11 @@ public:
 
     void detect_overhangs(bool check_support_necessity = false);
 
+    /*!
+     * \brief Hand the detected overhangs over to the PrintObject once the trees are generated, see TreeSupportOverhangs.
+     */
+    void store_overhangs();
+
     SupportNode* create_node(const Point  position,
         const int    distance_to_top,
         const int    obj_layer_nr,
@@ -429,6 +477,8 @@ private:
     SupportParameters   m_support_params;
     size_t          m_raft_layers = 0;  // number of raft layers, including raft base, raft interface, raft gap
     size_t          m_highest_overhang_layer = 0;
+    // Overhangs detected or reused by detect_overhangs(), until stored by store_overhangs().
+    std::shared_ptr<TreeSupportOverhangs> m_overhangs;
     std::vector<std::vector<MinimumSpanningTree>> m_spanning_trees;
     std::vector< std::unordered_map<Line, bool, LineHash>> m_mst_line_x_layer_contour_caches;
     float    DO_NOT_MOVER_UNDER_MM = 0.0;
@@ -22,6 +22,7 @@
 #include "SupportCommon.hpp"
 #include "TriangleMeshSlicer.hpp"
 #include "TreeSupport.hpp"
+#include "Utils.hpp"
 #include "I18N.hpp"
 
 #include <cassert>
@@ -3530,6 +3531,10 @@ static void generate_support_areas(Print &print, TreeSupport* tree_support, cons
                 "Influence area creation: " << dur_path << "ms "
                 "Placement of Points in InfluenceAreas: " << dur_place << "ms "
                 "Drawing result as support " << dur_draw << " ms";
+            // The caches are at their largest once the branches are drawn.
+            const size_t volumes_memsize = volumes.memsize();
+            print_object.update_support_caches_memsize(volumes_memsize);
+            BOOST_LOG_TRIVIAL(info) << "Tree support model volumes caches: " << format_memsize_MB(volumes_memsize);
     //        if (config.branch_radius==2121)
     //            BOOST_LOG_TRIVIAL(error) << "Why ask questions when you already know the answer twice.\n (This is not a real bug, please dont report it.)";
             
@@ -2,10 +2,62 @@
 #include "BoundingBox.hpp"
 #include "SVG.hpp"
 
+#include <cmath>
 #include <map>
 
+#include <boost/functional/hash.hpp>
+
+#include <ankerl/unordered_dense.h>
+
 namespace Slic3r {
 
+// Assigns the surfaces into groups of surfaces, which could merge with each other (see surfaces_could_merge()),
+// in constant time per surface instead of comparing the surface with the first surface of each group.
+class SurfaceMergeGroups
+{
+public:
+    // Id of the group of surfaces, which could merge with the surface. A new group gets the next id,
+    // thus the groups are numbered in the order of their first surfaces.
+    size_t group_id(const Surface &surface)
+    {
+        // A surface with a NaN property could not merge with any surface, not even with itself.
+        if (std::isnan(surface.thickness) || std::isnan(surface.bridge_angle))
+            return m_num_groups ++;
+        auto [it, inserted] = m_groups.try_emplace(Key{ surface.surface_type, surface.thickness, surface.thickness_layers, surface.bridge_angle }, m_num_groups);
+        if (inserted)
+            ++ m_num_groups;
+        return it->second;
+    }
+
+private:
+    struct Key
+    {
+        SurfaceType    surface_type;
+        double         thickness;
+        unsigned short thickness_layers;
+        double         bridge_angle;
+
+        bool operator==(const Key &rhs) const {
+            return surface_type == rhs.surface_type && thickness == rhs.thickness && thickness_layers == rhs.thickness_layers && bridge_angle == rhs.bridge_angle;
+        }
+    };
+    struct KeyHash
+    {
+        size_t operator()(const Key &key) const noexcept {
+            // Equal keys shall hash equal, though 0. == -0.
+            auto normalized = [](double value) { return value == 0. ? 0. : value; };
+            size_t seed = std::hash<int>()(int(key.surface_type));
+            boost::hash_combine(seed, normalized(key.thickness));
+            boost::hash_combine(seed, key.thickness_layers);
+            boost::hash_combine(seed, normalized(key.bridge_angle));
+            return seed;
+        }
+    };
+
+    ankerl::unordered_dense::map<Key, size_t, KeyHash> m_groups;
+    size_t                                              m_num_groups { 0 };
+};
+
 void SurfaceCollection::simplify(double tolerance)
 {
     Surfaces ss;
@@ -24,21 +76,27 @@ void SurfaceCollection::simplify(double tolerance)
 /* group surfaces by common properties */
 void SurfaceCollection::group(std::vector<SurfacesPtr> *retval)
 {
-    for (Surfaces::iterator it = this->surfaces.begin(); it != this->surfaces.end(); ++it) {
-        // find a group with the same properties
-        SurfacesPtr* group = NULL;
-        for (std::vector<SurfacesPtr>::iterator git = retval->begin(); git != retval->end(); ++git)
-            if (! git->empty() && surfaces_could_merge(*git->front(), *it)) {
-                group = &*git;
-                break;
-            }
+    SurfaceMergeGroups  merge_groups;
+    // Index into retval of each group of surfaces, which could merge.
+    std::vector<size_t> group_indices;
+    // Index into retval of the group of the surface, new_group_index if no group with these properties exists.
+    auto group_index = [&merge_groups, &group_indices](const Surface &surface, size_t new_group_index) {
+        size_t id = merge_groups.group_id(surface);
+        if (id == group_indices.size())
+            group_indices.emplace_back(new_group_index);
+        return group_indices[id];
+    };
+    // A surface joins the first of the groups passed in it could merge with.
+    for (size_t idx = 0; idx < retval->size(); ++ idx)
+        if (! (*retval)[idx].empty())
+            group_index(*(*retval)[idx].front(), idx);
+    for (Surface &surface : this->surfaces) {
+        size_t idx = group_index(surface, retval->size());
         // if no group with these properties exists, add one
-        if (group == NULL) {
-            retval->resize(retval->size() + 1);
-            group = &retval->back();
-        }
+        if (idx == retval->size())
+            retval->emplace_back();
         // append surface to group
-        group->push_back(&*it);
+        (*retval)[idx].push_back(&surface);
     }
 }
 
@@ -0,0 +1,179 @@
+#include "Trace.hpp"
+#include "Thread.hpp"
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+#include <boost/log/trivial.hpp>
+#include <boost/nowide/fstream.hpp>
+
+namespace Slic3r {
+namespace Trace {
+
+namespace {
+
+struct Event
+{
+    const char *name;
+    uint64_t    start_us;
+    uint64_t    end_us;
+    size_t      object_id;
+    int         layer_id;
+};
+
+// Each thread records into its own buffer, so that recording does not contend between threads.
+// The buffers are owned by the global registry and they are never released, thus a zone recorded
+// by a TBB worker thread remains valid after the thread exits.
+struct ThreadBuffer
+{
+    int                tid;
+    std::string        thread_name;
+    // Only contended while the trace is being exported.
+    std::mutex         mutex;
+    std::vector<Event> events;
+};
+
+std::mutex                                  g_buffers_mutex;
+std::vector<std::unique_ptr<ThreadBuffer>>  g_buffers;
+thread_local ThreadBuffer                  *t_buffer = nullptr;
+
+const std::chrono::steady_clock::time_point g_epoch = std::chrono::steady_clock::now();
+
+ThreadBuffer& thread_buffer()
+{
+    if (t_buffer == nullptr) {
+        auto buffer = std::make_unique<ThreadBuffer>();
+        if (std::optional<std::string> name = get_current_thread_name(); name && ! name->empty())
+            buffer->thread_name = *name;
+        std::lock_guard<std::mutex> lock(g_buffers_mutex);
+        buffer->tid = int(g_buffers.size()) + 1;
+        if (buffer->thread_name.empty())
+            buffer->thread_name = "thread_" + std::to_string(buffer->tid);
+        t_buffer = buffer.get();
+        g_buffers.emplace_back(std::move(buffer));
+    }
+    return *t_buffer;
+}
+
+void write_json_string(std::ostream &os, const char *str)
+{
+    os << '"';
+    for (const char *c = str; *c != 0; ++ c) {
+        switch (*c) {
+        case '"':  os << "\\\""; break;
+        case '\\': os << "\\\\"; break;
+        case '\n': os << "\\n";  break;
+        case '\t': os << "\\t";  break;
+        default:
+            if ((unsigned char)*c >= 0x20)
+                os << *c;
+        }
+    }
+    os << '"';
+}
+
+} // anonymous namespace
+
+namespace detail {
+
+std::atomic<bool> g_enabled { false };
+
+uint64_t now_us()
+{
+    return uint64_t(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - g_epoch).count());
+}
+
+void record(const char *name, uint64_t start_us, uint64_t end_us, size_t object_id, int layer_id)
+{
+    ThreadBuffer &buffer = thread_buffer();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    buffer.events.push_back({ name, start_us, end_us, object_id, layer_id });
+}
+
+} // namespace detail
+
+void start()
+{
+    detail::g_enabled.store(true, std::memory_order_relaxed);
+}
+
+void stop()
+{
+    detail::g_enabled.store(false, std::memory_order_relaxed);
+}
+
+void clear()
+{
+    std::lock_guard<std::mutex> lock(g_buffers_mutex);
+    for (std::unique_ptr<ThreadBuffer> &buffer : g_buffers) {
+        std::lock_guard<std::mutex> buffer_lock(buffer->mutex);
+        buffer->events.clear();
+        buffer->events.shrink_to_fit();
+    }
+}
+
+bool write_chrome_trace(const std::string &path)
+{
+    boost::nowide::ofstream file(path, std::ios::out | std::ios::trunc);
+    if (! file.good()) {
+        BOOST_LOG_TRIVIAL(error) << "Failed to open trace file " << path;
+        return false;
+    }
+
+    size_t num_events = 0;
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    std::lock_guard<std::mutex> lock(g_buffers_mutex);
+    for (std::unique_ptr<ThreadBuffer> &buffer : g_buffers) {
+        std::lock_guard<std::mutex> buffer_lock(buffer->mutex);
+        file << (first ? "\n" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->tid << ",\"args\":{\"name\":";
+        write_json_string(file, buffer->thread_name.c_str());
+        file << "}}";
+        first = false;
+        for (const Event &event : buffer->events) {
+            file << ",\n{\"name\":";
+            write_json_string(file, event.name);
+            file << ",\"cat\":\"slicing\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->tid
+                 << ",\"ts\":" << event.start_us << ",\"dur\":" << (event.end_us - event.start_us);
+            if (event.object_id != NO_OBJECT || event.layer_id != NO_LAYER) {
+                file << ",\"args\":{";
+                if (event.object_id != NO_OBJECT)
+                    file << "\"object\":" << event.object_id << (event.layer_id != NO_LAYER ? "," : "");
+                if (event.layer_id != NO_LAYER)
+                    file << "\"layer\":" << event.layer_id;
+                file << "}";
+            }
+            file << "}";
+        }
+        num_events += buffer->events.size();
+    }
+    file << "\n]}\n";
+    file.close();
+
+    if (file.fail()) {
+        BOOST_LOG_TRIVIAL(error) << "Failed to write trace file " << path;
+        return false;
+    }
+    BOOST_LOG_TRIVIAL(info) << "Exported " << num_events << " trace zones to " << path;
+    return true;
+}
+
+ScopedChromeTrace::ScopedChromeTrace(std::string path) : m_path(std::move(path))
+{
+    if (! m_path.empty())
+        start();
+}
+
+ScopedChromeTrace::~ScopedChromeTrace()
+{
+    if (! m_path.empty()) {
+        stop();
+        write_chrome_trace(m_path);
+    }
+}
+
+} // namespace Trace
+} // namespace Slic3r
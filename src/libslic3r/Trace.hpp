@@ -0,0 +1,89 @@
+#ifndef libslic3r_Trace_hpp_
+#define libslic3r_Trace_hpp_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace Slic3r {
+
+// Lightweight structured tracing of the slicing pipeline.
+//
+// Scoped zones record their name, the thread they ran on and optionally the PrintObject and layer
+// they worked on. Recording is disabled by default, in which case constructing a zone costs a single
+// relaxed atomic load. The recorded zones are exported in the Chrome trace event format, which may be
+// opened with chrome://tracing or https://ui.perfetto.dev to see how the worker threads were utilized.
+namespace Trace {
+
+namespace detail {
+    extern std::atomic<bool> g_enabled;
+    uint64_t                 now_us();
+    void                     record(const char *name, uint64_t start_us, uint64_t end_us, size_t object_id, int layer_id);
+} // namespace detail
+
+static constexpr size_t NO_OBJECT = size_t(-1);
+static constexpr int    NO_LAYER  = -1;
+
+inline bool is_enabled() { return detail::g_enabled.load(std::memory_order_relaxed); }
+
+// Start recording zones. Zones recorded by a previous session are kept until clear() is called.
+void start();
+// Stop recording zones. Zones, which are active while stop() is called, are still recorded.
+void stop();
+// Drop all recorded zones.
+void clear();
+// Export the zones recorded so far in the Chrome trace event JSON format.
+// Returns false if the file could not be written.
+bool write_chrome_trace(const std::string &path);
+
+// Scoped zone. The name must be a string literal or otherwise outlive the trace session,
+// it is stored by pointer only.
+class Zone
+{
+public:
+    explicit Zone(const char *name, size_t object_id = NO_OBJECT, int layer_id = NO_LAYER) :
+        m_name(is_enabled() ? name : nullptr), m_object_id(object_id), m_layer_id(layer_id)
+    {
+        if (m_name != nullptr)
+            m_start = detail::now_us();
+    }
+    ~Zone()
+    {
+        if (m_name != nullptr)
+            detail::record(m_name, m_start, detail::now_us(), m_object_id, m_layer_id);
+    }
+
+    Zone(const Zone &) = delete;
+    Zone &operator=(const Zone &) = delete;
+
+private:
+    const char *m_name;
+    size_t      m_object_id;
+    int         m_layer_id;
+    uint64_t    m_start { 0 };
+};
+
+// Starts recording on construction if a path is provided, writes the trace to that path on destruction.
+class ScopedChromeTrace
+{
+public:
+    explicit ScopedChromeTrace(std::string path);
+    ~ScopedChromeTrace();
+
+private:
+    std::string m_path;
+};
+
+} // namespace Trace
+} // namespace Slic3r
+
+#define SLIC3R_TRACE_CONCAT_IMPL(a, b) a##b
+#define SLIC3R_TRACE_CONCAT(a, b) SLIC3R_TRACE_CONCAT_IMPL(a, b)
+#define SLIC3R_TRACE_ZONE(name) ::Slic3r::Trace::Zone SLIC3R_TRACE_CONCAT(slic3r_trace_zone_, __LINE__)(name)
+#define SLIC3R_TRACE_ZONE_OBJECT(name, object_id) \
+    ::Slic3r::Trace::Zone SLIC3R_TRACE_CONCAT(slic3r_trace_zone_, __LINE__)(name, size_t(object_id))
+#define SLIC3R_TRACE_ZONE_LAYER(name, object_id, layer_id) \
+    ::Slic3r::Trace::Zone SLIC3R_TRACE_CONCAT(slic3r_trace_zone_, __LINE__)(name, size_t(object_id), int(layer_id))
+
+#endif // libslic3r_Trace_hpp_
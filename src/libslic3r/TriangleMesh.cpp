@@ -390,16 +390,16 @@ bool TriangleMesh::is_splittable() const
 std::vector<TriangleMesh> TriangleMesh::split() const
 {
     std::vector<indexed_triangle_set> itss = its_split(this->its);
-    std::vector<TriangleMesh> out;
-    out.reserve(itss.size());
-    for (indexed_triangle_set &m : itss) {
+    std::vector<TriangleMesh> out(itss.size());
+    // The parts are independent, their statistics are calculated in parallel. The order of the parts is kept.
+    execution::for_each(ex_tbb, size_t(0), itss.size(), [&itss, &out](size_t part_id) {
         // The TriangleMesh constructor shall fill in the mesh statistics including volume.
-        out.emplace_back(std::move(m));
-        if (TriangleMesh &triangle_mesh = out.back(); triangle_mesh.volume() < 0)
+        TriangleMesh &triangle_mesh = out[part_id];
+        triangle_mesh = TriangleMesh(std::move(itss[part_id]));
+        if (triangle_mesh.volume() < 0)
             // Some source mesh parts may be incorrectly oriented. Correct them.
             triangle_mesh.flip_triangles();
-
-    }
+    });
     return out;
 }
 
@@ -1447,26 +1447,37 @@ indexed_triangle_set TriangleSelector::get_facets(EnforcerBlockerType state) con
 void TriangleSelector::get_facets(std::vector<indexed_triangle_set>& facets_per_type) const
 {
     facets_per_type.clear();
+    facets_per_type.resize((int)EnforcerBlockerType::ExtruderMax + 1);
 
-    for (int type = (int)EnforcerBlockerType::NONE; type <= (int)EnforcerBlockerType::ExtruderMax; type++) {
-        facets_per_type.emplace_back();
-        indexed_triangle_set& its = facets_per_type.back();
-        std::vector<int> vertex_map(m_vertices.size(), -1);
-
-        for (const Triangle& tr : m_triangles) {
-            if (tr.valid() && !tr.is_split() && tr.get_state() == (EnforcerBlockerType)type) {
-                stl_triangle_vertex_indices indices;
-                for (int i = 0; i < 3; ++i) {
-                    int j = tr.verts_idxs[i];
-                    if (vertex_map[j] == -1) {
-                        vertex_map[j] = int(its.vertices.size());
-                        its.vertices.emplace_back(m_vertices[j].v);
-                    }
-                    indices[i] = vertex_map[j];
+    // Sort the triangles by their state in a single pass, then collect the facets of each state.
+    std::vector<std::vector<int>> triangles_per_type(facets_per_type.size());
+    for (int itriangle = 0; itriangle < int(m_triangles.size()); ++ itriangle)
+        if (const Triangle &tr = m_triangles[itriangle]; tr.valid() && !tr.is_split() && size_t(tr.get_state()) < facets_per_type.size())
+            triangles_per_type[size_t(tr.get_state())].emplace_back(itriangle);
+
+    std::vector<int> vertex_map(m_vertices.size(), -1);
+    for (size_t type = 0; type < facets_per_type.size(); ++ type) {
+        if (triangles_per_type[type].empty())
+            continue;
+        indexed_triangle_set& its = facets_per_type[type];
+        its.indices.reserve(triangles_per_type[type].size());
+        for (int itriangle : triangles_per_type[type]) {
+            const Triangle& tr = m_triangles[itriangle];
+            stl_triangle_vertex_indices indices;
+            for (int i = 0; i < 3; ++i) {
+                int j = tr.verts_idxs[i];
+                if (vertex_map[j] == -1) {
+                    vertex_map[j] = int(its.vertices.size());
+                    its.vertices.emplace_back(m_vertices[j].v);
                 }
-                its.indices.emplace_back(indices);
+                indices[i] = vertex_map[j];
             }
+            its.indices.emplace_back(indices);
         }
+        // Reset the vertex map for the next state.
+        for (int itriangle : triangles_per_type[type])
+            for (int i = 0; i < 3; ++i)
+                vertex_map[m_triangles[itriangle].verts_idxs[i]] = -1;
     }
 }
 
@@ -1512,6 +1523,50 @@ void TriangleSelector::get_facets_strict_recursive(
         this->get_facets_split_by_tjoints({tr.verts_idxs[0], tr.verts_idxs[1], tr.verts_idxs[2]}, neighbors, out_triangles);
 }
 
+void TriangleSelector::get_facets_strict(std::vector<Vec3f> &vertices, std::vector<std::vector<stl_triangle_vertex_indices>> &indices_per_type) const
+{
+    indices_per_type.clear();
+    indices_per_type.resize((int)EnforcerBlockerType::ExtruderMax + 1);
+
+    // One traversal of the split triangles collects the facets of all the states.
+    for (int itriangle = 0; itriangle < m_orig_size_indices; ++ itriangle)
+        this->get_facets_strict_recursive(m_triangles[itriangle], m_neighbors[itriangle], indices_per_type);
+
+    // All the states share the vertices, as with get_facets_strict(state).
+    size_t num_vertices = 0;
+    for (const Vertex &v : m_vertices)
+        if (v.ref_cnt > 0)
+            ++ num_vertices;
+    vertices.clear();
+    vertices.reserve(num_vertices);
+    std::vector<int> vertex_map(m_vertices.size(), -1);
+    for (size_t i = 0; i < m_vertices.size(); ++ i)
+        if (const Vertex &v = m_vertices[i]; v.ref_cnt > 0) {
+            vertex_map[i] = int(vertices.size());
+            vertices.emplace_back(v.v);
+        }
+
+    for (std::vector<stl_triangle_vertex_indices> &indices : indices_per_type)
+        for (stl_triangle_vertex_indices &triangle : indices)
+            for (int i = 0; i < 3; ++ i)
+                triangle(i) = vertex_map[triangle(i)];
+}
+
+void TriangleSelector::get_facets_strict_recursive(
+    const Triangle                                          &tr,
+    const Vec3i32                                           &neighbors,
+    std::vector<std::vector<stl_triangle_vertex_indices>>   &out_triangles_per_type) const
+{
+    if (tr.is_split()) {
+        for (int i = 0; i <= tr.number_of_split_sides(); ++ i)
+            this->get_facets_strict_recursive(
+                m_triangles[tr.children[i]],
+                this->child_neighbors(tr, neighbors, i),
+                out_triangles_per_type);
+    } else if (size_t(tr.get_state()) < out_triangles_per_type.size())
+        this->get_facets_split_by_tjoints({tr.verts_idxs[0], tr.verts_idxs[1], tr.verts_idxs[2]}, neighbors, out_triangles_per_type[size_t(tr.get_state())]);
+}
+
 void TriangleSelector::get_facets_split_by_tjoints(const Vec3i32 &vertices, const Vec3i32 &neighbors, std::vector<stl_triangle_vertex_indices> &out_triangles) const
 {
 // Export this triangle, but first collect the T-joint vertices along its edges.
@@ -337,6 +337,9 @@ public:
 
     // BBS
     void get_facets(std::vector<indexed_triangle_set>& facets_per_type) const;
+    // Get facets of all the states at once, triangulating T-joints. All the states share the vertices get_facets_strict(state) returns,
+    // indices_per_type[state] holds the triangles of that state indexing into the shared vertices.
+    void get_facets_strict(std::vector<Vec3f> &vertices, std::vector<std::vector<stl_triangle_vertex_indices>> &indices_per_type) const;
 
     // Set facet of the mesh to a given state. Only works for original triangles.
     void set_facet(int facet_idx, EnforcerBlockerType state);
@@ -513,6 +516,10 @@ private:
         const Vec3i32                                 &neighbors,
         EnforcerBlockerType                          state,
         std::vector<stl_triangle_vertex_indices>    &out_triangles) const;
+    void get_facets_strict_recursive(
+        const Triangle                                          &tr,
+        const Vec3i32                                           &neighbors,
+        std::vector<std::vector<stl_triangle_vertex_indices>>   &out_triangles_per_type) const;
     void get_facets_split_by_tjoints(const Vec3i32 &vertices, const Vec3i32 &neighbors, std::vector<stl_triangle_vertex_indices> &out_triangles) const;
 
     void get_seed_fill_contour_recursive(int facet_idx, const Vec3i32 &neighbors, const Vec3i32 &neighbors_propagated, std::vector<Vec2i32> &edges_out) const;
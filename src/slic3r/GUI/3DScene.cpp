@@ -713,7 +713,7 @@ int GLVolumeCollection::load_object_volume(
     v.model.init_from(mesh, true);
 #else
     v.model.init_from(*mesh);
-    if (need_raycaster) { v.mesh_raycaster = std::make_unique<GUI::MeshRaycaster>(mesh); }
+    if (need_raycaster) { v.mesh_raycaster = m_raycaster_cache.get(mesh); }
 #endif // ENABLE_SMOOTH_NORMALS
     v.composite_id = GLVolume::CompositeID(obj_idx, volume_idx, instance_idx);
 
@@ -761,6 +761,10 @@ void GLVolumeCollection::load_object_auxiliary(
     mesh.transform(mesh_trafo_inv);
     // Convex hull is required for out of print bed detection.
     TriangleMesh convex_hull = mesh.convex_hull_3d();
+#if !ENABLE_SMOOTH_NORMALS
+    // The instances share the raycaster.
+    std::shared_ptr<const GUI::MeshRaycaster> mesh_raycaster = std::make_shared<const GUI::MeshRaycaster>(std::make_shared<const TriangleMesh>(mesh));
+#endif // !ENABLE_SMOOTH_NORMALS
     for (const std::pair<size_t, size_t>& instance_idx : instances) {
         const ModelInstance& model_instance = *print_object->model_object()->instances[instance_idx.first];
         this->volumes.emplace_back(new GLVolume((milestone == slaposPad) ? GLVolume::SLA_PAD_COLOR : GLVolume::SLA_SUPPORT_COLOR));
@@ -770,7 +774,7 @@ void GLVolumeCollection::load_object_auxiliary(
 #else
         v.model.init_from(mesh);
         v.model.set_color((milestone == slaposPad) ? GLVolume::SLA_PAD_COLOR : GLVolume::SLA_SUPPORT_COLOR);
-        v.mesh_raycaster = std::make_unique<GUI::MeshRaycaster>(std::make_shared<const TriangleMesh>(mesh));
+        v.mesh_raycaster = mesh_raycaster;
 #endif // ENABLE_SMOOTH_NORMALS
         v.composite_id = GLVolume::CompositeID(obj_idx, -int(milestone), (int)instance_idx.first);
         v.geometry_id = std::pair<size_t, size_t>(timestamp, model_instance.id().id);
@@ -207,8 +207,8 @@ public:
     EHoverState         	hover;
 
     GUI::GLModel            model;
-    // raycaster used for picking
-    std::unique_ptr<GUI::MeshRaycaster> mesh_raycaster;
+    // raycaster used for picking, shared with the GLVolumes of the other instances of the same mesh
+    std::shared_ptr<const GUI::MeshRaycaster> mesh_raycaster;
     // BBS
     mutable std::vector<GUI::GLModel> mmuseg_models;
     mutable ObjectBase::Timestamp       mmuseg_ts;
@@ -423,6 +423,9 @@ private:
     Slope m_slope;
     bool m_show_sinking_contours = false;
 
+    // Raycasters of the meshes of the loaded ModelVolumes, shared by their instances.
+    GUI::MeshRaycasterCache m_raycaster_cache;
+
 public:
     GLVolumePtrs volumes;
 
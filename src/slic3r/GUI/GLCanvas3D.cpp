@@ -1423,7 +1423,8 @@ void GLCanvas3D::toggle_sla_auxiliaries_visibility(bool visible, const ModelObje
 
     std::vector<std::shared_ptr<SceneRaycasterItem>>* raycasters = get_raycasters_for_picking(SceneRaycaster::EType::Volume);
 
-    for (GLVolume* vol : m_volumes.volumes) {
+    for (size_t volume_idx = 0; volume_idx < m_volumes.volumes.size(); ++ volume_idx) {
+        GLVolume* vol = m_volumes.volumes[volume_idx];
         if (vol->composite_id.object_id >= 1000 &&
             vol->composite_id.object_id < 1000 + wxGetApp().plater()->get_partplate_list().get_plate_count())
             continue; // the wipe tower
@@ -1431,7 +1432,9 @@ void GLCanvas3D::toggle_sla_auxiliaries_visibility(bool visible, const ModelObje
             && (instance_idx == -1 || vol->composite_id.instance_id == instance_idx)
             && vol->composite_id.volume_id < 0) {
             vol->is_active = visible;
-            auto it = std::find_if(raycasters->begin(), raycasters->end(), [vol](std::shared_ptr<SceneRaycasterItem> item) { return item->get_raycaster() == vol->mesh_raycaster.get(); });
+            // The raycasters are shared by the instances, look the item up by the index of the volume.
+            auto it = std::find_if(raycasters->begin(), raycasters->end(), [volume_idx](std::shared_ptr<SceneRaycasterItem> item) {
+                return SceneRaycaster::decode_id(SceneRaycaster::EType::Volume, item->get_id()) == int(volume_idx); });
             if (it != raycasters->end())
                 (*it)->set_active(vol->is_active);
         }
@@ -1441,7 +1444,8 @@ void GLCanvas3D::toggle_sla_auxiliaries_visibility(bool visible, const ModelObje
 void GLCanvas3D::toggle_model_objects_visibility(bool visible, const ModelObject* mo, int instance_idx, const ModelVolume* mv)
 {
     std::vector<std::shared_ptr<SceneRaycasterItem>>* raycasters = get_raycasters_for_picking(SceneRaycaster::EType::Volume);
-    for (GLVolume* vol : m_volumes.volumes) {
+    for (size_t volume_idx = 0; volume_idx < m_volumes.volumes.size(); ++ volume_idx) {
+        GLVolume* vol = m_volumes.volumes[volume_idx];
         // BBS: add partplate logic
         if (vol->composite_id.object_id >= 1000 &&
             vol->composite_id.object_id < 1000 + wxGetApp().plater()->get_partplate_list().get_plate_count()) { // wipe tower
@@ -1478,7 +1482,9 @@ void GLCanvas3D::toggle_model_objects_visibility(bool visible, const ModelObject
             }
         }
 
-        auto it = std::find_if(raycasters->begin(), raycasters->end(), [vol](std::shared_ptr<SceneRaycasterItem> item) { return item->get_raycaster() == vol->mesh_raycaster.get(); });
+        // The raycasters are shared by the instances, look the item up by the index of the volume.
+        auto it = std::find_if(raycasters->begin(), raycasters->end(), [volume_idx](std::shared_ptr<SceneRaycasterItem> item) {
+            return SceneRaycaster::decode_id(SceneRaycaster::EType::Volume, item->get_id()) == int(volume_idx); });
         if (it != raycasters->end())
             (*it)->set_active(vol->is_active);
     }
@@ -583,5 +583,11 @@ int MeshRaycaster::get_closest_facet(const Vec3f &point) const
     return facet_idx;
 }
 
+std::shared_ptr<const MeshRaycaster> MeshRaycasterCache::get(const std::shared_ptr<const TriangleMesh> &mesh)
+{
+    assert(mesh);
+    return m_raycasters.get(mesh, [&mesh]() { return std::make_shared<const MeshRaycaster>(mesh); });
+}
+
 } // namespace GUI
 } // namespace Slic3r
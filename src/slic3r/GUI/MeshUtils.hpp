@@ -5,6 +5,7 @@
 #include "libslic3r/Geometry.hpp"
 #include "libslic3r/TriangleMesh.hpp"
 #include "libslic3r/AABBMesh.hpp"
+#include "libslic3r/ConcurrentCache.hpp"
 #include "libslic3r/CSGMesh/TriangleMeshAdapter.hpp"
 #include "libslic3r/CSGMesh/CSGMeshCopy.hpp"
 #include "admesh/stl.h"
@@ -231,6 +232,21 @@ private:
     std::vector<stl_normal> m_normals;
 };
 
+// Raycasters shared by the GLVolumes of all the instances of a mesh.
+// A raycaster only depends on the mesh, the transformation of the instance is passed to each query.
+// The table does not keep the raycasters alive: a raycaster is released together with the last GLVolume using it.
+class MeshRaycasterCache
+{
+public:
+    // Return the raycaster of the mesh, build it if there is none alive.
+    std::shared_ptr<const MeshRaycaster> get(const std::shared_ptr<const TriangleMesh> &mesh);
+
+    void clear() { m_raycasters.clear(); }
+
+private:
+    WeakCache<TriangleMesh, MeshRaycaster> m_raycasters;
+};
+
 struct PickingModel
 {
     GLModel model;
@@ -1955,6 +1955,8 @@ void PartPlate::set_print(PrintBase* print, GCodeResult* result, int index)
 		m_print_index = index;
 
 	m_print->set_plate_origin(m_origin);
+	// Changing just the cooling or the pressure advance options of the plate only re-runs the G-code post-processing.
+	m_print->set_gcode_layer_cache_limit(Print::DefaultGCodeLayerCacheLimit);
 
 	return;
 }
@@ -7230,6 +7230,15 @@ void Plater::priv::on_process_completed(SlicingProcessCompletedEvent &evt)
     this->background_process.stop();
     notification_manager->set_slicing_progress_export_possible();
 
+    if (evt.success() && this->printer_technology == ptFFF && get_logging_level() >= 4) {
+        for (const PrintObject *object : this->background_process.fff_print()->objects())
+            if (! object->get_shared_object())
+                BOOST_LOG_TRIVIAL(debug) << "Memory usage of object " << object->model_object()->name << ": " << object->memory_usage().to_string();
+        if (const GCodeProcessorResult *result = this->background_process.get_current_gcode_result(); result != nullptr)
+            BOOST_LOG_TRIVIAL(debug) << "Memory usage of the G-code preview data: " << format_memsize_MB(result->memsize());
+        BOOST_LOG_TRIVIAL(debug) << "Memory usage of the undo / redo stack: " << format_memsize_MB(m_undo_redo_stack_main.memsize());
+    }
+
     // Reset the "export G-code path" name, so that the automatic background processing will be enabled again.
     this->background_process.reset_export();
     // This bool stops showing export finished notification even when process_completed_with_error is false
@@ -0,0 +1,83 @@
+#include <catch2/catch.hpp>
+#include <test_utils.hpp>
+
+#include "libslic3r/BridgeDetector.hpp"
+#include "libslic3r/ClipperUtils.hpp"
+#include "libslic3r/Geometry.hpp"
+#include "libslic3r/Layer.hpp"
+#include "libslic3r/Print.hpp"
+
+#include "test_data.hpp"
+
+using namespace Slic3r;
+using namespace Slic3r::Test;
+
+struct BridgeFixture
+{
+    ExPolygons bridge;
+    ExPolygons lower_slices;
+};
+
+static ExPolygon rectangle(double x1, double y1, double x2, double y2)
+{
+    return ExPolygon(Polygon::new_scale({ { x1, y1 }, { x2, y1 }, { x2, y2 }, { x1, y2 } }));
+}
+
+// The O-, C- and L-shaped overhangs and the two-sided bridge of the old Perl bridge tests,
+// and the bridges of the sliced bridge test meshes.
+static std::vector<BridgeFixture> bridge_fixtures()
+{
+    std::vector<BridgeFixture> out;
+    for (double rotation : { 0., 45., 135. })
+        for (const Vec2d &size : { Vec2d(20., 10.), Vec2d(10., 20.) }) {
+            ExPolygon lower = rectangle(-2., -2., size.x() + 2., size.y() + 2.);
+            ExPolygon hole  = rectangle(0., 0., size.x(), size.y());
+            lower.holes.emplace_back(hole.contour);
+            lower.holes.back().reverse();
+            lower.rotate(Geometry::deg2rad(rotation), Point::new_scale(size.x() / 2., size.y() / 2.));
+            hole.rotate(Geometry::deg2rad(rotation), Point::new_scale(size.x() / 2., size.y() / 2.));
+            out.push_back({ { hole }, { lower } });
+        }
+    out.push_back({ { rectangle(0., 0., 20., 10.) }, { rectangle(-2., 0., 0., 10.), rectangle(20., 0., 22., 10.) } });
+    out.push_back({ { ExPolygon(Polygon::new_scale({ { 0, 0 }, { 20, 0 }, { 10, 10 }, { 0, 10 } })) },
+                    { ExPolygon(Polygon::new_scale({ { 0, 0 }, { 0, 10 }, { 10, 10 }, { 10, 12 }, { -2, 12 }, { -2, -2 }, { 22, -2 }, { 22, 0 } })) } });
+    out.push_back({ { rectangle(10., 10., 20., 20.) },
+                    { ExPolygon(Polygon::new_scale({ { 10, 10 }, { 10, 20 }, { 20, 20 }, { 30, 30 }, { 0, 30 }, { 0, 0 } })) } });
+
+    for (TestMesh mesh : { TestMesh::bridge, TestMesh::bridge_with_hole, TestMesh::overhang }) {
+        Print print;
+        init_and_process_print({ mesh }, print, DynamicPrintConfig::full_print_config());
+        for (const Layer *layer : print.objects().front()->layers())
+            if (layer->lower_layer != nullptr)
+                for (ExPolygon &bridge : diff_ex(layer->lslices, layer->lower_layer->lslices))
+                    if (bridge.area() > scaled<double>(1.) * scaled<double>(1.))
+                        out.push_back({ { std::move(bridge) }, layer->lower_layer->lslices });
+    }
+    return out;
+}
+
+static double detect_bridge_angle(const BridgeFixture &fixture, bool prune_candidates)
+{
+    BridgeDetector detector(fixture.bridge, fixture.lower_slices, scaled<coord_t>(0.45));
+    detector.prune_candidates = prune_candidates;
+    return detector.detect_angle() ? detector.angle : -1.;
+}
+
+TEST_CASE("BridgeDetector: the pre-scored search picks the angle of the exhaustive search", "[Bridges]") {
+    const std::vector<BridgeFixture> fixtures = bridge_fixtures();
+    REQUIRE(fixtures.size() > 12);
+    for (const BridgeFixture &fixture : fixtures)
+        REQUIRE(detect_bridge_angle(fixture, true) == detect_bridge_angle(fixture, false));
+}
+
+TEST_CASE("BridgeDetector: pre-scored and exhaustive search of the bridge angles", "[Bridges][.Benchmark]") {
+    const std::vector<BridgeFixture> fixtures = bridge_fixtures();
+    std::vector<double> angles[2];
+    for (bool prune_candidates : { false, true })
+        benchmark(prune_candidates ? "Pre-scored" : "Exhaustive", [&fixtures, &angles, prune_candidates]() {
+            for (int i = 0; i < 20; ++ i)
+                for (const BridgeFixture &fixture : fixtures)
+                    angles[prune_candidates].emplace_back(detect_bridge_angle(fixture, prune_candidates));
+        });
+    REQUIRE(angles[true] == angles[false]);
+}
@@ -1,10 +1,12 @@
 #include <catch2/catch.hpp>
+#include <test_utils.hpp>
 
 #include <numeric>
 #include <sstream>
 
 #include "libslic3r/ClipperUtils.hpp"
 #include "libslic3r/Fill/Fill.hpp"
+#include "libslic3r/Fill/FillGyroid.hpp"
 #include "libslic3r/Flow.hpp"
 #include "libslic3r/Geometry.hpp"
 #include "libslic3r/Print.hpp"
@@ -190,6 +192,91 @@ TEST_CASE("Fill: Pattern Path Length", "[Fill]") {
     }
 }
 
+TEST_CASE("Fill: gyroid waves shared between the surfaces of a layer", "[Fill]") {
+    std::unique_ptr<Fill> filler(Fill::new_from_type(ipGyroid));
+    filler->angle   = 0.f;
+    filler->spacing = 0.45;
+    FillParams fill_params;
+    fill_params.density = 0.15f;
+
+    const ExPolygon square({ Point::new_scale(0, 0), Point::new_scale(40, 0), Point::new_scale(40, 40), Point::new_scale(0, 40) });
+    const ExPolygon island({ Point::new_scale(60, 0), Point::new_scale(100, 0), Point::new_scale(100, 40), Point::new_scale(60, 40) });
+    auto fill = [&filler, &fill_params](const ExPolygon &expolygon, double z, GyroidWaveCache *cache) {
+        filler->z = z;
+        static_cast<FillGyroid*>(filler.get())->wave_cache = cache;
+        Surface surface(stInternal, expolygon);
+        return filler->fill_surface(&surface, fill_params);
+    };
+
+    GyroidWaveCache cache;
+    for (double z : { 0.2, 0.4, 1.3, 7.7 }) {
+        const Polylines reference = fill(square, z, nullptr);
+        REQUIRE(! reference.empty());
+        // The first fill computes the waves, the second one and the fill of the other island of the same layer reuse them.
+        REQUIRE(fill(square, z, &cache) == reference);
+        REQUIRE(fill(square, z, &cache) == reference);
+        Polylines other = fill(island, z, nullptr);
+        REQUIRE(fill(island, z, &cache) == other);
+    }
+}
+
+TEST_CASE("Fill: gyroid waves shared between layers one Z period apart", "[Fill]") {
+    std::unique_ptr<Fill> filler(Fill::new_from_type(ipGyroid));
+    filler->angle   = 0.f;
+    filler->spacing = 0.45;
+    FillParams fill_params;
+    fill_params.density = 0.15f;
+
+    const ExPolygon square({ Point::new_scale(0, 0), Point::new_scale(40, 0), Point::new_scale(40, 40), Point::new_scale(0, 40) });
+    auto fill = [&filler, &fill_params, &square](double z, GyroidWaveCache *cache) {
+        filler->z = z;
+        static_cast<FillGyroid*>(filler.get())->wave_cache = cache;
+        Surface surface(stInternal, square);
+        return filler->fill_surface(&surface, fill_params);
+    };
+
+    // Period of the pattern in Z.
+    const double period = 2. * M_PI * filler->spacing / (fill_params.density * FillGyroid::DensityAdjust);
+    for (double z : { 0.2, 1.3, 4.1 }) {
+        GyroidWaveCache cache;
+        const Polylines lower = fill(z, &cache);
+        const Polylines upper = fill(z + period, &cache);
+        REQUIRE(cache.stats().misses == 1);
+        REQUIRE(cache.stats().hits == 1);
+        REQUIRE(lower == fill(z, nullptr));
+        REQUIRE(upper == fill(z + period, nullptr));
+    }
+}
+
+TEST_CASE("Fill: gyroid and TPMS infill of a tall part", "[Fill][.Benchmark]") {
+    const ExPolygon square({ Point::new_scale(0, 0), Point::new_scale(120, 0), Point::new_scale(120, 120), Point::new_scale(0, 120) });
+    FillParams fill_params;
+    fill_params.density = 0.15f;
+
+    for (InfillPattern pattern : { ipGyroid, ipTpmsFK }) {
+        std::unique_ptr<Fill> filler(Fill::new_from_type(pattern));
+        filler->angle   = 0.f;
+        filler->spacing = 0.45;
+        GyroidWaveCache cache;
+        if (pattern == ipGyroid)
+            static_cast<FillGyroid*>(filler.get())->wave_cache = &cache;
+
+        size_t num_lines = 0;
+        benchmark(pattern == ipGyroid ? "Gyroid" : "TPMS-FK", [&filler, &fill_params, &square, &num_lines]() {
+            for (size_t layer_id = 0; layer_id < 500; ++ layer_id) {
+                filler->z = 0.2 * double(layer_id + 1);
+                // Two islands per layer, as in a part with two towers.
+                for (int island = 0; island < 2; ++ island) {
+                    Surface surface(stInternal, square);
+                    surface.expolygon.translate(Point::new_scale(150 * island, 0));
+                    num_lines += filler->fill_surface(&surface, fill_params).size();
+                }
+            }
+        });
+        REQUIRE(num_lines > 0);
+    }
+}
+
 /*
 {
     my $collection = Slic3r::Polyline::Collection->new(
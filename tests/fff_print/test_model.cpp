@@ -1,4 +1,5 @@
 #include <catch2/catch.hpp>
+#include <test_utils.hpp>
 
 #include "libslic3r/libslic3r.h"
 #include "libslic3r/Model.hpp"
@@ -59,3 +60,110 @@ SCENARIO("Model construction", "[Model]") {
         }
     }
 }
+
+SCENARIO("ModelVolume convex hull", "[Model]") {
+    GIVEN("A volume and a clone of its object") {
+        Model         model;
+        ModelObject  *object = model.add_object();
+        ModelVolume  *volume = object->add_volume(make_cylinder(10., 30.));
+        object->add_instance();
+        ModelObject  *clone  = model.add_object(*object);
+        ModelVolume  *cloned = clone->volumes.front();
+        const TriangleMesh expected = volume->mesh().convex_hull_3d();
+
+        THEN("The hull is calculated on demand and shared by the volumes of the same mesh") {
+            REQUIRE(! volume->has_convex_hull());
+            REQUIRE(cloned->get_mesh_shared_ptr() == volume->get_mesh_shared_ptr());
+            REQUIRE(cloned->get_convex_hull().its.vertices == expected.its.vertices);
+            REQUIRE(volume->get_convex_hull_shared_ptr() == cloned->get_convex_hull_shared_ptr());
+        }
+        THEN("The hulls calculated in parallel match the ones calculated on demand") {
+            model.calculate_convex_hulls();
+            REQUIRE(volume->has_convex_hull());
+            REQUIRE(volume->get_convex_hull().its.vertices == expected.its.vertices);
+            // An object with a copy of the mesh and with the hull calculated eagerly.
+            ModelObject *eager = model.add_object();
+            eager->add_volume(make_cylinder(10., 30.))->calculate_convex_hull();
+            const Transform3d trafo = Geometry::rotation_transform(Vec3d(0., 0., 0.5)) * Geometry::translation_transform(Vec3d(20., 30., 0.));
+            REQUIRE(object->convex_hull_2d(trafo) == eager->convex_hull_2d(trafo));
+        }
+        WHEN("The mesh of a volume is scaled before its hull was calculated") {
+            ModelVolume *scaled = model.add_object()->add_volume(make_cylinder(10., 30.));
+            scaled->scale_geometry_after_creation(Vec3f(2.f, 1.f, 0.5f));
+            THEN("The hull is calculated from the scaled mesh") {
+                REQUIRE(scaled->get_convex_hull().bounding_box().min.isApprox(scaled->mesh().bounding_box().min));
+                REQUIRE(scaled->get_convex_hull().bounding_box().max.isApprox(scaled->mesh().bounding_box().max));
+                REQUIRE(volume->get_convex_hull().its.vertices == expected.its.vertices);
+            }
+        }
+    }
+}
+
+// Paint patches of the extruder states 1 to num_states over the mesh of a volume, splitting the triangles at the patch borders.
+static void paint_patches(ModelVolume &volume, int num_patches, int num_states)
+{
+    const indexed_triangle_set &its = volume.mesh().its;
+    TriangleSelector            selector(volume.mesh());
+    for (int i = 0; i < num_patches; ++ i) {
+        const int   facet  = int((size_t(i) * 7919) % its.indices.size());
+        const Vec3f center = (its.vertices[its.indices[facet](0)] + its.vertices[its.indices[facet](1)] + its.vertices[its.indices[facet](2)]) / 3.f;
+        selector.select_patch(facet,
+            TriangleSelector::SinglePointCursor::cursor_factory(center, 10.f * center, 2.f, TriangleSelector::CursorType::SPHERE, Transform3d::Identity(), TriangleSelector::ClippingPlane()),
+            EnforcerBlockerType(1 + i % num_states), Transform3d::Identity(), true);
+    }
+    volume.mmu_segmentation_facets.set(selector);
+}
+
+SCENARIO("Painted facets of all the states", "[Model]") {
+    GIVEN("A sphere painted with 16 extruders") {
+        Model        model;
+        ModelVolume *volume = model.add_object()->add_volume(make_sphere(20.));
+        paint_patches(*volume, 64, 16);
+        const FacetsAnnotation &facets = volume->mmu_segmentation_facets;
+
+        THEN("The facets of all the states decoded at once match the facets of each state") {
+            std::vector<Vec3f>                                    strict_vertices;
+            std::vector<std::vector<stl_triangle_vertex_indices>> strict_per_type;
+            std::vector<indexed_triangle_set>                     facets_per_type;
+            facets.get_facets_strict(*volume, strict_vertices, strict_per_type);
+            facets.get_facets(*volume, facets_per_type);
+            REQUIRE(strict_per_type.size() == size_t(EnforcerBlockerType::ExtruderMax) + 1);
+            REQUIRE(facets_per_type.size() == strict_per_type.size());
+            for (size_t type = 0; type < strict_per_type.size(); ++ type) {
+                const indexed_triangle_set strict = facets.get_facets_strict(*volume, EnforcerBlockerType(type));
+                REQUIRE(strict_per_type[type] == strict.indices);
+                if (! strict.indices.empty())
+                    REQUIRE(strict_vertices == strict.vertices);
+                const indexed_triangle_set its = facets.get_facets(*volume, EnforcerBlockerType(type));
+                REQUIRE(facets_per_type[type].indices == its.indices);
+                REQUIRE(facets_per_type[type].vertices == its.vertices);
+            }
+            REQUIRE(! strict_per_type[16].empty());
+        }
+    }
+}
+
+TEST_CASE("Painted facets of a large mesh", "[Model][.Benchmark]") {
+    Model        model;
+    ModelVolume *volume = model.add_object()->add_volume(make_sphere(100., 2. * PI / 500.));
+    paint_patches(*volume, 1000, 16);
+    const FacetsAnnotation &facets = volume->mmu_segmentation_facets;
+
+    size_t num_facets = 0;
+    benchmark("Decoded once per state", [&facets, volume, &num_facets]() {
+        for (int type = 0; type <= int(EnforcerBlockerType::ExtruderMax); ++ type)
+            num_facets += facets.get_facets_strict(*volume, EnforcerBlockerType(type)).indices.size();
+    });
+
+    size_t num_facets_all = 0;
+    benchmark("Decoded once for all the states", [&facets, volume, &num_facets_all]() {
+        std::vector<Vec3f>                                    vertices;
+        std::vector<std::vector<stl_triangle_vertex_indices>> indices_per_type;
+        facets.get_facets_strict(*volume, vertices, indices_per_type);
+        for (const std::vector<stl_triangle_vertex_indices> &indices : indices_per_type)
+            num_facets_all += indices.size();
+    });
+    REQUIRE(num_facets_all == num_facets);
+    // Each triangle of the mesh is either a leaf or split into several leaves.
+    REQUIRE(num_facets >= volume->mesh().its.indices.size());
+}
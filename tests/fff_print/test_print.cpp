@@ -3,6 +3,14 @@
 #include "libslic3r/libslic3r.h"
 #include "libslic3r/Print.hpp"
 #include "libslic3r/Layer.hpp"
+#include "libslic3r/Trace.hpp"
+
+#include <set>
+
+#include <boost/filesystem.hpp>
+#include <boost/nowide/fstream.hpp>
+
+#include "nlohmann/json.hpp"
 
 #include "test_data.hpp"
 
@@ -138,3 +146,68 @@ SCENARIO("Print: Brim generation", "[Print]") {
         }
     }
 }
+
+SCENARIO("Print: Trace of the slicing pipeline", "[Print]") {
+    GIVEN("A cube sliced and exported while recording a trace") {
+        const boost::filesystem::path path = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("%%%%-%%%%-%%%%.json");
+        Slic3r::Print print;
+        Slic3r::Model model;
+        Slic3r::Test::init_print({ TestMesh::cube_20x20x20 }, print, model, DynamicPrintConfig::full_print_config());
+        Trace::clear();
+        {
+            Trace::ScopedChromeTrace trace(path.string());
+            Slic3r::Test::gcode(print);
+        }
+        nlohmann::json json;
+        {
+            boost::nowide::ifstream file(path.string());
+            REQUIRE(file.good());
+            json = nlohmann::json::parse(file);
+        }
+        boost::filesystem::remove(path);
+        Trace::clear();
+
+        THEN("The trace is a valid Chrome trace with a named thread for each zone") {
+            REQUIRE(json["traceEvents"].is_array());
+            std::set<int> named_threads;
+            for (const nlohmann::json &event : json["traceEvents"])
+                if (event["ph"] == "M") {
+                    REQUIRE(event["name"] == "thread_name");
+                    REQUIRE(! event["args"]["name"].get<std::string>().empty());
+                    named_threads.insert(event["tid"].get<int>());
+                }
+            size_t num_zones = 0;
+            for (const nlohmann::json &event : json["traceEvents"])
+                if (event["ph"] == "X") {
+                    REQUIRE(named_threads.count(event["tid"].get<int>()) == 1);
+                    REQUIRE(event["ts"].is_number_unsigned());
+                    REQUIRE(event["dur"].is_number_unsigned());
+                    ++ num_zones;
+                }
+            REQUIRE(num_zones > 0);
+        }
+        THEN("The pipeline steps and each layer of the object are recorded") {
+            const PrintObject &object = *print.objects().front();
+            std::set<std::string> names;
+            std::vector<int>      perimeter_layers;
+            for (const nlohmann::json &event : json["traceEvents"])
+                if (event["ph"] == "X") {
+                    const std::string name = event["name"];
+                    names.insert(name);
+                    if (name == "PrintObject::slice")
+                        REQUIRE(event["args"]["object"] == object.id().id);
+                    if (name == "Layer::make_perimeters") {
+                        REQUIRE(event["args"]["object"] == object.id().id);
+                        perimeter_layers.emplace_back(event["args"]["layer"].get<int>());
+                    }
+                }
+            for (const char *name : { "Print::process", "PrintObject::slice", "PrintObject::make_perimeters", "PrintObject::infill",
+                                      "GCode::do_export", "GCode::process_layer", "GCodeProcessor::finalize" })
+                REQUIRE(names.count(name) == 1);
+            std::sort(perimeter_layers.begin(), perimeter_layers.end());
+            REQUIRE(perimeter_layers.size() == object.layer_count());
+            for (size_t layer_idx = 0; layer_idx < perimeter_layers.size(); ++ layer_idx)
+                REQUIRE(perimeter_layers[layer_idx] == int(layer_idx));
+        }
+    }
+}
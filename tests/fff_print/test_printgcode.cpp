@@ -2,6 +2,7 @@
 
 #include "libslic3r/libslic3r.h"
 #include "libslic3r/GCodeReader.hpp"
+#include "libslic3r/Layer.hpp"
 
 #include "test_data.hpp"
 
@@ -269,3 +270,100 @@ SCENARIO( "PrintGCode basic functionality", "[PrintGCode]") {
         }
     }
 }
+
+// The export time differs between the exports, the IDs of the objects differ between the prints.
+static std::string without_timestamp_and_ids(const std::string &gcode)
+{
+    return boost::regex_replace(boost::regex_replace(gcode, boost::regex("; generated by [^\n]*\n"), ""), boost::regex("\\bid: ?[0-9]+"), "id:");
+}
+
+SCENARIO("PrintGCode: Cached G-code layers", "[PrintGCode]") {
+    GIVEN("A cube with adaptive pressure advance and the G-code layer cache enabled") {
+        DynamicPrintConfig config = DynamicPrintConfig::full_print_config();
+        config.set_deserialize_strict({
+            { "enable_pressure_advance",   "1" },
+            { "adaptive_pressure_advance", "1" },
+            { "slow_down_layer_time",      "8" },
+            { "fan_max_speed",             "100" }
+            });
+        config.set_key_value("adaptive_pressure_advance_model", new ConfigOptionStrings({ "0.04,3.96,3000\n0.033,3.96,10000\n0.029,7.91,3000\n0.026,7.91,10000" }));
+        Print print;
+        Model model;
+        init_print({ TestMesh::cube_20x20x20 }, print, model, config);
+        print.set_gcode_layer_cache_limit(Print::DefaultGCodeLayerCacheLimit);
+        const std::string first = gcode(print);
+        REQUIRE(print.has_gcode_layer_cache());
+
+        auto fresh_gcode = [&config]() {
+            Print print;
+            Model model;
+            init_print({ TestMesh::cube_20x20x20 }, print, model, config);
+            return gcode(print);
+        };
+        WHEN("Only the options of the post-processing filters change") {
+            config.set_key_value("adaptive_pressure_advance_model", new ConfigOptionStrings({ "0.05,3.96,3000\n0.04,3.96,10000\n0.035,7.91,3000\n0.03,7.91,10000" }));
+            config.set_deserialize_strict({ { "slow_down_layer_time", "15" }, { "fan_max_speed", "80" } });
+            print.apply(model, config);
+            THEN("The cached layers are kept and the G-code is identical to a fresh export") {
+                REQUIRE(print.has_gcode_layer_cache());
+                const std::string replayed = gcode(print);
+                REQUIRE(replayed != first);
+                REQUIRE(without_timestamp_and_ids(replayed) == without_timestamp_and_ids(fresh_gcode()));
+            }
+        }
+        WHEN("An option of the G-code generator changes") {
+            config.set_deserialize_strict({ { "adaptive_pressure_advance", "0" } });
+            print.apply(model, config);
+            THEN("The cached layers are dropped and the G-code is identical to a fresh export") {
+                REQUIRE(! print.has_gcode_layer_cache());
+                REQUIRE(without_timestamp_and_ids(gcode(print)) == without_timestamp_and_ids(fresh_gcode()));
+            }
+        }
+        WHEN("The cache is disabled") {
+            print.set_gcode_layer_cache_limit(0);
+            THEN("No layers are kept by the print") {
+                REQUIRE(! print.has_gcode_layer_cache());
+                config.set_deserialize_strict({ { "slow_down_layer_time", "15" } });
+                print.apply(model, config);
+                gcode(print);
+                REQUIRE(! print.has_gcode_layer_cache());
+            }
+        }
+    }
+}
+
+SCENARIO("PrintGCode: Low memory mode", "[PrintGCode]") {
+    GIVEN("An overhang with infill and supports") {
+        DynamicPrintConfig config = DynamicPrintConfig::full_print_config();
+        config.set_deserialize_strict({
+            { "enable_support",        "1" },
+            { "sparse_infill_density", "20%" }
+            });
+        auto export_gcode = [&config](bool low_memory_mode, size_t &num_extrusions) {
+            Print print;
+            Model model;
+            init_print({ TestMesh::overhang }, print, model, config);
+            print.set_low_memory_mode(low_memory_mode);
+            const std::string out = gcode(print);
+            num_extrusions = 0;
+            for (const Layer *layer : print.objects().front()->layers())
+                for (const LayerRegion *layerm : layer->regions())
+                    num_extrusions += layerm->perimeters.entities.size() + layerm->fills.entities.size();
+            for (const SupportLayer *layer : print.objects().front()->support_layers())
+                num_extrusions += layer->support_fills.entities.size();
+            return out;
+        };
+        WHEN("The G-code is exported in the normal and in the low memory mode") {
+            size_t num_extrusions, num_extrusions_low_memory;
+            const std::string normal     = export_gcode(false, num_extrusions);
+            const std::string low_memory = export_gcode(true, num_extrusions_low_memory);
+            THEN("The G-code is identical") {
+                REQUIRE(without_timestamp_and_ids(low_memory) == without_timestamp_and_ids(normal));
+            }
+            THEN("The extrusions of the layers are released in the low memory mode only") {
+                REQUIRE(num_extrusions > 0);
+                REQUIRE(num_extrusions_low_memory == 0);
+            }
+        }
+    }
+}
@@ -3,6 +3,13 @@
 #include "libslic3r/libslic3r.h"
 #include "libslic3r/Print.hpp"
 #include "libslic3r/Layer.hpp"
+#include "libslic3r/ClipperUtils.hpp"
+#include "libslic3r/GCode/GCodeProcessor.hpp"
+#include "libslic3r/Model.hpp"
+#include "libslic3r/MutablePolygon.hpp"
+#include "libslic3r/Utils.hpp"
+
+#include <boost/filesystem.hpp>
 
 #include "test_data.hpp"
 
@@ -87,3 +94,599 @@ SCENARIO("PrintObject: object layer heights", "[PrintObject]") {
 #endif
     }
 }
+
+// Fill surfaces of all the layer regions of an object, indexed by layer and region.
+static std::vector<std::vector<Surfaces>> fill_surfaces(const PrintObject &object)
+{
+    std::vector<std::vector<Surfaces>> out;
+    for (const Layer *layer : object.layers()) {
+        std::vector<Surfaces> &layer_out = out.emplace_back();
+        for (const LayerRegion *layerm : layer->regions())
+            layer_out.emplace_back(layerm->fill_surfaces.surfaces);
+    }
+    return out;
+}
+
+static void set_fill_surfaces(PrintObject &object, const std::vector<std::vector<Surfaces>> &surfaces)
+{
+    for (size_t layer_id = 0; layer_id < object.layers().size(); ++ layer_id)
+        for (size_t region_id = 0; region_id < object.layers()[layer_id]->regions().size(); ++ region_id)
+            object.layers()[layer_id]->regions()[region_id]->fill_surfaces.surfaces = surfaces[layer_id][region_id];
+}
+
+// Fill surfaces of all the layer regions of the first object, indexed by layer and region.
+static std::vector<std::vector<Surfaces>> process_fill_surfaces(TestMesh mesh, const DynamicPrintConfig &config)
+{
+    Slic3r::Print print;
+    Slic3r::Test::init_and_process_print({ mesh }, print, config);
+    return fill_surfaces(*print.objects().front());
+}
+
+// Object split into two regions by a modifier over the half of the object with the lower X,
+// the modifier changes the shell and the infill settings.
+static void init_and_process_print_with_modifier(TestMesh mesh, Slic3r::Print &print, Slic3r::Model &model, const DynamicPrintConfig &config)
+{
+    Slic3r::Test::init_print({ mesh }, print, model, config);
+    ModelObject        *object = model.objects.front();
+    const BoundingBoxf3 bbox   = object->volumes.front()->mesh().transformed_bounding_box(object->volumes.front()->get_matrix());
+    const Vec3d         size   = bbox.size();
+    TriangleMesh        modifier_mesh(its_make_cube(0.5 * size.x(), size.y() + 2., size.z() + 2.));
+    modifier_mesh.translate(float(bbox.min.x()), float(bbox.min.y() - 1.), float(bbox.min.z() - 1.));
+    // Centered with its offset as the object part, the bounding boxes PrintApply intersects the volumes by ignore the XY offsets.
+    ModelVolume *modifier = object->add_volume(std::move(modifier_mesh), ModelVolumeType::PARAMETER_MODIFIER);
+    modifier->config.set_key_value("top_shell_layers", new ConfigOptionInt(5));
+    modifier->config.set_key_value("bottom_shell_layers", new ConfigOptionInt(4));
+    modifier->config.set_key_value("sparse_infill_density", new ConfigOptionPercent(40));
+    modifier->config.set_key_value("ensure_vertical_shell_thickness", new ConfigOptionEnum<EnsureVerticalShellThickness>(evstNone));
+    print.apply(model, config);
+    print.process();
+}
+
+namespace Slic3r {
+
+// Runs the steps of PrintObject::prepare_infill() one by one on a processed object.
+struct PrintObjectTestAccess
+{
+    // Fill surfaces up to the discovery of the horizontal shells. prepare_infill() is idempotent, thus the steps
+    // produce the same surfaces as when the object was processed.
+    static void discover_vertical_shells(PrintObject &object)
+    {
+        for (Layer *layer : object.m_layers)
+            layer->restore_untyped_slices_no_extra_perimeters();
+        object.detect_surfaces_type();
+        for (Layer *layer : object.m_layers)
+            for (LayerRegion *layerm : layer->regions())
+                layerm->prepare_fill_surfaces();
+        object.discover_vertical_shells();
+    }
+    static void discover_horizontal_shells(PrintObject &object) { object.discover_horizontal_shells(); }
+    // Fill surfaces up to the clipping of the fill surfaces.
+    static void process_external_surfaces(PrintObject &object)
+    {
+        discover_vertical_shells(object);
+        object.discover_horizontal_shells();
+        object.process_external_surfaces();
+    }
+    static void clip_fill_surfaces(PrintObject &object) { object.clip_fill_surfaces(); }
+    static void bridge_over_infill(PrintObject &object) { object.bridge_over_infill(); }
+    static void combine_infill(PrintObject &object) { object.combine_infill(); }
+};
+
+} // namespace Slic3r
+
+// Reference: the top / bottom regions are scattered to the neighbor layers one layer region after the other,
+// as PrintObject::discover_horizontal_shells() used to do.
+static void discover_horizontal_shells_serial(PrintObject &object)
+{
+    LayerPtrs &layers = object.layers();
+    for (size_t region_id = 0; region_id < object.num_printing_regions(); ++ region_id) {
+        for (size_t i = 0; i < layers.size(); ++ i) {
+            Layer                   *layer         = layers[i];
+            LayerRegion             *layerm        = layer->regions()[region_id];
+            const PrintRegionConfig &region_config = layerm->region().config();
+
+            if (!region_config.extra_solid_infills.value.empty() &&
+                check_layer_id_pattern(region_config.extra_solid_infills.value, i)) {
+                for (Surface& surface : layerm->fill_surfaces.surfaces)
+                    if (surface.surface_type == stInternal)
+                        surface.surface_type = stInternalSolid;
+            }
+
+            if (region_config.ensure_vertical_shell_thickness.value == evstAll)
+                continue;
+
+            coordf_t print_z  = layer->print_z;
+            coordf_t bottom_z = layer->bottom_z();
+            for (size_t idx_surface_type = 0; idx_surface_type < 3; ++ idx_surface_type) {
+                SurfaceType type = (idx_surface_type == 0) ? stTop : (idx_surface_type == 1) ? stBottom : stBottomBridge;
+                int num_solid_layers = (type == stTop) ? region_config.top_shell_layers.value : region_config.bottom_shell_layers.value;
+                if (num_solid_layers == 0)
+                    continue;
+                Polygons solid;
+                for (const Surface &surface : layerm->slices.surfaces)
+                    if (surface.surface_type == type)
+                        polygons_append(solid, to_polygons(surface.expolygon));
+                for (const Surface &surface : layerm->fill_surfaces.surfaces)
+                    if (surface.surface_type == type)
+                        polygons_append(solid, to_polygons(surface.expolygon));
+                if (solid.empty())
+                    continue;
+
+                for (int n = (type == stTop) ? int(i) - 1 : int(i) + 1;
+                    (type == stTop) ?
+                        (n >= 0                 && (int(i) - n < num_solid_layers ||
+                                                    print_z - layers[n]->print_z < region_config.top_shell_thickness.value - EPSILON)) :
+                        (n < int(layers.size()) && (n - int(i) < num_solid_layers ||
+                                                    layers[n]->bottom_z() - bottom_z < region_config.bottom_shell_thickness.value - EPSILON));
+                    (type == stTop) ? -- n : ++ n)
+                {
+                    LayerRegion *neighbor_layerm = layers[n]->regions()[region_id];
+                    Polygons new_internal_solid;
+                    {
+                        Polygons internal;
+                        for (const Surface &surface : neighbor_layerm->fill_surfaces.surfaces)
+                            if (surface.surface_type == stInternal || surface.surface_type == stInternalSolid)
+                                polygons_append(internal, to_polygons(surface.expolygon));
+                        new_internal_solid = intersection(solid, internal, ApplySafetyOffset::Yes);
+                    }
+                    if (new_internal_solid.empty()) {
+                        if (region_config.sparse_infill_density.value == 0 || region_config.ensure_vertical_shell_thickness.value == evstCriticalOnly || region_config.ensure_vertical_shell_thickness.value == evstNone)
+                            goto EXTERNAL;
+                        else
+                            continue;
+                    }
+
+                    float factor = 0.0f;
+                    if (region_config.sparse_infill_density.value == 0)
+                        factor = 1.0f;
+                    else if (region_config.ensure_vertical_shell_thickness.value == evstNone)
+                        factor = 0.5f;
+                    else if (region_config.ensure_vertical_shell_thickness.value == evstCriticalOnly)
+                        factor = 0.2f;
+                    if (factor > 0.0f) {
+                        float    margin     = float(neighbor_layerm->flow(frExternalPerimeter).scaled_width()) * factor;
+                        Polygons too_narrow = diff(new_internal_solid,
+                                                   opening(new_internal_solid, margin, margin + ClipperSafetyOffset, jtMiter, 5));
+                        if (!too_narrow.empty())
+                            new_internal_solid = solid = diff(new_internal_solid, too_narrow);
+                    }
+
+                    {
+                        float margin = (region_config.ensure_vertical_shell_thickness.value != evstNone ? 3.f : 1.0f) * layerm->flow(frSolidInfill).scaled_width();
+                        Polygons too_narrow = diff(
+                            new_internal_solid,
+                            opening(new_internal_solid, margin, margin + ClipperSafetyOffset, ClipperLib::jtMiter, 5));
+                        if (! too_narrow.empty()) {
+                            Polygons internal;
+                            for (const Surface &surface : neighbor_layerm->fill_surfaces.surfaces)
+                                if (surface.is_internal() && !surface.is_bridge())
+                                    polygons_append(internal, to_polygons(surface.expolygon));
+                            polygons_append(new_internal_solid, intersection(expand(too_narrow, +margin), internal));
+                        }
+                    }
+
+                    SurfaceCollection backup = std::move(neighbor_layerm->fill_surfaces);
+                    polygons_append(new_internal_solid, to_polygons(backup.filter_by_type(stInternalSolid)));
+                    ExPolygons internal_solid = union_ex(new_internal_solid);
+                    neighbor_layerm->fill_surfaces.set(internal_solid, stInternalSolid);
+                    Polygons polygons_internal = to_polygons(std::move(internal_solid));
+                    ExPolygons internal = diff_ex(backup.filter_by_type(stInternal), polygons_internal, ApplySafetyOffset::Yes);
+                    neighbor_layerm->fill_surfaces.append(internal, stInternal);
+                    polygons_append(polygons_internal, to_polygons(std::move(internal)));
+                    backup.keep_types({ stTop, stBottom, stBottomBridge });
+                    std::vector<SurfacesPtr> top_bottom_groups;
+                    backup.group(&top_bottom_groups);
+                    for (SurfacesPtr &group : top_bottom_groups)
+                        neighbor_layerm->fill_surfaces.append(diff_ex(group, polygons_internal), *group.front());
+                }
+        EXTERNAL:;
+            }
+        }
+    }
+}
+
+// Reference: the sparse infill is clipped by a serial top-down sweep collecting the surfaces of each layer,
+// as PrintObject::clip_fill_surfaces() used to do.
+static void clip_fill_surfaces_serial(PrintObject &object)
+{
+    if (! PrintObject::infill_only_where_needed)
+        return;
+    bool has_infill = false;
+    for (size_t i = 0; i < object.num_printing_regions(); ++ i)
+        if (object.printing_region(i).config().sparse_infill_density > 0) {
+            has_infill = true;
+            break;
+        }
+    if (! has_infill)
+        return;
+
+    LayerPtrs &layers = object.layers();
+    Polygons   upper_internal;
+    for (int layer_id = int(layers.size()) - 1; layer_id > 0; -- layer_id) {
+        Layer *layer       = layers[layer_id];
+        Layer *lower_layer = layers[layer_id - 1];
+        Polygons fill_surfaces;
+        Polygons overhangs;
+        for (const LayerRegion *layerm : layer->regions())
+            for (const Surface &surface : layerm->fill_surfaces.surfaces) {
+                Polygons polygons = to_polygons(surface.expolygon);
+                if (surface.is_solid())
+                    polygons_append(overhangs, polygons);
+                polygons_append(fill_surfaces, std::move(polygons));
+            }
+        Polygons lower_layer_fill_surfaces;
+        Polygons lower_layer_internal_surfaces;
+        for (const LayerRegion *layerm : lower_layer->regions())
+            for (const Surface &surface : layerm->fill_surfaces.surfaces) {
+                Polygons polygons = to_polygons(surface.expolygon);
+                if (surface.surface_type == stInternal || surface.surface_type == stInternalVoid)
+                    polygons_append(lower_layer_internal_surfaces, polygons);
+                polygons_append(lower_layer_fill_surfaces, std::move(polygons));
+            }
+        {
+            Polygons perimeters = intersection(diff(layer->lslices, fill_surfaces), lower_layer_fill_surfaces);
+            float pw = FLT_MAX;
+            for (const LayerRegion *layerm : layer->regions())
+                pw = std::min(pw, (float)layerm->flow(frPerimeter).scaled_width());
+            polygons_append(overhangs, opening(perimeters, pw));
+        }
+        polygons_append(upper_internal, std::move(overhangs));
+        const auto closing_radius = scaled<float>(2.f);
+        upper_internal = intersection(
+            smooth_outward(
+                closing(upper_internal, closing_radius, ClipperLib::jtSquare, 0.),
+                scaled<coord_t>(0.1)),
+            lower_layer_internal_surfaces);
+        for (LayerRegion *layerm : lower_layer->regions()) {
+            if (layerm->region().config().sparse_infill_density.value == 0)
+                continue;
+            Polygons internal;
+            for (Surface &surface : layerm->fill_surfaces.surfaces)
+                if (surface.surface_type == stInternal || surface.surface_type == stInternalVoid)
+                    polygons_append(internal, std::move(surface.expolygon));
+            layerm->fill_surfaces.remove_types({ stInternal, stInternalVoid });
+            layerm->fill_surfaces.append(intersection_ex(internal, upper_internal, ApplySafetyOffset::Yes), stInternal);
+            layerm->fill_surfaces.append(diff_ex        (internal, upper_internal, ApplySafetyOffset::Yes), stInternalVoid);
+        }
+    }
+}
+
+// Reference: the combination groups of each region are combined one after the other,
+// as PrintObject::combine_infill() used to do.
+static void combine_infill_serial(PrintObject &object)
+{
+    LayerPtrs &layers = object.layers();
+    for (size_t region_id = 0; region_id < object.num_printing_regions(); ++ region_id) {
+        const PrintRegion &region = object.printing_region(region_id);
+        if (! region.config().infill_combination.value || region.config().sparse_infill_density == 0.)
+            continue;
+
+        const bool          use_solid_infill = fabs(region.config().sparse_infill_density.value - 100.) < EPSILON;
+        const SurfaceType   surface_type     = use_solid_infill ? stInternalSolid : stInternal;
+        const InfillPattern infill_pattern   = use_solid_infill ? region.config().internal_solid_infill_pattern :
+                                                                  region.config().sparse_infill_pattern;
+
+        double nozzle_diameter = std::min(
+            object.print()->config().nozzle_diameter.get_at(region.config().sparse_infill_filament.value - 1),
+            object.print()->config().nozzle_diameter.get_at(region.config().solid_infill_filament.value - 1));
+        const double infill_combination_max_layer_height = region.config().infill_combination_max_layer_height.get_abs_value(nozzle_diameter);
+        nozzle_diameter = infill_combination_max_layer_height > 0 ? std::min(infill_combination_max_layer_height, nozzle_diameter) : nozzle_diameter;
+
+        std::vector<size_t> combine(layers.size(), 0);
+        {
+            double current_height = 0.;
+            size_t num_layers = 0;
+            for (size_t layer_idx = 0; layer_idx < layers.size(); ++ layer_idx) {
+                const Layer *layer = layers[layer_idx];
+                if (layer->id() == 0)
+                    continue;
+                if (current_height + layer->height >= nozzle_diameter + EPSILON) {
+                    combine[layer_idx - 1] = num_layers;
+                    current_height = 0.;
+                    num_layers = 0;
+                }
+                current_height += layer->height;
+                ++ num_layers;
+            }
+            combine[layers.size() - 1] = num_layers;
+        }
+
+        for (size_t layer_idx = 0; layer_idx < layers.size(); ++ layer_idx) {
+            size_t num_layers = combine[layer_idx];
+            if (num_layers <= 1)
+                continue;
+            std::vector<LayerRegion*> layerms;
+            layerms.reserve(num_layers);
+            for (size_t i = layer_idx + 1 - num_layers; i <= layer_idx; ++ i)
+                layerms.emplace_back(layers[i]->regions()[region_id]);
+            ExPolygons intersection = to_expolygons(layerms.front()->fill_surfaces.filter_by_type(surface_type));
+            for (size_t i = 1; i < layerms.size(); ++ i)
+                intersection = intersection_ex(layerms[i]->fill_surfaces.filter_by_type(surface_type), intersection);
+            double area_threshold = layerms.front()->infill_area_threshold();
+            if (! intersection.empty() && area_threshold > 0.)
+                intersection.erase(std::remove_if(intersection.begin(), intersection.end(),
+                    [area_threshold](const ExPolygon &expoly) { return expoly.area() <= area_threshold; }),
+                    intersection.end());
+            if (intersection.empty())
+                continue;
+            Polygons intersection_with_clearance;
+            intersection_with_clearance.reserve(intersection.size());
+            float clearance_offset =
+                0.5f * layerms.back()->flow(frPerimeter).scaled_width() +
+                ((infill_pattern == ipRectilinear      ||
+                  infill_pattern == ipMonotonic        ||
+                  infill_pattern == ipGrid             ||
+                  infill_pattern == ipLateralLattice   ||
+                  infill_pattern == ipLine             ||
+                  infill_pattern == ipHoneycomb        ||
+                  infill_pattern == ipLateralHoneycomb) ? 1.5f : 0.5f) *
+                    layerms.back()->flow(frSolidInfill).scaled_width();
+            for (ExPolygon &expoly : intersection)
+                polygons_append(intersection_with_clearance, offset(expoly, clearance_offset));
+            for (LayerRegion *layerm : layerms) {
+                Polygons internal = to_polygons(std::move(layerm->fill_surfaces.filter_by_type(surface_type)));
+                layerm->fill_surfaces.remove_type(surface_type);
+                layerm->fill_surfaces.append(diff_ex(internal, intersection_with_clearance), surface_type);
+                if (layerm == layerms.back()) {
+                    Surface templ(surface_type, ExPolygon());
+                    templ.thickness = 0.;
+                    for (LayerRegion *layerm2 : layerms)
+                        templ.thickness += layerm2->layer()->height;
+                    templ.thickness_layers = (unsigned short)layerms.size();
+                    layerm->fill_surfaces.append(intersection, templ);
+                } else {
+                    layerm->fill_surfaces.append(intersection_ex(internal, intersection_with_clearance), stInternalVoid);
+                }
+            }
+        }
+    }
+}
+
+// Fill surfaces of the horizontal shells of a processed object discovered by PrintObject::discover_horizontal_shells() and by the reference.
+static std::pair<std::vector<std::vector<Surfaces>>, std::vector<std::vector<Surfaces>>> discover_horizontal_shells(PrintObject &object)
+{
+    PrintObjectTestAccess::discover_vertical_shells(object);
+    const std::vector<std::vector<Surfaces>> vertical_shells = fill_surfaces(object);
+    PrintObjectTestAccess::discover_horizontal_shells(object);
+    std::vector<std::vector<Surfaces>> shells = fill_surfaces(object);
+    set_fill_surfaces(object, vertical_shells);
+    discover_horizontal_shells_serial(object);
+    return { std::move(shells), fill_surfaces(object) };
+}
+
+// Fill surfaces of a processed object clipped by PrintObject::clip_fill_surfaces() and by the reference,
+// then combined by PrintObject::combine_infill() and by the reference.
+struct ClippedAndCombinedInfill
+{
+    std::vector<std::vector<Surfaces>> clipped;
+    std::vector<std::vector<Surfaces>> clipped_expected;
+    std::vector<std::vector<Surfaces>> combined;
+    std::vector<std::vector<Surfaces>> combined_expected;
+};
+
+static ClippedAndCombinedInfill clip_and_combine_infill(PrintObject &object)
+{
+    ClippedAndCombinedInfill out;
+    PrintObjectTestAccess::process_external_surfaces(object);
+    const std::vector<std::vector<Surfaces>> external_surfaces = fill_surfaces(object);
+    PrintObjectTestAccess::clip_fill_surfaces(object);
+    out.clipped = fill_surfaces(object);
+    set_fill_surfaces(object, external_surfaces);
+    clip_fill_surfaces_serial(object);
+    out.clipped_expected = fill_surfaces(object);
+    // Both combinations start from the same bridges over the sparse infill.
+    PrintObjectTestAccess::bridge_over_infill(object);
+    const std::vector<std::vector<Surfaces>> bridged = fill_surfaces(object);
+    PrintObjectTestAccess::combine_infill(object);
+    out.combined = fill_surfaces(object);
+    set_fill_surfaces(object, bridged);
+    combine_infill_serial(object);
+    out.combined_expected = fill_surfaces(object);
+    return out;
+}
+
+static void require_identical_fill_surfaces(const std::vector<std::vector<Surfaces>> &serial, const std::vector<std::vector<Surfaces>> &parallel)
+{
+    REQUIRE(serial.size() == parallel.size());
+    for (size_t layer_id = 0; layer_id < serial.size(); ++ layer_id) {
+        REQUIRE(serial[layer_id].size() == parallel[layer_id].size());
+        for (size_t region_id = 0; region_id < serial[layer_id].size(); ++ region_id) {
+            const Surfaces &lhs = serial[layer_id][region_id];
+            const Surfaces &rhs = parallel[layer_id][region_id];
+            REQUIRE(lhs.size() == rhs.size());
+            for (size_t i = 0; i < lhs.size(); ++ i) {
+                REQUIRE(lhs[i].surface_type == rhs[i].surface_type);
+                REQUIRE(lhs[i].thickness_layers == rhs[i].thickness_layers);
+                REQUIRE(lhs[i].expolygon == rhs[i].expolygon);
+            }
+        }
+    }
+}
+
+SCENARIO("PrintObject: Horizontal shells", "[PrintObject]") {
+    GIVEN("Objects with top and bottom surfaces on many layers") {
+        auto mesh = GENERATE(TestMesh::pyramid, TestMesh::overhang);
+        auto [top_layers, bottom_layers, extra_solid_infills, sparse_infill_density] = GENERATE(
+            std::make_tuple(2, 1, std::string(), "15%"),
+            std::make_tuple(4, 3, std::string("4"), "0%"),
+            std::make_tuple(3, 2, std::string("3#2,10"), "15%"));
+        auto ensure_vertical_shell_thickness = GENERATE("none", "ensure_critical_only", "ensure_moderate", "ensure_all");
+        DynamicPrintConfig config = DynamicPrintConfig::full_print_config();
+        config.set_deserialize_strict({
+            { "top_shell_layers",                top_layers },
+            { "bottom_shell_layers",             bottom_layers },
+            { "top_shell_thickness",             0 },
+            { "bottom_shell_thickness",          0 },
+            { "extra_solid_infills",             extra_solid_infills },
+            { "ensure_vertical_shell_thickness", ensure_vertical_shell_thickness },
+            { "sparse_infill_density",           sparse_infill_density },
+            { "layer_height",                    0.2 },
+            { "initial_layer_print_height",      0.2 }
+        });
+        Slic3r::Print print;
+        Slic3r::Test::init_and_process_print({ mesh }, print, config);
+        WHEN("The shells are discovered in parallel and by the serial scatter") {
+            auto [shells, expected] = discover_horizontal_shells(*print.get_object(0));
+            THEN("The fill surfaces are identical") {
+                require_identical_fill_surfaces(shells, expected);
+            }
+        }
+    }
+    GIVEN("Objects split into two regions by a modifier") {
+        auto mesh                            = GENERATE(TestMesh::pyramid, TestMesh::overhang);
+        auto ensure_vertical_shell_thickness = GENERATE("ensure_critical_only", "ensure_all");
+        DynamicPrintConfig config = DynamicPrintConfig::full_print_config();
+        config.set_deserialize_strict({
+            { "top_shell_layers",                3 },
+            { "bottom_shell_layers",             2 },
+            { "top_shell_thickness",             0 },
+            { "bottom_shell_thickness",          0 },
+            { "extra_solid_infills",             "3#2,10" },
+            { "ensure_vertical_shell_thickness", ensure_vertical_shell_thickness },
+            { "sparse_infill_density",           "15%" },
+            { "layer_height",                    0.2 },
+            { "initial_layer_print_height",      0.2 }
+        });
+        Slic3r::Print print;
+        Slic3r::Model model;
+        init_and_process_print_with_modifier(mesh, print, model, config);
+        REQUIRE(print.objects().front()->num_printing_regions() == 2);
+        WHEN("The shells are discovered in parallel and by the serial scatter") {
+            auto [shells, expected] = discover_horizontal_shells(*print.get_object(0));
+            THEN("The fill surfaces of both regions are identical") {
+                require_identical_fill_surfaces(shells, expected);
+            }
+        }
+    }
+    GIVEN("20mm cube with 3 top shell layers, 2 bottom shell layers and a solid infill every 10 layers") {
+        DynamicPrintConfig config = DynamicPrintConfig::full_print_config();
+        config.set_deserialize_strict({
+            { "top_shell_layers",                3 },
+            { "bottom_shell_layers",             2 },
+            { "top_shell_thickness",             0 },
+            { "bottom_shell_thickness",          0 },
+            { "extra_solid_infills",             "10" },
+            { "ensure_vertical_shell_thickness", "none" },
+            { "sparse_infill_density",           "15%" },
+            { "layer_height",                    0.25 },
+            { "initial_layer_print_height",      0.25 }
+        });
+        std::vector<std::vector<Surfaces>> layers = process_fill_surfaces(TestMesh::cube_20x20x20, config);
+        THEN("Only the shell layers and every 10th layer are solid") {
+            REQUIRE(layers.size() == 80);
+            auto expected_solid = [](size_t layer_id) { return layer_id < 2 || layer_id >= 77 || (layer_id + 1) % 10 == 0; };
+            for (size_t layer_id = 0; layer_id < layers.size(); ++ layer_id) {
+                bool solid = true;
+                for (const Surfaces &surfaces : layers[layer_id])
+                    for (const Surface &surface : surfaces)
+                        solid &= surface.is_solid();
+                if (expected_solid(layer_id))
+                    CHECK(solid);
+                else if (! expected_solid(layer_id + 1))
+                    // The sparse infill below a solid layer may be turned into an internal bridge.
+                    CHECK(! solid);
+            }
+        }
+    }
+}
+
+SCENARIO("PrintObject: Combined and clipped infill", "[PrintObject]") {
+    // Sets PrintObject::infill_only_where_needed, restores its previous value when leaving the scope.
+    struct InfillOnlyWhereNeeded {
+        InfillOnlyWhereNeeded(bool value) : previous(PrintObject::infill_only_where_needed) { PrintObject::infill_only_where_needed = value; }
+        ~InfillOnlyWhereNeeded() { PrintObject::infill_only_where_needed = previous; }
+        bool previous;
+    };
+    // Without infill_only_where_needed, the sparse infill spans all the layers and some of it is combined.
+    auto require_as_reference = [](const ClippedAndCombinedInfill &infill, bool expect_combined) {
+        require_identical_fill_surfaces(infill.clipped, infill.clipped_expected);
+        require_identical_fill_surfaces(infill.combined, infill.combined_expected);
+        size_t num_combined = 0;
+        for (const std::vector<Surfaces> &layer : infill.combined)
+            for (const Surfaces &surfaces : layer)
+                for (const Surface &surface : surfaces)
+                    if (surface.thickness_layers > 1)
+                        ++ num_combined;
+        if (expect_combined)
+            REQUIRE(num_combined > 0);
+    };
+    GIVEN("Objects with sparse infill on many layers") {
+        auto mesh                     = GENERATE(TestMesh::pyramid, TestMesh::overhang, TestMesh::sloping_hole);
+        auto sparse_infill_density    = GENERATE("15%", "100%");
+        auto infill_only_where_needed = GENERATE(false, true);
+        InfillOnlyWhereNeeded infill_only_where_needed_guard(infill_only_where_needed);
+        DynamicPrintConfig config = DynamicPrintConfig::full_print_config();
+        config.set_deserialize_strict({
+            { "infill_combination",         1 },
+            { "sparse_infill_density",      sparse_infill_density },
+            { "layer_height",               0.1 },
+            { "initial_layer_print_height", 0.2 }
+        });
+        Slic3r::Print print;
+        Slic3r::Test::init_and_process_print({ mesh }, print, config);
+        WHEN("The infill is clipped and combined in parallel and by the serial references") {
+            ClippedAndCombinedInfill infill = clip_and_combine_infill(*print.get_object(0));
+            THEN("The fill surfaces are identical") {
+                require_as_reference(infill, ! infill_only_where_needed);
+            }
+        }
+    }
+    GIVEN("Objects split into two regions by a modifier") {
+        auto mesh                     = GENERATE(TestMesh::pyramid, TestMesh::sloping_hole);
+        auto infill_only_where_needed = GENERATE(false, true);
+        InfillOnlyWhereNeeded infill_only_where_needed_guard(infill_only_where_needed);
+        DynamicPrintConfig config = DynamicPrintConfig::full_print_config();
+        config.set_deserialize_strict({
+            { "infill_combination",         1 },
+            { "sparse_infill_density",      "15%" },
+            { "layer_height",               0.1 },
+            { "initial_layer_print_height", 0.2 }
+        });
+        Slic3r::Print print;
+        Slic3r::Model model;
+        init_and_process_print_with_modifier(mesh, print, model, config);
+        REQUIRE(print.objects().front()->num_printing_regions() == 2);
+        WHEN("The infill is clipped and combined in parallel and by the serial references") {
+            ClippedAndCombinedInfill infill = clip_and_combine_infill(*print.get_object(0));
+            THEN("The fill surfaces of both regions are identical") {
+                require_as_reference(infill, ! infill_only_where_needed);
+            }
+        }
+    }
+}
+
+SCENARIO("PrintObject: Memory usage report", "[PrintObject]") {
+    GIVEN("An overhang with infill and organic tree supports, sliced and exported") {
+        DynamicPrintConfig config = DynamicPrintConfig::full_print_config();
+        config.set_deserialize_strict({
+            { "enable_support",        "1" },
+            { "support_type",          "tree(auto)" },
+            { "support_style",         "organic" },
+            { "sparse_infill_density", "20%" }
+            });
+        Slic3r::Print print;
+        Slic3r::Model model;
+        Slic3r::Test::init_print({ TestMesh::overhang }, print, model, config);
+        print.set_status_silent();
+        print.process();
+        const boost::filesystem::path path = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+        GCodeProcessorResult          result;
+        print.export_gcode(path.string(), &result, nullptr);
+        boost::filesystem::remove(path);
+        WHEN("The memory usage is reported") {
+            const PrintObjectMemoryUsage usage = print.objects().front()->memory_usage();
+            THEN("The memory held by each step is reported") {
+                REQUIRE(usage.slices > 0);
+                REQUIRE(usage.perimeters > 0);
+                REQUIRE(usage.fill_surfaces > 0);
+                REQUIRE(usage.fills > 0);
+                REQUIRE(usage.support_layers > 0);
+                REQUIRE(usage.support_caches > 0);
+                REQUIRE(usage.total() == usage.slices + usage.perimeters + usage.fill_surfaces + usage.fills + usage.support_layers);
+            }
+            THEN("The memory held by the G-code preview is reported") {
+                REQUIRE(result.memsize() > 0);
+            }
+        }
+    }
+}
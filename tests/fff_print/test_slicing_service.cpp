@@ -0,0 +1,111 @@
+#include <catch2/catch.hpp>
+
+#include "libslic3r/libslic3r.h"
+#include "libslic3r/SlicingService.hpp"
+
+#include <boost/filesystem.hpp>
+
+#include "nlohmann/json.hpp"
+
+#include "test_data.hpp"
+
+using namespace Slic3r;
+using namespace Slic3r::Test;
+
+// Root directory of the service, removed at the end of the test.
+struct ServiceRoot
+{
+    ServiceRoot() : path(boost::filesystem::temp_directory_path() / boost::filesystem::unique_path()) { boost::filesystem::create_directories(path); }
+    ~ServiceRoot() { boost::system::error_code ec; boost::filesystem::remove_all(path, ec); }
+    boost::filesystem::path path;
+};
+
+static nlohmann::json request(SlicingService &service, const nlohmann::json &req, std::vector<nlohmann::json> *progress = nullptr)
+{
+    return nlohmann::json::parse(service.process_request(req.dump(), [progress](const std::string &line) {
+        if (progress)
+            progress->emplace_back(nlohmann::json::parse(line));
+    }));
+}
+
+SCENARIO("SlicingService: requests and answers", "[SlicingService]") {
+    ServiceRoot        root;
+    DynamicPrintConfig config = DynamicPrintConfig::full_print_config();
+    // The default relative extruder addressing does not validate without resetting the extruder position at each layer.
+    config.set_deserialize_strict({ { "layer_change_gcode", "G92 E0" } });
+    SlicingService     service((root.path / "service.sock").string(), root.path.string(), config);
+    TriangleMesh       cube = mesh(TestMesh::cube_20x20x20);
+    REQUIRE(cube.write_binary((root.path / "cube.stl").string().c_str()));
+
+    GIVEN("An open session with a model") {
+        nlohmann::json answer = request(service, { { "command", "open" } });
+        REQUIRE(answer["result"] == "ok");
+        const size_t session = answer["session"].get<size_t>();
+        REQUIRE(request(service, { { "command", "load_model" }, { "session", session }, { "path", "cube.stl" } })["result"] == "ok");
+        REQUIRE(request(service, { { "command", "set_config" }, { "session", session }, { "options", { { "layer_height", "0.3" }, { "wall_loops", 2 } } } })["result"] == "ok");
+        WHEN("The session is sliced") {
+            std::vector<nlohmann::json> progress;
+            answer = request(service, { { "command", "slice" }, { "session", session }, { "output", "cube.gcode" } }, &progress);
+            THEN("The G-code is exported into the root directory and the progress is reported") {
+                REQUIRE(answer["result"] == "ok");
+                REQUIRE(answer["session"] == session);
+                REQUIRE(answer["print_time"].get<double>() > 0.);
+                REQUIRE(boost::filesystem::file_size(root.path / "cube.gcode") > 0);
+                REQUIRE(! progress.empty());
+                for (const nlohmann::json &line : progress)
+                    REQUIRE(line["session"] == session);
+            }
+            AND_WHEN("The session is sliced again after a configuration change") {
+                REQUIRE(request(service, { { "command", "set_config" }, { "session", session }, { "options", { { "layer_height", "0.2" } } } })["result"] == "ok");
+                answer = request(service, { { "command", "slice" }, { "session", session }, { "output", "cube2.gcode" } });
+                THEN("The new G-code is exported") {
+                    REQUIRE(answer["result"] == "ok");
+                    REQUIRE(boost::filesystem::file_size(root.path / "cube2.gcode") > 0);
+                }
+            }
+        }
+        WHEN("The client disconnects while slicing") {
+            std::string answer_line = service.process_request(nlohmann::json{ { "command", "slice" }, { "session", session }, { "output", "cube.gcode" } }.dump(),
+                [](const std::string&) { throw std::runtime_error("Broken pipe"); });
+            THEN("The slicing is canceled and the session stays usable") {
+                REQUIRE(nlohmann::json::parse(answer_line)["result"] == "error");
+                REQUIRE(request(service, { { "command", "slice" }, { "session", session }, { "output", "cube.gcode" } })["result"] == "ok");
+            }
+        }
+        WHEN("The session is closed") {
+            answer = request(service, { { "command", "close" }, { "session", session } });
+            THEN("Further requests on the session are refused") {
+                REQUIRE(answer["result"] == "ok");
+                answer = request(service, { { "command", "slice" }, { "session", session }, { "output", "cube.gcode" } });
+                REQUIRE(answer["result"] == "error");
+                REQUIRE(answer["error"].get<std::string>().find("Unknown session") != std::string::npos);
+            }
+        }
+    }
+    GIVEN("Invalid requests") {
+        const size_t session = request(service, { { "command", "open" } })["session"].get<size_t>();
+        THEN("Each one is answered with an error") {
+            auto error = [&service](const nlohmann::json &req) {
+                nlohmann::json answer = request(service, req);
+                return answer["result"] == "error" && ! answer["error"].get<std::string>().empty();
+            };
+            REQUIRE(nlohmann::json::parse(service.process_request("{ not json", [](const std::string&) {}))["result"] == "error");
+            REQUIRE(error({ { "command", "unknown" }, { "session", session } }));
+            REQUIRE(error({ { "command", "slice" } }));
+            REQUIRE(error({ { "command", "slice" }, { "session", session + 1 }, { "output", "cube.gcode" } }));
+            // Nothing loaded yet.
+            REQUIRE(error({ { "command", "slice" }, { "session", session }, { "output", "cube.gcode" } }));
+            REQUIRE(error({ { "command", "load_model" }, { "session", session }, { "path", "missing.stl" } }));
+            REQUIRE(error({ { "command", "set_config" }, { "session", session }, { "options", { { "layer_height", "thick" } } } }));
+        }
+        THEN("Paths outside of the root directory are refused") {
+            const std::string outside = (root.path.parent_path() / "cube.gcode").string();
+            REQUIRE(request(service, { { "command", "load_model" }, { "session", session }, { "path", "../cube.stl" } })["result"] == "error");
+            REQUIRE(request(service, { { "command", "load_config" }, { "session", session }, { "path", "/etc/passwd" } })["result"] == "error");
+            REQUIRE(request(service, { { "command", "load_model" }, { "session", session }, { "path", (root.path / "cube.stl").string() } })["result"] == "ok");
+            REQUIRE(request(service, { { "command", "slice" }, { "session", session }, { "output", outside } })["result"] == "error");
+            REQUIRE(request(service, { { "command", "slice" }, { "session", session }, { "output", "sub/../../cube.gcode" } })["result"] == "error");
+            REQUIRE(! boost::filesystem::exists(outside));
+        }
+    }
+}
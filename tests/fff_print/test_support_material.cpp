@@ -1,7 +1,11 @@
 #include <catch2/catch.hpp>
 
+#include "libslic3r/AABBTreeLines.hpp"
+#include "libslic3r/GCode/ExtrusionProcessor.hpp"
 #include "libslic3r/GCodeReader.hpp"
 #include "libslic3r/Layer.hpp"
+#include "libslic3r/Support/SupportCommon.hpp"
+#include "libslic3r/Support/SupportSpotsGenerator.hpp"
 
 #include "test_data.hpp" // get access to init_print, etc
 
@@ -119,6 +123,215 @@ SCENARIO("SupportMaterial: support_layers_z and contact_distance", "[SupportMate
     }
 }
 
+SCENARIO("SupportMaterial: tree support overhangs are reused", "[SupportMaterial]")
+{
+    GIVEN("An overhang supported by tree supports") {
+        DynamicPrintConfig config = DynamicPrintConfig::full_print_config();
+        config.set_deserialize_strict({
+            { "enable_support", "1" },
+            { "support_type",   "tree(auto)" },
+            { "support_style",  "tree_slim" }
+            });
+        Slic3r::Print print;
+        Slic3r::Model model;
+        Slic3r::Test::init_print({ TestMesh::overhang }, print, model, config);
+        print.process();
+        const std::shared_ptr<TreeSupportOverhangs> detected = print.objects().front()->tree_support_overhangs();
+        REQUIRE(detected);
+
+        auto reprocess = [&print, &model, &config]() {
+            print.apply(model, config);
+            print.process();
+            return print.objects().front()->tree_support_overhangs();
+        };
+        auto support_islands = [](const Print &print) {
+            std::vector<std::pair<coordf_t, ExPolygons>> out;
+            for (const SupportLayer *layer : print.objects().front()->support_layers())
+                out.emplace_back(layer->print_z, layer->support_islands);
+            return out;
+        };
+        WHEN("Only the branch parameters change") {
+            config.set_deserialize_strict({ { "tree_support_branch_diameter", "3" }, { "tree_support_branch_angle", "30" } });
+            THEN("The overhangs of the previous run are reused") {
+                REQUIRE(reprocess() == detected);
+            }
+            THEN("The supports generated from the reused overhangs are those of a clean run") {
+                reprocess();
+                Slic3r::Print clean_print;
+                Slic3r::Model clean_model;
+                Slic3r::Test::init_print({ TestMesh::overhang }, clean_print, clean_model, config);
+                clean_print.process();
+                const std::vector<std::pair<coordf_t, ExPolygons>> expected = support_islands(clean_print);
+                REQUIRE(! expected.empty());
+                REQUIRE(support_islands(print) == expected);
+            }
+        }
+        WHEN("The support threshold angle changes") {
+            config.set_deserialize_strict({ { "support_threshold_angle", "50" } });
+            THEN("The overhangs are detected again") {
+                const std::shared_ptr<TreeSupportOverhangs> overhangs = reprocess();
+                REQUIRE(overhangs);
+                REQUIRE(overhangs != detected);
+            }
+        }
+        WHEN("A support enforcer is added") {
+            TriangleMesh enforcer(its_make_cube(200., 200., 200.));
+            enforcer.translate(-100.f, -100.f, -1.f);
+            model.objects.front()->add_volume(std::move(enforcer), ModelVolumeType::SUPPORT_ENFORCER, false);
+            THEN("The overhangs are detected again") {
+                const std::shared_ptr<TreeSupportOverhangs> overhangs = reprocess();
+                REQUIRE(overhangs);
+                REQUIRE(overhangs != detected);
+            }
+        }
+    }
+}
+
+SCENARIO("SupportMaterial: base fills reused along a support column", "[SupportMaterial]")
+{
+    // Sets support_reuse_base_fills, restores its previous value when leaving the scope.
+    struct ReuseBaseFills {
+        ReuseBaseFills(bool value) : previous(support_reuse_base_fills) { support_reuse_base_fills = value; }
+        ~ReuseBaseFills() { support_reuse_base_fills = previous; }
+        bool previous;
+    };
+    auto support_fills = [](const Print &print) {
+        std::vector<std::pair<coordf_t, Polylines>> out;
+        for (const SupportLayer *layer : print.objects().front()->support_layers())
+            out.emplace_back(layer->print_z, layer->support_fills.as_polylines());
+        return out;
+    };
+    GIVEN("A wide cap on a thin pillar, supported by a tall column of constant footprint") {
+        TriangleMesh pillar(its_make_cube(4., 4., 30.));
+        pillar.translate(8.f, 8.f, 0.f);
+        TriangleMesh mesh(its_make_cube(20., 20., 2.));
+        mesh.translate(0.f, 0.f, 30.f);
+        mesh.merge(pillar);
+        auto support_base_pattern = GENERATE("rectilinear", "rectilinear-grid");
+        DynamicPrintConfig config = DynamicPrintConfig::full_print_config();
+        config.set_deserialize_strict({
+            { "enable_support",       "1" },
+            { "support_type",         "normal(auto)" },
+            { "support_base_pattern", support_base_pattern },
+            { "layer_height",         0.2 },
+            { "brim_type",            "no_brim" }
+            });
+        WHEN("The support toolpaths are generated with and without reusing the base fills of the layers below") {
+            std::vector<std::pair<coordf_t, Polylines>> fills[2];
+            for (bool reuse : { false, true }) {
+                ReuseBaseFills reuse_guard(reuse);
+                Slic3r::Print print;
+                Slic3r::Test::init_and_process_print({ mesh }, print, config);
+                fills[reuse] = support_fills(print);
+            }
+            THEN("The support toolpaths are identical") {
+                REQUIRE(fills[false].size() >= 100);
+                REQUIRE(fills[true] == fills[false]);
+            }
+        }
+    }
+}
+
+// Line of an external perimeter annotated with its curled up height.
+struct CurlingLine
+{
+    Vec2f a;
+    Vec2f b;
+    float curled_up_height;
+
+    static const constexpr int Dim = 2;
+    using Scalar                   = Vec2f::Scalar;
+};
+
+// Reference: the external perimeters are annotated and their curled up height is propagated one layer after the other,
+// as SupportSpotsGenerator::estimate_malformations() used to do.
+static std::vector<CurledLines> estimate_malformations_serial(const PrintObject &object)
+{
+    const Print                        &print = *object.print();
+    const SupportSpotsGenerator::Params params{ print.config().filament_type.values, float(print.default_object_config().inner_wall_acceleration.getFloat()),
+                                                object.config().raft_layers.getInt(), object.config().brim_type.value, float(object.config().brim_width.getFloat()) };
+    std::vector<CurledLines>                      out;
+    AABBTreeLines::LinesDistancer<CurlingLine>    prev_layer_lines;
+    for (const Layer *layer : object.layers()) {
+        AABBTreeLines::LinesDistancer<Linef> prev_layer_boundary{ layer->lower_layer != nullptr ? to_unscaled_linesf(layer->lower_layer->lslices) : std::vector<Linef>() };
+        std::vector<CurlingLine>             current_layer_lines;
+        for (const LayerRegion *layerm : layer->regions())
+            for (const ExtrusionEntity *extrusion : layerm->perimeters.flatten().entities) {
+                if (extrusion->role() != erExternalPerimeter)
+                    continue;
+                Points extrusion_pts;
+                extrusion->collect_points(extrusion_pts);
+                const float flow_width       = layerm->flow(frExternalPerimeter).width();
+                const auto  annotated_points = estimate_points_properties<true, true, false, false>(extrusion_pts, prev_layer_lines, flow_width, params.bridge_distance);
+                for (size_t i = 0; i < annotated_points.size(); ++ i) {
+                    const ExtendedPoint &a = i > 0 ? annotated_points[i - 1] : annotated_points[i];
+                    const ExtendedPoint &b = annotated_points[i];
+                    CurlingLine line{ a.position.cast<float>(), b.position.cast<float>(), 0.f };
+                    const Vec2f middle                        = 0.5 * (line.a + line.b);
+                    auto [middle_distance, bottom_line_idx, x] = prev_layer_lines.distance_from_lines_extra<false>(middle);
+                    const float bottom_curled_up_height       = prev_layer_lines.get_lines().empty() ? 0.f : prev_layer_lines.get_line(bottom_line_idx).curled_up_height;
+                    const float sign = (prev_layer_boundary.distance_from_lines<true>(middle.cast<double>()) + 0.5f * flow_width) < 0.0f ? -1.0f : 1.0f;
+                    line.curled_up_height = SupportSpotsGenerator::estimate_curled_up_height(middle_distance * sign * params.curled_distance_expansion,
+                        0.5 * (a.curvature + b.curvature), layer->height, flow_width, bottom_curled_up_height, params);
+                    current_layer_lines.push_back(line);
+                }
+            }
+        CurledLines &curled_lines = out.emplace_back();
+        for (const CurlingLine &line : current_layer_lines)
+            if (line.curled_up_height > params.curling_tolerance_limit)
+                curled_lines.emplace_back(Point::new_scale(line.a), Point::new_scale(line.b), line.curled_up_height);
+        prev_layer_lines = AABBTreeLines::LinesDistancer<CurlingLine>{ std::move(current_layer_lines) };
+    }
+    return out;
+}
+
+// Length of the curled lines and their length weighted by the curled up height.
+static std::pair<double, double> curled_length_and_area(const CurledLines &curled_lines)
+{
+    double length = 0.;
+    double area   = 0.;
+    for (const CurledLine &line : curled_lines) {
+        const double l = unscaled((line.b - line.a).cast<double>().norm());
+        length += l;
+        area   += l * line.curled_height;
+    }
+    return { length, area };
+}
+
+SCENARIO("SupportMaterial: curled extrusions are estimated as by the serial reference", "[SupportMaterial]")
+{
+    GIVEN("Objects with overhangs") {
+        auto mesh = GENERATE(TestMesh::overhang, TestMesh::bridge, TestMesh::sloping_hole, TestMesh::V);
+        DynamicPrintConfig config = DynamicPrintConfig::full_print_config();
+        config.set_deserialize_strict({
+            { "enable_overhang_speed", "1" },
+            { "layer_height",          0.2 }
+            });
+        Slic3r::Print print;
+        Slic3r::Test::init_and_process_print({ mesh }, print, config);
+        WHEN("The curled extrusions are estimated for all layers in parallel and by the serial reference") {
+            const PrintObject              &object   = *print.objects().front();
+            const std::vector<CurledLines>  expected = estimate_malformations_serial(object);
+            // The serial reference annotates the extrusions against the annotated extrusions of the layer below. Where an extrusion
+            // crosses a point inserted into the layer below, the intersection may be split differently, which slightly changes
+            // the propagated curled up height. The same parts of the extrusions shall curl up to a similar height.
+            THEN("The same parts of the extrusions curl up to a similar height") {
+                REQUIRE(expected.size() == object.layers().size());
+                double curled_length = 0.;
+                for (size_t layer_idx = 0; layer_idx < expected.size(); ++ layer_idx) {
+                    const auto [length, area]                   = curled_length_and_area(object.get_layer(int(layer_idx))->curled_lines);
+                    const auto [expected_length, expected_area] = curled_length_and_area(expected[layer_idx]);
+                    REQUIRE(length == Approx(expected_length).epsilon(1e-4));
+                    REQUIRE(area == Approx(expected_area).epsilon(0.05));
+                    curled_length += length;
+                }
+                if (mesh == TestMesh::overhang)
+                    REQUIRE(curled_length > 0.);
+            }
+        }
+    }
+}
+
 #if 0
 // Test 8.
 TEST_CASE("SupportMaterial: forced support is generated", "[SupportMaterial]")
@@ -0,0 +1,149 @@
+#include <catch2/catch.hpp>
+#include <test_utils.hpp>
+
+#include <algorithm>
+#include <limits>
+#include <random>
+
+#include "libslic3r/Print.hpp"
+#include "libslic3r/GCode/ToolOrdering.hpp"
+
+using namespace Slic3r;
+
+// Asymmetric flush volumes of num_extruders filaments.
+static std::vector<std::vector<float>> random_wipe_volumes(size_t num_extruders, std::mt19937 &rng)
+{
+    std::uniform_real_distribution<float> dist(50.f, 800.f);
+    std::vector<std::vector<float>>       wipe_volumes(num_extruders, std::vector<float>(num_extruders, 0.f));
+    for (size_t i = 0; i < num_extruders; ++ i)
+        for (size_t j = 0; j < num_extruders; ++ j)
+            if (i != j)
+                wipe_volumes[i][j] = std::round(dist(rng));
+    return wipe_volumes;
+}
+
+// Layers of a print with bands of layers sharing the same set of extruders, as the regions of a multi-material part.
+static std::vector<std::vector<unsigned int>> random_layers(size_t num_extruders, size_t num_layers, std::mt19937 &rng)
+{
+    std::vector<std::vector<unsigned int>> layers;
+    std::uniform_int_distribution<size_t>  band_dist(1, 20);
+    std::uniform_int_distribution<size_t>  size_dist(1, num_extruders);
+    while (layers.size() < num_layers) {
+        std::vector<unsigned int> extruders(num_extruders);
+        for (unsigned int i = 0; i < num_extruders; ++ i)
+            extruders[i] = i;
+        std::shuffle(extruders.begin(), extruders.end(), rng);
+        extruders.resize(size_dist(rng));
+        std::sort(extruders.begin(), extruders.end());
+        for (size_t i = band_dist(rng); i > 0 && layers.size() < num_layers; -- i)
+            layers.emplace_back(extruders);
+    }
+    return layers;
+}
+
+static float brute_force_flush_volume(const std::vector<std::vector<float>> &wipe_volumes, std::vector<unsigned int> extruders, unsigned int start_extruder_id)
+{
+    // The start extruder is printed first if it prints the layer.
+    auto begin = extruders.begin();
+    if (auto it = std::find(extruders.begin(), extruders.end(), start_extruder_id); it != extruders.end())
+        std::swap(*begin ++, *it);
+    float best = std::numeric_limits<float>::max();
+    std::sort(begin, extruders.end());
+    do {
+        best = std::min(best, get_flush_volume(wipe_volumes, { extruders }, start_extruder_id));
+    } while (std::next_permutation(begin, extruders.end()));
+    return best;
+}
+
+static bool is_permutation_of_layers(const std::vector<std::vector<unsigned int>> &ordered, const std::vector<std::vector<unsigned int>> &layers)
+{
+    if (ordered.size() != layers.size())
+        return false;
+    for (size_t i = 0; i < layers.size(); ++ i)
+        if (! std::is_permutation(ordered[i].begin(), ordered[i].end(), layers[i].begin(), layers[i].end()))
+            return false;
+    return true;
+}
+
+TEST_CASE("Extruder order of a layer is optimal", "[ToolOrdering]") {
+    std::mt19937 rng(1);
+    for (size_t num_extruders : { 2, 3, 5, 7 }) {
+        const std::vector<std::vector<float>> wipe_volumes = random_wipe_volumes(num_extruders + 1, rng);
+        for (size_t test = 0; test < 20; ++ test) {
+            std::vector<unsigned int> extruders = random_layers(num_extruders + 1, 1, rng).front();
+            // The start extruder may or may not print the layer.
+            const unsigned int        start     = std::uniform_int_distribution<unsigned int>(0, num_extruders)(rng);
+            std::vector<unsigned int> order     = get_extruders_order(wipe_volumes, extruders, start);
+            REQUIRE(std::is_permutation(order.begin(), order.end(), extruders.begin(), extruders.end()));
+            if (std::find(extruders.begin(), extruders.end(), start) != extruders.end())
+                REQUIRE(order.front() == start);
+            REQUIRE(get_flush_volume(wipe_volumes, { order }, start) == Approx(brute_force_flush_volume(wipe_volumes, extruders, start)));
+        }
+    }
+}
+
+TEST_CASE("Extruder order of a layer with more than 16 extruders", "[ToolOrdering]") {
+    std::mt19937                          rng(2);
+    const std::vector<std::vector<float>> wipe_volumes = random_wipe_volumes(32, rng);
+    std::vector<unsigned int>             extruders(24);
+    for (unsigned int i = 0; i < 24; ++ i)
+        extruders[i] = i + 8;
+    // The start extruders 16 + k and 17 + k used to share the key of the table of the solved layers.
+    for (unsigned int start : { 20, 21, 3 }) {
+        std::vector<unsigned int> order = get_extruders_order(wipe_volumes, extruders, start);
+        REQUIRE(std::is_permutation(order.begin(), order.end(), extruders.begin(), extruders.end()));
+        if (start >= 8)
+            REQUIRE(order.front() == start);
+        // Not worse than printing the extruders in the order of their indices.
+        REQUIRE(get_flush_volume(wipe_volumes, { order }, start) <= get_flush_volume(wipe_volumes, { extruders }, start));
+    }
+}
+
+TEST_CASE("Extruder order across layers", "[ToolOrdering]") {
+    std::mt19937 rng(3);
+    for (size_t num_extruders : { 4, 8, 16, 24 }) {
+        const std::vector<std::vector<float>>        wipe_volumes = random_wipe_volumes(num_extruders, rng);
+        const std::vector<std::vector<unsigned int>> layers       = random_layers(num_extruders, num_extruders > 16 ? 30 : 80, rng);
+        std::vector<bool>                            fixed_layers(layers.size(), false);
+        fixed_layers.front() = true;
+        const std::vector<std::vector<unsigned int>> one_by_one = get_layers_extruders_order(wipe_volumes, layers, fixed_layers, false);
+        const std::vector<std::vector<unsigned int>> across     = get_layers_extruders_order(wipe_volumes, layers, fixed_layers, true);
+        REQUIRE(is_permutation_of_layers(one_by_one, layers));
+        REQUIRE(is_permutation_of_layers(across, layers));
+        REQUIRE(one_by_one.front() == layers.front());
+        REQUIRE(across.front() == layers.front());
+        REQUIRE(get_flush_volume(wipe_volumes, across) <= get_flush_volume(wipe_volumes, one_by_one));
+    }
+}
+
+TEST_CASE("Extruder order across layers keeps the fixed layers", "[ToolOrdering]") {
+    // Two extruders, switching from 0 to 1 is cheap, switching back is expensive.
+    const std::vector<std::vector<float>> wipe_volumes { { 0.f, 10.f }, { 500.f, 0.f } };
+    const std::vector<std::vector<unsigned int>> layers { { 0 }, { 0, 1 }, { 0, 1 }, { 1, 0 } };
+    const std::vector<std::vector<unsigned int>> across = get_layers_extruders_order(wipe_volumes, layers, { true, false, false, true });
+    REQUIRE(across.front() == layers.front());
+    REQUIRE(across.back() == layers.back());
+    REQUIRE(get_flush_volume(wipe_volumes, across) <= get_flush_volume(wipe_volumes, get_layers_extruders_order(wipe_volumes, layers, { true, false, false, true }, false)));
+}
+
+TEST_CASE("Extruder order of 4 to 24 filaments", "[ToolOrdering][.Benchmark]") {
+    std::mt19937 rng(4);
+    for (size_t num_extruders : { 4, 8, 16, 24 }) {
+        const std::vector<std::vector<float>>        wipe_volumes = random_wipe_volumes(num_extruders, rng);
+        const std::vector<std::vector<unsigned int>> layers       = random_layers(num_extruders, 500, rng);
+        std::vector<bool>                            fixed_layers(layers.size(), false);
+        fixed_layers.front() = true;
+        float flush_volumes[2];
+        for (bool across_layers : { false, true }) {
+            std::vector<std::vector<unsigned int>> result;
+            benchmark(std::to_string(num_extruders) + " filaments, " + (across_layers ? "across layers" : "layer by layer"),
+                [&wipe_volumes, &layers, &fixed_layers, across_layers, &result]() {
+                    result = get_layers_extruders_order(wipe_volumes, layers, fixed_layers, across_layers);
+                });
+            REQUIRE(is_permutation_of_layers(result, layers));
+            flush_volumes[across_layers] = get_flush_volume(wipe_volumes, result);
+        }
+        // The order across layers falls back to the order layer by layer if it does not flush less.
+        REQUIRE(flush_volumes[true] <= flush_volumes[false]);
+    }
+}
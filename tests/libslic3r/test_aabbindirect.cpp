@@ -3,6 +3,10 @@
 
 #include <libslic3r/TriangleMesh.hpp>
 #include <libslic3r/AABBTreeIndirect.hpp>
+#include <libslic3r/AABBTreeLines.hpp>
+#include <libslic3r/Polygon.hpp>
+
+#include <random>
 
 using namespace Slic3r;
 
@@ -58,3 +62,134 @@ TEST_CASE("Building a tree over a box, ray caster and closest query", "[AABBIndi
     REQUIRE(closest_point.y() == Approx(0.5));
     REQUIRE(closest_point.z() == Approx(1.));
 }
+
+// Contours of a layer with many gear shaped islands, in scaled coordinates.
+static Lines gear_layer_lines(int islands_per_side, int teeth)
+{
+    Polygons polygons;
+    for (int ix = 0; ix < islands_per_side; ++ ix)
+        for (int iy = 0; iy < islands_per_side; ++ iy) {
+            Polygon gear;
+            const Vec2d center(ix * 12., iy * 12.);
+            for (int i = 0; i < teeth * 4; ++ i) {
+                const double angle  = 2. * PI * i / (teeth * 4);
+                const double radius = (i / 2) % 2 == 0 ? 5. : 4.;
+                gear.points.emplace_back(Point::new_scale(center + radius * Vec2d(cos(angle), sin(angle))));
+            }
+            polygons.emplace_back(std::move(gear));
+        }
+    return to_lines(polygons);
+}
+
+TEST_CASE("LinesDistancer queries match brute force", "[AABBIndirect]")
+{
+    Lines lines = gear_layer_lines(4, 12);
+    // Degenerate line.
+    lines.emplace_back(Point::new_scale(6., 6.), Point::new_scale(6., 6.));
+    AABBTreeLines::LinesDistancer<Line> distancer(lines);
+
+    std::mt19937                           rng(17);
+    std::uniform_int_distribution<coord_t> coord(scaled<coord_t>(-8.), scaled<coord_t>(45.));
+    std::vector<Point>                     points;
+    for (size_t i = 0; i < 500; ++ i)
+        points.emplace_back(coord(rng), coord(rng));
+    // Vertices are at the same distance from both of their lines.
+    points.emplace_back(lines[5].a);
+    points.emplace_back(lines[70].b);
+
+    for (const Point &p : points) {
+        double min_sqr_d = std::numeric_limits<double>::infinity();
+        size_t min_idx   = 0;
+        for (size_t j = 0; j < lines.size(); ++ j)
+            if (double sqr_d = line_alg::distance_to_squared(lines[j], p); sqr_d < min_sqr_d) {
+                min_sqr_d = sqr_d;
+                min_idx   = j;
+            }
+        auto [distance, line_idx, nearest_point] = distancer.distance_from_lines_extra<false>(p);
+        REQUIRE(distance == Approx(std::sqrt(min_sqr_d)));
+        // Ties are resolved to the lowest line index.
+        REQUIRE(line_idx == min_idx);
+        REQUIRE((nearest_point - p.cast<double>()).norm() == Approx(distance).margin(2.));
+
+        const double radius = scaled<double>(1.5);
+        std::vector<size_t> in_radius;
+        for (size_t j = 0; j < lines.size(); ++ j)
+            if (line_alg::distance_to_squared(lines[j], p) < radius * radius)
+                in_radius.emplace_back(j);
+        REQUIRE(distancer.all_lines_in_radius(p, radius) == in_radius);
+    }
+
+    // The batched query gives the same distances as the single point queries.
+    const std::vector<double> distances = distancer.distances_from_lines<true>(points);
+    REQUIRE(distances.size() == points.size());
+    for (size_t i = 0; i < points.size(); ++ i)
+        REQUIRE(distances[i] == distancer.distance_from_lines<true>(points[i]));
+
+    // Unscaled lines are evaluated in double precision as well.
+    Linesf linesf;
+    for (const Line &l : lines)
+        linesf.emplace_back(unscaled(l.a), unscaled(l.b));
+    AABBTreeLines::LinesDistancer<Linef> distancerf(linesf);
+    for (const Point &p : points) {
+        const Vec2d pf        = unscaled(p);
+        double      min_sqr_d = std::numeric_limits<double>::infinity();
+        size_t      min_idx   = 0;
+        for (size_t j = 0; j < linesf.size(); ++ j)
+            if (double sqr_d = line_alg::distance_to_squared(linesf[j], pf); sqr_d < min_sqr_d) {
+                min_sqr_d = sqr_d;
+                min_idx   = j;
+            }
+        auto [distance, line_idx, nearest_point] = distancerf.distance_from_lines_extra<false>(pf);
+        REQUIRE(distance == Approx(std::sqrt(min_sqr_d)));
+        REQUIRE(line_idx == min_idx);
+    }
+
+    // The islands are full, the gaps between them are empty.
+    REQUIRE(distancer.outside(Point::new_scale(12., 12.)) == -1);
+    REQUIRE(distancer.outside(Point::new_scale(6., 5.)) == 1);
+    REQUIRE(distancer.distance_from_lines<true>(Point::new_scale(12., 12.)) < 0.);
+    REQUIRE(distancer.intersections_with_line<true>(Line(Point::new_scale(-10., 0.3), Point::new_scale(50., 0.3))).size() == 8);
+}
+
+TEST_CASE("LinesDistancer benchmark", "[AABBIndirect][.Benchmark]")
+{
+    const Lines lines = gear_layer_lines(40, 24);
+
+    std::mt19937                           rng(17);
+    std::uniform_real_distribution<double> coord(-8., 480.);
+    std::vector<Point>                     points;
+    // Polylines of short segments, as the extrusions whose overhangs are estimated.
+    for (size_t i = 0; i < 2000; ++ i) {
+        Vec2d p(coord(rng), coord(rng));
+        for (size_t j = 0; j < 100; ++ j, p += Vec2d(0.2, 0.1))
+            points.emplace_back(Point::new_scale(p));
+    }
+
+    double tree_sum = 0.;
+    benchmark("AABB tree of single lines", [&lines, &points, &tree_sum]() {
+        const auto tree = AABBTreeLines::build_aabb_tree_over_indexed_lines(lines);
+        for (const Point &p : points) {
+            size_t      hit_idx;
+            Vec2d       hit_point;
+            const Vec2d pd = p.cast<double>();
+            tree_sum += std::sqrt(AABBTreeLines::squared_distance_to_indexed_lines(lines, tree, pd, hit_idx, hit_point));
+        }
+    });
+
+    AABBTreeLines::LinesDistancer<Line> distancer;
+    double                              packed_sum = 0.;
+    benchmark("Packed tree", [&lines, &points, &distancer, &packed_sum]() {
+        distancer = AABBTreeLines::LinesDistancer<Line>(lines);
+        for (const Point &p : points)
+            packed_sum += std::get<0>(distancer.distance_from_lines_extra<false>(p));
+    });
+
+    double batched_sum = 0.;
+    benchmark("Packed tree, batched", [&points, &distancer, &batched_sum]() {
+        for (double distance : distancer.distances_from_lines<false>(points))
+            batched_sum += distance;
+    });
+
+    REQUIRE(packed_sum == Approx(tree_sum));
+    REQUIRE(batched_sum == Approx(tree_sum));
+}
@@ -0,0 +1,107 @@
+#include <catch2/catch.hpp>
+#include <test_utils.hpp>
+
+#include <cmath>
+#include <map>
+#include <random>
+#include <sstream>
+
+#include "libslic3r/GCode/AdaptivePAInterpolator.hpp"
+
+// PA values of the models measured at a few flow rates (mm3/s) and accelerations (mm/s2), one set per line.
+static const char *pa_model =
+    "0.040,3.96,1000\n0.035,7.91,1000\n0.032,12.0,1000\n0.031,20.0,1000\n"
+    "0.038,3.96,3000\n0.031,7.91,3000\n0.030,12.0,3000\n0.027,20.0,3000\n"
+    "0.033,3.96,6000\n0.029,7.91,6000\n0.028,12.0,6000\n0.029,20.0,6000\n"
+    "0.031,3.96,10000\n0.026,7.91,10000\n0.022,12.0,10000\n0.021,20.0,10000\n"
+    "0.029,3.96,15000\n0.025,7.91,15000\n0.023,12.0,15000\n0.020,20.0,15000\n";
+
+// Interpolation by a PA-acceleration PCHIP model of all the flow-rate-to-PA models, built for each query.
+struct AllModelsInterpolator
+{
+    std::map<double, PchipInterpolatorHelper> models;
+
+    explicit AllModelsInterpolator(const std::string &data)
+    {
+        std::map<double, std::pair<std::vector<double>, std::vector<double>>> points;
+        std::istringstream ss(data);
+        for (std::string line; std::getline(ss, line);) {
+            double pa, flow, accel;
+            char   comma;
+            std::istringstream(line) >> pa >> comma >> flow >> comma >> accel;
+            points[accel].first.push_back(flow);
+            points[accel].second.push_back(pa);
+        }
+        for (const auto &[accel, model] : points)
+            if (model.first.size() > 1)
+                models[accel] = PchipInterpolatorHelper(model.first, model.second);
+    }
+
+    double operator()(double flow_rate, double acceleration) const
+    {
+        std::vector<double> pa_values, acc_values;
+        for (const auto &[accel, model] : models) {
+            double pa = model.interpolate(flow_rate);
+            if (pa != -1) {
+                pa_values.push_back(pa);
+                acc_values.push_back(accel);
+            }
+        }
+        if (acc_values.size() < 2)
+            return acc_values.empty() ? -1 : std::round(pa_values.front() * 1000.0) / 1000.0;
+        return std::round(PchipInterpolatorHelper(acc_values, pa_values).interpolate(acceleration) * 1000.0) / 1000.0;
+    }
+};
+
+TEST_CASE("Adaptive PA interpolation matches the PCHIP of all the models", "[AdaptivePA]") {
+    std::mt19937                           rng(1);
+    std::uniform_real_distribution<double> flow_dist(0., 25.);
+    std::uniform_real_distribution<double> accel_dist(0., 20000.);
+
+    for (const std::string data : { std::string(pa_model), std::string("0.04,3.96,3000\n0.033,7.91,3000\n"),
+                                    std::string("0.04,3.96,3000\n0.033,7.91,3000\n0.029,3.96,10000\n0.026,7.91,10000\n"),
+                                    // Invalid PA values drop the model from the PA-acceleration model at some flow rates.
+                                    std::string("-1,3.96,3000\n0.033,7.91,3000\n0.029,3.96,6000\n0.026,7.91,6000\n0.025,3.96,9000\n0.021,7.91,9000\n") }) {
+        AdaptivePAInterpolator interpolator;
+        REQUIRE(interpolator.parseAndSetData(data) == 0);
+        AllModelsInterpolator  all_models_interpolator(data);
+        for (size_t i = 0; i < 10000; ++ i) {
+            const double flow  = flow_dist(rng);
+            const double accel = i % 10 == 0 ? 3000. : accel_dist(rng);
+            REQUIRE(interpolator(flow, accel) == all_models_interpolator(flow, accel));
+        }
+        // Measured points and the ends of the model.
+        for (double flow : { 0., 3.96, 7.91, 12., 20., 30. })
+            for (double accel : { 0., 1000., 3000., 6000., 10000., 15000., 20000. })
+                REQUIRE(interpolator(flow, accel) == all_models_interpolator(flow, accel));
+    }
+}
+
+TEST_CASE("Adaptive PA interpolation of PA changes", "[AdaptivePA][.Benchmark]") {
+    AdaptivePAInterpolator interpolator;
+    REQUIRE(interpolator.parseAndSetData(pa_model) == 0);
+
+    // PA changes of a print: mostly perimeters and infill at a few feature accelerations, flow rates spread around the feature speeds.
+    std::mt19937                     rng(2);
+    std::normal_distribution<double> flow_dist(9., 4.);
+    const double                     accelerations[] = { 500., 2000., 5000., 5000., 8000., 10000. };
+    std::vector<std::pair<double, double>> queries(1000000);
+    for (auto &[flow, accel] : queries) {
+        flow  = std::max(0.5, flow_dist(rng));
+        accel = accelerations[rng() % std::size(accelerations)];
+    }
+
+    double sum = 0.;
+    benchmark("Adaptive PA", [&interpolator, &queries, &sum]() {
+        for (const auto &[flow, accel] : queries)
+            sum += interpolator(flow, accel);
+    });
+
+    AllModelsInterpolator all_models_interpolator(pa_model);
+    double                sum_all_models = 0.;
+    benchmark("PCHIP of all the models", [&all_models_interpolator, &queries, &sum_all_models]() {
+        for (const auto &[flow, accel] : queries)
+            sum_all_models += all_models_interpolator(flow, accel);
+    });
+    REQUIRE(sum == Approx(sum_all_models));
+}
@@ -0,0 +1,293 @@
+#include <catch2/catch.hpp>
+#include <test_utils.hpp>
+
+#include "libslic3r/ArcFitter.hpp"
+#include "libslic3r/MultiPoint.hpp"
+#include "libslic3r/Point.hpp"
+#include "libslic3r/Polyline.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+using namespace Slic3r;
+
+// Wave of the gyroid infill, as a long open path.
+static Points gyroid_like_path(size_t num_points)
+{
+    Points out;
+    out.reserve(num_points);
+    for (size_t i = 0; i < num_points; ++ i) {
+        double x = 0.05 * double(i);
+        out.emplace_back(scale_(x), scale_(2. * std::sin(0.7 * x) + 0.3 * std::sin(2.1 * x)));
+    }
+    return out;
+}
+
+// Slowly drifting circles with a slight wobble of the radius, as produced by Arachne for a variable width perimeter.
+static Points arachne_like_path(size_t num_points)
+{
+    Points out;
+    out.reserve(num_points);
+    for (size_t i = 0; i < num_points; ++ i) {
+        double angle  = 0.002 * double(i);
+        double radius = 30. + 0.004 * std::sin(1.7 * double(i));
+        out.emplace_back(scale_(radius * std::cos(angle) + 3. * angle), scale_(radius * std::sin(angle)));
+    }
+    return out;
+}
+
+// Smooth open curve of a slowly and randomly changing curvature, as the outlines of organic models.
+static Points random_curve_path(size_t num_points, unsigned int seed)
+{
+    std::mt19937                           rng(seed);
+    std::uniform_real_distribution<double> random(-1., 1.);
+    Points out;
+    out.reserve(num_points);
+    Vec2d  p = Vec2d::Zero();
+    double angle = 0., curvature = 0.;
+    for (size_t i = 0; i < num_points; ++ i) {
+        curvature = std::clamp(curvature + 0.01 * random(rng), -0.1, 0.1);
+        angle    += curvature;
+        p        += 0.2 * Vec2d(std::cos(angle), std::sin(angle));
+        out.emplace_back(scale_(p.x()), scale_(p.y()));
+    }
+    return out;
+}
+
+// Densely sampled circle with a noise in the order of the fitting tolerance.
+static Points noisy_circle_path(size_t num_points, double radius, double noise, unsigned int seed)
+{
+    std::mt19937                     rng(seed);
+    std::normal_distribution<double> deviation(0., noise);
+    Points out;
+    out.reserve(num_points);
+    for (size_t i = 0; i < num_points; ++ i) {
+        double angle = 0.1 * double(i) / radius;
+        out.emplace_back(scale_(radius * std::cos(angle) + deviation(rng)), scale_(radius * std::sin(angle) + deviation(rng)));
+    }
+    return out;
+}
+
+// Circle through the first, the last and any other point of the list with the least deviation of all the points, if within the tolerance.
+// The point in the middle is skipped, a circle close to it was tried first.
+static bool fit_circle_exhaustive(const Points &points, double tolerance, Circle &circle)
+{
+    bool   found = false;
+    double least_deviation = 0.;
+    for (size_t i = 1; i + 1 < points.size(); ++ i) {
+        if (i == points.size() / 2)
+            continue;
+        Circle test_circle;
+        double deviation;
+        if (Circle::try_create_circle(points.front(), points[i], points.back(), DEFAULT_SCALED_MAX_RADIUS, test_circle) &&
+            test_circle.get_deviation_sum_squared(points, tolerance, deviation) && (! found || deviation < least_deviation)) {
+            found           = true;
+            least_deviation = deviation;
+            circle          = test_circle;
+        }
+    }
+    return found;
+}
+
+// ArcFitter::do_arc_fitting() before the number of points of an arc was limited, measuring the whole segment for every point.
+static std::vector<PathFittingData> arc_fitting_unlimited(const Points &points, double tolerance)
+{
+    std::vector<PathFittingData> result;
+    size_t     front_index = 0;
+    size_t     back_index  = 0;
+    ArcSegment last_arc;
+    ArcSegment target_arc;
+    Points     current_segment;
+    for (size_t i = 0; i < points.size(); ++ i) {
+        back_index = i;
+        current_segment.push_back(points[i]);
+        if (back_index - front_index < 2)
+            continue;
+        if (ArcSegment::try_create_arc(current_segment, target_arc, Polyline(current_segment).length(), DEFAULT_SCALED_MAX_RADIUS, tolerance, DEFAULT_ARC_LENGTH_PERCENT_TOLERANCE)) {
+            last_arc = target_arc;
+            if (back_index == points.size() - 1) {
+                result.push_back({ front_index, back_index, last_arc.direction == ArcDirection::Arc_Dir_CCW ? EMovePathType::Arc_move_ccw : EMovePathType::Arc_move_cw, last_arc });
+                front_index = back_index;
+            }
+        } else {
+            if (back_index - front_index > 2)
+                result.push_back({ front_index, back_index - 1, last_arc.direction == ArcDirection::Arc_Dir_CCW ? EMovePathType::Arc_move_ccw : EMovePathType::Arc_move_cw, last_arc });
+            else if (result.empty() || result.back().path_type != EMovePathType::Linear_move)
+                result.push_back({ front_index, front_index + 1, EMovePathType::Linear_move, ArcSegment() });
+            else
+                result.back().end_point_index = front_index + 1;
+            front_index = back_index - 1;
+            current_segment = { points[front_index], points[front_index + 1] };
+        }
+    }
+    if (front_index != back_index) {
+        if (result.empty() || result.back().path_type != EMovePathType::Linear_move)
+            result.push_back({ front_index, back_index, EMovePathType::Linear_move, ArcSegment() });
+        else
+            result.back().end_point_index = back_index;
+    }
+    return result;
+}
+
+// ArcFitter::do_arc_fitting_and_simplify() before the simplification was done in place, simplifying copies of the parts.
+static void arc_fitting_and_simplify_copying(Points &points, std::vector<PathFittingData> &result, double tolerance)
+{
+    if (std::abs(tolerance) > SCALED_EPSILON)
+        ArcFitter::do_arc_fitting(points, result, tolerance);
+    else
+        result.push_back(PathFittingData{ 0, points.size() - 1, EMovePathType::Linear_move, ArcSegment() });
+    if (result.size() == 1 && result[0].path_type == EMovePathType::Linear_move) {
+        points = MultiPoint::_douglas_peucker(points, tolerance);
+        result[0].end_point_index = points.size() - 1;
+        return;
+    }
+    Points              simplified_points { points.front() };
+    std::vector<size_t> reduce_count(result.size(), 0);
+    for (size_t i = 0; i < result.size(); ++ i) {
+        const Points part = MultiPoint::_douglas_peucker(Points(points.begin() + result[i].start_point_index, points.begin() + result[i].end_point_index + 1), tolerance);
+        reduce_count[i] = result[i].end_point_index - result[i].start_point_index + 1 - part.size();
+        simplified_points.insert(simplified_points.end(), part.begin() + 1, part.end());
+    }
+    points = std::move(simplified_points);
+    for (size_t j = 1; j < reduce_count.size(); ++ j)
+        reduce_count[j] += reduce_count[j - 1];
+    for (size_t j = 0; j < result.size(); ++ j) {
+        result[j].end_point_index -= reduce_count[j];
+        if (j + 1 != result.size())
+            result[j + 1].start_point_index = result[j].end_point_index;
+    }
+}
+
+static bool same_fitting(const std::vector<PathFittingData> &lhs, const std::vector<PathFittingData> &rhs)
+{
+    return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(), [](const PathFittingData &l, const PathFittingData &r) {
+        return l.start_point_index == r.start_point_index && l.end_point_index == r.end_point_index && l.path_type == r.path_type &&
+               (l.path_type == EMovePathType::Linear_move || (l.arc_data.center == r.arc_data.center && l.arc_data.radius == r.arc_data.radius));
+    });
+}
+
+// The fitting result covers all the points without gaps and all points of the arcs lie on their circles within the tolerance.
+static void check_fitting_result(const Points &points, const std::vector<PathFittingData> &result, double tolerance)
+{
+    REQUIRE(! result.empty());
+    REQUIRE(result.front().start_point_index == 0);
+    REQUIRE(result.back().end_point_index == points.size() - 1);
+    for (size_t i = 1; i < result.size(); ++ i)
+        REQUIRE(result[i].start_point_index == result[i - 1].end_point_index);
+    for (PathFittingData data : result)
+        if (data.is_arc_move()) {
+            const ArcSegment &arc = data.arc_data;
+            REQUIRE(arc.start_point == points[data.start_point_index]);
+            REQUIRE(arc.end_point == points[data.end_point_index]);
+            for (size_t i = data.start_point_index; i <= data.end_point_index; ++ i)
+                REQUIRE(std::abs((points[i] - arc.center).cast<double>().norm() - arc.radius) <= tolerance + SCALED_EPSILON);
+        }
+}
+
+TEST_CASE("Arc fitting of sampled circle", "[ArcFitter]") {
+    Points points;
+    for (size_t i = 0; i < 400; ++ i) {
+        double angle = 0.99 * 2. * PI * double(i) / 400.;
+        points.emplace_back(scale_(20. * std::cos(angle)), scale_(20. * std::sin(angle)));
+    }
+    const double tolerance = scale_(0.0125);
+    std::vector<PathFittingData> result;
+    ArcFitter::do_arc_fitting(points, result, tolerance);
+    check_fitting_result(points, result, tolerance);
+    for (PathFittingData data : result) {
+        REQUIRE(data.path_type == EMovePathType::Arc_move_ccw);
+        REQUIRE(std::abs(data.arc_data.radius - scale_(20.)) < tolerance);
+    }
+}
+
+TEST_CASE("Arc fitting of long paths", "[ArcFitter]") {
+    const double tolerance = scale_(0.0125);
+    for (const Points &points : { gyroid_like_path(5000), arachne_like_path(5000) }) {
+        std::vector<PathFittingData> result;
+        ArcFitter::do_arc_fitting(points, result, tolerance);
+        check_fitting_result(points, result, tolerance);
+        REQUIRE(std::count_if(result.begin(), result.end(), [](PathFittingData data) { return data.is_arc_move(); }) > 0);
+    }
+}
+
+TEST_CASE("Circle fitting falls back to the best circle through any point", "[ArcFitter]") {
+    const double tolerance = scale_(0.0125);
+    size_t       num_fallbacks = 0;
+    for (unsigned int seed = 0; seed < 4; ++ seed) {
+        const Points path = random_curve_path(2000, seed);
+        for (size_t num_points : { 5, 16, 41, 100, 256 })
+            for (size_t first = 0; first + num_points <= path.size(); first += 37) {
+                const Points points(path.begin() + first, path.begin() + first + num_points);
+                const size_t middle       = num_points / 2;
+                const Point  middle_point = num_points % 2 == 0 ? (points[middle] + points[middle - 1]) / 2 : (points[middle - 1] + points[middle + 1]) / 2;
+                Circle       circle;
+                if (Circle::try_create_circle(points.front(), middle_point, points.back(), DEFAULT_SCALED_MAX_RADIUS, circle) &&
+                    ! circle.is_over_deviation(points, tolerance))
+                    // Not falling back.
+                    continue;
+                ++ num_fallbacks;
+                Circle expected;
+                const bool found = fit_circle_exhaustive(points, tolerance, expected);
+                REQUIRE(Circle::try_create_circle(points, DEFAULT_SCALED_MAX_RADIUS, tolerance, circle) == found);
+                if (found) {
+                    REQUIRE(circle.center == expected.center);
+                    REQUIRE(circle.radius == expected.radius);
+                }
+            }
+    }
+    REQUIRE(num_fallbacks > 0);
+}
+
+TEST_CASE("Arc fitting compared to the fitting of unlimited arcs", "[ArcFitter]") {
+    const double tolerance = scale_(0.0125);
+    SECTION("Paths of arcs shorter than the limit are fitted the same") {
+        std::vector<Points> paths { gyroid_like_path(5000), noisy_circle_path(3000, 10., 0.004, 1) };
+        for (unsigned int seed = 0; seed < 10; ++ seed)
+            paths.emplace_back(random_curve_path(5000, seed));
+        for (const Points &points : paths) {
+            std::vector<PathFittingData> result;
+            ArcFitter::do_arc_fitting(points, result, tolerance);
+            REQUIRE(same_fitting(result, arc_fitting_unlimited(points, tolerance)));
+        }
+    }
+    SECTION("Longer arcs are split, adding at most two segments per split") {
+        for (const Points &points : { arachne_like_path(5000), noisy_circle_path(3000, 20., 0.001, 2) }) {
+            std::vector<PathFittingData> result;
+            ArcFitter::do_arc_fitting(points, result, tolerance);
+            check_fitting_result(points, result, tolerance);
+            const std::vector<PathFittingData> unlimited = arc_fitting_unlimited(points, tolerance);
+            REQUIRE(std::any_of(unlimited.begin(), unlimited.end(), [](const PathFittingData &data) { return data.end_point_index - data.start_point_index >= 256; }));
+            REQUIRE(std::all_of(result.begin(), result.end(), [](const PathFittingData &data) { return data.path_type == EMovePathType::Linear_move || data.end_point_index - data.start_point_index < 256; }));
+            REQUIRE(result.size() <= unlimited.size() + 2 * (points.size() / 255 + 1));
+        }
+    }
+}
+
+TEST_CASE("Arc fitting and simplification in place", "[ArcFitter]") {
+    std::vector<Points> paths { gyroid_like_path(3000), arachne_like_path(3000), noisy_circle_path(2000, 10., 0.004, 3) };
+    for (unsigned int seed = 0; seed < 5; ++ seed)
+        paths.emplace_back(random_curve_path(2000, seed));
+    // Straight path with a little noise, simplified without any arc.
+    paths.emplace_back();
+    for (size_t i = 0; i < 1000; ++ i)
+        paths.back().emplace_back(coord_t(i) * scaled<coord_t>(0.1), coord_t(i % 3) * 50);
+    for (double tolerance : { 0., scale_(0.0125), scale_(0.05) })
+        for (const Points &path : paths) {
+            Points                       points = path, expected_points = path;
+            std::vector<PathFittingData> result, expected_result;
+            ArcFitter::do_arc_fitting_and_simplify(points, result, tolerance);
+            arc_fitting_and_simplify_copying(expected_points, expected_result, tolerance);
+            REQUIRE(points == expected_points);
+            REQUIRE(same_fitting(result, expected_result));
+        }
+}
+
+TEST_CASE("Arc fitting benchmark", "[ArcFitter][.Benchmark]") {
+    const double tolerance = scale_(0.0125);
+    for (const auto &[name, points] : { std::make_pair("gyroid", gyroid_like_path(200000)), std::make_pair("arachne", arachne_like_path(200000)) }) {
+        std::vector<PathFittingData> result;
+        benchmark(std::string("Arc fitting of ") + name + " path", [&points = points, &result, tolerance]() { ArcFitter::do_arc_fitting(points, result, tolerance); });
+        check_fitting_result(points, result, tolerance);
+    }
+}
@@ -0,0 +1,74 @@
+#include <catch2/catch.hpp>
+
+#include "libslic3r/Arachne/BeadingStrategy/BeadingStrategyFactory.hpp"
+
+using namespace Slic3r;
+using namespace Slic3r::Arachne;
+
+// Strategy chain as created by WallToolPaths, with the outer and inner line widths in mm.
+static BeadingStrategyPtr make_strategy(double outer_width, double inner_width, bool print_thin_walls, BeadingCache *cache)
+{
+    return BeadingStrategyFactory::makeStrategy(scaled<coord_t>(outer_width), scaled<coord_t>(inner_width), scaled<coord_t>(0.4), float(PI / 18.),
+                                                print_thin_walls, scaled<coord_t>(0.34), scaled<coord_t>(0.1), 0.15, 0.7, 4, 0, 1, 0.5, cache);
+}
+
+static void require_same_beading(const BeadingStrategy::Beading &beading, const BeadingStrategy::Beading &expected)
+{
+    REQUIRE(beading.total_thickness == expected.total_thickness);
+    REQUIRE(beading.bead_widths == expected.bead_widths);
+    REQUIRE(beading.toolpath_locations == expected.toolpath_locations);
+    REQUIRE(beading.left_over == expected.left_over);
+}
+
+// Thicknesses of thin and wide walls with any bead count up to the limit of the strategy, which is 4 beads and a marker.
+static void require_same_beadings(const BeadingStrategy &strategy, const BeadingStrategy &expected)
+{
+    for (coord_t thickness = 0; thickness < scaled<coord_t>(3.); thickness += scaled<coord_t>(0.0137))
+        for (coord_t bead_count = 0; bead_count <= 5; ++ bead_count)
+            require_same_beading(strategy.compute(thickness, bead_count), expected.compute(thickness, bead_count));
+}
+
+SCENARIO("Arachne beading cache", "[Arachne]") {
+    GIVEN("A beading strategy with and without a cache") {
+        BeadingCache       cache;
+        BeadingStrategyPtr cached   = make_strategy(0.42, 0.45, true, &cache);
+        BeadingStrategyPtr uncached = make_strategy(0.42, 0.45, true, nullptr);
+        WHEN("The beadings are computed twice") {
+            require_same_beadings(*cached, *uncached);
+            const BeadingCache::Stats first = cache.stats();
+            require_same_beadings(*cached, *uncached);
+            const BeadingCache::Stats second = cache.stats();
+            THEN("The cached beadings are the same as the computed ones and the second pass only hits the cache") {
+                REQUIRE(first.hits == 0);
+                REQUIRE(first.misses > 0);
+                REQUIRE(second.misses == first.misses);
+                REQUIRE(second.hits == first.misses);
+                REQUIRE(cached->getOptimalBeadCount(scaled<coord_t>(1.3)) == uncached->getOptimalBeadCount(scaled<coord_t>(1.3)));
+                REQUIRE(cached->getTransitionThickness(2) == uncached->getTransitionThickness(2));
+            }
+        }
+        WHEN("Strategies with different parameters share the cache") {
+            require_same_beadings(*cached, *uncached);
+            const size_t misses = cache.stats().misses;
+            BeadingStrategyPtr wider_outer        = make_strategy(0.5, 0.45, true, &cache);
+            BeadingStrategyPtr without_thin_walls = make_strategy(0.42, 0.45, false, &cache);
+            THEN("Each one gets its own beadings") {
+                require_same_beadings(*wider_outer, *make_strategy(0.5, 0.45, true, nullptr));
+                REQUIRE(cache.stats().misses == 2 * misses);
+                require_same_beadings(*without_thin_walls, *make_strategy(0.42, 0.45, false, nullptr));
+                REQUIRE(cache.stats().misses == 3 * misses);
+                require_same_beadings(*cached, *uncached);
+                REQUIRE(cache.stats().misses == 3 * misses);
+            }
+        }
+        WHEN("The cache is cleared") {
+            require_same_beadings(*cached, *uncached);
+            cache.clear();
+            THEN("The beadings are computed again") {
+                REQUIRE(cache.stats().misses == 0);
+                require_same_beadings(*cached, *uncached);
+                REQUIRE(cache.stats().hits == 0);
+            }
+        }
+    }
+}
@@ -607,4 +607,23 @@ SCENARIO("Elephant foot compensation", "[ElephantFoot]") {
             }
         }
 	}
+
+	GIVEN("Bed full of islands") {
+		ExPolygons islands;
+		for (int i = 0; i < 10; ++ i)
+			for (int j = 0; j < 10; ++ j) {
+				ExPolygon expoly = (i + j) % 3 == 0 ? contour_with_hole() : (i + j) % 3 == 1 ? vase_with_fins() : thin_ring();
+				expoly.translate(Point::new_scale(25 * i, 25 * j));
+				islands.emplace_back(std::move(expoly));
+			}
+        WHEN("Compensated") {
+			const Flow flow(0.419999987f, 0.2f, 0.4f);
+			ExPolygons islands_compensated = elephant_foot_compensation(islands, flow, 0.2f);
+            THEN("the islands are compensated in place, the same as one by one") {
+				REQUIRE(islands_compensated.size() == islands.size());
+				for (size_t i = 0; i < islands.size(); ++ i)
+					REQUIRE(islands_compensated[i] == elephant_foot_compensation(islands[i], flow, 0.2f));
+            }
+        }
+	}
 }
@@ -1,8 +1,12 @@
 #include <iostream>
 #include <fstream>
+#include <map>
+#include <random>
 #include <catch2/catch.hpp>
+#include <test_utils.hpp>
 
 #include "libslic3r/TriangleMesh.hpp"
+#include "libslic3r/MeshSplitImpl.hpp"
 
 using namespace Slic3r;
 
@@ -102,6 +106,142 @@ TEST_CASE("Split two watertight meshes", "[its_split][its]") {
     debug_write_obj(res, "parts_watertight");
 }
 
+// Grid of cubes, the facets of the cubes are shuffled so that the parts interleave in the mesh.
+// Every other cube is turned inside out.
+static indexed_triangle_set make_shuffled_cubes(size_t num_cubes)
+{
+    indexed_triangle_set its;
+    for (size_t i = 0; i < num_cubes; ++ i) {
+        indexed_triangle_set cube = its_make_cube(1., 1., 1.);
+        if (i % 2 == 1)
+            its_flip_triangles(cube);
+        its_transform(cube, identity3f().translate(Vec3f{ 2.f * float(i % 100), 2.f * float(i / 100), 0.f }));
+        its_merge(its, cube);
+    }
+    std::mt19937 rng(42);
+    std::shuffle(its.indices.begin(), its.indices.end(), rng);
+    return its;
+}
+
+// Serial split visiting the parts from their lowest facet in depth first order.
+static std::vector<indexed_triangle_set> split_serial(const indexed_triangle_set &its)
+{
+    std::vector<Vec3i32>              neighbors = its_face_neighbors(its);
+    std::vector<char>                 visited(its.indices.size(), false);
+    std::vector<indexed_triangle_set> out;
+    for (size_t seed = 0; seed < its.indices.size(); ++ seed) {
+        if (visited[seed])
+            continue;
+        std::vector<size_t> facets { seed }, stack { seed };
+        visited[seed] = true;
+        while (! stack.empty()) {
+            size_t facet_idx = stack.back();
+            stack.pop_back();
+            for (int neighbor_idx : neighbors[facet_idx])
+                if (neighbor_idx >= 0 && ! visited[neighbor_idx]) {
+                    visited[neighbor_idx] = true;
+                    facets.emplace_back(neighbor_idx);
+                    stack.emplace_back(neighbor_idx);
+                }
+        }
+        indexed_triangle_set &part = out.emplace_back();
+        std::map<int, int>    vertex_map;
+        for (size_t facet_idx : facets) {
+            Vec3i32 face;
+            for (int v = 0; v < 3; ++ v) {
+                auto [it, inserted] = vertex_map.emplace(its.indices[facet_idx](v), int(part.vertices.size()));
+                if (inserted)
+                    part.vertices.emplace_back(its.vertices[it->first]);
+                face(v) = it->second;
+            }
+            part.indices.emplace_back(face);
+        }
+    }
+    return out;
+}
+
+TEST_CASE("Split thousands of interleaved parts", "[its_split][its]") {
+    const size_t         num_cubes = 5000;
+    indexed_triangle_set its       = make_shuffled_cubes(num_cubes);
+
+    std::vector<indexed_triangle_set> res = its_split(its);
+    REQUIRE(res.size() == num_cubes);
+    REQUIRE(its_number_of_patches(its) == num_cubes);
+
+    SECTION("Parts are ordered and traversed as by a serial split") {
+        std::vector<indexed_triangle_set> expected = split_serial(its);
+        REQUIRE(res.size() == expected.size());
+        for (size_t i = 0; i < res.size(); ++ i) {
+            REQUIRE(res[i].indices == expected[i].indices);
+            REQUIRE(res[i].vertices == expected[i].vertices);
+        }
+    }
+
+    SECTION("Repeated splits are identical") {
+        for (int run = 0; run < 3; ++ run) {
+            std::vector<indexed_triangle_set> again = its_split(its);
+            REQUIRE(again.size() == res.size());
+            for (size_t i = 0; i < res.size(); ++ i) {
+                REQUIRE(again[i].indices == res[i].indices);
+                REQUIRE(again[i].vertices == res[i].vertices);
+            }
+        }
+    }
+
+    SECTION("Parts of a TriangleMesh are oriented outwards") {
+        std::vector<TriangleMesh> meshes = TriangleMesh(its).split();
+        REQUIRE(meshes.size() == num_cubes);
+        for (size_t i = 0; i < meshes.size(); ++ i) {
+            REQUIRE(meshes[i].its.indices.size() == 12);
+            REQUIRE(meshes[i].its.vertices.size() == 8);
+            REQUIRE(meshes[i].volume() == Approx(1.));
+            REQUIRE(meshes[i].its.vertices == res[i].vertices);
+        }
+    }
+}
+
+TEST_CASE("Split with a neighbor index, which is not symmetric", "[its_split][its]") {
+    const size_t         num_cubes = 50;
+    indexed_triangle_set its       = make_shuffled_cubes(num_cubes);
+
+    // Keep only the links towards the lower facets, thus the lowest facet of a part does not link to any other facet.
+    std::vector<Vec3i32> neighbors = its_face_neighbors(its);
+    for (size_t facet_idx = 0; facet_idx < neighbors.size(); ++ facet_idx)
+        for (int v = 0; v < 3; ++ v)
+            if (neighbors[facet_idx](v) > int(facet_idx))
+                neighbors[facet_idx](v) = -1;
+
+    std::vector<indexed_triangle_set> res      = its_split(ItsNeighborsWrapper{ its, std::move(neighbors) });
+    std::vector<indexed_triangle_set> expected = its_split(its);
+    REQUIRE(res.size() == num_cubes);
+    REQUIRE(expected.size() == num_cubes);
+
+    // The facets are traversed in another order, compare the sets of vertices.
+    auto sorted_vertices = [](std::vector<Vec3f> vertices) {
+        std::sort(vertices.begin(), vertices.end(), [](const Vec3f &a, const Vec3f &b) {
+            return std::lexicographical_compare(a.data(), a.data() + 3, b.data(), b.data() + 3);
+        });
+        return vertices;
+    };
+    for (size_t i = 0; i < res.size(); ++ i) {
+        REQUIRE(res[i].indices.size() == 12);
+        REQUIRE(res[i].vertices.size() == 8);
+        REQUIRE(sorted_vertices(res[i].vertices) == sorted_vertices(expected[i].vertices));
+    }
+}
+
+TEST_CASE("Split a mesh of many parts", "[its_split][its][.Benchmark]") {
+    indexed_triangle_set its = make_shuffled_cubes(200000);
+
+    std::vector<indexed_triangle_set> expected, res;
+    std::vector<TriangleMesh>         meshes;
+    benchmark("Serial split", [&its, &expected]() { expected = split_serial(its); });
+    benchmark("its_split", [&its, &res]() { res = its_split(its); });
+    REQUIRE(res.size() == expected.size());
+    benchmark("TriangleMesh::split", [&its, &meshes]() { meshes = TriangleMesh(its).split(); });
+    REQUIRE(meshes.size() == expected.size());
+}
+
 #include <libslic3r/QuadricEdgeCollapse.hpp>
 static float triangle_area(const Vec3f &v0, const Vec3f &v1, const Vec3f &v2)
 {
@@ -3,6 +3,8 @@
 #include "libslic3r/Point.hpp"
 #include "libslic3r/Polygon.hpp"
 
+#include <random>
+
 using namespace Slic3r;
 
 SCENARIO("Converted Perl tests", "[Polygon]") {
@@ -148,3 +150,48 @@ SCENARIO("Remove collinear points from Polygon", "[Polygon]") {
         }
     }
 }
+
+SCENARIO("Douglas-Peucker simplification in place", "[Polygon]") {
+    GIVEN("Random polylines with straight runs, spikes and repeated points") {
+        std::mt19937                           rng(11);
+        std::uniform_real_distribution<double> random(-1., 1.);
+        std::uniform_int_distribution<int>     kind(0, 9);
+        std::vector<Points> polylines;
+        for (size_t num_points : { 2, 3, 4, 17, 100, 1000, 10000 })
+            for (int i = 0; i < 5; ++ i) {
+                Points points;
+                Vec2d  p = Vec2d::Zero(), dir(1., 0.);
+                for (size_t j = 0; j < num_points; ++ j) {
+                    switch (kind(rng)) {
+                    case 0:  break;                                                   // repeated point
+                    case 1:  p += Vec2d(random(rng), random(rng)) * 5.; break;        // spike
+                    case 2:  dir = Vec2d(random(rng), random(rng)); [[fallthrough]];  // turn
+                    default: p += dir * 0.3 + Vec2d(random(rng), random(rng)) * 0.005;
+                    }
+                    points.emplace_back(scale_(p.x()), scale_(p.y()));
+                }
+                polylines.emplace_back(std::move(points));
+            }
+        for (double tolerance : { 0., scale_(0.0125), scale_(0.05), scale_(1.) })
+            WHEN("Simplified with tolerance " + std::to_string(unscale<double>(tolerance))) {
+                THEN("The points kept in place are the points of the simplified copy") {
+                    for (const Points &polyline : polylines) {
+                        Points in_place = polyline;
+                        in_place.erase(MultiPoint::_douglas_peucker_inplace(in_place.begin(), in_place.end(), tolerance), in_place.end());
+                        REQUIRE(in_place == MultiPoint::_douglas_peucker(polyline, tolerance));
+                    }
+                }
+                THEN("Simplifying a part keeps the points around it") {
+                    for (const Points &polyline : polylines)
+                        if (polyline.size() > 10) {
+                            Points in_place = polyline;
+                            auto   end      = MultiPoint::_douglas_peucker_inplace(in_place.begin() + 3, in_place.end() - 3, tolerance);
+                            Points expected(polyline.begin(), polyline.begin() + 3);
+                            append(expected, MultiPoint::_douglas_peucker(Points(polyline.begin() + 3, polyline.end() - 3), tolerance));
+                            REQUIRE(Points(in_place.begin(), end) == expected);
+                            REQUIRE(Points(in_place.end() - 3, in_place.end()) == Points(polyline.end() - 3, polyline.end()));
+                        }
+                }
+            }
+    }
+}
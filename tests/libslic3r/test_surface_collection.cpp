@@ -0,0 +1,105 @@
+#include <catch2/catch.hpp>
+#include <test_utils.hpp>
+
+#include <cmath>
+#include <limits>
+#include <random>
+
+#include "libslic3r/SurfaceCollection.hpp"
+
+using namespace Slic3r;
+
+// Grouping by comparing each surface with the first surface of each group.
+static void group_pairwise(SurfaceCollection &surfaces, std::vector<SurfacesPtr> *retval)
+{
+    for (Surface &surface : surfaces.surfaces) {
+        SurfacesPtr *group = nullptr;
+        for (SurfacesPtr &g : *retval)
+            if (! g.empty() && surfaces_could_merge(*g.front(), surface)) {
+                group = &g;
+                break;
+            }
+        if (group == nullptr) {
+            retval->emplace_back();
+            group = &retval->back();
+        }
+        group->push_back(&surface);
+    }
+}
+
+// Layer with islands of mixed types, bridge angles and thicknesses.
+static SurfaceCollection make_mixed_surfaces(size_t num_surfaces, size_t num_bridge_angles)
+{
+    static constexpr const SurfaceType types[] = { stTop, stBottom, stBottomBridge, stInternal, stInternalSolid, stInternalBridge };
+    std::mt19937 rng(7);
+    SurfaceCollection out;
+    out.surfaces.reserve(num_surfaces);
+    for (size_t i = 0; i < num_surfaces; ++ i) {
+        Surface &surface = out.surfaces.emplace_back(types[rng() % std::size(types)],
+            ExPolygon(Polygon{ { coord_t(i) * 10, 0 }, { coord_t(i) * 10 + 5, 0 }, { coord_t(i) * 10 + 5, 5 } }));
+        surface.thickness        = (rng() % 3) * 0.1;
+        surface.thickness_layers = (unsigned short)(1 + rng() % 2);
+        if (surface.is_bridge())
+            surface.bridge_angle = double(rng() % num_bridge_angles) * 0.01;
+    }
+    return out;
+}
+
+static void require_same_groups(const std::vector<SurfacesPtr> &groups, const std::vector<SurfacesPtr> &expected)
+{
+    REQUIRE(groups.size() == expected.size());
+    for (size_t i = 0; i < groups.size(); ++ i)
+        REQUIRE(groups[i] == expected[i]);
+}
+
+SCENARIO("Grouping of the surfaces, which could merge", "[SurfaceCollection]") {
+    GIVEN("A layer with thousands of mixed surfaces") {
+        SurfaceCollection surfaces = make_mixed_surfaces(5000, 50);
+        WHEN("The surfaces are grouped") {
+            std::vector<SurfacesPtr> groups, expected;
+            surfaces.group(&groups);
+            group_pairwise(surfaces, &expected);
+            THEN("The groups, their order and their members are the same as by pairwise comparison") {
+                require_same_groups(groups, expected);
+            }
+        }
+        WHEN("The surfaces are grouped into existing groups") {
+            SurfaceCollection other = make_mixed_surfaces(100, 5);
+            std::vector<SurfacesPtr> groups, expected;
+            other.group(&groups);
+            groups.emplace_back();
+            groups.front().clear();
+            expected = groups;
+            surfaces.group(&groups);
+            group_pairwise(surfaces, &expected);
+            THEN("The surfaces join the same existing groups as by pairwise comparison") {
+                require_same_groups(groups, expected);
+            }
+        }
+    }
+    GIVEN("Surfaces with a negative zero and a NaN bridge angle") {
+        SurfaceCollection surfaces;
+        for (double angle : { 0., -0., std::numeric_limits<double>::quiet_NaN(), 0., std::numeric_limits<double>::quiet_NaN() }) {
+            Surface &surface = surfaces.surfaces.emplace_back(stBottomBridge, ExPolygon(Polygon{ { 0, 0 }, { 5, 0 }, { 5, 5 } }));
+            surface.bridge_angle = angle;
+        }
+        WHEN("The surfaces are grouped") {
+            std::vector<SurfacesPtr> groups, expected;
+            surfaces.group(&groups);
+            group_pairwise(surfaces, &expected);
+            THEN("Zeros merge, while NaNs do not merge with anything") {
+                REQUIRE(groups.size() == 3);
+                require_same_groups(groups, expected);
+            }
+        }
+    }
+}
+
+TEST_CASE("Grouping of the surfaces of a layer with many islands", "[SurfaceCollection][.Benchmark]") {
+    SurfaceCollection surfaces = make_mixed_surfaces(50000, 1000);
+
+    std::vector<SurfacesPtr> expected, groups;
+    benchmark("Pairwise grouping", [&surfaces, &expected]() { group_pairwise(surfaces, &expected); });
+    benchmark("SurfaceCollection::group", [&surfaces, &groups]() { surfaces.group(&groups); });
+    require_same_groups(groups, expected);
+}
@@ -0,0 +1,140 @@
+#include <catch2/catch.hpp>
+#include <test_utils.hpp>
+
+#include "libslic3r/Feature/Interlocking/VoxelUtils.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <random>
+#include <set>
+#include <tuple>
+#include <unordered_set>
+
+using namespace Slic3r;
+
+namespace std {
+template<> struct hash<Slic3r::GridPoint3>
+{
+    size_t operator()(const Slic3r::GridPoint3& p) const noexcept { return size_t(p.x()) * 73856093 ^ size_t(p.y()) * 19349663 ^ size_t(p.z()) * 83492791; }
+};
+} // namespace std
+
+using CellSet = std::set<std::tuple<coord_t, coord_t, coord_t>>;
+
+static CellSet to_cell_set(const VoxelGrid& grid)
+{
+    CellSet out;
+    grid.forEach([&out](const GridPoint3& p) { out.emplace(p.x(), p.y(), p.z()); });
+    return out;
+}
+
+// Cells of a cylindrical shell, as produced by the outlines of a round object.
+static std::vector<GridPoint3> cylinder_shell(coord_t center_x, coord_t radius, coord_t height)
+{
+    std::vector<GridPoint3> out;
+    for (coord_t z = 0; z < height; ++ z)
+        for (int i = 0; i < 16 * radius; ++ i) {
+            double angle = 2. * PI * double(i) / double(16 * radius);
+            out.emplace_back(center_x + coord_t(std::round(radius * std::cos(angle))), coord_t(std::round(radius * std::sin(angle))), z);
+        }
+    return out;
+}
+
+static VoxelGrid to_grid(const std::vector<GridPoint3>& cells)
+{
+    GridPoint3 min = cells.front(), max = cells.front();
+    for (const GridPoint3& p : cells) {
+        min = min.cwiseMin(p);
+        max = max.cwiseMax(p);
+    }
+    VoxelGrid grid(min, max);
+    for (const GridPoint3& p : cells)
+        grid.insert(p);
+    return grid;
+}
+
+TEST_CASE("Voxel grid dilation matches dilation of single cells", "[VoxelGrid]") {
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<coord_t> dist(-70, 70);
+    std::vector<GridPoint3> seeds;
+    for (size_t i = 0; i < 500; ++ i)
+        seeds.emplace_back(dist(rng), dist(rng) / 2, dist(rng) / 10);
+    const VoxelGrid seeds_grid = to_grid(seeds);
+
+    for (DilationKernel::Type type : { DilationKernel::Type::CUBE, DilationKernel::Type::DIAMOND, DilationKernel::Type::PRISM })
+        for (coord_t size : { 1, 2, 3, 4 }) {
+            const DilationKernel kernel(GridPoint3(size, size, size), type);
+            CellSet expected;
+            for (const GridPoint3& p : seeds)
+                for (const GridPoint3& rel : kernel.relative_cells_)
+                    if (p.z() + rel.z() >= 0)
+                        expected.emplace(p.x() + rel.x(), p.y() + rel.y(), p.z() + rel.z());
+            // Output bounds unaligned with the seeds, cutting off the cells below zero.
+            VoxelGrid dilated(GridPoint3(-75, -40, 0), GridPoint3(75, 40, 10));
+            seeds_grid.dilateInto(kernel, dilated);
+            REQUIRE(to_cell_set(dilated) == expected);
+        }
+}
+
+TEST_CASE("Voxel grid set operations", "[VoxelGrid]") {
+    const std::vector<GridPoint3> cells_a = cylinder_shell(0, 40, 20);
+    const std::vector<GridPoint3> cells_b = cylinder_shell(50, 30, 30);
+    CellSet set_a, set_b;
+    for (const GridPoint3& p : cells_a)
+        set_a.emplace(p.x(), p.y(), p.z());
+    for (const GridPoint3& p : cells_b)
+        set_b.emplace(p.x(), p.y(), p.z());
+
+    VoxelGrid intersection = to_grid(cells_a);
+    REQUIRE(to_cell_set(intersection) == set_a);
+    intersection.intersect(to_grid(cells_b));
+    CellSet expected_intersection;
+    std::set_intersection(set_a.begin(), set_a.end(), set_b.begin(), set_b.end(), std::inserter(expected_intersection, expected_intersection.end()));
+    REQUIRE(! expected_intersection.empty());
+    REQUIRE(to_cell_set(intersection) == expected_intersection);
+    for (const GridPoint3& p : cells_a)
+        REQUIRE(intersection.contains(p) == (expected_intersection.count({ p.x(), p.y(), p.z() }) > 0));
+
+    VoxelGrid difference = to_grid(cells_a);
+    difference.subtract(to_grid(cells_b));
+    CellSet expected_difference;
+    std::set_difference(set_a.begin(), set_a.end(), set_b.begin(), set_b.end(), std::inserter(expected_difference, expected_difference.end()));
+    REQUIRE(to_cell_set(difference) == expected_difference);
+
+    difference.subtract(to_grid(cells_a));
+    REQUIRE(difference.empty());
+    REQUIRE(VoxelGrid().empty());
+}
+
+TEST_CASE("Voxel grid benchmark", "[VoxelGrid][.Benchmark]") {
+    // Shells of two large interpenetrating cylinders of different materials, 0.8mm cells over 250mm.
+    const std::vector<GridPoint3> cells_a = cylinder_shell(0, 150, 300);
+    const std::vector<GridPoint3> cells_b = cylinder_shell(100, 150, 300);
+    const DilationKernel          kernel(GridPoint3(2, 2, 2), DilationKernel::Type::PRISM);
+
+    size_t hash_count = 0;
+    benchmark("Hash set", [&]() {
+        std::unordered_set<GridPoint3> set_a, set_b;
+        for (const GridPoint3& p : cells_a)
+            for (const GridPoint3& rel : kernel.relative_cells_)
+                set_a.emplace(p + rel);
+        for (const GridPoint3& p : cells_b)
+            for (const GridPoint3& rel : kernel.relative_cells_)
+                set_b.emplace(p + rel);
+        for (const GridPoint3& p : set_a)
+            hash_count += set_b.count(p);
+    });
+
+    size_t grid_count = 0;
+    benchmark("Voxel grid", [&]() {
+        VoxelGrid grid_a(GridPoint3(-152, -152, -1), GridPoint3(152, 152, 300));
+        VoxelGrid grid_b(GridPoint3(-52, -152, -1), GridPoint3(252, 152, 300));
+        to_grid(cells_a).dilateInto(kernel, grid_a);
+        to_grid(cells_b).dilateInto(kernel, grid_b);
+        grid_a.intersect(grid_b);
+        grid_a.forEach([&grid_count](const GridPoint3&) { ++ grid_count; });
+    });
+
+    REQUIRE(grid_count == hash_count);
+}
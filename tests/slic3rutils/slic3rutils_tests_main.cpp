@@ -1,6 +1,7 @@
 #include <catch_main.hpp>
 
 #include "slic3r/Utils/Http.hpp"
+#include "slic3r/GUI/MeshUtils.hpp"
 
 TEST_CASE("Check SSL certificates paths", "[Http][NotWorking]") {
     
@@ -58,3 +59,33 @@ TEST_CASE("Http basic authentication", "[Http][NotWorking]") {
     REQUIRE(status == 200);
 }
 
+
+TEST_CASE("Instances of a mesh share one raycaster", "[MeshRaycaster]") {
+    using namespace Slic3r;
+    auto cube   = std::make_shared<const TriangleMesh>(its_make_cube(10., 10., 10.));
+    auto sphere = std::make_shared<const TriangleMesh>(its_make_sphere(5., PI / 16.));
+
+    GUI::MeshRaycasterCache cache;
+    std::vector<std::shared_ptr<const GUI::MeshRaycaster>> instances;
+    for (size_t i = 0; i < 200; ++ i)
+        instances.emplace_back(cache.get(cube));
+    for (const auto &raycaster : instances)
+        REQUIRE(raycaster == instances.front());
+    REQUIRE(cache.get(sphere) != instances.front());
+
+    // Picking through the shared raycaster matches a raycaster built for a single instance.
+    const GUI::MeshRaycaster single(cube);
+    for (size_t i = 0; i < instances.size(); ++ i) {
+        const Transform3d trafo = Geometry::translation_transform(Vec3d(20. * double(i % 10), 20. * double(i / 10), 0.));
+        const Vec3d       point = trafo * Vec3d(5., 5., 20.);
+        for (const Vec3d &direction : { Vec3d(0., 0., -1.), Vec3d(1., 0., 0.) })
+            REQUIRE(instances[i]->intersects_line(point, direction, trafo) == single.intersects_line(point, direction, trafo));
+    }
+    REQUIRE(instances.front()->get_closest_point(Vec3f(5.f, 5.f, 20.f)) == single.get_closest_point(Vec3f(5.f, 5.f, 20.f)));
+
+    // The raycaster is released with the last instance, and built again when the mesh is loaded again.
+    instances.clear();
+    auto reloaded = cache.get(cube);
+    REQUIRE(reloaded);
+    REQUIRE(reloaded.use_count() == 1);
+}
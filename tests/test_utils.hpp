@@ -3,6 +3,10 @@
 
 #include <libslic3r/TriangleMesh.hpp>
 #include <libslic3r/Format/OBJ.hpp>
+#include <libslic3r/Timer.hpp>
+
+#include <iostream>
+#include <string>
 
 #if defined(WIN32) || defined(_WIN32)
 #define PATH_SEPARATOR R"(\)"
@@ -20,4 +24,17 @@ inline Slic3r::TriangleMesh load_model(const std::string &obj_filename)
     return mesh;
 }
 
+// Run fn once, print its wall time prefixed by the label and return it in milliseconds.
+// Used by the hidden [.Benchmark] test cases, which are run on demand only.
+template<typename Fn>
+double benchmark(const std::string &label, Fn &&fn)
+{
+    Slic3r::Timing::Timer timer;
+    timer.start();
+    fn();
+    const double milliseconds = double(timer.elapsed_nanoseconds()) / 1000000.;
+    std::cout << label << ": " << milliseconds << " ms" << std::endl;
+    return milliseconds;
+}
+
 #endif // SLIC3R_TEST_UTILS